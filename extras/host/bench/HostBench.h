@@ -0,0 +1,65 @@
+// HostBench.h
+// Timing and reporting of the host benchmarks. Every result is one line "bench metric value unit",
+// so runs can be diffed or collected with grep. --quick runs a short pass, ctest uses it as a smoke test.
+// Numbers are from the build host (x86-64, -O2), they compare code paths, they are not board timings.
+
+#ifndef _HOST_HOSTBENCH_h
+#define _HOST_HOSTBENCH_h
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+class HostBench
+{
+public:
+    static void Init(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--quick") == 0)
+                s_Quick() = true;
+        }
+    }
+
+    static bool IsQuick()
+    {
+        return s_Quick();
+    }
+
+    // Iterations of a loop, a hundredth of them with --quick
+    static unsigned long Iterations(unsigned long full)
+    {
+        return (s_Quick() && full >= 100) ? full / 100 : full;
+    }
+
+    static double Seconds()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Time stamp counter, 0 where there is none
+    static uint64_t Cycles()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    static void Report(const char* bench, const char* metric, double value, const char* unit)
+    {
+        printf("%-24s %-32s %14.2f %s\n", bench, metric, value, unit);
+        fflush(stdout);
+    }
+
+private:
+    static bool& s_Quick() { static bool quick = false; return quick; }
+};
+
+#endif
@@ -0,0 +1,80 @@
+// ChaChaPoly: cycles per byte of Block(), Encrypt() and Decrypt(), on the payload of one credential record
+// (ssid and password, 8 authenticated bytes) and on larger buffers.
+
+#include <ChaChaPoly.h>
+#include <CredentialsHandler.h>
+#include "HostBench.h"
+
+#define BENCH_RECORD_PAYLOAD (CREDENTIALS_SSID_SIZE + CREDENTIALS_PASS_SIZE)
+#define BENCH_RECORD_AAD 8
+
+static uint8_t G_Key[CHACHAPOLY_KEY_SIZE];
+static uint8_t G_Nonce[CHACHAPOLY_NONCE_SIZE];
+
+static void BenchBlock()
+{
+    uint32_t block[16];
+    unsigned long iterations = HostBench::Iterations(5000000);
+    volatile uint32_t sink = 0;
+
+    uint64_t cycles = HostBench::Cycles();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        ChaChaPoly::Block(G_Key, i, G_Nonce, block);
+        sink += block[0];
+    }
+    cycles = HostBench::Cycles() - cycles;
+    HostBench::Report("chachapoly", "block_cycles", (double)cycles / iterations, "cycles/block");
+    HostBench::Report("chachapoly", "block_cycles_per_byte", (double)cycles / iterations / 64, "cycles/byte");
+}
+
+static void BenchAead(const char* name, size_t length, size_t aadLength, unsigned long full)
+{
+    uint8_t data[4096], aad[16], tag[CHACHAPOLY_TAG_SIZE];
+    unsigned long iterations = HostBench::Iterations(full);
+    char metric[64];
+    memset(data, 0x5a, length);
+    memset(aad, 0xa5, sizeof(aad));
+
+    uint64_t cycles = HostBench::Cycles();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        G_Nonce[0] = (uint8_t)i;
+        ChaChaPoly::Encrypt(G_Key, G_Nonce, aad, aadLength, data, length, tag);
+    }
+    cycles = HostBench::Cycles() - cycles;
+    snprintf(metric, sizeof(metric), "encrypt_%s", name);
+    HostBench::Report("chachapoly", metric, (double)cycles / iterations / length, "cycles/byte");
+    snprintf(metric, sizeof(metric), "encrypt_%s_call", name);
+    HostBench::Report("chachapoly", metric, (double)cycles / iterations, "cycles");
+
+    // Decrypt pays the tag first, then the key stream
+    unsigned long failures = 0;
+    cycles = HostBench::Cycles();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        if (!ChaChaPoly::Decrypt(G_Key, G_Nonce, aad, aadLength, data, length, tag))
+            failures++;
+        ChaChaPoly::Encrypt(G_Key, G_Nonce, aad, aadLength, data, length, tag);
+    }
+    cycles = HostBench::Cycles() - cycles;
+    snprintf(metric, sizeof(metric), "decrypt_encrypt_%s", name);
+    HostBench::Report("chachapoly", metric, (double)cycles / iterations / length, "cycles/byte");
+    if (failures > 0)
+    {
+        fprintf(stderr, "%lu tags did not verify\n", failures);
+        exit(1);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    HostBench::Init(argc, argv);
+    for (int i = 0; i < CHACHAPOLY_KEY_SIZE; i++)
+        G_Key[i] = (uint8_t)(0x80 + i);
+    BenchBlock();
+    BenchAead("record", BENCH_RECORD_PAYLOAD, BENCH_RECORD_AAD, 2000000);
+    BenchAead("1k", 1024, 0, 200000);
+    BenchAead("4k", 4096, 0, 50000);
+    return 0;
+}
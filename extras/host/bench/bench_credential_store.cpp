@@ -0,0 +1,128 @@
+// Flash traffic of the credential journal against the erase and rewrite it replaced: 1000 re-provisions,
+// each a new password for one of three networks followed by the successful connect that records lastSuccess.
+// The rewrite erases the file and writes the whole store on every change, the journal appends a record and
+// erases only when it compacts. File erases, write calls and bytes come from the WiFiStorage stand-in.
+
+#include <CredentialsHandler.h>
+#include <HostSim.h>
+#include "HostBench.h"
+
+#define BENCH_PROVISIONS 1000
+#define BENCH_NETWORKS 3
+#define BENCH_LEGACY_FILE "/fs/WifiLegacyStore"
+#define BENCH_LEGACY_HEADER 8            // Store version 1: 8 byte header, 112 byte records
+#define BENCH_LEGACY_RECORD 112
+
+static const char* const G_Networks[BENCH_NETWORKS] = { "Home", "Cafe", "Office" };
+
+struct StoreTraffic
+{
+    unsigned long erases;
+    unsigned long writes;
+    unsigned long bytesWritten;
+    double seconds;
+};
+
+// The write of store version 1: erase, then the full file in one write
+static void LegacyRewrite(int count)
+{
+    uint8_t buffer[BENCH_LEGACY_HEADER + CREDENTIALS_MAX_NETWORKS * BENCH_LEGACY_RECORD];
+    memset(buffer, 0xA5, sizeof(buffer));
+    WiFiStorageFile file = WiFiStorage.open(BENCH_LEGACY_FILE);
+    if (file)
+        file.erase();
+    file.write(buffer, BENCH_LEGACY_HEADER + count * BENCH_LEGACY_RECORD);
+    file.close();
+}
+
+static StoreTraffic Collect(double start)
+{
+    StoreTraffic traffic;
+    const HostStorageStats& stats = HostStorage::GetStats();
+    traffic.erases = stats.erases;
+    traffic.writes = stats.writes;
+    traffic.bytesWritten = stats.bytesWritten;
+    traffic.seconds = HostBench::Seconds() - start;
+    return traffic;
+}
+
+static StoreTraffic RunLegacy(unsigned long provisions)
+{
+    HostStorage::Clear();
+    HostStorage::ResetStats();
+    int count = 0;
+    double start = HostBench::Seconds();
+    for (unsigned long i = 0; i < provisions; i++)
+    {
+        if (count < BENCH_NETWORKS)
+            count++;
+        LegacyRewrite(count);                       // new password
+        LegacyRewrite(count);                       // lastSuccess of the connect
+    }
+    return Collect(start);
+}
+
+static StoreTraffic RunJournal(unsigned long provisions)
+{
+    HostStorage::Clear();
+    CredentialsHandler::Invalidate();
+    HostStorage::ResetStats();
+    double start = HostBench::Seconds();
+    for (unsigned long i = 0; i < provisions; i++)
+    {
+        const char* ssid = G_Networks[i % BENCH_NETWORKS];
+        char password[24];
+        snprintf(password, sizeof(password), "password-%lu", i);
+        if (CredentialsHandler::AddNetwork(ssid, password, CREDENTIALS_DEFAULT_PRIORITY) == 0
+            || CredentialsHandler::MarkConnected(ssid, 1700000000 + i) == 0)
+        {
+            fprintf(stderr, "store write %lu failed\n", i);
+            exit(1);
+        }
+    }
+    StoreTraffic traffic = Collect(start);
+
+    // Nothing lost on the way
+    WiFiNetworkCredentials network;
+    CredentialsHandler::Invalidate();
+    int index = CredentialsHandler::FindNetwork(G_Networks[(provisions - 1) % BENCH_NETWORKS]);
+    char expected[24];
+    snprintf(expected, sizeof(expected), "password-%lu", provisions - 1);
+    if (CredentialsHandler::GetNetworkCount() != BENCH_NETWORKS || !CredentialsHandler::GetNetwork(index, network)
+        || strcmp(network.password, expected) != 0)
+    {
+        fprintf(stderr, "store does not hold the last provision\n");
+        exit(1);
+    }
+    return traffic;
+}
+
+static void Report(const char* variant, const StoreTraffic& traffic, unsigned long provisions)
+{
+    char metric[64];
+    double scale = (double)BENCH_PROVISIONS / provisions;
+    snprintf(metric, sizeof(metric), "%s_erases", variant);
+    HostBench::Report("credential_store", metric, traffic.erases * scale, "per 1000 provisions");
+    snprintf(metric, sizeof(metric), "%s_writes", variant);
+    HostBench::Report("credential_store", metric, traffic.writes * scale, "per 1000 provisions");
+    snprintf(metric, sizeof(metric), "%s_bytes_written", variant);
+    HostBench::Report("credential_store", metric, traffic.bytesWritten * scale, "per 1000 provisions");
+    snprintf(metric, sizeof(metric), "%s_time", variant);
+    HostBench::Report("credential_store", metric, traffic.seconds * 1e6 / provisions, "us/provision (host files)");
+}
+
+int main(int argc, char** argv)
+{
+    HostBench::Init(argc, argv);
+    unsigned long provisions = HostBench::IsQuick() ? 100 : BENCH_PROVISIONS;
+
+    StoreTraffic legacy = RunLegacy(provisions);
+    StoreTraffic journal = RunJournal(provisions);
+    WiFiCredentialStoreStats stats = CredentialsHandler::GetStoreStats();
+    Report("rewrite", legacy, provisions);
+    Report("journal", journal, provisions);
+    HostBench::Report("credential_store", "journal_appends", stats.appends, "records");
+    HostBench::Report("credential_store", "journal_compactions", stats.compactions, "rewrites");
+    HostBench::Report("credential_store", "erase_ratio", (double)legacy.erases / (journal.erases > 0 ? journal.erases : 1), "x fewer erases");
+    return (journal.erases < legacy.erases) ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+// Captive portal DNS: DnsResponder::BuildReply() on its own, and bursts of queries through the portal's UDP
+// socket as a phone sends them after joining, answered DNS_MAX_PACKETS_PER_POLL per Poll().
+
+#include <EasyWiFi.h>
+#include <DnsResponder.h>
+#include <HostSim.h>
+#include <algorithm>
+#include <vector>
+#include "HostBench.h"
+#include "HostPhone.h"
+
+#define BENCH_BURST 32                   // Queries a phone fires right after joining, the A lookups of its check hosts
+
+static const char* const G_Names[] =
+{
+    "connectivitycheck.gstatic.com",
+    "clients3.google.com",
+    "www.google.com",
+    "captive.apple.com",
+    "www.msftconnecttest.com",
+    "detectportal.firefox.com",
+    "android.clients.google.com",
+    "time.android.com"
+};
+#define BENCH_NAMES (sizeof(G_Names) / sizeof(G_Names[0]))
+
+static void BenchBuildReply()
+{
+    uint8_t query[300], packet[UDP_PACKET_SIZE];
+    int length = HostPhone::BuildDnsQuery(1, G_Names[0], query, sizeof(query));
+    unsigned long iterations = HostBench::Iterations(5000000);
+    volatile size_t sink = 0;
+
+    double start = HostBench::Seconds();
+    uint64_t cycles = HostBench::Cycles();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        memcpy(packet, query, length);
+        sink += DnsResponder::BuildReply(packet, length, sizeof(packet), IPAddress(172, 217, 28, 1));
+    }
+    cycles = HostBench::Cycles() - cycles;
+    double elapsed = HostBench::Seconds() - start;
+
+    HostBench::Report("dns", "build_reply_rate", iterations / elapsed / 1e6, "M queries/s");
+    HostBench::Report("dns", "build_reply_cycles", (double)cycles / iterations, "cycles/query");
+}
+
+// Fire BENCH_BURST queries at once, then poll until every reply is back
+static void BenchBursts(EasyWiFi& wifi)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(HostNet::GetPort(53));
+
+    unsigned long bursts = HostBench::Iterations(2000);
+    std::vector<double> times;
+    unsigned long polls = 0, replies = 0;
+    uint8_t query[300], reply[512];
+    uint16_t id = 0;
+
+    double start = HostBench::Seconds();
+    for (unsigned long b = 0; b < bursts; b++)
+    {
+        double burstStart = HostBench::Seconds();
+        for (int q = 0; q < BENCH_BURST; q++)
+        {
+            int length = HostPhone::BuildDnsQuery(++id, G_Names[q % BENCH_NAMES], query, sizeof(query));
+            sendto(fd, query, length, 0, (struct sockaddr*)&address, sizeof(address));
+        }
+        int received = 0;
+        while (received < BENCH_BURST)
+        {
+            wifi.Poll();
+            polls++;
+            while (recv(fd, reply, sizeof(reply), 0) > 0)
+                received++;
+            if (HostBench::Seconds() - burstStart > 5)
+            {
+                fprintf(stderr, "burst %lu: %d of %d replies\n", b, received, BENCH_BURST);
+                exit(1);
+            }
+        }
+        replies += received;
+        times.push_back(HostBench::Seconds() - burstStart);
+    }
+    double elapsed = HostBench::Seconds() - start;
+    close(fd);
+    std::sort(times.begin(), times.end());
+
+    HostBench::Report("dns", "burst_size", BENCH_BURST, "queries");
+    HostBench::Report("dns", "portal_rate", replies / elapsed, "queries/s (loopback)");
+    HostBench::Report("dns", "burst_p50", times[times.size() / 2] * 1e6, "us (loopback)");
+    HostBench::Report("dns", "burst_p99", times[times.size() * 99 / 100] * 1e6, "us (loopback)");
+    HostBench::Report("dns", "polls_per_burst", (double)polls / bursts, "Poll() calls");
+    HostBench::Report("dns", "queue_high_water", wifi.GetDnsStats().queueHighWater, "queries in one Poll()");
+}
+
+int main(int argc, char** argv)
+{
+    HostBench::Init(argc, argv);
+    BenchBuildReply();
+
+    EasyWiFi wifi;
+    HostWiFi::AddNetwork("Home", "secretpass", -48);
+    wifi.Begin();
+    for (unsigned long elapsed = 0; wifi.Poll() != EASYWIFI_PORTAL; elapsed += 5)
+    {
+        if (elapsed > 600000)
+        {
+            fprintf(stderr, "portal did not open\n");
+            return 1;
+        }
+        HostClock::Advance(5);
+    }
+    HostWiFi::SetStationJoined(true);
+    BenchBursts(wifi);
+    return 0;
+}
@@ -0,0 +1,129 @@
+// The gzip copies of the static portal pages: size on the wire, TCP segments and time per request with and
+// without Accept-Encoding: gzip, and what inflating costs the phone. The gzip copy must inflate to the page.
+
+#include <EasyWiFi.h>
+#include <HostSim.h>
+#include <PortalAssets.h>
+#include <algorithm>
+#include <vector>
+#include <zlib.h>
+#include "HostBench.h"
+#include "HostPhone.h"
+
+static void PumpWiFi(void* context)
+{
+    ((EasyWiFi*)context)->Poll();
+    HostClock::Advance(1);
+}
+
+// Inflate a gzip member as a browser does, false if it is broken
+static bool Inflate(const uint8_t* data, size_t size, std::string& out)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+        return false;
+    char buffer[4096];
+    int result;
+    out.clear();
+    stream.next_in = (Bytef*)data;
+    stream.avail_in = size;
+    do
+    {
+        stream.next_out = (Bytef*)buffer;
+        stream.avail_out = sizeof(buffer);
+        result = inflate(&stream, Z_NO_FLUSH);
+        out.append(buffer, sizeof(buffer) - stream.avail_out);
+    } while (result == Z_OK);
+    inflateEnd(&stream);
+    return result == Z_STREAM_END;
+}
+
+static void MeasureAsset(const char* name, const char* page, size_t pageSize, const uint8_t* pageGzip, size_t pageGzipSize)
+{
+    char metric[64];
+    std::string inflated;
+    if (!Inflate(pageGzip, pageGzipSize, inflated) || inflated != std::string(page, pageSize))
+    {
+        fprintf(stderr, "%s: gzip copy does not inflate to the page\n", name);
+        exit(1);
+    }
+    unsigned long iterations = HostBench::Iterations(100000);
+    double start = HostBench::Seconds();
+    for (unsigned long i = 0; i < iterations; i++)
+        Inflate(pageGzip, pageGzipSize, inflated);
+    double inflateTime = HostBench::Seconds() - start;
+
+    snprintf(metric, sizeof(metric), "%s_bytes", name);
+    HostBench::Report("gzip_assets", metric, pageSize, "B");
+    snprintf(metric, sizeof(metric), "%s_gzip_bytes", name);
+    HostBench::Report("gzip_assets", metric, pageGzipSize, "B");
+    snprintf(metric, sizeof(metric), "%s_gzip_ratio", name);
+    HostBench::Report("gzip_assets", metric, 100.0 * pageGzipSize / pageSize, "%");
+    snprintf(metric, sizeof(metric), "%s_inflate_time", name);
+    HostBench::Report("gzip_assets", metric, inflateTime / iterations * 1e6, "us (phone side, host CPU)");
+}
+
+// Median time of a GET of path, bytes and write() calls of one response at the simulated module
+static void MeasureRoute(EasyWiFi& wifi, const char* name, const char* path, bool gzip)
+{
+    HostPhone phone(PumpWiFi, &wifi);
+    HostHttpResponse response;
+    const char* headers = gzip ? "Accept-Encoding: gzip, deflate\r\n" : "";
+    unsigned long iterations = HostBench::Iterations(2000);
+    std::vector<double> times;
+    unsigned long bytes = 0, writes = 0;
+    char metric[64];
+
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        HostNet::ResetStats();
+        double start = HostBench::Seconds();
+        if (!phone.Get(path, response, headers) || response.status != 200 || response.gzip != gzip)
+        {
+            fprintf(stderr, "GET %s failed\n", path);
+            exit(1);
+        }
+        times.push_back(HostBench::Seconds() - start);
+        bytes = HostNet::GetStats().tcpBytes;
+        writes = HostNet::GetStats().tcpWrites;
+    }
+    std::sort(times.begin(), times.end());
+
+    const char* variant = gzip ? "gzip" : "plain";
+    snprintf(metric, sizeof(metric), "portal_%s_%s_bytes", name, variant);
+    HostBench::Report("gzip_assets", metric, bytes, "B (header and body)");
+    snprintf(metric, sizeof(metric), "portal_%s_%s_segments", name, variant);
+    HostBench::Report("gzip_assets", metric, (bytes + HTTP_RESPONSE_BUFFER_SIZE - 1) / HTTP_RESPONSE_BUFFER_SIZE, "TCP segments");
+    snprintf(metric, sizeof(metric), "portal_%s_%s_writes", name, variant);
+    HostBench::Report("gzip_assets", metric, writes, "write() calls");
+    snprintf(metric, sizeof(metric), "portal_%s_%s_p50", name, variant);
+    HostBench::Report("gzip_assets", metric, times[times.size() / 2] * 1e6, "us (loopback)");
+}
+
+int main(int argc, char** argv)
+{
+    HostBench::Init(argc, argv);
+    MeasureAsset("start", PORTAL_START_PAGE, sizeof(PORTAL_START_PAGE) - 1, PORTAL_START_PAGE_GZ, sizeof(PORTAL_START_PAGE_GZ));
+    MeasureAsset("password", PORTAL_PASSWORD_PAGE, sizeof(PORTAL_PASSWORD_PAGE) - 1, PORTAL_PASSWORD_PAGE_GZ, sizeof(PORTAL_PASSWORD_PAGE_GZ));
+
+    EasyWiFi wifi;
+    HostWiFi::AddNetwork("Home", "secretpass", -48);
+    wifi.Begin();
+    for (unsigned long elapsed = 0; wifi.Poll() != EASYWIFI_PORTAL; elapsed += 5)
+    {
+        if (elapsed > 600000)
+        {
+            fprintf(stderr, "portal did not open\n");
+            return 1;
+        }
+        HostClock::Advance(5);
+    }
+    HostWiFi::SetStationJoined(true);
+
+    MeasureRoute(wifi, "start", "/", false);
+    MeasureRoute(wifi, "start", "/", true);
+    MeasureRoute(wifi, "password", "/enterPassword?network=Home", false);
+    MeasureRoute(wifi, "password", "/enterPassword?network=Home", true);
+    return 0;
+}
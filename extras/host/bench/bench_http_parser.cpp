@@ -0,0 +1,173 @@
+// HttpRequestParser against the String based request handling it replaced: bytes per second and heap use
+// for a POST /connect as a phone browser sends it.
+
+#include <Arduino.h>
+#include <HostSim.h>
+#include <HttpRequestParser.h>
+#include "HostBench.h"
+
+static const char REQUEST_HEAD[] =
+    "POST /connect HTTP/1.1\r\n"
+    "Host: 172.217.28.1\r\n"
+    "Connection: keep-alive\r\n"
+    "Content-Length: %u\r\n"
+    "User-Agent: Mozilla/5.0 (Linux; Android 13; Pixel 7) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/118.0.0.0 Mobile Safari/537.36\r\n"
+    "Content-Type: application/x-www-form-urlencoded\r\n"
+    "Accept: */*\r\n"
+    "Origin: http://172.217.28.1\r\n"
+    "Referer: http://172.217.28.1/enterPassword?network=My%%20Home%%20WiFi\r\n"
+    "Accept-Encoding: gzip, deflate\r\n"
+    "Accept-Language: en-US,en;q=0.9\r\n"
+    "\r\n";
+static const char REQUEST_BODY[] = "network=My%20Home%20WiFi&password=correct%20horse%20battery%2Bstaple";
+
+// A request in memory, read the way WiFiClient is
+class MemoryStream : public Stream
+{
+public:
+    MemoryStream(const char* data, size_t length) : m_Data(data), m_Length(length), m_Offset(0) {}
+    void Rewind() { m_Offset = 0; }
+    virtual int available() { return m_Length - m_Offset; }
+    virtual int read() { return (m_Offset < m_Length) ? (uint8_t)m_Data[m_Offset++] : -1; }
+    virtual int peek() { return (m_Offset < m_Length) ? (uint8_t)m_Data[m_Offset] : -1; }
+    virtual size_t write(uint8_t) { return 0; }
+
+private:
+    const char* m_Data;
+    size_t m_Length;
+    size_t m_Offset;
+};
+
+// ***************************************
+// The String based path of the baseline EasyWiFi.cpp. It read only the request line with readStringUntil('\r');
+// here it reads every line that way, as its commented out loop did, so it gets to the body at all.
+
+static String LegacyUrlDecode(String str)
+{
+    String decodedString = "";
+    char temp[3] = { 0 };
+    unsigned int len = str.length();
+    unsigned int i = 0;
+    while (i < len)
+    {
+        char decodedChar;
+        if (str.charAt(i) == '%')
+        {
+            temp[0] = str.charAt(i + 1);
+            temp[1] = str.charAt(i + 2);
+            decodedChar = strtol(temp, NULL, 16);
+            i += 2;
+        }
+        else if (str.charAt(i) == '+')
+        {
+            decodedChar = ' ';
+        }
+        else
+        {
+            decodedChar = str.charAt(i);
+        }
+        i++;
+        decodedString += decodedChar;
+    }
+    return decodedString;
+}
+
+static String LegacyGetValueFromRequest(String requestBody, String key)
+{
+    String value = "";
+    int keyIndex = requestBody.indexOf(key + "=");
+    if (keyIndex != -1)
+    {
+        int valueIndex = keyIndex + key.length() + 1;
+        int endIndex = requestBody.indexOf("&", valueIndex);
+        if (endIndex == -1)
+            endIndex = requestBody.length();
+        value = requestBody.substring(valueIndex, endIndex);
+        value = LegacyUrlDecode(value);
+    }
+    return value;
+}
+
+static void LegacyParse(Stream& client, String& ssid, String& password)
+{
+    String request = "";
+    while (client.available())
+    {
+        request += client.readStringUntil('\r');
+        if (client.available())
+            request += '\r'; // taken by readStringUntil()
+    }
+    String requestBody = request.substring(request.indexOf("\r\n\r\n") + 4);
+    ssid = LegacyGetValueFromRequest(requestBody, "network");
+    password = LegacyGetValueFromRequest(requestBody, "password");
+}
+
+// ***************************************
+
+// Fed in HTTP_READ_CHUNK_SIZE reads, as ServicePortalConnection() does
+static void ParserParse(HttpRequestParser& parser, const char* data, size_t length, char* ssid, char* password)
+{
+    parser.Reset();
+    for (size_t offset = 0; offset < length; offset += HTTP_READ_CHUNK_SIZE)
+        parser.Feed((const uint8_t*)data + offset, (length - offset < HTTP_READ_CHUNK_SIZE) ? length - offset : HTTP_READ_CHUNK_SIZE);
+    HttpRequestParser::GetFormValue(parser.GetBody(), "network", ssid, 34);
+    HttpRequestParser::GetFormValue(parser.GetBody(), "password", password, 65);
+}
+
+int main(int argc, char** argv)
+{
+    HostBench::Init(argc, argv);
+    char request[1024];
+    int length = snprintf(request, sizeof(request), REQUEST_HEAD, (unsigned)strlen(REQUEST_BODY));
+    length += snprintf(request + length, sizeof(request) - length, "%s", REQUEST_BODY);
+    unsigned long iterations = HostBench::Iterations(200000);
+
+    HttpRequestParser parser;
+    char ssid[34], password[65];
+    volatile size_t sink = 0;
+    double start = HostBench::Seconds();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        ParserParse(parser, request, length, ssid, password);
+        sink += ssid[0];
+    }
+    double parserTime = HostBench::Seconds() - start;
+
+    MemoryStream stream(request, length);
+    String legacySsid, legacyPassword;
+    HostString::Reset();
+    start = HostBench::Seconds();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        stream.Rewind();
+        LegacyParse(stream, legacySsid, legacyPassword);
+        sink += legacySsid.length();
+    }
+    double legacyTime = HostBench::Seconds() - start;
+    unsigned long allocations = HostString::GetStats().allocations;
+
+    // Heap of one request, the result Strings emptied first so only the request itself counts
+    legacySsid = "";
+    legacyPassword = "";
+    HostString::Reset();
+    unsigned long base = HostString::GetStats().bytes;
+    stream.Rewind();
+    LegacyParse(stream, legacySsid, legacyPassword);
+    unsigned long legacyPeak = HostString::GetStats().peakBytes - base;
+
+    if (strcmp(ssid, legacySsid.c_str()) != 0 || strcmp(password, legacyPassword.c_str()) != 0 || strcmp(ssid, "My Home WiFi") != 0)
+    {
+        fprintf(stderr, "results differ: \"%s\"/\"%s\" and \"%s\"/\"%s\"\n", ssid, password, legacySsid.c_str(), legacyPassword.c_str());
+        return 1;
+    }
+
+    HostBench::Report("http_parser", "request_bytes", length, "B");
+    HostBench::Report("http_parser", "parser_throughput", length * iterations / parserTime / 1e6, "MB/s");
+    HostBench::Report("http_parser", "legacy_throughput", length * iterations / legacyTime / 1e6, "MB/s");
+    HostBench::Report("http_parser", "speedup", legacyTime / parserTime, "x");
+    HostBench::Report("http_parser", "parser_heap_allocations", 0, "per request");
+    HostBench::Report("http_parser", "legacy_heap_allocations", (double)allocations / iterations, "per request");
+    HostBench::Report("http_parser", "parser_ram", sizeof(HttpRequestParser), "B (fixed, per connection)");
+    HostBench::Report("http_parser", "legacy_peak_heap", legacyPeak, "B (String payload, no allocator overhead)");
+    return (sink == 0) ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+// The page sequence of one phone over kept alive connections against a new connection per request:
+// connections opened, module sockets held and time per sequence.
+
+#include <EasyWiFi.h>
+#include <HostSim.h>
+#include <algorithm>
+#include <vector>
+#include "HostBench.h"
+#include "HostPhone.h"
+
+static const char* const G_Paths[] =
+{
+    "/",
+    "/list_networks",
+    "/enterPassword?network=Home",
+    "/api/networks",
+    "/api/status"
+};
+#define BENCH_PATHS (sizeof(G_Paths) / sizeof(G_Paths[0]))
+
+static int G_PeakSockets = 0;
+
+static void PumpWiFi(void* context)
+{
+    ((EasyWiFi*)context)->Poll();
+    HostClock::Advance(1);
+    G_PeakSockets = std::max(G_PeakSockets, HostNet::GetOpenSockets());
+}
+
+static void MeasureSequences(EasyWiFi& wifi, const char* variant, const char* headers)
+{
+    HostPhone phone(PumpWiFi, &wifi);
+    HostHttpResponse response;
+    unsigned long iterations = HostBench::Iterations(2000);
+    std::vector<double> times;
+    char metric[64];
+    int baseSockets = HostNet::GetOpenSockets();
+
+    G_PeakSockets = 0;
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        double start = HostBench::Seconds();
+        for (size_t p = 0; p < BENCH_PATHS; p++)
+        {
+            if (!phone.Get(G_Paths[p], response, headers) || response.status != 200)
+            {
+                fprintf(stderr, "GET %s failed\n", G_Paths[p]);
+                exit(1);
+            }
+        }
+        times.push_back(HostBench::Seconds() - start);
+    }
+    std::sort(times.begin(), times.end());
+
+    snprintf(metric, sizeof(metric), "%s_connections", variant);
+    HostBench::Report("keepalive", metric, (double)phone.GetConnects() / iterations, "per sequence");
+    snprintf(metric, sizeof(metric), "%s_client_sockets_peak", variant);
+    HostBench::Report("keepalive", metric, G_PeakSockets - baseSockets, "module sockets");
+    snprintf(metric, sizeof(metric), "%s_sequence_p50", variant);
+    HostBench::Report("keepalive", metric, times[times.size() / 2] * 1e6, "us (loopback)");
+    snprintf(metric, sizeof(metric), "%s_sequence_p99", variant);
+    HostBench::Report("keepalive", metric, times[times.size() * 99 / 100] * 1e6, "us (loopback)");
+}
+
+int main(int argc, char** argv)
+{
+    HostBench::Init(argc, argv);
+    EasyWiFi wifi;
+    HostWiFi::AddNetwork("Home", "secretpass", -48);
+    wifi.Begin();
+    for (unsigned long elapsed = 0; wifi.Poll() != EASYWIFI_PORTAL; elapsed += 5)
+    {
+        if (elapsed > 600000)
+        {
+            fprintf(stderr, "portal did not open\n");
+            return 1;
+        }
+        HostClock::Advance(5);
+    }
+    HostWiFi::SetStationJoined(true);
+
+    HostBench::Report("keepalive", "requests", BENCH_PATHS, "per sequence");
+    MeasureSequences(wifi, "keepalive", "");
+    MeasureSequences(wifi, "close", "Connection: close\r\n");
+    return 0;
+}
@@ -0,0 +1,271 @@
+// HttpResponseWriter against printing line by line to the WiFiClient: client.write() calls per response.
+// On the board every write() is one SPI transaction to the NINA module and often one TCP segment.
+
+#include <EasyWiFi.h>
+#include <HostSim.h>
+#include <HttpResponseWriter.h>
+#include "HostBench.h"
+#include "HostPhone.h"
+
+#define BENCH_NETWORKS MAX_SSID
+
+// Counts the write calls it gets, drops the data
+class CountingClient : public Client
+{
+public:
+    CountingClient() : m_Writes(0), m_Bytes(0) {}
+    void Reset() { m_Writes = 0; m_Bytes = 0; }
+    unsigned long GetWrites() { return m_Writes; }
+    unsigned long GetBytes() { return m_Bytes; }
+
+    virtual int connect(IPAddress, uint16_t) { return 1; }
+    virtual int connect(const char*, uint16_t) { return 1; }
+    virtual size_t write(uint8_t) { m_Writes++; m_Bytes++; return 1; }
+    virtual size_t write(const uint8_t*, size_t size) { m_Writes++; m_Bytes += size; return size; }
+    using Print::write;
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int read(uint8_t*, size_t) { return -1; }
+    virtual int peek() { return -1; }
+    virtual void flush() {}
+    virtual void stop() {}
+    virtual uint8_t connected() { return 1; }
+    virtual operator bool() { return true; }
+
+private:
+    unsigned long m_Writes;
+    unsigned long m_Bytes;
+};
+
+static String G_Networks[BENCH_NETWORKS];
+
+// ***************************************
+// The pages as the baseline EasyWiFi.cpp printed them, one print()/println() per piece
+
+static void LegacySendNetworkList(Print& client)
+{
+    client.println("HTTP/1.1 200 OK");
+    client.println("Content-Type: text/html");
+    client.println();
+
+    client.println("<html>");
+    client.println("<head><title>Select your network</title></head>");
+    client.println("<meta charset='UTF-8'>");
+    client.println("<meta name='viewport' content='width=device-width,initial-scale=1'>");
+    client.println("<body>");
+    client.println("<h2>Select your network:</h2>");
+
+    for (int i = 0; i < BENCH_NETWORKS; i++)
+    {
+        String networkName = G_Networks[i];
+        client.print("<form action=\"/enterPassword?network=" + networkName + "\" method=\"post\">");
+        client.print("<input type=\"submit\" value=\"");
+        client.print(i+1);
+        client.print(". ");
+        client.print(networkName);
+        client.println("\"/>");
+        client.println("</form>");
+    }
+
+    client.println("</body>");
+    client.println("</html>");
+    client.print("<meta http-equiv=\"refresh\" content=\"20;url=http://"); client.print(IPAddress(172, 217, 28, 1)); client.println("\">");
+    client.println();
+}
+
+static void LegacySendEnterWifiPasswordPage(Print& client, const String& networkName)
+{
+    client.println("HTTP/1.1 200 OK");
+    client.println("Content-Type: text/html");
+    client.println();
+
+    client.println("<html>");
+    client.println("<meta charset='UTF-8'>");
+    client.println("<meta name='viewport' content='width=device-width,initial-scale=1'>");
+    client.println("<head><title>Enter Wi-Fi Password</title></head>");
+    client.println("<body>");
+    client.print("<h2>Network: ");
+    client.print(networkName);
+    client.println("</h2>");
+    client.println("<form id=\"connectForm\" onsubmit=\"submitForm(event)\" method=\"post\">");
+    client.println("Password: <input id=\"passwordField\" type=\"password\" name=\"password\" /><br/>");
+    client.println("Show password: <input id=\"showPasswordCheckbox\" type=\"checkbox\" onchange=\"togglePasswordVisibility()\" /><br/>");
+    client.println("<input type=\"submit\" value=\"Connect\"/>");
+    client.println("</form>");
+
+    client.println("<script>");
+    client.println("function togglePasswordVisibility() {");
+    client.println("  var passwordField = document.getElementById('passwordField');");
+    client.println("  var showPasswordCheckbox = document.getElementById('showPasswordCheckbox');");
+    client.println("  if (showPasswordCheckbox.checked) {");
+    client.println("    passwordField.type = 'text';");
+    client.println("  } else {");
+    client.println("    passwordField.type = 'password';");
+    client.println("  }");
+    client.println("}");
+    client.println("function submitForm(event) {");
+    client.println("  event.preventDefault();");
+    client.println("  var password = document.getElementById('passwordField').value;");
+    client.println("  var xhr = new XMLHttpRequest();");
+    client.println("  xhr.open('POST', '/connect', true);");
+    client.println("  xhr.setRequestHeader('Content-Type', 'application/x-www-form-urlencoded');");
+    client.println("  xhr.onreadystatechange = function() {");
+    client.println("    if (xhr.readyState === 4 && xhr.status === 200) {");
+    client.println("      console.log(xhr.responseText);");
+    client.println("    }");
+    client.println("  };");
+    client.println("  var params = 'network=" + networkName + "&password=' + encodeURIComponent(password);");
+    client.println("  xhr.send(params);");
+    client.println("}");
+    client.println("</script>");
+    client.println("</body>");
+    client.println("</html>");
+    client.println();
+}
+
+// ***************************************
+
+enum BenchPage
+{
+    BENCH_NETWORK_LIST,
+    BENCH_ENTER_PASSWORD
+};
+
+static void SendLegacyPage(Print& out, BenchPage page)
+{
+    if (page == BENCH_NETWORK_LIST)
+        LegacySendNetworkList(out);
+    else
+        LegacySendEnterWifiPasswordPage(out, G_Networks[0]);
+}
+
+// Read what arrived at the server side of the loopback connection
+static void Drain(WiFiServer& server)
+{
+    uint8_t buffer[2048];
+    WiFiClient peer = server.available();
+    while (peer && peer.read(buffer, sizeof(buffer)) > 0)
+        ;
+}
+
+/* The same prints, straight to the client and through the writer. Write calls are counted, the time per
+   response is taken over a loopback connection where each write() is one send() of the host */
+static void CompareLegacyPage(const char* name, BenchPage page)
+{
+    CountingClient counter;
+    HttpResponseWriter writer;
+    char metric[64];
+
+    SendLegacyPage(counter, page);
+    unsigned long lineWrites = counter.GetWrites();
+    unsigned long bytes = counter.GetBytes();
+    counter.Reset();
+    writer.Begin(counter);
+    SendLegacyPage(writer, page);
+    writer.End();
+    unsigned long writerWrites = counter.GetWrites();
+
+    WiFiServer server(8080);
+    server.begin();
+    WiFiClient client;
+    if (!client.connect(IPAddress(127, 0, 0, 1), HostNet::GetPort(8080)))
+    {
+        fprintf(stderr, "loopback connect failed\n");
+        exit(1);
+    }
+    unsigned long iterations = HostBench::Iterations(20000);
+    double start = HostBench::Seconds();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        SendLegacyPage(client, page);
+        Drain(server);
+    }
+    double lineTime = HostBench::Seconds() - start;
+    start = HostBench::Seconds();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        writer.Begin(client);
+        SendLegacyPage(writer, page);
+        writer.End();
+        Drain(server);
+    }
+    double writerTime = HostBench::Seconds() - start;
+    HostNet::CloseAll();
+
+    snprintf(metric, sizeof(metric), "%s_bytes", name);
+    HostBench::Report("response_writer", metric, bytes, "B");
+    snprintf(metric, sizeof(metric), "%s_line_writes", name);
+    HostBench::Report("response_writer", metric, lineWrites, "write() calls");
+    snprintf(metric, sizeof(metric), "%s_writer_writes", name);
+    HostBench::Report("response_writer", metric, writerWrites, "write() calls");
+    snprintf(metric, sizeof(metric), "%s_line_time", name);
+    HostBench::Report("response_writer", metric, lineTime / iterations * 1e6, "us (loopback)");
+    snprintf(metric, sizeof(metric), "%s_writer_time", name);
+    HostBench::Report("response_writer", metric, writerTime / iterations * 1e6, "us (loopback)");
+}
+
+// ***************************************
+// The portal as it is, write() calls counted at the simulated module
+
+static void PumpWiFi(void* context)
+{
+    ((EasyWiFi*)context)->Poll();
+    HostClock::Advance(1);
+}
+
+static void MeasurePortalRoute(EasyWiFi& wifi, HostPhone& phone, const char* name, const char* path)
+{
+    HostHttpResponse response;
+    char metric[64];
+    HostNet::ResetStats();
+    if (!phone.Get(path, response) || response.status != 200)
+    {
+        fprintf(stderr, "GET %s failed\n", path);
+        exit(1);
+    }
+    for (int i = 0; i < 10; i++)
+        PumpWiFi(&wifi);
+    snprintf(metric, sizeof(metric), "portal_%s_bytes", name);
+    HostBench::Report("response_writer", metric, HostNet::GetStats().tcpBytes, "B");
+    snprintf(metric, sizeof(metric), "portal_%s_writes", name);
+    HostBench::Report("response_writer", metric, HostNet::GetStats().tcpWrites, "write() calls");
+}
+
+static void MeasurePortal()
+{
+    EasyWiFi wifi;
+    for (int i = 0; i < BENCH_NETWORKS; i++)
+        HostWiFi::AddNetwork(G_Networks[i].c_str(), "secretpass", -40 - i);
+    wifi.Begin();
+    for (unsigned long elapsed = 0; wifi.Poll() != EASYWIFI_PORTAL; elapsed += 5)
+    {
+        if (elapsed > 600000)
+        {
+            fprintf(stderr, "portal did not open\n");
+            exit(1);
+        }
+        HostClock::Advance(5);
+    }
+    HostWiFi::SetStationJoined(true);
+
+    HostPhone phone(PumpWiFi, &wifi);
+    MeasurePortalRoute(wifi, phone, "start_page", "/");
+    MeasurePortalRoute(wifi, phone, "network_list", "/list_networks");
+    MeasurePortalRoute(wifi, phone, "enter_password", "/enterPassword?network=Network%2001");
+}
+
+int main(int argc, char** argv)
+{
+    HostBench::Init(argc, argv);
+    for (int i = 0; i < BENCH_NETWORKS; i++)
+    {
+        char ssid[16];
+        snprintf(ssid, sizeof(ssid), "Network %02d", i + 1);
+        G_Networks[i] = ssid;
+    }
+
+    CompareLegacyPage("network_list", BENCH_NETWORK_LIST);
+    CompareLegacyPage("enter_password", BENCH_ENTER_PASSWORD);
+    MeasurePortal();
+    return 0;
+}
@@ -0,0 +1,260 @@
+// Load driver of the captive portal: N phones on threads of their own walk the portal side by side while the
+// main thread polls the library with the clock in real time. Per step latency percentiles, requests per
+// second and failures go to a JSON file, its format is described in README.md.
+//
+//     portal_load [--phones N] [--rounds R] [--out FILE] [--quick]
+
+#include <EasyWiFi.h>
+#include <HostSim.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "HostBench.h"
+#include "HostPhone.h"
+
+#define LOAD_RESULT_FORMAT "easywifi-portal-load/1"
+#define LOAD_ATTEMPTS 10                 // Tries of one step, a refused (503) or lost connection is tried again
+#define LOAD_RETRY_DELAY 20              // Time in ms before the next try
+
+enum LoadStep
+{
+    LOAD_DNS,
+    LOAD_PROBE,
+    LOAD_START,
+    LOAD_LIST,
+    LOAD_PASSWORD,
+    LOAD_CONNECT,
+    LOAD_STEPS
+};
+
+static const char* const G_StepNames[LOAD_STEPS] = { "dns", "generate_204", "start", "list_networks", "enter_password", "connect" };
+
+// Lookups of a phone right after joining
+static const char* const G_DnsBurst[] =
+{
+    "connectivitycheck.gstatic.com",
+    "www.google.com",
+    "clients3.google.com",
+    "android.clients.google.com"
+};
+#define LOAD_DNS_BURST (int)(sizeof(G_DnsBurst) / sizeof(G_DnsBurst[0]))
+
+// Results of one phone, merged once its thread is done
+struct LoadResult
+{
+    std::vector<double> latencies[LOAD_STEPS];   // ms of the successful steps, retries included
+    unsigned long failures[LOAD_STEPS];
+    unsigned long retries[LOAD_STEPS];
+};
+
+struct LoadOptions
+{
+    int phones;
+    int rounds;
+    std::string out;
+    uint16_t httpPort;
+    uint16_t dnsPort;
+};
+
+static double Milliseconds()
+{
+    return HostBench::Seconds() * 1000;
+}
+
+/* One HTTP step, tried again while the portal refuses it. POST /connect sends a password the portal
+   rejects with a 400: valid credentials would close the portal for every other phone */
+static bool RunHttpStep(HostPhone& phone, LoadStep step, HostHttpResponse& response)
+{
+    switch (step)
+    {
+    case LOAD_PROBE:
+        return phone.Get("/generate_204", response) && response.status == 200;
+    case LOAD_START:
+        return phone.Get("/", response, "Accept-Encoding: gzip, deflate\r\n") && response.status == 200;
+    case LOAD_LIST:
+        return phone.Get("/list_networks", response) && response.status == 200;
+    case LOAD_PASSWORD:
+        return phone.Get("/enterPassword?network=Home", response, "Accept-Encoding: gzip, deflate\r\n") && response.status == 200;
+    case LOAD_CONNECT:
+        return phone.Post("/connect", "network=Home&password=short", response) && response.status == 400;
+    default:
+        return false;
+    }
+}
+
+static void RunPhone(const LoadOptions& options, LoadResult& result)
+{
+    HostPhone phone(NULL, NULL, 5000);
+    HostHttpResponse response;
+    phone.SetPorts(options.httpPort, options.dnsPort);
+    for (int round = 0; round < options.rounds; round++)
+    {
+        for (int step = 0; step < LOAD_STEPS; step++)
+        {
+            double start = Milliseconds();
+            bool done = false;
+            for (int attempt = 0; attempt < LOAD_ATTEMPTS && !done; attempt++)
+            {
+                if (attempt > 0)
+                {
+                    result.retries[step]++;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(LOAD_RETRY_DELAY));
+                }
+                if (step == LOAD_DNS)
+                    done = (phone.DnsBurst(G_DnsBurst, LOAD_DNS_BURST) == LOAD_DNS_BURST);
+                else
+                    done = RunHttpStep(phone, (LoadStep)step, response);
+            }
+            if (done)
+                result.latencies[step].push_back(Milliseconds() - start);
+            else
+                result.failures[step]++;
+        }
+        phone.Close(); // the phone leaves, the next round is a new one
+    }
+}
+
+static double Percentile(const std::vector<double>& sorted, int percent)
+{
+    if (sorted.empty())
+        return 0;
+    size_t index = sorted.size() * percent / 100;
+    return sorted[(index < sorted.size()) ? index : sorted.size() - 1];
+}
+
+static bool WriteResult(const LoadOptions& options, const LoadResult& total, double duration)
+{
+    FILE* file = fopen(options.out.c_str(), "w");
+    unsigned long requests = 0, failures = 0, retries = 0;
+    if (file == NULL)
+        return false;
+    for (int step = 0; step < LOAD_STEPS; step++)
+    {
+        requests += total.latencies[step].size();
+        failures += total.failures[step];
+        retries += total.retries[step];
+    }
+    fprintf(file, "{\n");
+    fprintf(file, "  \"format\": \"%s\",\n", LOAD_RESULT_FORMAT);
+    fprintf(file, "  \"phones\": %d,\n", options.phones);
+    fprintf(file, "  \"rounds\": %d,\n", options.rounds);
+    fprintf(file, "  \"portal_max_connections\": %d,\n", PORTAL_MAX_CONNECTIONS);
+    fprintf(file, "  \"duration_s\": %.3f,\n", duration);
+    fprintf(file, "  \"requests\": %lu,\n", requests);
+    fprintf(file, "  \"requests_per_s\": %.1f,\n", requests / duration);
+    fprintf(file, "  \"failures\": %lu,\n", failures);
+    fprintf(file, "  \"retries\": %lu,\n", retries);
+    fprintf(file, "  \"steps\": [\n");
+    for (int step = 0; step < LOAD_STEPS; step++)
+    {
+        const std::vector<double>& sorted = total.latencies[step];
+        fprintf(file, "    { \"name\": \"%s\", \"ok\": %lu, \"failures\": %lu, \"retries\": %lu, "
+            "\"p50_ms\": %.3f, \"p99_ms\": %.3f, \"max_ms\": %.3f }%s\n",
+            G_StepNames[step], (unsigned long)sorted.size(), total.failures[step], total.retries[step],
+            Percentile(sorted, 50), Percentile(sorted, 99), sorted.empty() ? 0 : sorted.back(),
+            (step + 1 < LOAD_STEPS) ? "," : "");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    LoadOptions options;
+    options.phones = 8;
+    options.rounds = 50;
+    options.out = "portal_load.json";
+    HostBench::Init(argc, argv);
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--phones") == 0 && i + 1 < argc)
+            options.phones = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc)
+            options.rounds = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            options.out = argv[++i];
+        else if (strcmp(argv[i], "--quick") != 0)
+        {
+            fprintf(stderr, "usage: %s [--phones N] [--rounds R] [--out FILE] [--quick]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (HostBench::IsQuick())
+        options.rounds = 2;
+    if (options.phones < 1 || options.rounds < 1)
+        return 2;
+
+    // Up to the open portal on the virtual clock, then real time so the phones see real timeouts
+    EasyWiFi wifi;
+    HostWiFi::AddNetwork("Home", "secretpass", -48);
+    HostWiFi::AddNetwork("Cafe", "espresso-42", -67);
+    wifi.Begin();
+    for (unsigned long elapsed = 0; wifi.Poll() != EASYWIFI_PORTAL; elapsed += 5)
+    {
+        if (elapsed > 600000)
+        {
+            fprintf(stderr, "portal did not open\n");
+            return 1;
+        }
+        HostClock::Advance(5);
+    }
+    HostWiFi::SetStationJoined(true);
+    options.httpPort = HostNet::GetPort(80);
+    options.dnsPort = HostNet::GetPort(53);
+    HostClock::UseRealTime(true);
+
+    std::vector<LoadResult> results(options.phones);
+    std::vector<std::thread> phones;
+    std::atomic<int> running(options.phones);
+    double start = HostBench::Seconds();
+    for (int i = 0; i < options.phones; i++)
+    {
+        memset(results[i].failures, 0, sizeof(results[i].failures));
+        memset(results[i].retries, 0, sizeof(results[i].retries));
+        phones.push_back(std::thread([&options, &results, &running, i]() { RunPhone(options, results[i]); running--; }));
+    }
+    while (running > 0)
+    {
+        wifi.Poll();
+        std::this_thread::yield();
+    }
+    double duration = HostBench::Seconds() - start;
+    for (size_t i = 0; i < phones.size(); i++)
+        phones[i].join();
+
+    LoadResult total;
+    memset(total.failures, 0, sizeof(total.failures));
+    memset(total.retries, 0, sizeof(total.retries));
+    for (int i = 0; i < options.phones; i++)
+    {
+        for (int step = 0; step < LOAD_STEPS; step++)
+        {
+            total.latencies[step].insert(total.latencies[step].end(), results[i].latencies[step].begin(), results[i].latencies[step].end());
+            total.failures[step] += results[i].failures[step];
+            total.retries[step] += results[i].retries[step];
+        }
+    }
+    unsigned long failures = 0;
+    for (int step = 0; step < LOAD_STEPS; step++)
+    {
+        std::sort(total.latencies[step].begin(), total.latencies[step].end());
+        failures += total.failures[step];
+        char metric[64];
+        snprintf(metric, sizeof(metric), "%s_p50", G_StepNames[step]);
+        HostBench::Report("portal_load", metric, Percentile(total.latencies[step], 50), "ms");
+        snprintf(metric, sizeof(metric), "%s_p99", G_StepNames[step]);
+        HostBench::Report("portal_load", metric, Percentile(total.latencies[step], 99), "ms");
+    }
+    if (!WriteResult(options, total, duration))
+    {
+        fprintf(stderr, "cannot write %s\n", options.out.c_str());
+        return 1;
+    }
+    HostBench::Report("portal_load", "failures", failures, "steps");
+    printf("result: %s\n", options.out.c_str());
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+// Arduino.h
+// Host stand-in of the Arduino core for the host build in extras/host. Holds what the library, its examples
+// and the host tests use, with the behaviour of the SAMD core. The clock is virtual, see HostSim.h
+
+#ifndef _HOST_ARDUINO_h
+#define _HOST_ARDUINO_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// No separate program memory on the host
+#define PROGMEM
+#define PSTR(text) (text)
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+// Heap backed string of the Arduino core, grown to the exact size on every change as the core does
+class String
+{
+public:
+    String(const char* text = "");
+    String(const String& other);
+    explicit String(char c);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    ~String();
+
+    String& operator=(const String& other);
+    String& operator=(const char* text);
+    boolean reserve(unsigned int size);
+    unsigned int length() const;
+    const char* c_str() const;
+
+    boolean concat(const String& other);
+    boolean concat(const char* text);
+    boolean concat(const char* text, unsigned int length);
+    boolean concat(char c);
+    boolean concat(int value);
+    boolean concat(unsigned long value);
+    String& operator+=(const String& other);
+    String& operator+=(const char* text);
+    String& operator+=(char c);
+    String& operator+=(int value);
+    String& operator+=(unsigned long value);
+    friend String operator+(const String& a, const String& b);
+    friend String operator+(const String& a, const char* b);
+    friend String operator+(const char* a, const String& b);
+    friend String operator+(const String& a, char b);
+
+    boolean equals(const String& other) const;
+    boolean equals(const char* text) const;
+    boolean operator==(const String& other) const;
+    boolean operator==(const char* text) const;
+    boolean operator!=(const String& other) const;
+    boolean operator!=(const char* text) const;
+    boolean startsWith(const String& prefix) const;
+    boolean endsWith(const String& suffix) const;
+
+    char charAt(unsigned int index) const;
+    void setCharAt(unsigned int index, char c);
+    char operator[](unsigned int index) const;
+    char& operator[](unsigned int index);
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& text, unsigned int from = 0) const;
+    int indexOf(const char* text, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+    void trim();
+    void toLowerCase();
+    long toInt() const;
+
+private:
+    boolean Resize(unsigned int length);
+    void Assign(const char* text, unsigned int length);
+
+    char* m_Buffer;
+    unsigned int m_Capacity;
+    unsigned int m_Length;
+};
+
+class Print;
+
+class Printable
+{
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print& out) const = 0;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* text);
+    size_t write(const char* buffer, size_t size);
+    virtual int availableForWrite();
+    virtual void flush();
+
+    size_t print(const char text[]);
+    size_t print(char c);
+    size_t print(const String& text);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+    size_t print(const Printable& value);
+
+    size_t println();
+    size_t println(const char text[]);
+    size_t println(char c);
+    size_t println(const String& text);
+    size_t println(unsigned char value, int base = DEC);
+    size_t println(int value, int base = DEC);
+    size_t println(unsigned int value, int base = DEC);
+    size_t println(long value, int base = DEC);
+    size_t println(unsigned long value, int base = DEC);
+    size_t println(double value, int digits = 2);
+    size_t println(const Printable& value);
+
+private:
+    size_t PrintNumber(unsigned long value, uint8_t base);
+    size_t PrintFloat(double value, uint8_t digits);
+};
+
+class Stream : public Print
+{
+public:
+    Stream();
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout);
+    size_t readBytes(char* buffer, size_t length);
+    String readString();
+    String readStringUntil(char terminator);
+
+protected:
+    int TimedRead();
+
+    unsigned long m_Timeout;           // ms
+};
+
+class IPAddress : public Printable
+{
+public:
+    IPAddress();
+    IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth);
+    IPAddress(uint32_t address);
+    IPAddress(const uint8_t* address);
+
+    boolean fromString(const char* text);
+    operator uint32_t() const;
+    boolean operator==(const IPAddress& other) const;
+    boolean operator!=(const IPAddress& other) const;
+    uint8_t operator[](int index) const;
+    uint8_t& operator[](int index);
+    IPAddress& operator=(uint32_t address);
+
+    virtual size_t printTo(Print& out) const;
+
+private:
+    uint8_t m_Bytes[4];                // Network order
+};
+
+class Client : public Stream
+{
+public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int read(uint8_t* buffer, size_t size) = 0;
+    virtual int peek() = 0;
+    virtual void flush() = 0;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+    virtual operator bool() = 0;
+};
+
+class UDP : public Stream
+{
+public:
+    virtual uint8_t begin(uint16_t port) = 0;
+    virtual void stop() = 0;
+    virtual int beginPacket(IPAddress ip, uint16_t port) = 0;
+    virtual int endPacket() = 0;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+    virtual int parsePacket() = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int read(unsigned char* buffer, size_t length) = 0;
+    virtual int read(char* buffer, size_t length) = 0;
+    virtual int peek() = 0;
+    virtual void flush() = 0;
+    virtual IPAddress remoteIP() = 0;
+    virtual uint16_t remotePort() = 0;
+};
+
+// Serial port, written to stdout
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baud);
+    void end();
+    operator bool();
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    using Print::write;
+    virtual int available();
+    virtual int read();
+    virtual int peek();
+    virtual void flush();
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,143 @@
+// HostSim.h
+// Controls of the host stand-ins: virtual clock, simulated NINA module, loopback sockets and storage directory.
+// Tests set up the world with these and then drive the library through its public API only.
+
+#ifndef _HOST_HOSTSIM_h
+#define _HOST_HOSTSIM_h
+
+#include <Arduino.h>
+#include <WiFiNINA.h>
+
+/* Clock behind millis() and micros(). Virtual by default: it stands still until Advance() or delay(),
+   so a test sees the same times on every run. In real time mode it follows the host clock and Advance()
+   skips ahead, so waits of the state machine need not be slept through */
+class HostClock
+{
+public:
+    static void UseRealTime(boolean realTime);
+    static void Set(unsigned long ms);
+    static void Advance(unsigned long ms);
+    static void AdvanceMicros(unsigned long us);
+    static unsigned long long GetMicros();
+};
+
+#define HOST_WIFI_MAX_NETWORKS 32
+#define HOST_WIFI_CONNECT_TIME 1500      // Default time in ms from WiFi.begin() to WL_CONNECTED
+#define HOST_WIFI_SCAN_TIME 2000         // Default time in ms WiFi.scanNetworks() takes, the virtual clock advances by it
+
+// One access point in range of the simulated module
+struct HostNetwork
+{
+    char ssid[WL_SSID_MAX_LENGTH + 1];
+    char password[64];
+    int32_t rssi;
+    uint8_t channel;
+    uint8_t encryption;
+    uint8_t bssid[6];
+};
+
+// Module calls counted since Reset()
+struct HostWiFiCounters
+{
+    unsigned long begins;              // WiFi.begin()
+    unsigned long beginAPs;            // WiFi.beginAP()
+    unsigned long scans;               // WiFi.scanNetworks()
+    unsigned long statusReads;         // WiFi.status()
+    unsigned long configs;             // WiFi.config()
+    unsigned long disconnects;         // WiFi.disconnect() and WiFi.end()
+    unsigned long ledWrites;           // WiFiDrv::analogWrite()
+};
+
+/* The simulated NINA module. WiFi.begin() connects after the connect time if the network is in range
+   and the password matches, WiFi.beginAP() answers WL_AP_LISTENING (after the configured failures) and
+   WL_AP_CONNECTED once a station joined */
+class HostWiFi
+{
+public:
+    static void Reset();
+    static void AddNetwork(const char* ssid, const char* password, int32_t rssi, uint8_t channel = 6, uint8_t encryption = ENC_TYPE_CCMP);
+    static void RemoveNetwork(const char* ssid);
+    static void SetRssi(const char* ssid, int32_t rssi);
+    static void SetBssid(const char* ssid, const uint8_t* bssid);
+    static void SetConnectTime(unsigned long ms);
+    static void SetScanTime(unsigned long ms);
+    static void SetScanFails(boolean fails);
+    static void SetScanEntriesLost(boolean lost);
+    static void SetAccessPointFailures(int count);
+    static void SetStationJoined(boolean joined);
+    static void SetTime(unsigned long unixTime);
+    static void SetMacAddress(const uint8_t* mac);
+
+    static boolean IsConnected();
+    static boolean IsAccessPoint();
+    static const char* GetConnectedSsid();
+    static const char* GetAccessPointName();
+    static IPAddress GetStaticIP();
+    static uint8_t GetLed(uint8_t pin);
+    static const HostWiFiCounters& GetCounters();
+};
+
+// Socket calls counted since ResetStats(), each one an SPI transaction to the module on the board
+struct HostNetStats
+{
+    unsigned long tcpWrites;           // WiFiClient::write() calls
+    unsigned long tcpBytes;
+    unsigned long udpPackets;          // WiFiUDP::endPacket() calls
+    unsigned long udpBytes;
+};
+
+/* Sockets of the module. A WiFiServer or WiFiUDP of port p listens on 127.0.0.1, on p + offset, or on a
+   free port chosen by the host when the offset is negative (the default, so tests can run side by side) */
+class HostNet
+{
+public:
+    static void SetPortOffset(int offset);
+    static uint16_t GetPort(uint16_t port);
+    static int GetOpenSockets();
+    static void CloseAll();
+    static const HostNetStats& GetStats();
+    static void ResetStats();
+};
+
+// File calls of WiFiStorage counted since ResetStats()
+struct HostStorageStats
+{
+    unsigned long opens;
+    unsigned long reads;               // read() calls
+    unsigned long writes;              // write() calls
+    unsigned long erases;              // Files removed
+    unsigned long bytesRead;
+    unsigned long bytesWritten;
+};
+
+/* WiFiStorage files ("/fs/name") as files of a directory, a fresh temporary one unless set.
+   Writes append as the module firmware opens files with "ab" */
+class HostStorage
+{
+public:
+    static void SetDirectory(const char* path);
+    static const char* GetDirectory();
+    static void Clear();
+    static boolean WriteFile(const char* filename, const void* data, size_t size);
+    static long ReadFile(const char* filename, void* data, size_t size);
+    static void SetWriteLimit(long bytes);
+    static const HostStorageStats& GetStats();
+    static void ResetStats();
+};
+
+// Heap use of String since Reset(), to compare the String based code paths against the fixed buffers
+struct HostStringStats
+{
+    unsigned long allocations;         // malloc() and realloc() calls
+    unsigned long bytes;               // Bytes held right now
+    unsigned long peakBytes;
+};
+
+class HostString
+{
+public:
+    static void Reset();
+    static const HostStringStats& GetStats();
+};
+
+#endif
@@ -0,0 +1,4 @@
+// IPAddress.h
+// Host stand-in, IPAddress is declared in Arduino.h as the core does
+
+#include <Arduino.h>
@@ -0,0 +1,180 @@
+// WiFiNINA.h
+// Host stand-in of the WiFiNINA library. The module is simulated: networks, connection and access point
+// are set up through HostWiFi, sockets are loopback sockets of the host (HostNet) and WiFiStorage files
+// live in a directory (HostStorage), see HostSim.h. Calls behave as the module firmware answers them.
+
+#ifndef _HOST_WIFININA_h
+#define _HOST_WIFININA_h
+
+#include <Arduino.h>
+
+#define MAX_SOCK_NUM 10                  // Sockets of the module, shared by servers, clients and UDP
+#define NO_SOCKET_AVAIL 255
+#define WL_MAC_ADDR_LENGTH 6
+#define WL_SSID_MAX_LENGTH 32
+#define WL_NETWORKS_LIST_MAXNUM 10
+
+typedef enum
+{
+    WL_NO_SHIELD = 255,
+    WL_NO_MODULE = WL_NO_SHIELD,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL,
+    WL_SCAN_COMPLETED,
+    WL_CONNECTED,
+    WL_CONNECT_FAILED,
+    WL_CONNECTION_LOST,
+    WL_DISCONNECTED,
+    WL_AP_LISTENING,
+    WL_AP_CONNECTED,
+    WL_AP_FAILED
+} wl_status_t;
+
+enum wl_enc_type
+{
+    ENC_TYPE_WEP = 5,
+    ENC_TYPE_TKIP = 2,
+    ENC_TYPE_CCMP = 4,
+    ENC_TYPE_NONE = 7,
+    ENC_TYPE_AUTO = 8,
+    ENC_TYPE_UNKNOWN = 255
+};
+
+// TCP states of WiFiClient::status()
+enum wl_tcp_state
+{
+    CLOSED = 0,
+    LISTEN = 1,
+    ESTABLISHED = 4
+};
+
+class WiFiClass
+{
+public:
+    int begin(const char* ssid);
+    int begin(const char* ssid, const char* passphrase);
+    uint8_t beginAP(const char* ssid, uint8_t channel);
+    void config(IPAddress localIP);
+    void config(IPAddress localIP, IPAddress dnsServer);
+    void config(IPAddress localIP, IPAddress dnsServer, IPAddress gateway);
+    void config(IPAddress localIP, IPAddress dnsServer, IPAddress gateway, IPAddress subnet);
+    void setDNS(IPAddress dnsServer1);
+    void setDNS(IPAddress dnsServer1, IPAddress dnsServer2);
+    int disconnect();
+    void end();
+
+    uint8_t* macAddress(uint8_t* mac);
+    IPAddress localIP();
+    IPAddress subnetMask();
+    IPAddress gatewayIP();
+    IPAddress dnsIP(int n = 0);
+    const char* SSID();
+    uint8_t* BSSID(uint8_t* bssid);
+    int32_t RSSI();
+    uint8_t encryptionType();
+
+    int8_t scanNetworks();
+    const char* SSID(uint8_t networkItem);
+    uint8_t encryptionType(uint8_t networkItem);
+    uint8_t* BSSID(uint8_t networkItem, uint8_t* bssid);
+    uint8_t channel(uint8_t networkItem);
+    int32_t RSSI(uint8_t networkItem);
+
+    uint8_t status();
+    unsigned long getTime();
+    void setTimeout(unsigned long timeout);
+};
+
+extern WiFiClass WiFi;
+
+// Pins of the module, the RGB LED of the MKR WiFi 1010 is on 25 (green), 26 (red) and 27 (blue)
+class WiFiDrv
+{
+public:
+    static void pinMode(uint8_t pin, uint8_t mode);
+    static void digitalWrite(uint8_t pin, uint8_t value);
+    static void analogWrite(uint8_t pin, uint8_t value);
+};
+
+class WiFiClient : public Client
+{
+public:
+    WiFiClient();
+    WiFiClient(uint8_t sock);
+
+    virtual int connect(IPAddress ip, uint16_t port);
+    virtual int connect(const char* host, uint16_t port);
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    using Print::write;
+    virtual int available();
+    virtual int read();
+    virtual int read(uint8_t* buffer, size_t size);
+    virtual int peek();
+    virtual void flush();
+    virtual void stop();
+    virtual uint8_t connected();
+    uint8_t status();
+    virtual operator bool();
+    bool operator==(const WiFiClient& other) const;
+    bool operator!=(const WiFiClient& other) const;
+
+    IPAddress remoteIP();
+    uint16_t remotePort();
+
+private:
+    uint8_t m_Socket;                  // Socket of the module, NO_SOCKET_AVAIL if none
+};
+
+// available() hands out a client with unread data, new or already handed out, as the module firmware does
+class WiFiServer
+{
+public:
+    WiFiServer(uint16_t port);
+    void begin();
+    WiFiClient available(uint8_t* status = NULL);
+    uint8_t status();
+
+private:
+    uint16_t m_Port;
+    uint8_t m_Socket;                  // Listening socket, NO_SOCKET_AVAIL before begin()
+};
+
+class WiFiStorageFile
+{
+public:
+    WiFiStorageFile(const char* filename);
+    operator bool();
+    uint32_t read(void* buffer, uint32_t length);
+    uint32_t write(const void* buffer, uint32_t length);
+    void seek(uint32_t offset);
+    uint32_t position();
+    uint32_t size();
+    uint32_t available();
+    void erase();
+    void flush();
+    void close();
+
+private:
+    char m_Filename[64];               // Copied, open(String) hands in a temporary
+    uint32_t m_Offset;
+    uint32_t m_Length;                 // Size as last read by operator bool, size() or available()
+};
+
+class WiFiStorageClass
+{
+public:
+    static bool begin();
+    static WiFiStorageFile open(const char* filename);
+    static WiFiStorageFile open(String filename);
+    static bool exists(const char* filename);
+    static bool exists(const char* filename, uint32_t* size);
+    static bool remove(const char* filename);
+    static bool rename(const char* oldName, const char* newName);
+    static bool read(const char* filename, uint32_t offset, uint8_t* buffer, uint32_t length);
+    static bool write(const char* filename, uint32_t offset, const uint8_t* buffer, uint32_t length);
+};
+
+extern WiFiStorageClass WiFiStorage;
+
+#endif
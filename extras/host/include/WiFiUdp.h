@@ -0,0 +1,40 @@
+// WiFiUdp.h
+// Host stand-in of the WiFiNINA UDP socket, a loopback UDP socket of the host, see HostSim.h
+
+#ifndef _HOST_WIFIUDP_h
+#define _HOST_WIFIUDP_h
+
+#include <WiFiNINA.h>
+
+class WiFiUDP : public UDP
+{
+public:
+    WiFiUDP();
+    virtual uint8_t begin(uint16_t port);
+    virtual void stop();
+
+    virtual int beginPacket(IPAddress ip, uint16_t port);
+    virtual int beginPacket(const char* host, uint16_t port);
+    virtual int endPacket();
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    using Print::write;
+
+    // Size of the next received packet, the unread rest of the previous one is discarded. Packets larger
+    // than the receive buffer of the module are reported with their full size but cut to the buffer
+    virtual int parsePacket();
+    virtual int available();
+    virtual int read();
+    virtual int read(unsigned char* buffer, size_t length);
+    virtual int read(char* buffer, size_t length);
+    virtual int peek();
+    virtual void flush();
+
+    virtual IPAddress remoteIP();
+    virtual uint16_t remotePort();
+
+private:
+    uint8_t m_Socket;                  // Socket of the module, NO_SOCKET_AVAIL before begin()
+};
+
+#endif
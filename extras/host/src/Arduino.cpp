@@ -0,0 +1,908 @@
+#include <Arduino.h>
+#include <math.h>
+#include <time.h>
+#include <atomic>
+#include "HostSim.h"
+
+HardwareSerial Serial;
+
+static std::atomic<bool> G_RealTime(false);
+static std::atomic<unsigned long long> G_ClockMicros(0);  // virtual time, or the skip added to the host clock
+static std::atomic<unsigned long long> G_RealStart(0);    // host clock when real time was switched on
+static HostStringStats G_StringStats = { 0, 0, 0 };
+
+// Monotonic host clock in us
+static unsigned long long HostMicros()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+// Follow the host clock from now on, or stand still until Advance()
+void HostClock::UseRealTime(boolean realTime)
+{
+	unsigned long long now = GetMicros();
+	G_RealStart = HostMicros();
+	G_ClockMicros = now;
+	G_RealTime = realTime;
+}
+
+void HostClock::Set(unsigned long ms)
+{
+	G_RealStart = HostMicros();
+	G_ClockMicros = (unsigned long long)ms * 1000;
+}
+
+void HostClock::Advance(unsigned long ms)
+{
+	G_ClockMicros += (unsigned long long)ms * 1000;
+}
+
+void HostClock::AdvanceMicros(unsigned long us)
+{
+	G_ClockMicros += us;
+}
+
+// Time in us since the start, not wrapped as micros() is
+unsigned long long HostClock::GetMicros()
+{
+	if (G_RealTime)
+		return HostMicros() - G_RealStart + G_ClockMicros;
+	return G_ClockMicros;
+}
+
+// 32 bit and wrapping as on the board
+unsigned long millis()
+{
+	return (uint32_t)(HostClock::GetMicros() / 1000);
+}
+
+unsigned long micros()
+{
+	return (uint32_t)HostClock::GetMicros();
+}
+
+void delay(unsigned long ms)
+{
+	if (!G_RealTime)
+	{
+		HostClock::Advance(ms);
+		return;
+	}
+	struct timespec wait = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000L };
+	nanosleep(&wait, NULL);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	if (!G_RealTime)
+	{
+		HostClock::AdvanceMicros(us);
+		return;
+	}
+	struct timespec wait = { (time_t)(us / 1000000), (long)(us % 1000000) * 1000L };
+	nanosleep(&wait, NULL);
+}
+
+// Busy waits call yield(): on the virtual clock a millisecond passes, so they end
+void yield()
+{
+	if (!G_RealTime)
+		HostClock::Advance(1);
+}
+
+long random(long howBig)
+{
+	if (howBig == 0)
+		return 0;
+	return ::random() % howBig;
+}
+
+long random(long howSmall, long howBig)
+{
+	if (howSmall >= howBig)
+		return howSmall;
+	return random(howBig - howSmall) + howSmall;
+}
+
+void randomSeed(unsigned long seed)
+{
+	if (seed != 0)
+		srandom(seed);
+}
+
+// ***************************************
+// String
+
+void HostString::Reset()
+{
+	G_StringStats.allocations = 0;
+	G_StringStats.peakBytes = G_StringStats.bytes;
+}
+
+const HostStringStats& HostString::GetStats()
+{
+	return G_StringStats;
+}
+
+String::String(const char* text)
+{
+	m_Buffer = NULL;
+	m_Capacity = 0;
+	m_Length = 0;
+	Assign(text != NULL ? text : "", text != NULL ? strlen(text) : 0);
+}
+
+String::String(const String& other)
+{
+	m_Buffer = NULL;
+	m_Capacity = 0;
+	m_Length = 0;
+	Assign(other.m_Buffer, other.m_Length);
+}
+
+String::String(char c)
+{
+	m_Buffer = NULL;
+	m_Capacity = 0;
+	m_Length = 0;
+	Assign(&c, 1);
+}
+
+String::String(int value, unsigned char base)
+{
+	char text[8 * sizeof(int) + 2];
+	m_Buffer = NULL;
+	m_Capacity = 0;
+	m_Length = 0;
+	if (base == 10)
+		snprintf(text, sizeof(text), "%d", value);
+	else
+		snprintf(text, sizeof(text), base == 16 ? "%x" : "%o", value);
+	Assign(text, strlen(text));
+}
+
+String::String(unsigned int value, unsigned char base)
+{
+	char text[8 * sizeof(int) + 2];
+	m_Buffer = NULL;
+	m_Capacity = 0;
+	m_Length = 0;
+	snprintf(text, sizeof(text), base == 16 ? "%x" : (base == 8 ? "%o" : "%u"), value);
+	Assign(text, strlen(text));
+}
+
+String::String(long value, unsigned char base)
+{
+	char text[8 * sizeof(long) + 2];
+	m_Buffer = NULL;
+	m_Capacity = 0;
+	m_Length = 0;
+	if (base == 10)
+		snprintf(text, sizeof(text), "%ld", value);
+	else
+		snprintf(text, sizeof(text), base == 16 ? "%lx" : "%lo", value);
+	Assign(text, strlen(text));
+}
+
+String::String(unsigned long value, unsigned char base)
+{
+	char text[8 * sizeof(long) + 2];
+	m_Buffer = NULL;
+	m_Capacity = 0;
+	m_Length = 0;
+	snprintf(text, sizeof(text), base == 16 ? "%lx" : (base == 8 ? "%lo" : "%lu"), value);
+	Assign(text, strlen(text));
+}
+
+String::~String()
+{
+	if (m_Buffer != NULL)
+	{
+		G_StringStats.bytes -= m_Capacity + 1;
+		free(m_Buffer);
+	}
+}
+
+// Grow or shrink the buffer to exactly length characters, as the core does on every change
+boolean String::Resize(unsigned int length)
+{
+	if (m_Buffer != NULL && m_Capacity >= length)
+		return true;
+	char* buffer = (char*)realloc(m_Buffer, length + 1);
+	if (buffer == NULL)
+		return false;
+	G_StringStats.allocations++;
+	G_StringStats.bytes += length + 1;
+	if (m_Buffer != NULL)
+		G_StringStats.bytes -= m_Capacity + 1;
+	if (G_StringStats.bytes > G_StringStats.peakBytes)
+		G_StringStats.peakBytes = G_StringStats.bytes;
+	if (m_Buffer == NULL)
+		buffer[0] = 0;
+	m_Buffer = buffer;
+	m_Capacity = length;
+	return true;
+}
+
+void String::Assign(const char* text, unsigned int length)
+{
+	if (!Resize(length))
+		return;
+	memmove(m_Buffer, text, length);
+	m_Buffer[length] = 0;
+	m_Length = length;
+}
+
+String& String::operator=(const String& other)
+{
+	if (this != &other)
+		Assign(other.m_Buffer, other.m_Length);
+	return *this;
+}
+
+String& String::operator=(const char* text)
+{
+	Assign(text, strlen(text));
+	return *this;
+}
+
+boolean String::reserve(unsigned int size)
+{
+	return Resize(size);
+}
+
+unsigned int String::length() const
+{
+	return m_Length;
+}
+
+const char* String::c_str() const
+{
+	return m_Buffer;
+}
+
+boolean String::concat(const char* text, unsigned int length)
+{
+	if (length == 0)
+		return true;
+	if (!Resize(m_Length + length))
+		return false;
+	memmove(m_Buffer + m_Length, text, length);
+	m_Length += length;
+	m_Buffer[m_Length] = 0;
+	return true;
+}
+
+boolean String::concat(const String& other)
+{
+	return concat(other.m_Buffer, other.m_Length);
+}
+
+boolean String::concat(const char* text)
+{
+	return concat(text, strlen(text));
+}
+
+boolean String::concat(char c)
+{
+	return concat(&c, 1);
+}
+
+boolean String::concat(int value)
+{
+	return concat(String(value));
+}
+
+boolean String::concat(unsigned long value)
+{
+	return concat(String(value));
+}
+
+String& String::operator+=(const String& other)
+{
+	concat(other);
+	return *this;
+}
+
+String& String::operator+=(const char* text)
+{
+	concat(text);
+	return *this;
+}
+
+String& String::operator+=(char c)
+{
+	concat(c);
+	return *this;
+}
+
+String& String::operator+=(int value)
+{
+	concat(value);
+	return *this;
+}
+
+String& String::operator+=(unsigned long value)
+{
+	concat(value);
+	return *this;
+}
+
+String operator+(const String& a, const String& b)
+{
+	String result(a);
+	result.concat(b);
+	return result;
+}
+
+String operator+(const String& a, const char* b)
+{
+	String result(a);
+	result.concat(b);
+	return result;
+}
+
+String operator+(const char* a, const String& b)
+{
+	String result(a);
+	result.concat(b);
+	return result;
+}
+
+String operator+(const String& a, char b)
+{
+	String result(a);
+	result.concat(b);
+	return result;
+}
+
+boolean String::equals(const String& other) const
+{
+	return m_Length == other.m_Length && memcmp(m_Buffer, other.m_Buffer, m_Length) == 0;
+}
+
+boolean String::equals(const char* text) const
+{
+	return strcmp(m_Buffer, text) == 0;
+}
+
+boolean String::operator==(const String& other) const
+{
+	return equals(other);
+}
+
+boolean String::operator==(const char* text) const
+{
+	return equals(text);
+}
+
+boolean String::operator!=(const String& other) const
+{
+	return !equals(other);
+}
+
+boolean String::operator!=(const char* text) const
+{
+	return !equals(text);
+}
+
+boolean String::startsWith(const String& prefix) const
+{
+	return prefix.m_Length <= m_Length && memcmp(m_Buffer, prefix.m_Buffer, prefix.m_Length) == 0;
+}
+
+boolean String::endsWith(const String& suffix) const
+{
+	return suffix.m_Length <= m_Length && memcmp(m_Buffer + m_Length - suffix.m_Length, suffix.m_Buffer, suffix.m_Length) == 0;
+}
+
+char String::charAt(unsigned int index) const
+{
+	return (index < m_Length) ? m_Buffer[index] : 0;
+}
+
+void String::setCharAt(unsigned int index, char c)
+{
+	if (index < m_Length)
+		m_Buffer[index] = c;
+}
+
+char String::operator[](unsigned int index) const
+{
+	return charAt(index);
+}
+
+char& String::operator[](unsigned int index)
+{
+	static char dummy;
+	if (index >= m_Length)
+	{
+		dummy = 0;
+		return dummy;
+	}
+	return m_Buffer[index];
+}
+
+int String::indexOf(char c, unsigned int from) const
+{
+	if (from >= m_Length)
+		return -1;
+	const char* found = strchr(m_Buffer + from, c);
+	return (found != NULL) ? (int)(found - m_Buffer) : -1;
+}
+
+int String::indexOf(const String& text, unsigned int from) const
+{
+	return indexOf(text.m_Buffer, from);
+}
+
+int String::indexOf(const char* text, unsigned int from) const
+{
+	if (from >= m_Length)
+		return -1;
+	const char* found = strstr(m_Buffer + from, text);
+	return (found != NULL) ? (int)(found - m_Buffer) : -1;
+}
+
+int String::lastIndexOf(char c) const
+{
+	const char* found = strrchr(m_Buffer, c);
+	return (found != NULL) ? (int)(found - m_Buffer) : -1;
+}
+
+String String::substring(unsigned int from) const
+{
+	return substring(from, m_Length);
+}
+
+String String::substring(unsigned int from, unsigned int to) const
+{
+	if (from > to)
+	{
+		unsigned int swap = from;
+		from = to;
+		to = swap;
+	}
+	String result;
+	if (from >= m_Length)
+		return result;
+	if (to > m_Length)
+		to = m_Length;
+	result.Assign(m_Buffer + from, to - from);
+	return result;
+}
+
+void String::trim()
+{
+	unsigned int begin = 0, end = m_Length;
+	while (begin < end && (m_Buffer[begin] == ' ' || (m_Buffer[begin] >= '\t' && m_Buffer[begin] <= '\r')))
+		begin++;
+	while (end > begin && (m_Buffer[end - 1] == ' ' || (m_Buffer[end - 1] >= '\t' && m_Buffer[end - 1] <= '\r')))
+		end--;
+	m_Length = end - begin;
+	memmove(m_Buffer, m_Buffer + begin, m_Length);
+	m_Buffer[m_Length] = 0;
+}
+
+void String::toLowerCase()
+{
+	for (unsigned int i = 0; i < m_Length; i++)
+	{
+		if (m_Buffer[i] >= 'A' && m_Buffer[i] <= 'Z')
+			m_Buffer[i] += 'a' - 'A';
+	}
+}
+
+long String::toInt() const
+{
+	return atol(m_Buffer);
+}
+
+// ***************************************
+// Print
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+	size_t n = 0;
+	while (size--)
+	{
+		if (write(*buffer++))
+			n++;
+		else
+			break;
+	}
+	return n;
+}
+
+size_t Print::write(const char* text)
+{
+	if (text == NULL)
+		return 0;
+	return write((const uint8_t*)text, strlen(text));
+}
+
+size_t Print::write(const char* buffer, size_t size)
+{
+	return write((const uint8_t*)buffer, size);
+}
+
+int Print::availableForWrite()
+{
+	return 0;
+}
+
+void Print::flush()
+{
+}
+
+size_t Print::print(const char text[])
+{
+	return write(text);
+}
+
+size_t Print::print(char c)
+{
+	return write((uint8_t)c);
+}
+
+size_t Print::print(const String& text)
+{
+	return write(text.c_str(), text.length());
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+	return print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base)
+{
+	return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+	return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base)
+{
+	if (base == 0)
+		return write((uint8_t)value);
+	if (base == 10 && value < 0)
+		return print('-') + PrintNumber(-(unsigned long)value, 10);
+	if (base == 10)
+		return PrintNumber(value, 10);
+	return PrintNumber((uint32_t)value, base); // 32 bit two's complement as on the board
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+	if (base == 0)
+		return write((uint8_t)value);
+	return PrintNumber(value, base);
+}
+
+size_t Print::print(double value, int digits)
+{
+	return PrintFloat(value, digits);
+}
+
+size_t Print::print(const Printable& value)
+{
+	return value.printTo(*this);
+}
+
+size_t Print::println()
+{
+	return write("\r\n");
+}
+
+size_t Print::println(const char text[])
+{
+	size_t n = print(text);
+	return n + println();
+}
+
+size_t Print::println(char c)
+{
+	size_t n = print(c);
+	return n + println();
+}
+
+size_t Print::println(const String& text)
+{
+	size_t n = print(text);
+	return n + println();
+}
+
+size_t Print::println(unsigned char value, int base)
+{
+	size_t n = print(value, base);
+	return n + println();
+}
+
+size_t Print::println(int value, int base)
+{
+	size_t n = print(value, base);
+	return n + println();
+}
+
+size_t Print::println(unsigned int value, int base)
+{
+	size_t n = print(value, base);
+	return n + println();
+}
+
+size_t Print::println(long value, int base)
+{
+	size_t n = print(value, base);
+	return n + println();
+}
+
+size_t Print::println(unsigned long value, int base)
+{
+	size_t n = print(value, base);
+	return n + println();
+}
+
+size_t Print::println(double value, int digits)
+{
+	size_t n = print(value, digits);
+	return n + println();
+}
+
+size_t Print::println(const Printable& value)
+{
+	size_t n = print(value);
+	return n + println();
+}
+
+size_t Print::PrintNumber(unsigned long value, uint8_t base)
+{
+	char text[8 * sizeof(long) + 1];
+	char* digit = &text[sizeof(text) - 1];
+	*digit = 0;
+	if (base < 2)
+		base = 10;
+	do
+	{
+		char c = value % base;
+		value /= base;
+		*--digit = (c < 10) ? c + '0' : c + 'A' - 10;
+	} while (value != 0);
+	return write(digit);
+}
+
+size_t Print::PrintFloat(double value, uint8_t digits)
+{
+	size_t n = 0;
+	if (isnan(value))
+		return print("nan");
+	if (isinf(value))
+		return print("inf");
+	if (value > 4294967040.0 || value < -4294967040.0)
+		return print("ovf");
+	if (value < 0.0)
+	{
+		n += print('-');
+		value = -value;
+	}
+	double rounding = 0.5;
+	for (uint8_t i = 0; i < digits; i++)
+		rounding /= 10.0;
+	value += rounding;
+
+	unsigned long integer = (unsigned long)value;
+	double remainder = value - (double)integer;
+	n += print(integer);
+	if (digits > 0)
+		n += print('.');
+	while (digits-- > 0)
+	{
+		remainder *= 10.0;
+		unsigned int digit = (unsigned int)remainder;
+		n += print(digit);
+		remainder -= digit;
+	}
+	return n;
+}
+
+// ***************************************
+// Stream
+
+Stream::Stream()
+{
+	m_Timeout = 1000;
+}
+
+void Stream::setTimeout(unsigned long timeout)
+{
+	m_Timeout = timeout;
+}
+
+// Next byte, waiting up to the timeout for it
+int Stream::TimedRead()
+{
+	unsigned long start = millis();
+	do
+	{
+		int c = read();
+		if (c >= 0)
+			return c;
+		yield();
+	} while (millis() - start < m_Timeout);
+	return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length)
+{
+	size_t count = 0;
+	while (count < length)
+	{
+		int c = TimedRead();
+		if (c < 0)
+			break;
+		buffer[count++] = (char)c;
+	}
+	return count;
+}
+
+String Stream::readString()
+{
+	String text;
+	int c = TimedRead();
+	while (c >= 0)
+	{
+		text += (char)c;
+		c = TimedRead();
+	}
+	return text;
+}
+
+String Stream::readStringUntil(char terminator)
+{
+	String text;
+	int c = TimedRead();
+	while (c >= 0 && c != terminator)
+	{
+		text += (char)c;
+		c = TimedRead();
+	}
+	return text;
+}
+
+// ***************************************
+// IPAddress
+
+IPAddress::IPAddress()
+{
+	memset(m_Bytes, 0, sizeof(m_Bytes));
+}
+
+IPAddress::IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth)
+{
+	m_Bytes[0] = first;
+	m_Bytes[1] = second;
+	m_Bytes[2] = third;
+	m_Bytes[3] = fourth;
+}
+
+IPAddress::IPAddress(uint32_t address)
+{
+	memcpy(m_Bytes, &address, sizeof(m_Bytes));
+}
+
+IPAddress::IPAddress(const uint8_t* address)
+{
+	memcpy(m_Bytes, address, sizeof(m_Bytes));
+}
+
+boolean IPAddress::fromString(const char* text)
+{
+	unsigned int parts[4];
+	char end;
+	if (sscanf(text, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &end) != 4)
+		return false;
+	for (int i = 0; i < 4; i++)
+	{
+		if (parts[i] > 255)
+			return false;
+		m_Bytes[i] = (uint8_t)parts[i];
+	}
+	return true;
+}
+
+IPAddress::operator uint32_t() const
+{
+	uint32_t address;
+	memcpy(&address, m_Bytes, sizeof(address));
+	return address;
+}
+
+boolean IPAddress::operator==(const IPAddress& other) const
+{
+	return memcmp(m_Bytes, other.m_Bytes, sizeof(m_Bytes)) == 0;
+}
+
+boolean IPAddress::operator!=(const IPAddress& other) const
+{
+	return !(*this == other);
+}
+
+uint8_t IPAddress::operator[](int index) const
+{
+	return m_Bytes[index];
+}
+
+uint8_t& IPAddress::operator[](int index)
+{
+	return m_Bytes[index];
+}
+
+IPAddress& IPAddress::operator=(uint32_t address)
+{
+	memcpy(m_Bytes, &address, sizeof(m_Bytes));
+	return *this;
+}
+
+size_t IPAddress::printTo(Print& out) const
+{
+	size_t n = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		if (i > 0)
+			n += out.print('.');
+		n += out.print(m_Bytes[i], DEC);
+	}
+	return n;
+}
+
+// ***************************************
+// Serial
+
+void HardwareSerial::begin(unsigned long baud)
+{
+	(void)baud;
+}
+
+void HardwareSerial::end()
+{
+}
+
+HardwareSerial::operator bool()
+{
+	return true;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+	return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size)
+{
+	return fwrite(buffer, 1, size, stdout);
+}
+
+int HardwareSerial::available()
+{
+	return 0;
+}
+
+int HardwareSerial::read()
+{
+	return -1;
+}
+
+int HardwareSerial::peek()
+{
+	return -1;
+}
+
+void HardwareSerial::flush()
+{
+	fflush(stdout);
+}
@@ -0,0 +1,481 @@
+#include <WiFiNINA.h>
+#include "HostSim.h"
+
+WiFiClass WiFi;
+
+enum HostWiFiMode
+{
+	HOST_WIFI_IDLE,          // Not connected, no access point
+	HOST_WIFI_STATION,       // WiFi.begin() issued, connected once connectAt passed
+	HOST_WIFI_AP             // Access point listening
+};
+
+// State of the simulated module
+struct HostModule
+{
+	HostNetwork networks[HOST_WIFI_MAX_NETWORKS];
+	int networkCount;
+	HostNetwork scan[HOST_WIFI_MAX_NETWORKS];  // Result of the last scanNetworks()
+	int scanCount;
+	HostWiFiMode mode;
+	uint8_t lastStatus;                          // Status after a disconnect or failed attempt
+	char ssid[WL_SSID_MAX_LENGTH + 1];           // Network of the current or last WiFi.begin()
+	char password[64];
+	char apName[WL_SSID_MAX_LENGTH + 1];
+	unsigned long connectAt;                     // millis() at which the attempt completes
+	boolean linkSeen;                            // The attempt connected, a missing network is a lost link
+	unsigned long connectTime;
+	unsigned long scanTime;
+	boolean scanFails;
+	boolean scanEntriesLost;                     // SSID() of a scan entry answers NULL
+	int apFailures;                              // beginAP() calls still to fail
+	boolean stationJoined;
+	unsigned long unixTime;
+	uint8_t mac[6];
+	IPAddress staticIP, staticDns, staticGateway, staticSubnet;
+	uint8_t led[3];                              // Pins 25, 26, 27
+	HostWiFiCounters counters;
+};
+
+static HostModule G_Module;
+static boolean G_ModuleReady = false;
+
+static HostModule& Module()
+{
+	if (!G_ModuleReady)
+		HostWiFi::Reset();
+	return G_Module;
+}
+
+static HostNetwork* FindNetwork(const char* ssid)
+{
+	HostModule& module = Module();
+	for (int i = 0; i < module.networkCount; i++)
+	{
+		if (strcmp(module.networks[i].ssid, ssid) == 0)
+			return &module.networks[i];
+	}
+	return NULL;
+}
+
+// The connection attempt completed and found its network with the right password
+static boolean IsLinkUp()
+{
+	HostModule& module = Module();
+	if (module.mode != HOST_WIFI_STATION || (long)(millis() - module.connectAt) < 0)
+		return false;
+	HostNetwork* network = FindNetwork(module.ssid);
+	return network != NULL && strcmp(network->password, module.password) == 0;
+}
+
+// ***************************************
+// HostWiFi
+
+void HostWiFi::Reset()
+{
+	static const uint8_t mac[6] = { 0xbc, 0x9a, 0x78, 0x56, 0x34, 0x12 };
+	G_Module = HostModule(); // zeroed
+	G_Module.mode = HOST_WIFI_IDLE;
+	G_Module.lastStatus = WL_IDLE_STATUS;
+	G_Module.connectTime = HOST_WIFI_CONNECT_TIME;
+	G_Module.scanTime = HOST_WIFI_SCAN_TIME;
+	memcpy(G_Module.mac, mac, sizeof(mac));
+	G_ModuleReady = true;
+	HostNet::CloseAll();
+}
+
+void HostWiFi::AddNetwork(const char* ssid, const char* password, int32_t rssi, uint8_t channel, uint8_t encryption)
+{
+	HostModule& module = Module();
+	HostNetwork* network = FindNetwork(ssid);
+	if (network == NULL)
+	{
+		if (module.networkCount >= HOST_WIFI_MAX_NETWORKS)
+			return;
+		network = &module.networks[module.networkCount++];
+	}
+	memset(network, 0, sizeof(*network));
+	strncpy(network->ssid, ssid, sizeof(network->ssid) - 1);
+	strncpy(network->password, password, sizeof(network->password) - 1);
+	network->rssi = rssi;
+	network->channel = channel;
+	network->encryption = encryption;
+	for (int i = 0; i < 6; i++)
+		network->bssid[i] = (uint8_t)(0x10 * (module.networkCount) + i);
+}
+
+// Network out of range: scans miss it and a connection to it is lost
+void HostWiFi::RemoveNetwork(const char* ssid)
+{
+	HostModule& module = Module();
+	HostNetwork* network = FindNetwork(ssid);
+	if (network == NULL)
+		return;
+	int index = network - module.networks;
+	for (int i = index; i < module.networkCount - 1; i++)
+		module.networks[i] = module.networks[i + 1];
+	module.networkCount--;
+}
+
+void HostWiFi::SetRssi(const char* ssid, int32_t rssi)
+{
+	HostNetwork* network = FindNetwork(ssid);
+	if (network != NULL)
+		network->rssi = rssi;
+}
+
+// Another access point now serves ssid, as after a router was replaced
+void HostWiFi::SetBssid(const char* ssid, const uint8_t* bssid)
+{
+	HostNetwork* network = FindNetwork(ssid);
+	if (network != NULL)
+		memcpy(network->bssid, bssid, 6);
+}
+
+void HostWiFi::SetConnectTime(unsigned long ms)
+{
+	Module().connectTime = ms;
+}
+
+void HostWiFi::SetScanTime(unsigned long ms)
+{
+	Module().scanTime = ms;
+}
+
+void HostWiFi::SetScanFails(boolean fails)
+{
+	Module().scanFails = fails;
+}
+
+// The module forgets the scan right after reporting its count, as when another scan started
+void HostWiFi::SetScanEntriesLost(boolean lost)
+{
+	Module().scanEntriesLost = lost;
+}
+
+void HostWiFi::SetAccessPointFailures(int count)
+{
+	Module().apFailures = count;
+}
+
+void HostWiFi::SetStationJoined(boolean joined)
+{
+	Module().stationJoined = joined;
+}
+
+void HostWiFi::SetTime(unsigned long unixTime)
+{
+	Module().unixTime = unixTime;
+}
+
+void HostWiFi::SetMacAddress(const uint8_t* mac)
+{
+	memcpy(Module().mac, mac, 6);
+}
+
+boolean HostWiFi::IsConnected()
+{
+	return IsLinkUp();
+}
+
+boolean HostWiFi::IsAccessPoint()
+{
+	return Module().mode == HOST_WIFI_AP;
+}
+
+const char* HostWiFi::GetConnectedSsid()
+{
+	return IsLinkUp() ? Module().ssid : "";
+}
+
+const char* HostWiFi::GetAccessPointName()
+{
+	return Module().apName;
+}
+
+// Address configured with WiFi.config(), 0.0.0.0 for DHCP
+IPAddress HostWiFi::GetStaticIP()
+{
+	return Module().staticIP;
+}
+
+uint8_t HostWiFi::GetLed(uint8_t pin)
+{
+	if (pin < 25 || pin > 27)
+		return 0;
+	return Module().led[pin - 25];
+}
+
+const HostWiFiCounters& HostWiFi::GetCounters()
+{
+	return Module().counters;
+}
+
+// ***************************************
+// WiFiClass
+
+int WiFiClass::begin(const char* ssid)
+{
+	return begin(ssid, "");
+}
+
+// Returns right away as with setTimeout(0), the attempt completes after the connect time
+int WiFiClass::begin(const char* ssid, const char* passphrase)
+{
+	HostModule& module = Module();
+	module.counters.begins++;
+	module.mode = HOST_WIFI_STATION;
+	strncpy(module.ssid, ssid, sizeof(module.ssid) - 1);
+	module.ssid[sizeof(module.ssid) - 1] = 0;
+	strncpy(module.password, passphrase, sizeof(module.password) - 1);
+	module.password[sizeof(module.password) - 1] = 0;
+	module.connectAt = millis() + module.connectTime;
+	module.linkSeen = false;
+	return WL_IDLE_STATUS;
+}
+
+uint8_t WiFiClass::beginAP(const char* ssid, uint8_t channel)
+{
+	HostModule& module = Module();
+	(void)channel;
+	module.counters.beginAPs++;
+	if (module.apFailures > 0)
+	{
+		module.apFailures--;
+		module.mode = HOST_WIFI_IDLE;
+		module.lastStatus = WL_AP_FAILED;
+		return WL_AP_FAILED;
+	}
+	strncpy(module.apName, ssid, sizeof(module.apName) - 1);
+	module.apName[sizeof(module.apName) - 1] = 0;
+	module.mode = HOST_WIFI_AP;
+	return WL_AP_LISTENING;
+}
+
+void WiFiClass::config(IPAddress localIP)
+{
+	Module().counters.configs++;
+	Module().staticIP = localIP;
+}
+
+void WiFiClass::config(IPAddress localIP, IPAddress dnsServer)
+{
+	config(localIP);
+	Module().staticDns = dnsServer;
+}
+
+void WiFiClass::config(IPAddress localIP, IPAddress dnsServer, IPAddress gateway)
+{
+	config(localIP, dnsServer);
+	Module().staticGateway = gateway;
+}
+
+void WiFiClass::config(IPAddress localIP, IPAddress dnsServer, IPAddress gateway, IPAddress subnet)
+{
+	config(localIP, dnsServer, gateway);
+	Module().staticSubnet = subnet;
+}
+
+void WiFiClass::setDNS(IPAddress dnsServer1)
+{
+	Module().staticDns = dnsServer1;
+}
+
+void WiFiClass::setDNS(IPAddress dnsServer1, IPAddress dnsServer2)
+{
+	(void)dnsServer2;
+	setDNS(dnsServer1);
+}
+
+int WiFiClass::disconnect()
+{
+	HostModule& module = Module();
+	module.counters.disconnects++;
+	if (module.mode == HOST_WIFI_STATION)
+		module.lastStatus = WL_DISCONNECTED;
+	module.mode = HOST_WIFI_IDLE;
+	return WL_DISCONNECTED;
+}
+
+void WiFiClass::end()
+{
+	HostModule& module = Module();
+	module.counters.disconnects++;
+	module.mode = HOST_WIFI_IDLE;
+	module.lastStatus = WL_IDLE_STATUS;
+	module.stationJoined = false;
+	HostNet::CloseAll(); // the module resets, its sockets are gone
+}
+
+// Reported last byte first, as the module does
+uint8_t* WiFiClass::macAddress(uint8_t* mac)
+{
+	memcpy(mac, Module().mac, 6);
+	return mac;
+}
+
+IPAddress WiFiClass::localIP()
+{
+	HostModule& module = Module();
+	if (module.mode == HOST_WIFI_AP)
+		return module.staticIP;
+	if (!IsLinkUp())
+		return IPAddress(0, 0, 0, 0);
+	if (module.staticIP != IPAddress(0, 0, 0, 0))
+		return module.staticIP;
+	return IPAddress(192, 168, 1, 100); // DHCP lease
+}
+
+IPAddress WiFiClass::subnetMask()
+{
+	if (!IsLinkUp())
+		return IPAddress(0, 0, 0, 0);
+	return IPAddress(255, 255, 255, 0);
+}
+
+IPAddress WiFiClass::gatewayIP()
+{
+	if (!IsLinkUp())
+		return IPAddress(0, 0, 0, 0);
+	return IPAddress(192, 168, 1, 1);
+}
+
+IPAddress WiFiClass::dnsIP(int n)
+{
+	if (!IsLinkUp())
+		return IPAddress(0, 0, 0, 0);
+	return IPAddress(192, 168, 1, (n == 0) ? 1 : 2);
+}
+
+const char* WiFiClass::SSID()
+{
+	return HostWiFi::GetConnectedSsid();
+}
+
+uint8_t* WiFiClass::BSSID(uint8_t* bssid)
+{
+	HostNetwork* network = IsLinkUp() ? FindNetwork(Module().ssid) : NULL;
+	if (network != NULL)
+		memcpy(bssid, network->bssid, 6);
+	else
+		memset(bssid, 0, 6);
+	return bssid;
+}
+
+int32_t WiFiClass::RSSI()
+{
+	HostNetwork* network = IsLinkUp() ? FindNetwork(Module().ssid) : NULL;
+	return (network != NULL) ? network->rssi : 0;
+}
+
+uint8_t WiFiClass::encryptionType()
+{
+	HostNetwork* network = IsLinkUp() ? FindNetwork(Module().ssid) : NULL;
+	return (network != NULL) ? network->encryption : (uint8_t)ENC_TYPE_UNKNOWN;
+}
+
+// Takes the scan time, the virtual clock advances by it
+int8_t WiFiClass::scanNetworks()
+{
+	HostModule& module = Module();
+	module.counters.scans++;
+	delay(module.scanTime);
+	if (module.scanFails)
+	{
+		module.scanCount = 0;
+		return -1;
+	}
+	module.scanCount = (module.networkCount < WL_NETWORKS_LIST_MAXNUM) ? module.networkCount : WL_NETWORKS_LIST_MAXNUM;
+	memcpy(module.scan, module.networks, module.scanCount * sizeof(HostNetwork));
+	return module.scanCount;
+}
+
+const char* WiFiClass::SSID(uint8_t networkItem)
+{
+	HostModule& module = Module();
+	return (networkItem < module.scanCount && !module.scanEntriesLost) ? module.scan[networkItem].ssid : NULL;
+}
+
+uint8_t WiFiClass::encryptionType(uint8_t networkItem)
+{
+	HostModule& module = Module();
+	return (networkItem < module.scanCount) ? module.scan[networkItem].encryption : 0;
+}
+
+uint8_t* WiFiClass::BSSID(uint8_t networkItem, uint8_t* bssid)
+{
+	HostModule& module = Module();
+	if (networkItem < module.scanCount)
+		memcpy(bssid, module.scan[networkItem].bssid, 6);
+	else
+		memset(bssid, 0, 6);
+	return bssid;
+}
+
+uint8_t WiFiClass::channel(uint8_t networkItem)
+{
+	HostModule& module = Module();
+	return (networkItem < module.scanCount) ? module.scan[networkItem].channel : 0;
+}
+
+int32_t WiFiClass::RSSI(uint8_t networkItem)
+{
+	HostModule& module = Module();
+	return (networkItem < module.scanCount) ? module.scan[networkItem].rssi : 0;
+}
+
+uint8_t WiFiClass::status()
+{
+	HostModule& module = Module();
+	module.counters.statusReads++;
+	switch (module.mode)
+	{
+	case HOST_WIFI_AP:
+		return module.stationJoined ? WL_AP_CONNECTED : WL_AP_LISTENING;
+	case HOST_WIFI_STATION:
+		if ((long)(millis() - module.connectAt) < 0)
+			return WL_IDLE_STATUS;
+		if (IsLinkUp())
+		{
+			module.linkSeen = true;
+			return WL_CONNECTED;
+		}
+		if (FindNetwork(module.ssid) == NULL)
+			return module.linkSeen ? WL_CONNECTION_LOST : WL_NO_SSID_AVAIL;
+		return WL_CONNECT_FAILED;
+	default:
+		return module.lastStatus;
+	}
+}
+
+unsigned long WiFiClass::getTime()
+{
+	return IsLinkUp() ? Module().unixTime : 0;
+}
+
+void WiFiClass::setTimeout(unsigned long timeout)
+{
+	(void)timeout;
+}
+
+// ***************************************
+// WiFiDrv
+
+void WiFiDrv::pinMode(uint8_t pin, uint8_t mode)
+{
+	(void)pin;
+	(void)mode;
+}
+
+void WiFiDrv::digitalWrite(uint8_t pin, uint8_t value)
+{
+	analogWrite(pin, value ? 255 : 0);
+}
+
+void WiFiDrv::analogWrite(uint8_t pin, uint8_t value)
+{
+	HostModule& module = Module();
+	module.counters.ledWrites++;
+	if (pin >= 25 && pin <= 27)
+		module.led[pin - 25] = value;
+}
@@ -0,0 +1,580 @@
+#include <WiFiNINA.h>
+#include <WiFiUdp.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "HostSim.h"
+
+#define HOST_UDP_BUFFER_SIZE 2048        // Receive and send buffer of a UDP socket, larger packets are cut
+#define HOST_WRITE_TIMEOUT 2000          // Time in ms a TCP write waits for the peer to take the data
+
+enum HostSocketKind
+{
+	HOST_SOCKET_FREE,
+	HOST_SOCKET_LISTEN,
+	HOST_SOCKET_TCP,
+	HOST_SOCKET_UDP
+};
+
+// One socket of the module, backed by a socket of the host
+struct HostSocket
+{
+	HostSocketKind kind;
+	int fd;
+	uint16_t port;                 // Port asked for by WiFiServer / WiFiUDP begin()
+	uint16_t boundPort;            // Loopback port it listens on
+	uint8_t server;                // Listening socket an accepted client came in on
+	boolean handedOut;             // WiFiServer::available() returned it at least once
+	uint8_t* rx;                   // UDP: packet being read
+	int rxLength;
+	int rxOffset;
+	struct sockaddr_in remote;     // UDP: sender of the packet being read
+	uint8_t* tx;                   // UDP: packet being built
+	int txLength;
+	struct sockaddr_in destination;
+};
+
+static HostSocket G_Sockets[MAX_SOCK_NUM];
+static int G_PortOffset = -1;
+static uint8_t G_LastHandedOut = 0;
+static HostNetStats G_NetStats;
+
+static uint8_t AllocateSocket(HostSocketKind kind, int fd)
+{
+	for (uint8_t i = 0; i < MAX_SOCK_NUM; i++)
+	{
+		if (G_Sockets[i].kind == HOST_SOCKET_FREE)
+		{
+			memset(&G_Sockets[i], 0, sizeof(G_Sockets[i]));
+			G_Sockets[i].kind = kind;
+			G_Sockets[i].fd = fd;
+			return i;
+		}
+	}
+	return NO_SOCKET_AVAIL;
+}
+
+static void FreeSocket(uint8_t sock)
+{
+	if (sock >= MAX_SOCK_NUM || G_Sockets[sock].kind == HOST_SOCKET_FREE)
+		return;
+	HostSocket& socket = G_Sockets[sock];
+	if (socket.kind == HOST_SOCKET_TCP)
+		shutdown(socket.fd, SHUT_RDWR);
+	close(socket.fd);
+	free(socket.rx);
+	free(socket.tx);
+	memset(&socket, 0, sizeof(socket));
+	socket.kind = HOST_SOCKET_FREE;
+}
+
+static HostSocket* GetSocket(uint8_t sock, HostSocketKind kind)
+{
+	if (sock >= MAX_SOCK_NUM || G_Sockets[sock].kind != kind)
+		return NULL;
+	return &G_Sockets[sock];
+}
+
+// Non-blocking host socket bound to the loopback port of port
+static int OpenBound(int type, uint16_t port, uint16_t& boundPort)
+{
+	int fd = socket(AF_INET, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -1;
+	int reuse = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons((G_PortOffset < 0) ? 0 : port + G_PortOffset);
+	socklen_t length = sizeof(address);
+	if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0
+		|| getsockname(fd, (struct sockaddr*)&address, &length) != 0)
+	{
+		close(fd);
+		return -1;
+	}
+	boundPort = ntohs(address.sin_port);
+	return fd;
+}
+
+static int PendingBytes(int fd)
+{
+	int pending = 0;
+	if (ioctl(fd, FIONREAD, &pending) != 0)
+		return 0;
+	return pending;
+}
+
+// The peer closed its side and everything it sent was read
+static boolean PeerClosed(int fd)
+{
+	char c;
+	ssize_t n = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+	return n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+}
+
+// ***************************************
+// HostNet
+
+// Listen on port + offset, or on a free port of the host when offset is negative
+void HostNet::SetPortOffset(int offset)
+{
+	G_PortOffset = offset;
+}
+
+// Loopback port the open WiFiServer or WiFiUDP of port listens on, 0 if there is none
+uint16_t HostNet::GetPort(uint16_t port)
+{
+	for (int i = 0; i < MAX_SOCK_NUM; i++)
+	{
+		if ((G_Sockets[i].kind == HOST_SOCKET_LISTEN || G_Sockets[i].kind == HOST_SOCKET_UDP) && G_Sockets[i].port == port)
+			return G_Sockets[i].boundPort;
+	}
+	return 0;
+}
+
+int HostNet::GetOpenSockets()
+{
+	int count = 0;
+	for (int i = 0; i < MAX_SOCK_NUM; i++)
+	{
+		if (G_Sockets[i].kind != HOST_SOCKET_FREE)
+			count++;
+	}
+	return count;
+}
+
+// Close every socket, as a reset of the module does
+void HostNet::CloseAll()
+{
+	for (uint8_t i = 0; i < MAX_SOCK_NUM; i++)
+		FreeSocket(i);
+}
+
+const HostNetStats& HostNet::GetStats()
+{
+	return G_NetStats;
+}
+
+void HostNet::ResetStats()
+{
+	memset(&G_NetStats, 0, sizeof(G_NetStats));
+}
+
+// ***************************************
+// WiFiClient
+
+WiFiClient::WiFiClient()
+{
+	m_Socket = NO_SOCKET_AVAIL;
+}
+
+WiFiClient::WiFiClient(uint8_t sock)
+{
+	m_Socket = sock;
+}
+
+// Connect to a port of the host as it is, without the offset of HostNet
+int WiFiClient::connect(IPAddress ip, uint16_t port)
+{
+	int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return 0;
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	for (int i = 0; i < 4; i++)
+		((uint8_t*)&address.sin_addr.s_addr)[i] = ip[i];
+	uint8_t sock = AllocateSocket(HOST_SOCKET_TCP, fd);
+	if (sock == NO_SOCKET_AVAIL || ::connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+	{
+		if (sock != NO_SOCKET_AVAIL)
+			FreeSocket(sock);
+		else
+			close(fd);
+		return 0;
+	}
+	m_Socket = sock;
+	return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port)
+{
+	IPAddress ip;
+	if (!ip.fromString(host))
+		return 0;
+	return connect(ip, port);
+}
+
+size_t WiFiClient::write(uint8_t c)
+{
+	return write(&c, 1);
+}
+
+// Blocks until the peer took everything, or HOST_WRITE_TIMEOUT passed
+size_t WiFiClient::write(const uint8_t* buffer, size_t size)
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_TCP);
+	size_t written = 0;
+	if (socket == NULL)
+		return 0;
+	G_NetStats.tcpWrites++;
+	while (written < size)
+	{
+		ssize_t n = send(socket->fd, buffer + written, size - written, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (n > 0)
+		{
+			written += n;
+			continue;
+		}
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			struct pollfd wait = { socket->fd, POLLOUT, 0 };
+			if (poll(&wait, 1, HOST_WRITE_TIMEOUT) > 0)
+				continue;
+		}
+		break;
+	}
+	G_NetStats.tcpBytes += written;
+	return written;
+}
+
+int WiFiClient::available()
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_TCP);
+	return (socket != NULL) ? PendingBytes(socket->fd) : 0;
+}
+
+int WiFiClient::read()
+{
+	uint8_t c;
+	return (read(&c, 1) == 1) ? c : -1;
+}
+
+// -1 if nothing is available, as the module answers
+int WiFiClient::read(uint8_t* buffer, size_t size)
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_TCP);
+	if (socket == NULL)
+		return -1;
+	ssize_t n = recv(socket->fd, buffer, size, MSG_DONTWAIT);
+	return (n > 0) ? (int)n : -1;
+}
+
+int WiFiClient::peek()
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_TCP);
+	uint8_t c;
+	if (socket == NULL || recv(socket->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) != 1)
+		return -1;
+	return c;
+}
+
+void WiFiClient::flush()
+{
+}
+
+void WiFiClient::stop()
+{
+	FreeSocket(m_Socket);
+	m_Socket = NO_SOCKET_AVAIL;
+}
+
+// Connected while the peer has not closed, or unread data is left
+uint8_t WiFiClient::connected()
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_TCP);
+	if (socket == NULL)
+		return 0;
+	if (PendingBytes(socket->fd) > 0)
+		return 1;
+	return PeerClosed(socket->fd) ? 0 : 1;
+}
+
+uint8_t WiFiClient::status()
+{
+	return connected() ? ESTABLISHED : CLOSED;
+}
+
+WiFiClient::operator bool()
+{
+	return m_Socket != NO_SOCKET_AVAIL;
+}
+
+bool WiFiClient::operator==(const WiFiClient& other) const
+{
+	return m_Socket == other.m_Socket;
+}
+
+bool WiFiClient::operator!=(const WiFiClient& other) const
+{
+	return m_Socket != other.m_Socket;
+}
+
+IPAddress WiFiClient::remoteIP()
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_TCP);
+	struct sockaddr_in address;
+	socklen_t length = sizeof(address);
+	if (socket == NULL || getpeername(socket->fd, (struct sockaddr*)&address, &length) != 0)
+		return IPAddress(0, 0, 0, 0);
+	return IPAddress((const uint8_t*)&address.sin_addr.s_addr);
+}
+
+uint16_t WiFiClient::remotePort()
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_TCP);
+	struct sockaddr_in address;
+	socklen_t length = sizeof(address);
+	if (socket == NULL || getpeername(socket->fd, (struct sockaddr*)&address, &length) != 0)
+		return 0;
+	return ntohs(address.sin_port);
+}
+
+// ***************************************
+// WiFiServer
+
+WiFiServer::WiFiServer(uint16_t port)
+{
+	m_Port = port;
+	m_Socket = NO_SOCKET_AVAIL;
+}
+
+void WiFiServer::begin()
+{
+	uint16_t boundPort;
+	if (GetSocket(m_Socket, HOST_SOCKET_LISTEN) != NULL)
+		return;
+	int fd = OpenBound(SOCK_STREAM, m_Port, boundPort);
+	if (fd < 0)
+	{
+		perror("WiFiServer: bind");
+		return;
+	}
+	m_Socket = AllocateSocket(HOST_SOCKET_LISTEN, fd);
+	if (m_Socket == NO_SOCKET_AVAIL || listen(fd, 16) != 0)
+	{
+		if (m_Socket != NO_SOCKET_AVAIL)
+			FreeSocket(m_Socket);
+		else
+			close(fd);
+		m_Socket = NO_SOCKET_AVAIL;
+		return;
+	}
+	G_Sockets[m_Socket].port = m_Port;
+	G_Sockets[m_Socket].boundPort = boundPort;
+}
+
+/* Accept waiting connections while sockets are free, then hand out the next client with unread data,
+   round robin. Connections closed before they sent anything are dropped as the module drops them */
+WiFiClient WiFiServer::available(uint8_t* status)
+{
+	HostSocket* listener = GetSocket(m_Socket, HOST_SOCKET_LISTEN);
+	if (status != NULL)
+		*status = (listener != NULL) ? LISTEN : CLOSED;
+	if (listener == NULL)
+		return WiFiClient();
+
+	while (HostNet::GetOpenSockets() < MAX_SOCK_NUM)
+	{
+		int fd = accept4(listener->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0)
+			break;
+		// no Nagle: a response split in two writes would otherwise wait for the delayed ACK of the peer,
+		// real time the virtual clock does not know about
+		int noDelay = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+		uint8_t sock = AllocateSocket(HOST_SOCKET_TCP, fd);
+		G_Sockets[sock].server = m_Socket;
+	}
+
+	for (uint8_t i = 1; i <= MAX_SOCK_NUM; i++)
+	{
+		uint8_t sock = (G_LastHandedOut + i) % MAX_SOCK_NUM;
+		HostSocket& socket = G_Sockets[sock];
+		if (socket.kind != HOST_SOCKET_TCP || socket.server != m_Socket)
+			continue;
+		if (PendingBytes(socket.fd) > 0)
+		{
+			socket.handedOut = true;
+			G_LastHandedOut = sock;
+			return WiFiClient(sock);
+		}
+		if (!socket.handedOut && PeerClosed(socket.fd))
+			FreeSocket(sock);
+	}
+	return WiFiClient();
+}
+
+uint8_t WiFiServer::status()
+{
+	return (GetSocket(m_Socket, HOST_SOCKET_LISTEN) != NULL) ? LISTEN : CLOSED;
+}
+
+// ***************************************
+// WiFiUDP
+
+WiFiUDP::WiFiUDP()
+{
+	m_Socket = NO_SOCKET_AVAIL;
+}
+
+uint8_t WiFiUDP::begin(uint16_t port)
+{
+	uint16_t boundPort;
+	stop();
+	int fd = OpenBound(SOCK_DGRAM, port, boundPort);
+	if (fd < 0)
+		return 0;
+	m_Socket = AllocateSocket(HOST_SOCKET_UDP, fd);
+	if (m_Socket == NO_SOCKET_AVAIL)
+	{
+		close(fd);
+		return 0;
+	}
+	HostSocket& socket = G_Sockets[m_Socket];
+	socket.port = port;
+	socket.boundPort = boundPort;
+	socket.rx = (uint8_t*)malloc(HOST_UDP_BUFFER_SIZE);
+	socket.tx = (uint8_t*)malloc(HOST_UDP_BUFFER_SIZE);
+	return 1;
+}
+
+void WiFiUDP::stop()
+{
+	if (GetSocket(m_Socket, HOST_SOCKET_UDP) != NULL)
+		FreeSocket(m_Socket);
+	m_Socket = NO_SOCKET_AVAIL;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port)
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_UDP);
+	if (socket == NULL)
+		return 0;
+	memset(&socket->destination, 0, sizeof(socket->destination));
+	socket->destination.sin_family = AF_INET;
+	socket->destination.sin_port = htons(port);
+	for (int i = 0; i < 4; i++)
+		((uint8_t*)&socket->destination.sin_addr.s_addr)[i] = ip[i];
+	socket->txLength = 0;
+	return 1;
+}
+
+int WiFiUDP::beginPacket(const char* host, uint16_t port)
+{
+	IPAddress ip;
+	if (!ip.fromString(host))
+		return 0;
+	return beginPacket(ip, port);
+}
+
+int WiFiUDP::endPacket()
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_UDP);
+	if (socket == NULL)
+		return 0;
+	ssize_t n = sendto(socket->fd, socket->tx, socket->txLength, 0, (struct sockaddr*)&socket->destination, sizeof(socket->destination));
+	G_NetStats.udpPackets++;
+	G_NetStats.udpBytes += socket->txLength;
+	socket->txLength = 0;
+	return (n >= 0) ? 1 : 0;
+}
+
+size_t WiFiUDP::write(uint8_t c)
+{
+	return write(&c, 1);
+}
+
+size_t WiFiUDP::write(const uint8_t* buffer, size_t size)
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_UDP);
+	if (socket == NULL)
+		return 0;
+	if (size > (size_t)(HOST_UDP_BUFFER_SIZE - socket->txLength))
+		size = HOST_UDP_BUFFER_SIZE - socket->txLength;
+	memcpy(socket->tx + socket->txLength, buffer, size);
+	socket->txLength += size;
+	return size;
+}
+
+int WiFiUDP::parsePacket()
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_UDP);
+	if (socket == NULL)
+		return 0;
+	socket->rxLength = 0;
+	socket->rxOffset = 0;
+	socklen_t length = sizeof(socket->remote);
+	ssize_t n = recvfrom(socket->fd, socket->rx, HOST_UDP_BUFFER_SIZE, MSG_DONTWAIT | MSG_TRUNC, (struct sockaddr*)&socket->remote, &length);
+	if (n <= 0)
+		return 0;
+	socket->rxLength = (n < HOST_UDP_BUFFER_SIZE) ? (int)n : HOST_UDP_BUFFER_SIZE;
+	return (int)n;
+}
+
+int WiFiUDP::available()
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_UDP);
+	return (socket != NULL) ? socket->rxLength - socket->rxOffset : 0;
+}
+
+int WiFiUDP::read()
+{
+	uint8_t c;
+	return (read(&c, 1) == 1) ? c : -1;
+}
+
+int WiFiUDP::read(unsigned char* buffer, size_t length)
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_UDP);
+	if (socket == NULL || socket->rxOffset >= socket->rxLength)
+		return -1;
+	if (length > (size_t)(socket->rxLength - socket->rxOffset))
+		length = socket->rxLength - socket->rxOffset;
+	memcpy(buffer, socket->rx + socket->rxOffset, length);
+	socket->rxOffset += length;
+	return (int)length;
+}
+
+int WiFiUDP::read(char* buffer, size_t length)
+{
+	return read((unsigned char*)buffer, length);
+}
+
+int WiFiUDP::peek()
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_UDP);
+	if (socket == NULL || socket->rxOffset >= socket->rxLength)
+		return -1;
+	return socket->rx[socket->rxOffset];
+}
+
+void WiFiUDP::flush()
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_UDP);
+	if (socket != NULL)
+		socket->rxOffset = socket->rxLength;
+}
+
+IPAddress WiFiUDP::remoteIP()
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_UDP);
+	if (socket == NULL)
+		return IPAddress(0, 0, 0, 0);
+	return IPAddress((const uint8_t*)&socket->remote.sin_addr.s_addr);
+}
+
+uint16_t WiFiUDP::remotePort()
+{
+	HostSocket* socket = GetSocket(m_Socket, HOST_SOCKET_UDP);
+	return (socket != NULL) ? ntohs(socket->remote.sin_port) : 0;
+}
@@ -0,0 +1,293 @@
+#include <WiFiNINA.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "HostSim.h"
+
+WiFiStorageClass WiFiStorage;
+
+static char G_Directory[256] = "";
+static boolean G_TemporaryDirectory = false;
+static long G_WriteLimit = -1;             // bytes still written before writes fail, -1 unlimited
+static HostStorageStats G_StorageStats = { 0, 0, 0, 0, 0, 0 };
+
+static void RemoveTemporaryDirectory()
+{
+	if (!G_TemporaryDirectory)
+		return;
+	HostStorage::Clear();
+	rmdir(G_Directory);
+}
+
+// Host path of a WiFiStorage file, "/fs/name" is name in the storage directory
+static void GetPath(const char* filename, char* path, size_t size)
+{
+	const char* name = strrchr(filename, '/');
+	name = (name != NULL) ? name + 1 : filename;
+	snprintf(path, size, "%s/%s", HostStorage::GetDirectory(), name);
+}
+
+// ***************************************
+// HostStorage
+
+void HostStorage::SetDirectory(const char* path)
+{
+	RemoveTemporaryDirectory();
+	G_TemporaryDirectory = false;
+	snprintf(G_Directory, sizeof(G_Directory), "%s", path);
+	mkdir(G_Directory, 0700);
+}
+
+// The storage directory, a new temporary one removed at exit unless SetDirectory() was called
+const char* HostStorage::GetDirectory()
+{
+	if (G_Directory[0] == 0)
+	{
+		const char* base = getenv("TMPDIR");
+		snprintf(G_Directory, sizeof(G_Directory), "%s/easywifi-XXXXXX", (base != NULL) ? base : "/tmp");
+		if (mkdtemp(G_Directory) == NULL)
+		{
+			perror("HostStorage: mkdtemp");
+			abort();
+		}
+		G_TemporaryDirectory = true;
+		atexit(RemoveTemporaryDirectory);
+	}
+	return G_Directory;
+}
+
+// Remove all files, as after a flash erase of the module
+void HostStorage::Clear()
+{
+	DIR* directory = opendir(GetDirectory());
+	if (directory == NULL)
+		return;
+	struct dirent* entry;
+	while ((entry = readdir(directory)) != NULL)
+	{
+		char path[512];
+		if (entry->d_name[0] == '.')
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", G_Directory, entry->d_name);
+		unlink(path);
+	}
+	closedir(directory);
+}
+
+// Replace the content of a file, for a test to lay out a store. Not counted in the stats
+boolean HostStorage::WriteFile(const char* filename, const void* data, size_t size)
+{
+	char path[512];
+	GetPath(filename, path, sizeof(path));
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+		return false;
+	size_t written = fwrite(data, 1, size, file);
+	fclose(file);
+	return written == size;
+}
+
+// Read up to size bytes of a file, -1 if it does not exist. Not counted in the stats
+long HostStorage::ReadFile(const char* filename, void* data, size_t size)
+{
+	char path[512];
+	GetPath(filename, path, sizeof(path));
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+		return -1;
+	long count = fread(data, 1, size, file);
+	fclose(file);
+	return count;
+}
+
+// Let writes fail once bytes more were written, a full or worn out flash. -1 for no limit
+void HostStorage::SetWriteLimit(long bytes)
+{
+	G_WriteLimit = bytes;
+}
+
+const HostStorageStats& HostStorage::GetStats()
+{
+	return G_StorageStats;
+}
+
+void HostStorage::ResetStats()
+{
+	memset(&G_StorageStats, 0, sizeof(G_StorageStats));
+}
+
+// ***************************************
+// WiFiStorageClass
+
+bool WiFiStorageClass::begin()
+{
+	return true;
+}
+
+WiFiStorageFile WiFiStorageClass::open(const char* filename)
+{
+	G_StorageStats.opens++;
+	return WiFiStorageFile(filename);
+}
+
+WiFiStorageFile WiFiStorageClass::open(String filename)
+{
+	return open(filename.c_str());
+}
+
+bool WiFiStorageClass::exists(const char* filename)
+{
+	uint32_t size;
+	return exists(filename, &size);
+}
+
+bool WiFiStorageClass::exists(const char* filename, uint32_t* size)
+{
+	char path[512];
+	struct stat info;
+	GetPath(filename, path, sizeof(path));
+	if (stat(path, &info) != 0)
+	{
+		*size = 0;
+		return false;
+	}
+	*size = info.st_size;
+	return true;
+}
+
+bool WiFiStorageClass::remove(const char* filename)
+{
+	char path[512];
+	GetPath(filename, path, sizeof(path));
+	if (unlink(path) != 0)
+		return false;
+	G_StorageStats.erases++;
+	return true;
+}
+
+bool WiFiStorageClass::rename(const char* oldName, const char* newName)
+{
+	char oldPath[512], newPath[512];
+	GetPath(oldName, oldPath, sizeof(oldPath));
+	GetPath(newName, newPath, sizeof(newPath));
+	return ::rename(oldPath, newPath) == 0;
+}
+
+bool WiFiStorageClass::read(const char* filename, uint32_t offset, uint8_t* buffer, uint32_t length)
+{
+	char path[512];
+	GetPath(filename, path, sizeof(path));
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+	ssize_t count = pread(fd, buffer, length, offset);
+	close(fd);
+	G_StorageStats.reads++;
+	if (count > 0)
+		G_StorageStats.bytesRead += count;
+	return count == (ssize_t)length;
+}
+
+// The firmware opens the file with "ab": the data is appended whatever the offset
+bool WiFiStorageClass::write(const char* filename, uint32_t offset, const uint8_t* buffer, uint32_t length)
+{
+	char path[512];
+	(void)offset;
+	GetPath(filename, path, sizeof(path));
+	G_StorageStats.writes++;
+	if (G_WriteLimit >= 0 && (long)length > G_WriteLimit)
+	{
+		length = G_WriteLimit;
+		G_WriteLimit = 0;
+	}
+	else if (G_WriteLimit >= 0)
+	{
+		G_WriteLimit -= length;
+	}
+	int fd = ::open(path, O_WRONLY | O_CREAT | O_APPEND, 0600);
+	if (fd < 0)
+		return false;
+	ssize_t count = (length > 0) ? ::write(fd, buffer, length) : 0;
+	close(fd);
+	if (count > 0)
+		G_StorageStats.bytesWritten += count;
+	return count == (ssize_t)length;
+}
+
+// ***************************************
+// WiFiStorageFile
+
+WiFiStorageFile::WiFiStorageFile(const char* filename)
+{
+	snprintf(m_Filename, sizeof(m_Filename), "%s", filename);
+	m_Offset = 0;
+	m_Length = 0;
+}
+
+// True if the file exists
+WiFiStorageFile::operator bool()
+{
+	return WiFiStorage.exists(m_Filename, &m_Length);
+}
+
+uint32_t WiFiStorageFile::read(void* buffer, uint32_t length)
+{
+	if (m_Offset + length > m_Length)
+	{
+		if (m_Offset >= m_Length)
+			return 0;
+		length = m_Length - m_Offset;
+	}
+	WiFiStorage.read(m_Filename, m_Offset, (uint8_t*)buffer, length);
+	m_Offset += length;
+	return length;
+}
+
+// Bytes the file took. The module always reports length, here a write cut by SetWriteLimit() shows up short
+uint32_t WiFiStorageFile::write(const void* buffer, uint32_t length)
+{
+	uint32_t before = 0, after = 0;
+	WiFiStorage.exists(m_Filename, &before);
+	WiFiStorage.write(m_Filename, m_Offset, (const uint8_t*)buffer, length);
+	WiFiStorage.exists(m_Filename, &after);
+	m_Offset += after - before;
+	return after - before;
+}
+
+void WiFiStorageFile::seek(uint32_t offset)
+{
+	m_Offset = offset;
+}
+
+uint32_t WiFiStorageFile::position()
+{
+	return m_Offset;
+}
+
+uint32_t WiFiStorageFile::size()
+{
+	WiFiStorage.exists(m_Filename, &m_Length);
+	return m_Length;
+}
+
+uint32_t WiFiStorageFile::available()
+{
+	WiFiStorage.exists(m_Filename, &m_Length);
+	return (m_Length > m_Offset) ? m_Length - m_Offset : 0;
+}
+
+void WiFiStorageFile::erase()
+{
+	m_Offset = 0;
+	WiFiStorage.remove(m_Filename);
+}
+
+void WiFiStorageFile::flush()
+{
+}
+
+void WiFiStorageFile::close()
+{
+	m_Offset = 0;
+}
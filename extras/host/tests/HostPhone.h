@@ -0,0 +1,349 @@
+// HostPhone.h
+// A phone joined to the access point: DNS queries and HTTP requests to the portal over loopback sockets.
+// Single threaded tests give it a pump that runs EasyWiFi::Poll() while the phone waits for an answer;
+// the load driver runs every phone on a thread of its own and polls the library from the main thread.
+
+#ifndef _HOST_HOSTPHONE_h
+#define _HOST_HOSTPHONE_h
+
+#include <HostSim.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+typedef void (*HostPump)(void* context);
+
+struct HostHttpResponse
+{
+    int status;                        // 0 if no complete response arrived
+    std::string headers;               // Status line and headers as sent
+    std::string body;                  // Decoded if it was chunked
+    bool keepAlive;                    // The portal keeps the connection open
+    bool chunked;
+    bool gzip;                         // Content-Encoding: gzip
+};
+
+class HostPhone
+{
+public:
+    HostPhone(HostPump pump = NULL, void* context = NULL, int timeout = 5000)
+        : m_Pump(pump), m_Context(context), m_Timeout(timeout), m_Fd(-1), m_UdpFd(-1), m_Connects(0), m_DnsId(0), m_HttpPort(0), m_DnsPort(0)
+    {
+    }
+
+    ~HostPhone()
+    {
+        Close();
+        if (m_UdpFd >= 0)
+            close(m_UdpFd);
+    }
+
+    /* Loopback ports of the web server and DNS responder to use instead of asking HostNet, which phones
+       on threads of their own must not do while the main thread polls the library */
+    void SetPorts(uint16_t httpPort, uint16_t dnsPort)
+    {
+        m_HttpPort = httpPort;
+        m_DnsPort = dnsPort;
+    }
+
+    // Open a new connection to the portal web server, a kept alive one is closed first
+    bool Connect()
+    {
+        Close();
+        m_Fd = ConnectTo((m_HttpPort != 0) ? m_HttpPort : HostNet::GetPort(80));
+        if (m_Fd < 0)
+            return false;
+        m_Connects++;
+        return true;
+    }
+
+    void Close()
+    {
+        if (m_Fd >= 0)
+            close(m_Fd);
+        m_Fd = -1;
+        m_Pending.clear();
+    }
+
+    bool IsConnected()
+    {
+        return m_Fd >= 0;
+    }
+
+    // Send a raw request and read the response. Connects unless the last response kept the connection open
+    bool Request(const std::string& request, HostHttpResponse& response)
+    {
+        response = HostHttpResponse();
+        if (m_Fd < 0 && !Connect())
+            return false;
+        if (!SendAll(m_Fd, request.data(), request.size()) || !ReadResponse(response))
+        {
+            Close();
+            return false;
+        }
+        if (!response.keepAlive)
+            Close();
+        return true;
+    }
+
+    bool Get(const char* path, HostHttpResponse& response, const char* headers = "")
+    {
+        std::string request = std::string("GET ") + path + " HTTP/1.1\r\nHost: portal\r\n" + headers + "\r\n";
+        return Request(request, response);
+    }
+
+    bool Post(const char* path, const std::string& body, HostHttpResponse& response, const char* headers = "")
+    {
+        std::string request = std::string("POST ") + path + " HTTP/1.1\r\nHost: portal\r\n"
+            + "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: " + std::to_string(body.size()) + "\r\n"
+            + headers + "\r\n" + body;
+        return Request(request, response);
+    }
+
+    // A query for name type A, returns the length of the reply in reply or -1 if none came
+    int Dns(const char* name, uint8_t* reply, int size)
+    {
+        uint8_t query[300];
+        int length = BuildDnsQuery(++m_DnsId, name, query, sizeof(query));
+        return (length > 0) ? DnsRaw(query, length, reply, size) : -1;
+    }
+
+    // Send any packet to the DNS port, returns the length of the reply or -1 if none came
+    int DnsRaw(const uint8_t* packet, int length, uint8_t* reply, int size)
+    {
+        if (m_UdpFd < 0)
+            m_UdpFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        struct sockaddr_in address = GetAddress((m_DnsPort != 0) ? m_DnsPort : HostNet::GetPort(UDP_PORT_DNS));
+        if (m_UdpFd < 0 || sendto(m_UdpFd, packet, length, 0, (struct sockaddr*)&address, sizeof(address)) != length)
+            return -1;
+        if (!Wait(m_UdpFd, POLLIN))
+            return -1;
+        ssize_t n = recv(m_UdpFd, reply, size, 0);
+        return (n > 0) ? (int)n : -1;
+    }
+
+    // A type A query for each name sent at once, as a phone does right after joining. Returns how many were answered
+    int DnsBurst(const char* const* names, int count)
+    {
+        uint8_t packet[512];
+        uint16_t firstId = m_DnsId + 1;
+        int answered = 0;
+        if (m_UdpFd < 0)
+            m_UdpFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        struct sockaddr_in address = GetAddress((m_DnsPort != 0) ? m_DnsPort : HostNet::GetPort(UDP_PORT_DNS));
+        if (m_UdpFd < 0)
+            return 0;
+        for (int i = 0; i < count; i++)
+        {
+            int length = BuildDnsQuery(++m_DnsId, names[i], packet, sizeof(packet));
+            if (length > 0)
+                sendto(m_UdpFd, packet, length, 0, (struct sockaddr*)&address, sizeof(address));
+        }
+        while (answered < count && Wait(m_UdpFd, POLLIN))
+        {
+            ssize_t n = recv(m_UdpFd, packet, sizeof(packet), 0);
+            uint16_t id = (n >= 2) ? ((packet[0] << 8) | packet[1]) : 0;
+            if ((uint16_t)(id - firstId) < count)
+                answered++; // a late reply to an earlier burst is not counted
+        }
+        return answered;
+    }
+
+    // Connections opened since the phone was made, keep-alive shows up as fewer than requests
+    int GetConnects()
+    {
+        return m_Connects;
+    }
+
+    // Standard query with recursion desired for name, type A class IN
+    static int BuildDnsQuery(uint16_t id, const char* name, uint8_t* packet, int size)
+    {
+        const uint8_t header[12] = { (uint8_t)(id >> 8), (uint8_t)id, 0x01, 0x00, 0, 1, 0, 0, 0, 0, 0, 0 };
+        int length = sizeof(header);
+        if (size < length + (int)strlen(name) + 6)
+            return -1;
+        memcpy(packet, header, sizeof(header));
+        while (*name != 0)
+        {
+            const char* dot = strchr(name, '.');
+            int label = (dot != NULL) ? (int)(dot - name) : (int)strlen(name);
+            packet[length++] = label;
+            memcpy(packet + length, name, label);
+            length += label;
+            name += label + ((dot != NULL) ? 1 : 0);
+        }
+        const uint8_t tail[5] = { 0, 0, 1, 0, 1 };
+        memcpy(packet + length, tail, sizeof(tail));
+        return length + sizeof(tail);
+    }
+
+private:
+    enum { UDP_PORT_DNS = 53 };
+
+    static struct sockaddr_in GetAddress(uint16_t port)
+    {
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        return address;
+    }
+
+    static int ConnectTo(uint16_t port)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_in address = GetAddress(port);
+        int noDelay = 1;
+        if (fd < 0)
+            return -1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        if (port == 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // Wait until fd is ready, pumping the library meanwhile if there is a pump
+    bool Wait(int fd, short events)
+    {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_Timeout);
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            struct pollfd ready = { fd, events, 0 };
+            if (poll(&ready, 1, (m_Pump != NULL) ? 0 : 10) > 0)
+                return true;
+            if (m_Pump != NULL)
+                m_Pump(m_Context);
+        }
+        return false;
+    }
+
+    bool SendAll(int fd, const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            if (!Wait(fd, POLLOUT))
+                return false;
+            ssize_t n = send(fd, data, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+            if (n > 0)
+            {
+                data += n;
+                size -= n;
+            }
+        }
+        return true;
+    }
+
+    // Receive more bytes into m_Pending, false once the portal closed the connection
+    bool Receive()
+    {
+        char buffer[2048];
+        if (!Wait(m_Fd, POLLIN))
+            return false;
+        ssize_t n = recv(m_Fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n <= 0)
+            return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        m_Pending.append(buffer, n);
+        return true;
+    }
+
+    static bool HasHeader(const std::string& headers, const char* line)
+    {
+        std::string lower(headers);
+        for (size_t i = 0; i < lower.size(); i++)
+            lower[i] = tolower(lower[i]);
+        return lower.find(line) != std::string::npos;
+    }
+
+    bool ReadResponse(HostHttpResponse& response)
+    {
+        size_t end;
+        while ((end = m_Pending.find("\r\n\r\n")) == std::string::npos)
+        {
+            if (!Receive())
+                return false;
+        }
+        response.headers = m_Pending.substr(0, end + 2);
+        m_Pending.erase(0, end + 4);
+        if (sscanf(response.headers.c_str(), "HTTP/1.%*d %d", &response.status) != 1)
+            return false;
+        response.keepAlive = HasHeader(response.headers, "\r\nconnection: keep-alive\r\n");
+        response.chunked = HasHeader(response.headers, "\r\ntransfer-encoding: chunked\r\n");
+        response.gzip = HasHeader(response.headers, "\r\ncontent-encoding: gzip\r\n");
+
+        std::string lower(response.headers);
+        for (size_t i = 0; i < lower.size(); i++)
+            lower[i] = tolower(lower[i]);
+        size_t lengthHeader = lower.find("\r\ncontent-length:");
+        if (response.chunked)
+            return ReadChunked(response);
+        if (lengthHeader != std::string::npos)
+        {
+            size_t length = strtoul(response.headers.c_str() + lengthHeader + 17, NULL, 10);
+            while (m_Pending.size() < length)
+            {
+                if (!Receive())
+                    return false;
+            }
+            response.body = m_Pending.substr(0, length);
+            m_Pending.erase(0, length);
+            return true;
+        }
+        // Delimited by closing the connection
+        while (Receive())
+        {
+        }
+        response.body = m_Pending;
+        m_Pending.clear();
+        response.keepAlive = false;
+        return true;
+    }
+
+    bool ReadChunked(HostHttpResponse& response)
+    {
+        while (true)
+        {
+            size_t end;
+            while ((end = m_Pending.find("\r\n")) == std::string::npos)
+            {
+                if (!Receive())
+                    return false;
+            }
+            size_t length = strtoul(m_Pending.c_str(), NULL, 16);
+            m_Pending.erase(0, end + 2);
+            while (m_Pending.size() < length + 2)
+            {
+                if (!Receive())
+                    return false;
+            }
+            response.body.append(m_Pending, 0, length);
+            m_Pending.erase(0, length + 2);
+            if (length == 0)
+                return true;
+        }
+    }
+
+    HostPump m_Pump;
+    void* m_Context;
+    int m_Timeout;                     // Time in ms to wait for an answer (real time)
+    int m_Fd;                          // Web server connection, -1 if none
+    int m_UdpFd;
+    int m_Connects;
+    uint16_t m_DnsId;
+    uint16_t m_HttpPort;               // 0: ask HostNet
+    uint16_t m_DnsPort;
+    std::string m_Pending;             // Received and not yet parsed
+};
+
+#endif
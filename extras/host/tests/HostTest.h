@@ -0,0 +1,69 @@
+// HostTest.h
+// Checks of the host tests. A failed check prints where and what, the test goes on with the next one;
+// main() returns HostTest::Result() so ctest sees the failure.
+
+#ifndef _HOST_HOSTTEST_h
+#define _HOST_HOSTTEST_h
+
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(condition) HostTest::Check((condition), #condition, __FILE__, __LINE__)
+#define CHECK_EQUAL(expected, actual) HostTest::CheckEqual((long long)(expected), (long long)(actual), #actual, __FILE__, __LINE__)
+#define CHECK_TEXT(expected, actual) HostTest::CheckText((expected), (actual), #actual, __FILE__, __LINE__)
+
+class HostTest
+{
+public:
+    static bool Check(bool condition, const char* text, const char* file, int line)
+    {
+        s_Checks()++;
+        if (!condition)
+        {
+            s_Failures()++;
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, text);
+        }
+        return condition;
+    }
+
+    static bool CheckEqual(long long expected, long long actual, const char* text, const char* file, int line)
+    {
+        s_Checks()++;
+        if (expected != actual)
+        {
+            s_Failures()++;
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", file, line, text, actual, expected);
+        }
+        return expected == actual;
+    }
+
+    static bool CheckText(const char* expected, const char* actual, const char* text, const char* file, int line)
+    {
+        bool equal = (actual != NULL) && (strcmp(expected, actual) == 0);
+        s_Checks()++;
+        if (!equal)
+        {
+            s_Failures()++;
+            fprintf(stderr, "%s:%d: %s is \"%s\", expected \"%s\"\n", file, line, text, (actual != NULL) ? actual : "(null)", expected);
+        }
+        return equal;
+    }
+
+    // Start of a test case, printed so a failure can be placed
+    static void Case(const char* name)
+    {
+        printf("-- %s\n", name);
+    }
+
+    static int Result()
+    {
+        printf("%d checks, %d failed\n", s_Checks(), s_Failures());
+        return (s_Failures() == 0) ? 0 : 1;
+    }
+
+private:
+    static int& s_Checks() { static int checks = 0; return checks; }
+    static int& s_Failures() { static int failures = 0; return failures; }
+};
+
+#endif
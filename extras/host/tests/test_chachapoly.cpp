@@ -0,0 +1,122 @@
+// ChaChaPoly against the test vectors of RFC 8439 and vectors of OpenSSL for the block boundaries.
+
+#include <ChaChaPoly.h>
+#include <string.h>
+#include "HostTest.h"
+
+static const char G_Sunscreen[] = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, "
+    "sunscreen would be it.";
+
+static size_t FromHex(const char* hex, uint8_t* out)
+{
+    size_t length = strlen(hex) / 2;
+    for (size_t i = 0; i < length; i++)
+    {
+        unsigned int value;
+        sscanf(hex + 2 * i, "%2x", &value);
+        out[i] = (uint8_t)value;
+    }
+    return length;
+}
+
+static bool SameBytes(const uint8_t* data, const char* hex)
+{
+    uint8_t expected[256];
+    size_t length = FromHex(hex, expected);
+    return memcmp(data, expected, length) == 0;
+}
+
+static void Sequence(uint8_t* out, size_t length, uint8_t first)
+{
+    for (size_t i = 0; i < length; i++)
+        out[i] = (uint8_t)(first + i);
+}
+
+static void TestBlock()
+{
+    HostTest::Case("block function (RFC 8439 2.3.2)");
+    uint8_t key[CHACHAPOLY_KEY_SIZE];
+    const uint8_t nonce[CHACHAPOLY_NONCE_SIZE] = { 0, 0, 0, 0x09, 0, 0, 0, 0x4a, 0, 0, 0, 0 };
+    const uint32_t expected[16] =
+    {
+        0xe4e7f110, 0x15593bd1, 0x1fdd0f50, 0xc47120a3, 0xc7f4d1c7, 0x0368c033, 0x9aaa2204, 0x4e6cd4c3,
+        0x466482d2, 0x09aa9f07, 0x05d7c214, 0xa2028bd9, 0xd19c12b5, 0xb94e16de, 0xe883d0cb, 0x4e3c50a2
+    };
+    uint32_t block[16];
+    Sequence(key, sizeof(key), 0);
+    ChaChaPoly::Block(key, 1, nonce, block);
+    CHECK(memcmp(block, expected, sizeof(block)) == 0);
+}
+
+static void TestEncryption()
+{
+    HostTest::Case("encryption (RFC 8439 2.4.2)");
+    uint8_t key[CHACHAPOLY_KEY_SIZE], tag[CHACHAPOLY_TAG_SIZE], data[sizeof(G_Sunscreen)];
+    const uint8_t nonce[CHACHAPOLY_NONCE_SIZE] = { 0, 0, 0, 0, 0, 0, 0, 0x4a, 0, 0, 0, 0 };
+    Sequence(key, sizeof(key), 0);
+    memcpy(data, G_Sunscreen, sizeof(data));
+    ChaChaPoly::Encrypt(key, nonce, NULL, 0, data, strlen(G_Sunscreen), tag);
+    CHECK(SameBytes(data,
+        "6e2e359a2568f98041ba0728dd0d6981e97e7aec1d4360c20a27afccfd9fae0bf91b65c5524733ab8f593dabcd62b357"
+        "1639d624e65152ab8f530c359f0861d807ca0dbf500d6a6156a38e088a22b65e52bc514d16ccf806818ce91ab7793736"
+        "5af90bbf74a35be6b40b8eedf2785e42874d"));
+}
+
+static void TestAead()
+{
+    HostTest::Case("AEAD (RFC 8439 2.8.2)");
+    uint8_t key[CHACHAPOLY_KEY_SIZE], tag[CHACHAPOLY_TAG_SIZE], data[sizeof(G_Sunscreen)];
+    const uint8_t nonce[CHACHAPOLY_NONCE_SIZE] = { 0x07, 0, 0, 0, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47 };
+    const uint8_t aad[12] = { 0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7 };
+    size_t length = strlen(G_Sunscreen);
+    Sequence(key, sizeof(key), 0x80);
+    memcpy(data, G_Sunscreen, sizeof(data));
+    ChaChaPoly::Encrypt(key, nonce, aad, sizeof(aad), data, length, tag);
+    CHECK(SameBytes(data,
+        "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d63dbea45e8ca9671282fafb69da92728b"
+        "1a71de0a9e060b2905d6a5b67ecd3b3692ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+        "3ff4def08e4b7a9de576d26586cec64b6116"));
+    CHECK(SameBytes(tag, "1ae10b594f09e26a7e902ecbd0600691"));
+    CHECK(ChaChaPoly::Decrypt(key, nonce, aad, sizeof(aad), data, length, tag));
+    CHECK(memcmp(data, G_Sunscreen, length) == 0);
+
+    HostTest::Case("AEAD block boundaries");
+    uint8_t plain[129], cipher[129];
+    Sequence(plain, sizeof(plain), 0);
+    ChaChaPoly::Encrypt(key, nonce, NULL, 0, cipher, 0, tag);
+    CHECK(SameBytes(tag, "a0784d7a4716f3feb4f64e7f4b39bf04"));
+    memcpy(cipher, plain, 64);
+    ChaChaPoly::Encrypt(key, nonce, aad, 1, cipher, 64, tag);
+    CHECK(SameBytes(cipher,
+        "9f7aeb5e05f846bd1deb85f03a8c04a1d1d19a2c1d1478c9c593ca9c499f1dba6ebfe91b88ab780c90f39824d6f67cc7"
+        "4535805d8a5c5b78589dbff42d852566"));
+    CHECK(SameBytes(tag, "42c3f9c5aa19221360d2fa8c8cc5f3ac"));
+    memcpy(cipher, plain, sizeof(cipher));
+    ChaChaPoly::Encrypt(key, nonce, plain, 17, cipher, sizeof(cipher), tag);
+    CHECK(SameBytes(cipher + 64,
+        "bcf0861c065ca8eba4239488022b2737de8a1397c8f657b67fb9f6f06719e7903ce7d9f6840e6b95f873dc2e88c6884d"
+        "65497e70ba401aa0de0f1980a192811bf5"));
+    CHECK(SameBytes(tag, "023df655dbeb976863733f6ca83d55ae"));
+
+    HostTest::Case("tampering is refused and leaves the data alone");
+    uint8_t copy[129];
+    memcpy(copy, cipher, sizeof(copy));
+    tag[15] ^= 0x01;
+    CHECK(!ChaChaPoly::Decrypt(key, nonce, plain, 17, cipher, sizeof(cipher), tag));
+    tag[15] ^= 0x01;
+    cipher[128] ^= 0x80;
+    CHECK(!ChaChaPoly::Decrypt(key, nonce, plain, 17, cipher, sizeof(cipher), tag));
+    cipher[128] ^= 0x80;
+    CHECK(!ChaChaPoly::Decrypt(key, nonce, plain, 16, cipher, sizeof(cipher), tag));
+    CHECK(memcmp(copy, cipher, sizeof(copy)) == 0);
+    CHECK(ChaChaPoly::Decrypt(key, nonce, plain, 17, cipher, sizeof(cipher), tag));
+    CHECK(memcmp(plain, cipher, sizeof(plain)) == 0);
+}
+
+int main()
+{
+    TestBlock();
+    TestEncryption();
+    TestAead();
+    return HostTest::Result();
+}
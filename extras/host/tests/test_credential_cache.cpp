@@ -0,0 +1,187 @@
+// RAM copy of the credential store: one file open for the first load, lookups and reconnects answered from
+// RAM, writes going through to the copy, and a failed write making the next read load the file again.
+
+#include <EasyWiFi.h>
+#include <HostSim.h>
+#include "HostTest.h"
+
+static bool RunUntil(EasyWiFi& wifi, EasyWiFiState state, unsigned long limit)
+{
+    for (unsigned long elapsed = 0; elapsed < limit; elapsed += 5)
+    {
+        if (wifi.Poll() == state)
+            return true;
+        HostClock::Advance(5);
+    }
+    return false;
+}
+
+static void ResetStore()
+{
+    HostStorage::Clear();
+    CredentialsHandler::Invalidate();
+}
+
+static void TestLoadOnce()
+{
+    HostTest::Case("one load, then lookups from RAM");
+    char ssid[CREDENTIALS_SSID_SIZE], password[CREDENTIALS_PASS_SIZE];
+    WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+    ResetStore();
+    CHECK(CredentialsHandler::AddNetwork("Home", "secretpass", 100) != 0);
+    CHECK(CredentialsHandler::AddNetwork("Cafe", "espresso-42", 50) != 0);
+    CredentialsHandler::Invalidate();
+
+    WiFiCredentialStoreStats before = CredentialsHandler::GetStoreStats();
+    HostStorage::ResetStats();
+    CHECK_EQUAL(2, CredentialsHandler::GetNetworks(networks));
+    WiFiCredentialStoreStats after = CredentialsHandler::GetStoreStats();
+    CHECK_EQUAL(1UL, after.cacheMisses - before.cacheMisses);
+    CHECK_EQUAL(1UL, after.readOpens - before.readOpens);
+    CHECK_EQUAL(1UL, HostStorage::GetStats().opens);
+
+    before = after;
+    HostStorage::ResetStats();
+    for (int i = 0; i < 10; i++)
+    {
+        CHECK(CredentialsHandler::Read_Credentials(ssid, password) != 0);
+        CHECK(CredentialsHandler::Check_Credentials() != 0);
+        CHECK_EQUAL(2, CredentialsHandler::GetNetworkCount());
+        CHECK_EQUAL(1, CredentialsHandler::FindNetwork("Cafe"));
+    }
+    CHECK_TEXT("Home", ssid);
+    after = CredentialsHandler::GetStoreStats();
+    CHECK_EQUAL(0UL, after.cacheMisses - before.cacheMisses);
+    CHECK_EQUAL(0UL, after.readOpens - before.readOpens);
+    CHECK(after.cacheHits - before.cacheHits >= 40);
+    CHECK_EQUAL(0UL, HostStorage::GetStats().opens);
+    CHECK_EQUAL(0UL, HostStorage::GetStats().reads);
+}
+
+static void TestWriteThrough()
+{
+    HostTest::Case("writes go through to the copy");
+    WiFiNetworkCredentials network;
+    ResetStore();
+    CHECK(CredentialsHandler::AddNetwork("Home", "secretpass", 100) != 0);
+    CHECK_EQUAL(1, CredentialsHandler::GetNetworkCount());
+
+    WiFiCredentialStoreStats before = CredentialsHandler::GetStoreStats();
+    HostStorage::ResetStats();
+    CHECK(CredentialsHandler::AddNetwork("Cafe", "espresso-42", 50) != 0);
+    CHECK(CredentialsHandler::RemoveNetwork("Home") != 0);
+    CHECK(CredentialsHandler::GetNetwork(CredentialsHandler::FindNetwork("Cafe"), network));
+    CHECK_TEXT("espresso-42", network.password);
+    CHECK_EQUAL(1, CredentialsHandler::GetNetworkCount());
+    WiFiCredentialStoreStats after = CredentialsHandler::GetStoreStats();
+    CHECK_EQUAL(2UL, after.appends - before.appends);
+    CHECK_EQUAL(2UL, after.writeOpens - before.writeOpens);
+    CHECK_EQUAL(0UL, after.readOpens - before.readOpens);
+    CHECK_EQUAL(0UL, after.cacheMisses - before.cacheMisses);
+    CHECK_EQUAL(0UL, HostStorage::GetStats().reads);
+    CHECK_EQUAL(0UL, HostStorage::GetStats().erases);
+
+    HostTest::Case("repeated successes within a day stay in RAM");
+    before = CredentialsHandler::GetStoreStats();
+    HostStorage::ResetStats();
+    for (int i = 0; i < 100; i++)
+        CHECK(CredentialsHandler::MarkConnected("Cafe", 1700000000 + 60 * i) != 0);
+    after = CredentialsHandler::GetStoreStats();
+    CHECK(after.appends - before.appends <= 1);
+    CHECK(HostStorage::GetStats().writes <= 1);
+    CHECK(CredentialsHandler::GetNetwork(CredentialsHandler::FindNetwork("Cafe"), network));
+    CHECK_EQUAL(1700000000UL + 60 * 99, (unsigned long)network.lastSuccess);
+
+    HostTest::Case("erase leaves an empty copy");
+    HostStorage::ResetStats();
+    CHECK(CredentialsHandler::Erase_Credentials() != 0);
+    CHECK_EQUAL(0, CredentialsHandler::GetNetworkCount());
+    CHECK_EQUAL(-1, CredentialsHandler::FindNetwork("Cafe"));
+    CHECK_EQUAL(0UL, HostStorage::GetStats().reads);
+}
+
+static void TestFailedWrite()
+{
+    HostTest::Case("a failed write drops the copy");
+    WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+    ResetStore();
+    CHECK(CredentialsHandler::AddNetwork("Home", "secretpass", 100) != 0);
+
+    HostStorage::SetWriteLimit(20);
+    CHECK_EQUAL(0, CredentialsHandler::AddNetwork("Cafe", "espresso-42", 50));
+    HostStorage::SetWriteLimit(-1);
+
+    WiFiCredentialStoreStats before = CredentialsHandler::GetStoreStats();
+    CHECK_EQUAL(1, CredentialsHandler::GetNetworks(networks));      // what the file holds, not what was asked
+    CHECK_TEXT("Home", networks[0].ssid);
+    WiFiCredentialStoreStats after = CredentialsHandler::GetStoreStats();
+    CHECK_EQUAL(1UL, after.cacheMisses - before.cacheMisses);
+    CHECK_EQUAL(1UL, after.readOpens - before.readOpens);
+
+    // The cut record is compacted away by the next change
+    CHECK(CredentialsHandler::AddNetwork("Cafe", "espresso-42", 50) != 0);
+    CredentialsHandler::Invalidate();
+    CHECK_EQUAL(2, CredentialsHandler::GetNetworkCount());
+}
+
+static void TestReconnectCache()
+{
+    HostTest::Case("reconnect cache read once");
+    WiFiReconnectCache cache = WiFiReconnectCache(), read;
+    ResetStore();
+    strcpy(cache.ssid, "Home");
+    cache.localIP = IPAddress(192, 168, 1, 23);
+    CHECK(CredentialsHandler::WriteReconnectCache(cache) != 0);
+
+    HostStorage::ResetStats();
+    CHECK(CredentialsHandler::ReadReconnectCache(read));
+    CHECK(read.localIP == cache.localIP);
+    CHECK_EQUAL(0UL, HostStorage::GetStats().opens);
+
+    CredentialsHandler::Invalidate();
+    for (int i = 0; i < 5; i++)
+        CHECK(CredentialsHandler::ReadReconnectCache(read));
+    CHECK_EQUAL(1UL, HostStorage::GetStats().opens);
+    CHECK_TEXT("Home", read.ssid);
+
+    HostStorage::ResetStats();
+    CHECK(CredentialsHandler::EraseReconnectCache() != 0);
+    for (int i = 0; i < 5; i++)
+        CHECK(!CredentialsHandler::ReadReconnectCache(read));
+    CHECK_EQUAL(1UL, HostStorage::GetStats().opens);              // the erase only
+}
+
+static void TestReconnect()
+{
+    HostTest::Case("Begin() again after a drop does not read flash");
+    EasyWiFi wifi;
+    ResetStore();
+    HostWiFi::AddNetwork("Home", "secretpass", -48);
+    HostWiFi::SetTime(1700000000);
+    CHECK(CredentialsHandler::AddNetwork("Home", "secretpass", 100) != 0);
+    CredentialsHandler::Invalidate();
+    wifi.Begin();
+    CHECK(RunUntil(wifi, EASYWIFI_CONNECTED, 600000));
+
+    WiFiCredentialStoreStats before = CredentialsHandler::GetStoreStats();
+    for (int i = 0; i < 3; i++)
+    {
+        WiFi.disconnect();
+        wifi.Begin();
+        CHECK(RunUntil(wifi, EASYWIFI_CONNECTED, 600000));
+    }
+    WiFiCredentialStoreStats after = CredentialsHandler::GetStoreStats();
+    CHECK_EQUAL(0UL, after.cacheMisses - before.cacheMisses);
+    CHECK_EQUAL(0UL, after.readOpens - before.readOpens);
+    CHECK(after.cacheHits > before.cacheHits);
+}
+
+int main()
+{
+    TestLoadOnce();
+    TestWriteThrough();
+    TestFailedWrite();
+    TestReconnectCache();
+    TestReconnect();
+    return HostTest::Result();
+}
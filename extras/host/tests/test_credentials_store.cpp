@@ -0,0 +1,339 @@
+// CredentialsHandler: Write_Credentials buffer sizes, journal round trips, damaged records and files,
+// and the migration of the version 1 and text formats.
+
+#include <CredentialsHandler.h>
+#include <HostSim.h>
+#include <string.h>
+#include "HostTest.h"
+
+#define STORE_FILE "/fs/WifiCredentials"
+#define RECONNECT_FILE "/fs/WifiReconnect"
+#define STORE_HEADER 12
+#define STORE_RECORD 136
+#define STORE_RECORD_SSID 20             // Encrypted ssid in a record
+#define STORE_SEED 4                     // Default seed of CredentialsHandler
+
+// Empty store, nothing cached
+static void ResetStore()
+{
+    HostStorage::Clear();
+    CredentialsHandler::Invalidate();
+}
+
+static long ReadStore(uint8_t* buffer, size_t size)
+{
+    return HostStorage::ReadFile(STORE_FILE, buffer, size);
+}
+
+// Read the store file from flash again, as after a reset of the board
+static int Reload(WiFiNetworkCredentials* networks)
+{
+    CredentialsHandler::Invalidate();
+    return CredentialsHandler::GetNetworks(networks);
+}
+
+static uint32_t Crc32(const uint8_t* data, size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+// The cypher of the formats before version 2, SimpleDecypher() undone
+static void SimpleCypher(const char* text, uint8_t* out, int length)
+{
+    for (int t = 0; t < length; t++)
+        out[t] = (uint8_t)(text[t] + STORE_SEED % 17 - t % 7);
+}
+
+static void TestWriteCredentialsSizes()
+{
+    HostTest::Case("Write_Credentials buffer sizes");
+    char ssid[] = "HomeNetwork";
+    char password[] = "secretpass";
+    char ssidBuffer[CREDENTIALS_SSID_SIZE], passwordBuffer[CREDENTIALS_PASS_SIZE];
+    ResetStore();
+
+    // Nothing to store: refused, and nothing written before the buffers
+    CHECK_EQUAL(0, CredentialsHandler::Write_Credentials(ssid, 0, password, sizeof(password)));
+    CHECK_EQUAL(0, CredentialsHandler::Write_Credentials(ssid, -1, password, sizeof(password)));
+    CHECK_EQUAL(0, CredentialsHandler::Write_Credentials(NULL, 10, password, sizeof(password)));
+    CHECK_EQUAL(0, CredentialsHandler::GetNetworkCount());
+
+    // size shorter than the text: cut at size
+    CHECK(CredentialsHandler::Write_Credentials(ssid, 4, password, sizeof(password)) != 0);
+    CHECK(CredentialsHandler::FindNetwork("Home") >= 0);
+
+    // Password of size 0: an open network
+    CHECK(CredentialsHandler::Write_Credentials(ssid, sizeof(ssid), password, 0) != 0);
+    WiFiNetworkCredentials network;
+    CHECK(CredentialsHandler::GetNetwork(CredentialsHandler::FindNetwork("HomeNetwork"), network));
+    CHECK_TEXT("", network.password);
+    CHECK(CredentialsHandler::Read_Credentials(ssidBuffer, passwordBuffer) != 0);
+
+    // Buffers without a terminator are read up to size only
+    char unterminated[4] = { 'C', 'a', 'f', 'e' };
+    char unterminatedPassword[8] = { 'e', 's', 'p', 'r', 'e', 's', 's', 'o' };
+    CHECK(CredentialsHandler::Write_Credentials(unterminated, sizeof(unterminated), unterminatedPassword, sizeof(unterminatedPassword)) != 0);
+    CHECK(CredentialsHandler::GetNetwork(CredentialsHandler::FindNetwork("Cafe"), network));
+    CHECK_TEXT("espresso", network.password);
+
+    // Buffers larger than the fields: the text is cut to what a field holds
+    char longSsid[64], longPassword[100];
+    memset(longSsid, 's', sizeof(longSsid) - 1);
+    longSsid[sizeof(longSsid) - 1] = 0;
+    memset(longPassword, 'p', sizeof(longPassword) - 1);
+    longPassword[sizeof(longPassword) - 1] = 0;
+    CHECK(CredentialsHandler::Write_Credentials(longSsid, sizeof(longSsid), longPassword, sizeof(longPassword)) != 0);
+    longSsid[CREDENTIALS_SSID_SIZE - 1] = 0;
+    CHECK(CredentialsHandler::GetNetwork(CredentialsHandler::FindNetwork(longSsid), network));
+    CHECK_EQUAL(CREDENTIALS_PASS_SIZE - 1, (long)strlen(network.password));
+}
+
+static void TestRoundTrip()
+{
+    HostTest::Case("journal round trip");
+    WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+    uint8_t file[4096];
+    ResetStore();
+
+    CHECK(CredentialsHandler::AddNetwork("Home", "secretpass", 200) != 0);
+    CHECK(CredentialsHandler::AddNetwork("Cafe", "espresso-42", 100) != 0);
+    CHECK(CredentialsHandler::AddNetwork("Office", "", 150) != 0);
+    CHECK(CredentialsHandler::MarkConnected("Cafe", 1700000000) != 0);
+    CHECK(CredentialsHandler::AddNetwork("Home", "new-secret", 50) != 0);
+    CHECK(CredentialsHandler::RemoveNetwork("Office") != 0);
+    CHECK_EQUAL(0, CredentialsHandler::RemoveNetwork("Office"));
+
+    CHECK_EQUAL(2, Reload(networks));
+    CHECK_TEXT("Home", networks[0].ssid);
+    CHECK_TEXT("new-secret", networks[0].password);
+    CHECK_EQUAL(50, networks[0].priority);
+    CHECK_TEXT("Cafe", networks[1].ssid);
+    CHECK_TEXT("espresso-42", networks[1].password);
+    CHECK_EQUAL(1700000000UL, (unsigned long)networks[1].lastSuccess);
+
+    // Nothing readable in plain text
+    long size = ReadStore(file, sizeof(file));
+    CHECK(size > STORE_HEADER);
+    CHECK(memmem(file, size, "espresso", 8) == NULL);
+    CHECK(memmem(file, size, "Cafe", 4) == NULL);
+
+    HostTest::Case("journal compaction");
+    WiFiCredentialStoreStats before = CredentialsHandler::GetStoreStats();
+    for (int i = 0; i < 3 * CREDENTIALS_JOURNAL_RECORDS; i++)
+    {
+        char password[24];
+        snprintf(password, sizeof(password), "password-%02d", i);
+        CHECK(CredentialsHandler::AddNetwork("Cafe", password, 100) != 0);
+    }
+    WiFiCredentialStoreStats after = CredentialsHandler::GetStoreStats();
+    CHECK(after.compactions - before.compactions >= 2);
+    size = ReadStore(file, sizeof(file));
+    CHECK(size <= STORE_HEADER + CREDENTIALS_JOURNAL_RECORDS * STORE_RECORD);
+    CHECK_EQUAL(2, Reload(networks));
+    CHECK_TEXT("password-47", networks[1].password);
+    CHECK_TEXT("new-secret", networks[0].password);
+
+    HostTest::Case("another seed cannot open the store");
+    CredentialsHandler::SetSeed(STORE_SEED + 1);
+    CHECK_EQUAL(0, CredentialsHandler::GetNetworkCount());
+    CredentialsHandler::SetSeed(STORE_SEED);
+    CHECK_EQUAL(2, CredentialsHandler::GetNetworkCount());
+}
+
+static void TestCorruption()
+{
+    HostTest::Case("damaged records are skipped");
+    WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+    uint8_t file[4096];
+    ResetStore();
+
+    CHECK(CredentialsHandler::AddNetwork("Home", "secretpass", 100) != 0);
+    CHECK(CredentialsHandler::AddNetwork("Cafe", "espresso-42", 100) != 0);
+    CHECK(CredentialsHandler::AddNetwork("Office", "office-pass", 100) != 0);
+    long size = ReadStore(file, sizeof(file));
+    CHECK_EQUAL(STORE_HEADER + 3 * STORE_RECORD, size);
+
+    // A flipped bit in the encrypted ssid of the second record
+    file[STORE_HEADER + STORE_RECORD + STORE_RECORD_SSID] ^= 0x01;
+    CHECK(HostStorage::WriteFile(STORE_FILE, file, size));
+    CHECK_EQUAL(2, Reload(networks));
+    CHECK_TEXT("Home", networks[0].ssid);
+    CHECK_TEXT("Office", networks[1].ssid);
+
+    // A changed priority, authenticated but not encrypted
+    file[STORE_HEADER + STORE_RECORD + STORE_RECORD_SSID] ^= 0x01;
+    file[STORE_HEADER + 2 * STORE_RECORD + 1] = 255;
+    CHECK(HostStorage::WriteFile(STORE_FILE, file, size));
+    CHECK_EQUAL(2, Reload(networks));
+    CHECK_TEXT("Cafe", networks[1].ssid);
+
+    // A record cut short by a power loss while appending: the next change compacts, as appends go to the end
+    file[STORE_HEADER + 2 * STORE_RECORD + 1] = 100;
+    CHECK(HostStorage::WriteFile(STORE_FILE, file, size - 20));
+    CHECK_EQUAL(2, Reload(networks));
+    CHECK(CredentialsHandler::AddNetwork("Office", "office-pass", 100) != 0);
+    CHECK_EQUAL(STORE_HEADER + 3 * STORE_RECORD, ReadStore(file, sizeof(file)));
+    CHECK_EQUAL(3, Reload(networks));
+
+    // Sequence numbers keep rising past records that failed: no nonce comes back
+    size = ReadStore(file, sizeof(file));
+    uint32_t last = 0;
+    for (long offset = STORE_HEADER; offset + STORE_RECORD <= size; offset += STORE_RECORD)
+    {
+        uint32_t sequence = 0;
+        for (int i = 0; i < 4; i++)
+            sequence |= (uint32_t)file[offset + 8 + i] << (8 * i);
+        CHECK(sequence > last);
+        last = sequence;
+    }
+
+    HostTest::Case("reconnect cache CRC");
+    WiFiReconnectCache cache = WiFiReconnectCache(), read;
+    strcpy(cache.ssid, "Home");
+    cache.localIP = IPAddress(192, 168, 1, 23);
+    cache.gateway = IPAddress(192, 168, 1, 1);
+    CHECK(CredentialsHandler::WriteReconnectCache(cache) != 0);
+    CredentialsHandler::Invalidate();
+    CHECK(CredentialsHandler::ReadReconnectCache(read));
+    CHECK_TEXT("Home", read.ssid);
+    CHECK(read.localIP == cache.localIP);
+
+    uint8_t reconnect[128];
+    long reconnectSize = HostStorage::ReadFile(RECONNECT_FILE, reconnect, sizeof(reconnect));
+    CHECK(reconnectSize > 0);
+    reconnect[reconnectSize - 10] ^= 0x80;                // inside the addresses
+    CHECK(HostStorage::WriteFile(RECONNECT_FILE, reconnect, reconnectSize));
+    CredentialsHandler::Invalidate();
+    CHECK(!CredentialsHandler::ReadReconnectCache(read));
+    reconnect[reconnectSize - 10] ^= 0x80;
+    reconnect[reconnectSize - 1] ^= 0x01;                 // the CRC itself
+    CHECK(HostStorage::WriteFile(RECONNECT_FILE, reconnect, reconnectSize));
+    CredentialsHandler::Invalidate();
+    CHECK(!CredentialsHandler::ReadReconnectCache(read));
+    CHECK(HostStorage::WriteFile(RECONNECT_FILE, reconnect, 20));
+    CredentialsHandler::Invalidate();
+    CHECK(!CredentialsHandler::ReadReconnectCache(read));
+
+    HostTest::Case("unknown version is not touched");
+    size = ReadStore(file, sizeof(file));
+    file[4] = 9;
+    CHECK(HostStorage::WriteFile(STORE_FILE, file, size));
+    CHECK_EQUAL(0, Reload(networks));
+    CHECK_EQUAL(size, ReadStore(file, sizeof(file)));
+    CHECK_EQUAL(9, file[4]);
+}
+
+static void TestEraseSalt()
+{
+    HostTest::Case("erase and provision again: new salt, no nonce reuse");
+    WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+    uint8_t first[1024], second[1024];
+    ResetStore();
+
+    CHECK(CredentialsHandler::AddNetwork("Home", "secretpass", 100) != 0);
+    CHECK_EQUAL(STORE_HEADER + STORE_RECORD, ReadStore(first, sizeof(first)));
+    CHECK_EQUAL(1, Reload(networks));
+    CHECK(CredentialsHandler::Erase_Credentials() != 0);
+    CHECK_EQUAL(0, Reload(networks));                     // a reset after the erase: the sequence starts over
+    CHECK(CredentialsHandler::AddNetwork("Home", "secretpass", 100) != 0);
+    CHECK_EQUAL(STORE_HEADER + STORE_RECORD, ReadStore(second, sizeof(second)));
+
+    // Same sequence in the nonce, but another salt and so another key
+    CHECK(memcmp(first + STORE_HEADER + 8, second + STORE_HEADER + 8, 4) == 0);
+    CHECK(memcmp(first + 6, second + 6, 2) != 0);
+    CHECK(memcmp(first + STORE_HEADER + STORE_RECORD_SSID, second + STORE_HEADER + STORE_RECORD_SSID, 4) != 0);
+    CHECK_EQUAL(1, Reload(networks));
+    CHECK_TEXT("secretpass", networks[0].password);
+
+    // The salt stays with the store through appends and compactions
+    for (int i = 0; i < CREDENTIALS_JOURNAL_RECORDS + 2; i++)
+        CHECK(CredentialsHandler::MarkConnected("Home", 1700000000 + i) != 0);
+    CHECK(ReadStore(first, sizeof(first)) > 0);
+    CHECK(memcmp(first + 6, second + 6, 2) == 0);
+    CHECK_EQUAL(1, Reload(networks));
+}
+
+// Version 1 record: flags, priority, lengths, lastSuccess, cyphered ssid (33) and password (64), CRC
+static void BuildRecordV1(uint8_t* record, const char* ssid, const char* password, uint8_t priority, uint32_t lastSuccess)
+{
+    memset(record, 0, 112);
+    record[0] = 0x01;
+    record[1] = priority;
+    record[2] = strlen(ssid);
+    record[3] = strlen(password);
+    for (int i = 0; i < 4; i++)
+        record[4 + i] = (uint8_t)(lastSuccess >> (8 * i));
+    SimpleCypher(ssid, record + 8, strlen(ssid));
+    SimpleCypher(password, record + 8 + CREDENTIALS_SSID_SIZE, strlen(password));
+    uint32_t crc = Crc32(record, 108);
+    for (int i = 0; i < 4; i++)
+        record[108 + i] = (uint8_t)(crc >> (8 * i));
+}
+
+static void TestMigration()
+{
+    HostTest::Case("version 1 store is migrated");
+    WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+    uint8_t file[4096];
+    ResetStore();
+
+    const uint8_t header[8] = { 'E', 'W', 'C', 'S', 1, 112, 0, 0 };
+    memcpy(file, header, sizeof(header));
+    BuildRecordV1(file + 8, "Home", "secretpass", 200, 1600000000);
+    BuildRecordV1(file + 8 + 112, "Broken", "lost-pass", 100, 0);
+    file[8 + 112 + 30] ^= 0x04;                           // CRC no longer matches
+    BuildRecordV1(file + 8 + 2 * 112, "Cafe", "espresso-42", 100, 1650000000);
+    CHECK(HostStorage::WriteFile(STORE_FILE, file, 8 + 3 * 112));
+
+    CHECK_EQUAL(2, CredentialsHandler::GetNetworks(networks));
+    CHECK_TEXT("Home", networks[0].ssid);
+    CHECK_TEXT("secretpass", networks[0].password);
+    CHECK_EQUAL(200, networks[0].priority);
+    CHECK_EQUAL(1600000000UL, (unsigned long)networks[0].lastSuccess);
+    CHECK_TEXT("Cafe", networks[1].ssid);
+
+    // Rewritten as version 2 and read as such
+    long size = ReadStore(file, sizeof(file));
+    CHECK_EQUAL(STORE_HEADER + 2 * STORE_RECORD, size);
+    CHECK_EQUAL(2, file[4]);
+    CHECK_EQUAL(2, Reload(networks));
+    CHECK_TEXT("espresso-42", networks[1].password);
+
+    HostTest::Case("text format of 1.4.2 is migrated");
+    ResetStore();
+    const char* ssid = "OldHome";
+    const char* password = "old-password";
+    size = 0;
+    SimpleCypher(ssid, file, strlen(ssid));
+    size += strlen(ssid);
+    file[size++] = 1;
+    SimpleCypher(password, file + size, strlen(password));
+    size += strlen(password);
+    file[size++] = 0;
+    CHECK(HostStorage::WriteFile(STORE_FILE, file, size));
+
+    CHECK_EQUAL(1, CredentialsHandler::GetNetworks(networks));
+    CHECK_TEXT("OldHome", networks[0].ssid);
+    CHECK_TEXT("old-password", networks[0].password);
+    CHECK_EQUAL(CREDENTIALS_DEFAULT_PRIORITY, networks[0].priority);
+    CHECK_EQUAL(STORE_HEADER + STORE_RECORD, ReadStore(file, sizeof(file)));
+    CHECK_EQUAL(1, Reload(networks));
+    CHECK_TEXT("old-password", networks[0].password);
+}
+
+int main()
+{
+    TestWriteCredentialsSizes();
+    TestRoundTrip();
+    TestCorruption();
+    TestEraseSalt();
+    TestMigration();
+    return HostTest::Result();
+}
@@ -0,0 +1,205 @@
+// DnsResponder on well formed, malformed and oversize queries, on its own and behind the portal's UDP socket.
+
+#include <EasyWiFi.h>
+#include <DnsResponder.h>
+#include <string.h>
+#include "HostTest.h"
+#include "HostPhone.h"
+
+static const IPAddress G_PortalIP(172, 217, 28, 1);
+
+static void PumpWiFi(void* context)
+{
+    ((EasyWiFi*)context)->Poll();
+    HostClock::Advance(1);
+}
+
+static bool RunUntil(EasyWiFi& wifi, EasyWiFiState state, unsigned long limit)
+{
+    for (unsigned long elapsed = 0; elapsed < limit; elapsed += 5)
+    {
+        if (wifi.Poll() == state)
+            return true;
+        HostClock::Advance(5);
+    }
+    return false;
+}
+
+static uint16_t Read16(const uint8_t* data)
+{
+    return (data[0] << 8) | data[1];
+}
+
+// Query for name of the given type, the type A query of HostPhone with QTYPE replaced
+static int BuildQuery(uint8_t* packet, int size, const char* name, uint16_t type)
+{
+    int length = HostPhone::BuildDnsQuery(0x1234, name, packet, size);
+    packet[length - 4] = type >> 8;
+    packet[length - 3] = type & 0xFF;
+    return length;
+}
+
+static void CheckError(const uint8_t* reply, size_t length, uint8_t rcode)
+{
+    CHECK_EQUAL(DNS_HEADER_SIZE, (long)length);
+    CHECK_EQUAL(0x1234, Read16(reply));
+    CHECK(reply[2] & 0x80);
+    CHECK_EQUAL(rcode, reply[3] & 0x0F);
+    CHECK_EQUAL(0, Read16(reply + 4));
+    CHECK_EQUAL(0, Read16(reply + 6));
+}
+
+static void TestWellFormed()
+{
+    HostTest::Case("A, ANY and other query types");
+    uint8_t packet[512];
+    int length = BuildQuery(packet, sizeof(packet), "connectivitycheck.gstatic.com", 1);
+    size_t reply = DnsResponder::BuildReply(packet, length, sizeof(packet), G_PortalIP);
+    CHECK_EQUAL(length + DNS_ANSWER_SIZE, (long)reply);
+    CHECK_EQUAL(0x1234, Read16(packet));
+    CHECK_EQUAL(0x85, packet[2]);                          // QR, AA, RD copied from the query
+    CHECK_EQUAL(0, packet[3] & 0x0F);
+    CHECK_EQUAL(1, Read16(packet + 4));
+    CHECK_EQUAL(1, Read16(packet + 6));
+    CHECK_EQUAL(0xC00C, Read16(packet + length));          // name points to the question
+    CHECK_EQUAL(DNS_ANSWER_TTL, Read16(packet + length + 8));
+    CHECK_EQUAL(4, Read16(packet + length + 10));
+    CHECK(memcmp(packet + length + 12, "\xAC\xD9\x1C\x01", 4) == 0);
+
+    length = BuildQuery(packet, sizeof(packet), "example.com", 255);
+    CHECK_EQUAL(length + DNS_ANSWER_SIZE, (long)DnsResponder::BuildReply(packet, length, sizeof(packet), G_PortalIP));
+
+    // AAAA and HTTPS: empty NOERROR answer, the phone falls back to A at once
+    length = BuildQuery(packet, sizeof(packet), "example.com", 28);
+    CHECK_EQUAL(length, (long)DnsResponder::BuildReply(packet, length, sizeof(packet), G_PortalIP));
+    CHECK_EQUAL(0, packet[3] & 0x0F);
+    CHECK_EQUAL(0, Read16(packet + 6));
+    length = BuildQuery(packet, sizeof(packet), "example.com", 65);
+    CHECK_EQUAL(length, (long)DnsResponder::BuildReply(packet, length, sizeof(packet), G_PortalIP));
+
+    // Class CH is not answered with the address
+    length = BuildQuery(packet, sizeof(packet), "version.bind", 1);
+    packet[length - 1] = 3;
+    CHECK_EQUAL(length, (long)DnsResponder::BuildReply(packet, length, sizeof(packet), G_PortalIP));
+
+    HostTest::Case("EDNS record of the query is dropped");
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    const uint8_t opt[11] = { 0, 0, 41, 0x10, 0, 0, 0, 0, 0, 0, 0 };
+    memcpy(packet + length, opt, sizeof(opt));
+    packet[11] = 1;
+    CHECK_EQUAL(length + DNS_ANSWER_SIZE, (long)DnsResponder::BuildReply(packet, length + sizeof(opt), sizeof(packet), G_PortalIP));
+    CHECK_EQUAL(0, Read16(packet + 10));
+}
+
+static void TestMalformed()
+{
+    HostTest::Case("malformed queries");
+    uint8_t packet[512];
+    int length;
+
+    // Shorter than a header, or a response: dropped
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    CHECK_EQUAL(0, (long)DnsResponder::BuildReply(packet, DNS_HEADER_SIZE - 1, sizeof(packet), G_PortalIP));
+    CHECK_EQUAL(0, (long)DnsResponder::BuildReply(packet, length, DNS_HEADER_SIZE - 1, G_PortalIP));
+    packet[2] |= 0x80;
+    CHECK_EQUAL(0, (long)DnsResponder::BuildReply(packet, length, sizeof(packet), G_PortalIP));
+
+    // Opcode other than a standard query
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    packet[2] |= 0x10;                                      // IQUERY
+    CheckError(packet, DnsResponder::BuildReply(packet, length, sizeof(packet), G_PortalIP), 4);
+
+    // No question, two questions
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    packet[5] = 0;
+    CheckError(packet, DnsResponder::BuildReply(packet, length, sizeof(packet), G_PortalIP), 1);
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    packet[5] = 2;
+    CheckError(packet, DnsResponder::BuildReply(packet, length, sizeof(packet), G_PortalIP), 1);
+
+    // Header only, question without QTYPE and QCLASS, QNAME without the root label
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    CheckError(packet, DnsResponder::BuildReply(packet, DNS_HEADER_SIZE, sizeof(packet), G_PortalIP), 1);
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    CheckError(packet, DnsResponder::BuildReply(packet, length - 4, sizeof(packet), G_PortalIP), 1);
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    CheckError(packet, DnsResponder::BuildReply(packet, length - 5, sizeof(packet), G_PortalIP), 1);
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    CheckError(packet, DnsResponder::BuildReply(packet, length - 2, sizeof(packet), G_PortalIP), 1);
+
+    // A label longer than the rest of the packet
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    packet[DNS_HEADER_SIZE] = 63;
+    CheckError(packet, DnsResponder::BuildReply(packet, length, sizeof(packet), G_PortalIP), 1);
+
+    // Compression pointer in the question, pointing at itself
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    packet[DNS_HEADER_SIZE] = 0xC0;
+    packet[DNS_HEADER_SIZE + 1] = DNS_HEADER_SIZE;
+    CheckError(packet, DnsResponder::BuildReply(packet, length, sizeof(packet), G_PortalIP), 1);
+
+    // QNAME longer than DNS_MAX_NAME_SIZE: five labels of 63
+    char name[5 * 64];
+    memset(name, 'a', sizeof(name));
+    for (int i = 1; i < 5; i++)
+        name[i * 64 - 1] = '.';
+    name[sizeof(name) - 1] = 0;
+    length = BuildQuery(packet, sizeof(packet), name, 1);
+    CheckError(packet, DnsResponder::BuildReply(packet, length, sizeof(packet), G_PortalIP), 1);
+
+    // No room for the answer in the buffer
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    CHECK_EQUAL(0, (long)DnsResponder::BuildReply(packet, length, length + DNS_ANSWER_SIZE - 1, G_PortalIP));
+}
+
+static void TestPortalSocket()
+{
+    HostTest::Case("oversize and malformed packets at the portal");
+    EasyWiFi wifi;
+    HostPhone phone(PumpWiFi, &wifi, 500);
+    uint8_t packet[4096];
+    uint8_t reply[512];
+    int length;
+
+    HostWiFi::AddNetwork("Home", "secretpass", -48);
+    wifi.Begin();
+    CHECK(RunUntil(wifi, EASYWIFI_PORTAL, 600000));
+    HostWiFi::SetStationJoined(true);
+    EasyWiFiDnsStats before = wifi.GetDnsStats();
+
+    // Larger than UDP_PACKET_SIZE: discarded unread and not answered, the next query is
+    memset(packet, 0, sizeof(packet));
+    length = BuildQuery(packet, sizeof(packet), "example.com", 1);
+    CHECK_EQUAL(-1, phone.DnsRaw(packet, UDP_PACKET_SIZE + 1, reply, sizeof(reply)));
+    CHECK_EQUAL(-1, phone.DnsRaw(packet, sizeof(packet), reply, sizeof(reply)));
+    CHECK_EQUAL(before.packetsOversize + 2, wifi.GetDnsStats().packetsOversize);
+    CHECK_EQUAL(length + DNS_ANSWER_SIZE, phone.DnsRaw(packet, length, reply, sizeof(reply)));
+    CHECK_EQUAL(0x1234, Read16(reply));
+
+    // Exactly UDP_PACKET_SIZE, the query followed by padding: answered
+    CHECK_EQUAL(length + DNS_ANSWER_SIZE, phone.DnsRaw(packet, UDP_PACKET_SIZE, reply, sizeof(reply)));
+
+    // Malformed: FORMERR, a response packet: dropped
+    packet[5] = 2;
+    CHECK_EQUAL(DNS_HEADER_SIZE, phone.DnsRaw(packet, length, reply, sizeof(reply)));
+    CHECK_EQUAL(1, reply[3] & 0x0F);
+    packet[5] = 1;
+    packet[2] |= 0x80;
+    CHECK_EQUAL(-1, phone.DnsRaw(packet, length, reply, sizeof(reply)));
+    CHECK_EQUAL(-1, phone.DnsRaw(packet, 3, reply, sizeof(reply)));
+    CHECK_EQUAL(before.packetsDropped + 2, wifi.GetDnsStats().packetsDropped);
+
+    // Still answering
+    length = phone.Dns("captive.apple.com", reply, sizeof(reply));
+    CHECK(length > DNS_ANSWER_SIZE);
+    if (length > DNS_ANSWER_SIZE)
+        CHECK(IPAddress(reply[length - 4], reply[length - 3], reply[length - 2], reply[length - 1]) == HostWiFi::GetStaticIP());
+}
+
+int main()
+{
+    TestWellFormed();
+    TestMalformed();
+    TestPortalSocket();
+    return HostTest::Result();
+}
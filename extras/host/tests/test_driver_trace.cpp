@@ -0,0 +1,124 @@
+// DriverTrace in a build with EASYWIFI_TRACE: a fixed connect from a stored network, timed by a virtual clock,
+// gives the same calls per site and the same PrintTo() table on every run.
+
+#include <EasyWiFi.h>
+#include <HostSim.h>
+#include <string>
+#include "HostTest.h"
+
+#define TRACE_CALL_TIME 25               // us every driver call takes on the trace clock
+
+static unsigned long G_TraceTicks = 0;
+
+// The virtual clock of the host, plus TRACE_CALL_TIME between the start and the end of each call
+static unsigned long TraceClock()
+{
+    G_TraceTicks += TRACE_CALL_TIME;
+    return (unsigned long)HostClock::GetMicros() + G_TraceTicks;
+}
+
+// Collects what is printed
+class TextPrint : public Print
+{
+public:
+    size_t write(uint8_t c)
+    {
+        text += (char)c;
+        return 1;
+    }
+
+    std::string text;
+};
+
+static bool RunUntil(EasyWiFi& wifi, EasyWiFiState state, unsigned long limit)
+{
+    for (unsigned long elapsed = 0; elapsed < limit; elapsed += 5)
+    {
+        if (wifi.Poll() == state)
+            return true;
+        HostClock::Advance(5);
+    }
+    return false;
+}
+
+// Begin() with one stored network in range, up to CONNECTED
+static void RunScenario(EasyWiFi& wifi)
+{
+    HostStorage::Clear();
+    CredentialsHandler::Invalidate();
+    HostWiFi::Reset();
+    HostWiFi::AddNetwork("Home", "secretpass", -48);
+    HostWiFi::SetTime(1700000000);
+    CHECK(CredentialsHandler::AddNetwork("Home", "secretpass", 100) != 0);
+    CHECK(CredentialsHandler::AddNetwork("Cafe", "espresso-42", 50) != 0);
+    CredentialsHandler::Invalidate();
+
+    G_TraceTicks = 0;
+    DriverTrace::SetClock(TraceClock);
+    DriverTrace::Reset();
+    wifi.Begin();
+    CHECK(RunUntil(wifi, EASYWIFI_CONNECTED, 600000));
+    DriverTrace::SetClock(NULL);
+}
+
+static void TestCounts()
+{
+    HostTest::Case("calls per site of a connect");
+    EasyWiFi wifi;
+    RunScenario(wifi);
+    CHECK_EQUAL(16UL, DriverTrace::Get(DRIVER_WIFI_STATUS).calls);
+    CHECK_EQUAL(1UL, DriverTrace::Get(DRIVER_WIFI_BEGIN).calls);
+    CHECK_EQUAL(1UL, DriverTrace::Get(DRIVER_WIFI_SCAN).calls);
+    CHECK_EQUAL(2UL, DriverTrace::Get(DRIVER_WIFI_SCAN_ENTRY).calls);
+    CHECK_EQUAL(8UL, DriverTrace::Get(DRIVER_STORAGE_OPEN).calls);        // 4 open() and 4 close()
+    CHECK_EQUAL(3UL, DriverTrace::Get(DRIVER_STORAGE_EXISTS).calls);
+    CHECK_EQUAL(6UL, DriverTrace::Get(DRIVER_STORAGE_READ).calls);
+    CHECK_EQUAL(2UL, DriverTrace::Get(DRIVER_STORAGE_WRITE).calls);
+    CHECK_EQUAL(0UL, DriverTrace::Get(DRIVER_STORAGE_ERASE).calls);
+    CHECK_EQUAL(0UL, DriverTrace::Get(DRIVER_WIFI_BEGIN_AP).calls);
+
+    // The scan advances the virtual clock by HOST_WIFI_SCAN_TIME, every other call takes TRACE_CALL_TIME
+    const DriverTraceStats& scan = DriverTrace::Get(DRIVER_WIFI_SCAN);
+    CHECK_EQUAL(HOST_WIFI_SCAN_TIME * 1000UL + TRACE_CALL_TIME, scan.maxTime);
+    CHECK_EQUAL(1, scan.latency[DRIVER_TRACE_BUCKETS - 1]);
+    CHECK_EQUAL(16, DriverTrace::Get(DRIVER_WIFI_STATUS).latency[1]);
+    CHECK_EQUAL(16UL * TRACE_CALL_TIME, DriverTrace::Get(DRIVER_WIFI_STATUS).totalTime);
+}
+
+static void TestPrintTo()
+{
+    HostTest::Case("PrintTo() of a connect");
+    const char* expected =
+        "site calls total_us mean_us max_us | <16us <32us ... >=262ms\r\n"
+        "wifi_status 16 400 25 25 | 0 16 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r\n"
+        "wifi_rssi 1 25 25 25 | 0 1 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r\n"
+        "wifi_begin 1 25 25 25 | 0 1 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r\n"
+        "wifi_config 1 25 25 25 | 0 1 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r\n"
+        "wifi_info 10 250 25 25 | 0 10 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r\n"
+        "wifi_scan 1 2000025 2000025 2000025 | 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 1\r\n"
+        "wifi_scan_entry 2 50 25 25 | 0 2 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r\n"
+        "led 12 300 25 25 | 0 12 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r\n"
+        "storage_open 8 200 25 25 | 0 8 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r\n"
+        "storage_exists 3 75 25 25 | 0 3 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r\n"
+        "storage_read 6 150 25 25 | 0 6 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r\n"
+        "storage_write 2 50 25 25 | 0 2 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r\n";
+    EasyWiFi first, second;
+    TextPrint firstTable, secondTable;
+
+    RunScenario(first);
+    DriverTrace::PrintTo(firstTable);
+    CHECK_TEXT(expected, firstTable.text.c_str());
+
+    // Same scenario once more, past the scan cache: the same table
+    HostClock::Advance(SCAN_CACHE_TTL + 1);
+    RunScenario(second);
+    DriverTrace::PrintTo(secondTable);
+    CHECK_TEXT(expected, secondTable.text.c_str());
+}
+
+int main()
+{
+    TestCounts();
+    TestPrintTo();
+    return HostTest::Result();
+}
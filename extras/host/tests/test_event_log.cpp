@@ -0,0 +1,106 @@
+// EventLog records drained as "~EL" lines and decoded by extras/tools/decode_log.py: every field kind of the
+// format comments, text arguments, library enums and a sequence gap come back as the expected text.
+// Built when CMake finds Python, which passes the interpreter and the decoder path.
+
+#include <EasyWiFi.h>
+#include <HostSim.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include "HostTest.h"
+
+// Collects what is printed
+class TextPrint : public Print
+{
+public:
+    size_t write(uint8_t c)
+    {
+        text += (char)c;
+        return 1;
+    }
+
+    std::string text;
+};
+
+// decode_log.py --only over capture, its output
+static std::string Decode(const std::string& capture)
+{
+    char path[] = "/tmp/easywifi_eventlog_XXXXXX";
+    int fd = mkstemp(path);
+    if (!CHECK(fd >= 0))
+        return "";
+    CHECK_EQUAL((long)capture.size(), (long)write(fd, capture.data(), capture.size()));
+    close(fd);
+
+    std::string command = std::string(HOST_PYTHON) + " " + HOST_DECODE_LOG + " --only " + path;
+    std::string output;
+    FILE* decoder = popen(command.c_str(), "r");
+    if (CHECK(decoder != NULL))
+    {
+        char buffer[256];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), decoder)) > 0)
+            output.append(buffer, n);
+        CHECK_EQUAL(0, pclose(decoder));
+    }
+    unlink(path);
+    return output;
+}
+
+static void TestFields()
+{
+    HostTest::Case("every field kind decodes");
+    TextPrint capture;
+    EventLog::SetLevel(LOG_LEVEL_DEBUG);
+    EventLog::Clear();
+    HostClock::Set(1234);
+    EventLog::Write(LOG_LEVEL_INFO, EVENT_STATE, EASYWIFI_CONNECTED, 0);
+    HostClock::Set(1500);
+    EventLog::WriteText(LOG_LEVEL_INFO, EVENT_CONNECT_ATTEMPT, "HomeNetwork");
+    EventLog::Write(LOG_LEVEL_WARN, EVENT_WIFI_STATUS, (uint32_t)IPAddress(192, 168, 1, 1), -67);
+    HostClock::Set(61000);
+    EventLog::Write(LOG_LEVEL_INFO, EVENT_CONNECTED, 4000000000UL, (uint32_t)IPAddress(10, 0, 0, 23));
+    EventLog::Write(LOG_LEVEL_DEBUG, EVENT_RESPONSE, EASYWIFI_ROUTE_METRICS, 512);
+    EventLog::Write(LOG_LEVEL_ERROR, EVENT_FAST_RECONNECT_FAILED, 0, 0);
+    CHECK_EQUAL(6, (long)EventLog::Drain(capture));
+
+    // Lines that are no records are dropped by --only
+    std::string text = "boot\r\n" + capture.text + "noise ~EL 12\r\n";
+    CHECK_TEXT("     1.234 INFO  State EASYWIFI_CONNECTED\n"
+               "     1.500 INFO  Connecting to HomeNetw\n"
+               "     1.500 WARN  Gateway 192.168.1.1, RSSI -67 dBm\n"
+               "    61.000 INFO  Connected after 4000000000 ms as 10.0.0.23\n"
+               "    61.000 DEBUG EASYWIFI_ROUTE_METRICS answered with 512 bytes\n"
+               "    61.000 ERROR Fast reconnect failed, using DHCP\n", Decode(text).c_str());
+}
+
+static void TestLostRecords()
+{
+    HostTest::Case("overwritten records show as a gap");
+    TextPrint first, second;
+    std::string expected;
+    EventLog::Clear();
+    HostClock::Set(2000);
+    EventLog::Write(LOG_LEVEL_INFO, EVENT_SCAN_ENTRY, 0, -40);
+    CHECK_EQUAL(1, (long)EventLog::Drain(first));
+    expected = "     2.000 INFO  Network 0: -40 dBm\n... 2 records lost\n";
+    for (int i = 1; i <= EVENT_LOG_SIZE + 2; i++)
+        EventLog::Write(LOG_LEVEL_INFO, EVENT_SCAN_ENTRY, i, -40 - i);
+    CHECK_EQUAL(2UL, EventLog::GetOverrun());
+    CHECK_EQUAL(EVENT_LOG_SIZE, (long)EventLog::Drain(second));
+    for (int i = 3; i <= EVENT_LOG_SIZE + 2; i++)
+    {
+        char line[64];
+        snprintf(line, sizeof(line), "     2.000 INFO  Network %d: %d dBm\n", i, -40 - i);
+        expected += line;
+    }
+    CHECK_TEXT(expected.c_str(), Decode(first.text + second.text).c_str());
+}
+
+int main()
+{
+    TestFields();
+    TestLostRecords();
+    return HostTest::Result();
+}
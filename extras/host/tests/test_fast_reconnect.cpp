@@ -0,0 +1,133 @@
+// Fast reconnect through /fs/WifiReconnect: a valid cache connects with the cached lease and no scan. A cache
+// failing its CRC, a truncated file or another access point behind the SSID fall back to the scan and DHCP,
+// and the next connect writes a cache that works again.
+
+#include <EasyWiFi.h>
+#include <HostSim.h>
+#include "HostTest.h"
+
+#define RECONNECT_FILE "/fs/WifiReconnect"
+#define RECONNECT_SIZE 65                // Version 1: 61 bytes of data and the CRC32
+
+static bool RunUntil(EasyWiFi& wifi, EasyWiFiState state, unsigned long limit)
+{
+    for (unsigned long elapsed = 0; elapsed < limit; elapsed += 5)
+    {
+        if (wifi.Poll() == state)
+            return true;
+        HostClock::Advance(5);
+    }
+    return false;
+}
+
+// Power cycle of the board: the module forgets its configuration, the store is read from flash again
+static void Reboot(const uint8_t* homeBssid = NULL, uint8_t homeChannel = 6)
+{
+    HostWiFi::Reset();
+    HostWiFi::AddNetwork("Home", "secretpass", -48, homeChannel);
+    HostWiFi::AddNetwork("Cafe", "espresso-42", -67);
+    if (homeBssid != NULL)
+        HostWiFi::SetBssid("Home", homeBssid);
+    HostWiFi::SetTime(1700000000);
+    CredentialsHandler::Invalidate();
+}
+
+// Begin() up to CONNECTED, true if it took the fast path. Scans of the attempt in scans
+static bool Connect(unsigned long& scans)
+{
+    EasyWiFi wifi;
+    unsigned long before = HostWiFi::GetCounters().scans;
+    wifi.UseFastReconnect(true);
+    wifi.Begin();
+    CHECK(RunUntil(wifi, EASYWIFI_CONNECTED, 600000));
+    CHECK_TEXT("Home", HostWiFi::GetConnectedSsid());
+    scans = HostWiFi::GetCounters().scans - before;
+    return wifi.IsFastReconnect();
+}
+
+static long ReadCache(uint8_t* buffer)
+{
+    return HostStorage::ReadFile(RECONNECT_FILE, buffer, RECONNECT_SIZE + 16);
+}
+
+static void TestCacheHit()
+{
+    HostTest::Case("a valid cache skips the scan");
+    unsigned long scans;
+    HostStorage::Clear();
+    Reboot();
+    CHECK(CredentialsHandler::AddNetwork("Home", "secretpass", 200) != 0);
+    CHECK(CredentialsHandler::AddNetwork("Cafe", "espresso-42", 100) != 0);
+    CHECK(!Connect(scans));                                         // no cache yet: scan and DHCP
+    CHECK_EQUAL(1UL, scans);
+    uint8_t file[RECONNECT_SIZE + 16];
+    CHECK_EQUAL(RECONNECT_SIZE, ReadCache(file));
+
+    Reboot();
+    unsigned long configs = HostWiFi::GetCounters().configs;
+    CHECK(Connect(scans));
+    CHECK_EQUAL(0UL, scans);
+    CHECK_EQUAL(1UL, HostWiFi::GetCounters().configs - configs);   // the cached lease, set statically
+    CHECK(HostWiFi::GetStaticIP() != IPAddress(0, 0, 0, 0));
+
+    HostTest::Case("the same access point on another channel keeps the fast path");
+    Reboot(NULL, 11);
+    CHECK(Connect(scans));
+    CHECK_EQUAL(0UL, scans);
+}
+
+static void TestDamagedCache()
+{
+    HostTest::Case("a cache failing its CRC falls back to the scan");
+    uint8_t file[RECONNECT_SIZE + 16];
+    unsigned long scans;
+    CHECK_EQUAL(RECONNECT_SIZE, ReadCache(file));
+    file[8] ^= 0x01;                                                // a bit of the ssid
+    CHECK(HostStorage::WriteFile(RECONNECT_FILE, file, RECONNECT_SIZE));
+    Reboot();
+    CHECK(!Connect(scans));
+    CHECK_EQUAL(1UL, scans);
+    CHECK(HostWiFi::GetStaticIP() == IPAddress(0, 0, 0, 0));        // DHCP, nothing configured
+    Reboot();
+    CHECK(Connect(scans));                                          // rewritten by the connect
+    CHECK_EQUAL(0UL, scans);
+
+    HostTest::Case("a truncated cache falls back to the scan");
+    CHECK_EQUAL(RECONNECT_SIZE, ReadCache(file));
+    CHECK(HostStorage::WriteFile(RECONNECT_FILE, file, RECONNECT_SIZE - 10));
+    Reboot();
+    CHECK(!Connect(scans));
+    CHECK_EQUAL(1UL, scans);
+    CHECK_EQUAL(RECONNECT_SIZE, ReadCache(file));
+    Reboot();
+    CHECK(Connect(scans));
+}
+
+static void TestOtherAccessPoint()
+{
+    HostTest::Case("another access point falls back to DHCP");
+    const uint8_t newRouter[6] = { 0x02, 0x11, 0x22, 0x33, 0x44, 0x55 };
+    uint8_t file[RECONNECT_SIZE + 16];
+    unsigned long scans;
+    Reboot(newRouter);
+    unsigned long begins = HostWiFi::GetCounters().begins;
+    CHECK(!Connect(scans));
+    CHECK_EQUAL(1UL, scans);
+    CHECK_EQUAL(2UL, HostWiFi::GetCounters().begins - begins);     // the fast attempt, then the DHCP one
+    CHECK(HostWiFi::GetStaticIP() == IPAddress(0, 0, 0, 0));        // the cached lease was dropped
+
+    // The cache now names the new access point, the next start is fast again
+    CHECK_EQUAL(RECONNECT_SIZE, ReadCache(file));
+    CHECK(memcmp(file + 6 + CREDENTIALS_SSID_SIZE, newRouter, 6) == 0);
+    Reboot(newRouter);
+    CHECK(Connect(scans));
+    CHECK_EQUAL(0UL, scans);
+}
+
+int main()
+{
+    TestCacheHit();
+    TestDamagedCache();
+    TestOtherAccessPoint();
+    return HostTest::Result();
+}
@@ -0,0 +1,51 @@
+// HttpRequestParser: Accept-Encoding with quality values.
+
+#include <HttpRequestParser.h>
+#include <string>
+#include "HostTest.h"
+
+// Parse a GET with the given Accept-Encoding header, fed in one chunk
+static bool AcceptsGzip(const char* acceptEncoding)
+{
+    HttpRequestParser parser;
+    std::string request = std::string("GET / HTTP/1.1\r\nHost: portal\r\nAccept-Encoding: ") + acceptEncoding + "\r\n\r\n";
+    parser.Feed((const uint8_t*)request.data(), request.size());
+    CHECK(parser.IsComplete());
+    return parser.AcceptsGzip();
+}
+
+static void TestAcceptEncoding()
+{
+    HostTest::Case("Accept-Encoding quality values");
+    CHECK(AcceptsGzip("gzip"));
+    CHECK(AcceptsGzip("GZIP"));
+    CHECK(AcceptsGzip("gzip, deflate, br"));
+    CHECK(AcceptsGzip("br,gzip"));
+    CHECK(AcceptsGzip("gzip;q=0.5"));
+    CHECK(AcceptsGzip("gzip;q=1.0"));
+    CHECK(AcceptsGzip("gzip;q=0.001"));
+    CHECK(AcceptsGzip("gzip;q=0.05"));
+    CHECK(AcceptsGzip("deflate;q=0, gzip"));
+    CHECK(AcceptsGzip("gzip ; q = 0.8"));
+
+    CHECK(!AcceptsGzip("gzip;q=0"));
+    CHECK(!AcceptsGzip("gzip; q=0"));
+    CHECK(!AcceptsGzip("gzip ;q=0"));
+    CHECK(!AcceptsGzip("gzip;q=0."));
+    CHECK(!AcceptsGzip("gzip;q=0.0"));
+    CHECK(!AcceptsGzip("gzip;q=0.00"));
+    CHECK(!AcceptsGzip("gzip;q=0.000"));
+    CHECK(!AcceptsGzip("gzip;Q=0"));
+    CHECK(!AcceptsGzip("deflate, gzip;q=0"));
+    CHECK(!AcceptsGzip("gzip;q=0, deflate"));
+    CHECK(!AcceptsGzip("gzip;level=1;q=0"));
+    CHECK(!AcceptsGzip("identity"));
+    CHECK(!AcceptsGzip("x-gzip-like"));
+    CHECK(!AcceptsGzip("deflate;note=gzip"));
+}
+
+int main()
+{
+    TestAcceptEncoding();
+    return HostTest::Result();
+}
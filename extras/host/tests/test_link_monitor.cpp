@@ -0,0 +1,164 @@
+// LinkMonitor fed through Sample(): the smoothed RSSI converging, the hysteresis band between the degraded
+// and recovered levels, and NeedsReconnect() only for a link that stays degraded or lost.
+
+#include <LinkMonitor.h>
+#include <WiFiNINA.h>
+#include "HostTest.h"
+
+// count samples of rssi, one per LINK_POLL_INTERVAL from now on, the time after the last one is returned
+static unsigned long Feed(LinkMonitor& monitor, unsigned long now, int count, int32_t rssi)
+{
+    for (int i = 0; i < count; i++)
+    {
+        monitor.Sample(now, WL_CONNECTED, rssi);
+        now += LINK_POLL_INTERVAL;
+    }
+    return now;
+}
+
+static void TestSmoothing()
+{
+    HostTest::Case("smoothed RSSI converges without overshooting");
+    LinkMonitor monitor;
+    monitor.Reset(0);
+    CHECK_EQUAL(0, monitor.GetRssi());
+    monitor.Sample(0, WL_CONNECTED, -50);
+    CHECK_EQUAL(-50, monitor.GetRssi());                   // the first sample is taken as it is
+
+    int previous = monitor.GetRssi();
+    int steps = 0;
+    for (unsigned long now = 1000; monitor.GetRssi() != -70 && steps < 100; now += 1000, steps++)
+    {
+        monitor.Sample(now, WL_CONNECTED, -70);
+        CHECK(monitor.GetRssi() <= previous);
+        CHECK(monitor.GetRssi() >= -70);
+        previous = monitor.GetRssi();
+    }
+    CHECK_EQUAL(-70, monitor.GetRssi());
+    CHECK(steps >= 5 && steps <= 20);                      // 25 % per sample: a few samples, not one
+    CHECK_EQUAL(-70, monitor.GetLastRssi());
+
+    // A sample of 0 is no value and leaves the average alone
+    monitor.Sample(100000, WL_CONNECTED, 0);
+    CHECK_EQUAL(-70, monitor.GetRssi());
+    CHECK_EQUAL(-70, monitor.GetLastRssi());
+
+    HostTest::Case("smoothing of 100 % follows every sample");
+    monitor.SetSmoothing(100);
+    monitor.Sample(101000, WL_CONNECTED, -40);
+    CHECK_EQUAL(-40, monitor.GetRssi());
+}
+
+static void TestHysteresis()
+{
+    HostTest::Case("degraded at the lower level, good again at the upper one");
+    LinkMonitor monitor;
+    monitor.SetSmoothing(100);
+    monitor.Reset(0);
+    unsigned long now = Feed(monitor, 0, 1, LINK_RSSI_DEGRADED + 1);
+    CHECK(!monitor.IsDegraded());
+    now = Feed(monitor, now, 1, LINK_RSSI_DEGRADED);
+    CHECK(monitor.IsDegraded());
+    now = Feed(monitor, now, 1, LINK_RSSI_RECOVERED - 1);
+    CHECK(monitor.IsDegraded());
+    now = Feed(monitor, now, 1, LINK_RSSI_RECOVERED);
+    CHECK(!monitor.IsDegraded());
+    now = Feed(monitor, now, 1, LINK_RSSI_DEGRADED + 1);
+    CHECK(!monitor.IsDegraded());
+
+    HostTest::Case("no flapping at a boundary");
+    int changes = 0;
+    bool degraded = monitor.IsDegraded();
+    for (int i = 0; i < 100; i++)
+    {
+        now = Feed(monitor, now, 1, (i % 2 == 0) ? LINK_RSSI_DEGRADED : LINK_RSSI_DEGRADED + 1);
+        if (monitor.IsDegraded() != degraded)
+            changes++;
+        degraded = monitor.IsDegraded();
+    }
+    CHECK_EQUAL(1, changes);
+    for (int i = 0; i < 100; i++)
+    {
+        now = Feed(monitor, now, 1, (i % 2 == 0) ? LINK_RSSI_RECOVERED : LINK_RSSI_RECOVERED - 1);
+        if (monitor.IsDegraded() != degraded)
+            changes++;
+        degraded = monitor.IsDegraded();
+    }
+    CHECK_EQUAL(2, changes);
+
+    HostTest::Case("noise around the degraded level with smoothing");
+    LinkMonitor smoothed;
+    smoothed.Reset(0);
+    now = Feed(smoothed, 0, 1, -60);
+    changes = 0;
+    degraded = smoothed.IsDegraded();
+    for (int i = 0; i < 200; i++)
+    {
+        now = Feed(smoothed, now, 1, LINK_RSSI_DEGRADED + ((i % 3) - 1) * 4);
+        if (smoothed.IsDegraded() != degraded)
+            changes++;
+        degraded = smoothed.IsDegraded();
+    }
+    CHECK(changes <= 1);
+}
+
+static void TestReconnect()
+{
+    HostTest::Case("a single dip does not reconnect");
+    LinkMonitor monitor;
+    monitor.Reset(0);
+    unsigned long now = Feed(monitor, 0, 5, -55);
+    now = Feed(monitor, now, 1, -95);
+    CHECK(!monitor.IsDegraded());                          // smoothed, one sample does not reach the level
+    now = Feed(monitor, now, 2 * LINK_DEGRADED_TIME / LINK_POLL_INTERVAL, -55);
+    CHECK(!monitor.NeedsReconnect());
+
+    monitor.SetSmoothing(100);
+    now = Feed(monitor, now, 1, -95);
+    CHECK(monitor.IsDegraded());
+    now = Feed(monitor, now, 1, -55);
+    CHECK(!monitor.IsDegraded());
+    now = Feed(monitor, now, 2 * LINK_DEGRADED_TIME / LINK_POLL_INTERVAL, -55);
+    CHECK(!monitor.NeedsReconnect());
+
+    HostTest::Case("sustained degradation reconnects after LINK_DEGRADED_TIME");
+    unsigned long since = now;
+    monitor.Sample(since, WL_CONNECTED, -92);
+    CHECK(monitor.IsDegraded());
+    monitor.Sample(since + LINK_DEGRADED_TIME - 1, WL_CONNECTED, -92);
+    CHECK(!monitor.NeedsReconnect());
+    monitor.Sample(since + LINK_DEGRADED_TIME, WL_CONNECTED, -92);
+    CHECK(monitor.NeedsReconnect());
+    monitor.Sample(since + LINK_DEGRADED_TIME + 1000, WL_CONNECTED, -60);
+    CHECK(!monitor.NeedsReconnect());
+
+    HostTest::Case("a lost link reconnects after LINK_LOST_TIME, a short loss does not");
+    since = since + LINK_DEGRADED_TIME + 2000;
+    monitor.Sample(since, WL_CONNECTION_LOST, 0);
+    CHECK(!monitor.IsConnected());
+    monitor.Sample(since + LINK_LOST_TIME - 1, WL_CONNECTION_LOST, 0);
+    CHECK(!monitor.NeedsReconnect());
+    monitor.Sample(since + LINK_LOST_TIME, WL_CONNECTED, -60);
+    CHECK(monitor.IsConnected());
+    CHECK(!monitor.NeedsReconnect());
+    since += 2 * LINK_LOST_TIME;
+    monitor.Sample(since, WL_DISCONNECTED, 0);
+    monitor.Sample(since + LINK_LOST_TIME, WL_DISCONNECTED, 0);
+    CHECK(monitor.NeedsReconnect());
+    CHECK_EQUAL(WL_DISCONNECTED, monitor.GetStatus());
+
+    HostTest::Case("Reset() starts a fresh connection");
+    monitor.Reset(since + LINK_LOST_TIME);
+    CHECK(monitor.IsConnected());
+    CHECK(!monitor.IsDegraded());
+    CHECK(!monitor.NeedsReconnect());
+    CHECK_EQUAL(0, monitor.GetRssi());
+}
+
+int main()
+{
+    TestSmoothing();
+    TestHysteresis();
+    TestReconnect();
+    return HostTest::Result();
+}
@@ -0,0 +1,109 @@
+// POST /connect and POST /api/credentials reject what cannot be stored or tried: an empty network,
+// an SSID or password cut by the form buffers, a WPA password shorter than 8 characters.
+// The answer is a 400 and the portal stays open for another try.
+
+#include <EasyWiFi.h>
+#include <string>
+#include "HostTest.h"
+#include "HostPhone.h"
+
+static void PumpWiFi(void* context)
+{
+    ((EasyWiFi*)context)->Poll();
+    HostClock::Advance(1);
+}
+
+static bool RunUntil(EasyWiFi& wifi, EasyWiFiState state, unsigned long limit)
+{
+    for (unsigned long elapsed = 0; elapsed < limit; elapsed += 5)
+    {
+        if (wifi.Poll() == state)
+            return true;
+        HostClock::Advance(5);
+    }
+    return false;
+}
+
+// Post form to path and expect a 400 with error, the portal still open afterwards
+static void CheckRejected(EasyWiFi& wifi, const char* path, const std::string& form, const char* error)
+{
+    HostPhone phone(PumpWiFi, &wifi);
+    HostHttpResponse response;
+    CHECK(phone.Post(path, form, response));
+    CHECK_EQUAL(400, response.status);
+    CHECK(response.body.find(error) != std::string::npos);
+    for (int i = 0; i < 100; i++)
+        PumpWiFi(&wifi);
+    CHECK_EQUAL(EASYWIFI_PORTAL, wifi.GetState());
+    CHECK_EQUAL(EASYWIFI_PROVISION_NONE, wifi.GetProvisionResult());
+}
+
+static void TestRejectedForms()
+{
+    HostTest::Case("rejected credentials keep the portal open");
+    EasyWiFi wifi;
+    std::string longSsid(CREDENTIALS_SSID_SIZE, 's');          // 33 characters, one more than an SSID holds
+    std::string longPassword(CREDENTIALS_PASS_SIZE, 'p');      // 64 characters
+
+    HostWiFi::AddNetwork("Home", "secretpass", -48);
+    wifi.Begin();
+    CHECK(RunUntil(wifi, EASYWIFI_PORTAL, 600000));
+    HostWiFi::SetStationJoined(true);
+
+    CheckRejected(wifi, "/connect", "password=secretpass", "invalid ssid");
+    CheckRejected(wifi, "/connect", "network=&password=secretpass", "invalid ssid");
+    CheckRejected(wifi, "/connect", "network=" + longSsid + "&password=secretpass", "invalid ssid");
+    CheckRejected(wifi, "/connect", "network=Home&password=" + longPassword, "invalid password");
+    CheckRejected(wifi, "/connect", "network=Home&password=short", "invalid password");
+    CheckRejected(wifi, "/api/credentials", "ssid=" + longSsid + "&password=secretpass", "invalid ssid");
+    CheckRejected(wifi, "/api/credentials", "ssid=Home&password=" + longPassword, "invalid password");
+
+    // 32 and 63 characters are the longest that fit
+    HostPhone phone(PumpWiFi, &wifi);
+    HostHttpResponse response;
+    std::string ssid(CREDENTIALS_SSID_SIZE - 1, 's');
+    std::string password(CREDENTIALS_PASS_SIZE - 1, 'p');
+    HostWiFi::AddNetwork(ssid.c_str(), password.c_str(), -60);
+    CHECK(phone.Post("/connect", "network=" + ssid + "&password=" + password, response));
+    CHECK_EQUAL(200, response.status);
+    CHECK(RunUntil(wifi, EASYWIFI_CONNECTED, 60000));
+    CHECK_TEXT(ssid.c_str(), HostWiFi::GetConnectedSsid());
+}
+
+static void TestHtmlEscaped()
+{
+    HostTest::Case("network names are HTML escaped");
+    HostWiFi::Reset();
+    HostStorage::Clear();
+    CredentialsHandler::Invalidate();
+    EasyWiFi wifi;
+    HostPhone phone(PumpWiFi, &wifi);
+    HostHttpResponse response;
+    const char* ssid = "\"><script>x('&')</script>";
+
+    HostWiFi::AddNetwork(ssid, "secretpass", -48);
+    HostClock::Advance(SCAN_CACHE_TTL + 1);               // the scan of the first case is not reused
+    wifi.Begin();
+    CHECK(RunUntil(wifi, EASYWIFI_PORTAL, 600000));
+    HostWiFi::SetStationJoined(true);
+
+    CHECK(phone.Get("/list_networks", response));
+    CHECK_EQUAL(200, response.status);
+    CHECK(response.body.find("<script>") == std::string::npos);
+    CHECK(response.body.find("value=\"1. &quot;&gt;&lt;script&gt;x(&#39;&amp;&#39;)&lt;/script&gt;\"") != std::string::npos);
+    CHECK(response.body.find("network=%22%3E%3Cscript%3Ex%28%27%26%27%29%3C%2Fscript%3E\"") != std::string::npos);
+
+    CHECK(phone.Post("/connect", "network=%22%3E%3Cscript%3Ex%28%27%26%27%29%3C%2Fscript%3E&password=secretpass", response));
+    CHECK_EQUAL(200, response.status);
+    CHECK(response.body.find("<script>") == std::string::npos);
+    CHECK(response.body.find("&quot;&gt;&lt;script&gt;") != std::string::npos);
+    CHECK(RunUntil(wifi, EASYWIFI_CONNECTED, 60000));
+    CHECK_TEXT(ssid, HostWiFi::GetConnectedSsid());
+}
+
+int main()
+{
+    TestRejectedForms();
+    TestHtmlEscaped();
+    return HostTest::Result();
+}
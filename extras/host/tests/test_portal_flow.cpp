@@ -0,0 +1,93 @@
+// Begin() with nothing stored: the hardcoded network is not in range, the portal opens, a phone joins,
+// resolves a name, walks the captive portal pages and posts credentials, which are verified and stored.
+
+#include <EasyWiFi.h>
+#include "HostTest.h"
+#include "HostPhone.h"
+
+static void PumpWiFi(void* context)
+{
+    ((EasyWiFi*)context)->Poll();
+    HostClock::Advance(1);
+}
+
+// Poll with the virtual clock running until state is reached, false after limit ms
+static bool RunUntil(EasyWiFi& wifi, EasyWiFiState state, unsigned long limit)
+{
+    for (unsigned long elapsed = 0; elapsed < limit; elapsed += 5)
+    {
+        if (wifi.Poll() == state)
+            return true;
+        HostClock::Advance(5);
+    }
+    return false;
+}
+
+static void TestPortalFlow()
+{
+    HostTest::Case("portal flow");
+    EasyWiFi wifi;
+    HostPhone phone(PumpWiFi, &wifi);
+    HostHttpResponse response;
+    uint8_t reply[512];
+
+    HostWiFi::AddNetwork("Home", "secretpass", -48);
+    HostWiFi::AddNetwork("Neighbour", "other-pass", -75, 11);
+    wifi.Begin();
+    CHECK(RunUntil(wifi, EASYWIFI_PORTAL, 600000));
+    CHECK(HostWiFi::IsAccessPoint());
+    CHECK_TEXT("EasyWiFi_AP", HostWiFi::GetAccessPointName());
+    CHECK_EQUAL(2, wifi.GetScanCount());
+    CHECK_TEXT("Home", wifi.GetScanResult(0)->ssid);
+    CHECK(wifi.GetPortalArena().IsActive());
+
+    HostWiFi::SetStationJoined(true);
+    int length = phone.Dns("connectivitycheck.gstatic.com", reply, sizeof(reply));
+    CHECK(length > 16);
+    if (length > 16)
+    {
+        CHECK_EQUAL(0x80, reply[2] & 0x80);               // a response
+        CHECK_EQUAL(0, reply[3] & 0x0F);                  // no error
+        CHECK_EQUAL(1, (reply[6] << 8) | reply[7]);       // one answer
+        IPAddress address(reply + length - 4);            // every name resolves to the access point
+        CHECK(address == HostWiFi::GetStaticIP());
+    }
+
+    CHECK(phone.Get("/generate_204", response));
+    CHECK_EQUAL(200, response.status);
+    CHECK(phone.Get("/", response, "Accept-Encoding: gzip\r\n"));
+    CHECK_EQUAL(200, response.status);
+    CHECK(response.gzip);
+    CHECK(phone.Get("/list_networks", response));
+    CHECK_EQUAL(200, response.status);
+    CHECK(response.body.find("Neighbour") != std::string::npos);
+    CHECK(phone.Post("/enterPassword?network=Home", "", response));
+    CHECK_EQUAL(200, response.status);
+    CHECK(phone.Post("/connect", "network=Home&password=secretpass", response));
+    CHECK_EQUAL(200, response.status);
+    CHECK(response.body.find("Home") != std::string::npos);
+    CHECK_EQUAL(EASYWIFI_PROVISION_PENDING, wifi.GetProvisionResult());
+
+    CHECK(RunUntil(wifi, EASYWIFI_CONNECTED, 60000));
+    CHECK(HostWiFi::IsConnected());
+    CHECK_TEXT("Home", HostWiFi::GetConnectedSsid());
+    CHECK_EQUAL(EASYWIFI_PROVISION_CONNECTED, wifi.GetProvisionResult());
+    CHECK_EQUAL(1, wifi.GetNetworkCount());
+    CHECK(!wifi.GetPortalArena().IsActive());
+    CHECK_EQUAL(0, HostNet::GetOpenSockets());
+    CHECK(wifi.GetTimeline().firstDnsQuery != EASYWIFI_PHASE_NONE);
+    CHECK(wifi.GetTimeline().credentialsReceived != EASYWIFI_PHASE_NONE);
+
+    // The next login finds the stored network, no portal
+    WiFi.disconnect();
+    wifi.Begin();
+    CHECK(RunUntil(wifi, EASYWIFI_CONNECTED, 60000));
+    CHECK_TEXT("Home", HostWiFi::GetConnectedSsid());
+    CHECK_EQUAL(1, (long)HostWiFi::GetCounters().beginAPs);
+}
+
+int main()
+{
+    TestPortalFlow();
+    return HostTest::Result();
+}
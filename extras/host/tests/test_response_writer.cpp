@@ -0,0 +1,99 @@
+// HttpResponseWriter framing: a chunked body decodes to what was written, one chunk per client write, with
+// chunk sizes of HTTP_CHUNK_DIGITS hex digits. CMakeLists.txt builds this test a second time with a buffer
+// large enough for chunks above 0xFFF bytes.
+
+#include <HttpResponseWriter.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "HostTest.h"
+
+#define WRITER_TEST_BODY 20000
+
+// A client that keeps every write() for the test
+class CaptureClient : public Client
+{
+public:
+    int connect(IPAddress, uint16_t) { return 1; }
+    int connect(const char*, uint16_t) { return 1; }
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size)
+    {
+        writes.push_back(std::string((const char*)buffer, size));
+        return size;
+    }
+    int available() { return 0; }
+    int read() { return -1; }
+    int read(uint8_t*, size_t) { return 0; }
+    int peek() { return -1; }
+    void flush() {}
+    void stop() {}
+    uint8_t connected() { return 1; }
+    operator bool() { return true; }
+
+    std::vector<std::string> writes;
+};
+
+static void TestChunkedBody()
+{
+    HostTest::Case("chunked body decodes to what was written");
+    CaptureClient client;
+    HttpResponseWriter writer;
+    std::string body;
+    for (int i = 0; i < WRITER_TEST_BODY; i++)
+        body += (char)('a' + i % 26);
+
+    writer.Begin(client);
+    writer.print("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n");
+    writer.BeginChunkedBody();
+    writer.write((const uint8_t*)body.data(), 1000);              // through the buffer in pieces
+    for (int i = 1000; i < 1100; i++)
+        writer.write((uint8_t)body[i]);
+    writer.write((const uint8_t*)body.data() + 1100, body.size() - 1100);
+    size_t sent = writer.End();
+
+    std::string stream;
+    for (size_t i = 0; i < client.writes.size(); i++)
+    {
+        CHECK(client.writes[i].size() <= HTTP_RESPONSE_BUFFER_SIZE);
+        stream += client.writes[i];
+    }
+    CHECK_EQUAL(stream.size(), sent);
+    size_t at = stream.find("\r\n\r\n");
+    CHECK(at != std::string::npos);
+    at += 4;
+
+    std::string decoded;
+    size_t chunks = 0, largest = 0;
+    while (at < stream.size())
+    {
+        size_t end = stream.find("\r\n", at);
+        if (!CHECK(end != std::string::npos))
+            return;
+        std::string digits = stream.substr(at, end - at);
+        size_t size = strtoul(digits.c_str(), NULL, 16);
+        if (size == 0)
+        {
+            CHECK_TEXT("0", digits.c_str());
+            CHECK_EQUAL(end + 4, stream.size());                   // "0\r\n\r\n" closes the stream
+            break;
+        }
+        CHECK_EQUAL(HTTP_CHUNK_DIGITS, digits.size());
+        CHECK(end + 2 + size + 2 <= stream.size());
+        decoded += stream.substr(end + 2, size);
+        CHECK(stream.compare(end + 2 + size, 2, "\r\n") == 0);
+        at = end + 2 + size + 2;
+        chunks++;
+        if (size > largest)
+            largest = size;
+    }
+    CHECK(decoded == body);
+    CHECK_EQUAL(client.writes.size(), chunks);                     // one chunk per write
+    CHECK(largest > HTTP_RESPONSE_BUFFER_SIZE - HTTP_CHUNK_HEADER_SIZE - HTTP_CHUNK_TRAILER_SIZE - 10);
+}
+
+int main()
+{
+    TestChunkedBody();
+    return HostTest::Result();
+}
@@ -0,0 +1,266 @@
+// RetryPolicy on its own: backoff growth, budgets and jitter for a seed. Then EasyWiFi on the virtual clock:
+// a seed of the application survives Begin(), devices that were not seeded back off out of step, and the
+// most recent retry times, taken at the WiFi.begin() of each retry, show up in /metrics.
+
+#include <EasyWiFi.h>
+#include <HostSim.h>
+#include <vector>
+#include "HostTest.h"
+#include "HostPhone.h"
+
+#define RETRY_TEST_WAITS 3
+
+static void PumpWiFi(void* context)
+{
+    ((EasyWiFi*)context)->Poll();
+    HostClock::Advance(1);
+}
+
+static void TestBackoff()
+{
+    HostTest::Case("delays grow up to the limit");
+    RetryPolicy policy;
+    unsigned long delay = 0, now = 0;
+    policy.SetJitter(0);
+    policy.SetBudget(0, 0);
+    policy.SetDelays(1000, 300, 20000);
+    policy.Reset(now);
+    const unsigned long expected[] = { 1000, 3000, 9000, 20000, 20000 };
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+    {
+        policy.OnAttempt();
+        CHECK(policy.Next(now, delay));
+        CHECK_EQUAL(expected[i], delay);
+        now += delay;
+    }
+
+    HostTest::Case("attempt and time budgets");
+    policy.SetDelays(1000, 200, 30000);
+    policy.SetBudget(3, 0);
+    policy.Reset(0);
+    for (int i = 0; i < 3; i++)
+    {
+        policy.OnAttempt();
+        CHECK_EQUAL(i < 2, (bool)policy.Next(0, delay));
+    }
+    CHECK_EQUAL(3, policy.GetAttempts());
+    policy.SetBudget(0, 10000);
+    policy.Reset(5000);
+    policy.OnAttempt();
+    CHECK(policy.Next(5000, delay));                       // starts at 6000
+    CHECK(policy.Next(11000, delay));                      // 2000: starts at 13000, inside 15000
+    CHECK(!policy.Next(12000, delay));                     // 4000: would start at 16000
+    policy.Reset(0);
+    CHECK_EQUAL(0, policy.GetAttempts());
+}
+
+static void TestJitter()
+{
+    HostTest::Case("jitter stays in range and follows the seed");
+    RetryPolicy first, second, other;
+    unsigned long a, b, c;
+    int differing = 0;
+    first.Seed(1234);
+    second.Seed(1234);
+    other.Seed(4321);
+    CHECK(first.IsSeeded());
+    CHECK(!RetryPolicy().IsSeeded());
+    for (int i = 0; i < 1000; i++)
+    {
+        first.Reset(0);
+        second.Reset(0);
+        other.Reset(0);
+        CHECK(first.Next(0, a));
+        CHECK(second.Next(0, b));
+        CHECK(other.Next(0, c));
+        CHECK(a >= RETRY_INITIAL_DELAY * (100 - RETRY_JITTER) / 100 && a <= RETRY_INITIAL_DELAY * (100 + RETRY_JITTER) / 100);
+        CHECK_EQUAL(a, b);
+        if (a != c)
+            differing++;
+    }
+    CHECK(differing > 900);
+
+    // Seed 0 would keep xorshift at 0, the jitter still varies
+    RetryPolicy zero;
+    zero.Seed(0);
+    zero.Reset(0);
+    zero.Next(0, a);
+    differing = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        zero.Reset(0);
+        zero.Next(0, b);
+        if (a != b)
+            differing++;
+    }
+    CHECK(differing > 0);
+}
+
+// Durations in ms of the first RETRY_TEST_WAITS EASYWIFI_RETRY_WAIT states after Begin(), stepping the clock 1 ms
+static std::vector<unsigned long> RetryWaits(EasyWiFi& wifi)
+{
+    std::vector<unsigned long> waits;
+    unsigned long start = 0;
+    bool waiting = false;
+    wifi.Begin();
+    for (unsigned long elapsed = 0; elapsed < 600000 && waits.size() < RETRY_TEST_WAITS; elapsed++)
+    {
+        bool now = (wifi.Poll() == EASYWIFI_RETRY_WAIT);
+        if (now && !waiting)
+            start = elapsed;
+        else if (!now && waiting)
+            waits.push_back(elapsed - start);
+        waiting = now;
+        HostClock::Advance(1);
+    }
+    return waits;
+}
+
+// The delays a policy seeded with seed hands out for the first RETRY_TEST_WAITS retries
+static std::vector<unsigned long> ExpectedWaits(uint32_t seed)
+{
+    RetryPolicy policy;
+    std::vector<unsigned long> waits;
+    unsigned long delay;
+    policy.SetJitter(100);
+    policy.Seed(seed);
+    policy.Reset(0);
+    for (int i = 0; i < RETRY_TEST_WAITS; i++)
+    {
+        policy.OnAttempt();
+        policy.Next(0, delay);
+        waits.push_back(delay);
+    }
+    return waits;
+}
+
+static bool SameWaits(const std::vector<unsigned long>& measured, const std::vector<unsigned long>& expected)
+{
+    if (measured.size() != expected.size())
+        return false;
+    for (size_t i = 0; i < measured.size(); i++)
+    {
+        if (measured[i] + 2 < expected[i] || measured[i] > expected[i] + 2) // a Poll() each ms
+            return false;
+    }
+    return true;
+}
+
+static void TestSeedKept()
+{
+    HostTest::Case("Begin() keeps the seed of the application");
+    const uint8_t macA[6] = { 0x24, 0x0A, 0xC4, 0x00, 0x00, 0x01 };
+    const uint8_t macB[6] = { 0x24, 0x0A, 0xC4, 0x00, 0x00, 0x02 };
+    HostWiFi::AddNetwork("Home", "secretpass", -48);
+    CHECK(CredentialsHandler::AddNetwork("Home", "wrong-password", 100) != 0); // every attempt times out
+
+    EasyWiFi seeded;
+    seeded.UseAccessPoint(false);
+    seeded.GetRetryPolicy().SetJitter(100);
+    seeded.GetRetryPolicy().Seed(1234);
+    HostWiFi::SetMacAddress(macA);
+    std::vector<unsigned long> waits = RetryWaits(seeded);
+    CHECK(SameWaits(waits, ExpectedWaits(1234)));
+    CHECK(seeded.GetRetryPolicy().IsSeeded());
+
+    // Seeded again by the application: the same sequence once more, whatever MAC and clock say
+    seeded.GetRetryPolicy().Seed(1234);
+    HostWiFi::SetMacAddress(macB);
+    HostClock::Advance(12345);
+    CHECK(SameWaits(RetryWaits(seeded), waits));
+
+    HostTest::Case("devices without a seed back off out of step");
+    EasyWiFi deviceA, deviceB;
+    deviceA.GetRetryPolicy().SetJitter(100);
+    deviceB.GetRetryPolicy().SetJitter(100);
+    HostWiFi::SetMacAddress(macA);
+    std::vector<unsigned long> waitsA = RetryWaits(deviceA);
+    CHECK(deviceA.GetRetryPolicy().IsSeeded());
+    HostWiFi::SetMacAddress(macB);
+    std::vector<unsigned long> waitsB = RetryWaits(deviceB);
+    CHECK_EQUAL(RETRY_TEST_WAITS, (long)waitsA.size());
+    CHECK_EQUAL(RETRY_TEST_WAITS, (long)waitsB.size());
+    CHECK(!SameWaits(waitsA, waitsB));
+}
+
+// Value of the sample of /metrics starting with prefix, -1 if there is none
+static long MetricValue(const std::string& body, const std::string& prefix)
+{
+    size_t at = body.find("\n" + prefix);
+    if (at == std::string::npos)
+        return -1;
+    return atol(body.c_str() + at + 1 + prefix.size());
+}
+
+static void TestRetryMetrics()
+{
+    HostTest::Case("the last retry times in /metrics");
+    EasyWiFi wifi;
+    HostPhone phone(PumpWiFi, &wifi);
+    HostHttpResponse response;
+    const int attempts = TIMELINE_RETRY_HISTORY + 4;
+    wifi.UseAccessPoint(true);                             // a global, turned off by the cases before
+    wifi.GetRetryPolicy().SetBudget(attempts, 0);          // the stored password is still wrong
+    wifi.GetRetryPolicy().SetDelays(500, 100, 500);
+    wifi.GetRetryPolicy().SetJitter(0);
+    wifi.Begin();
+    for (unsigned long elapsed = 0; elapsed < 600000 && wifi.Poll() != EASYWIFI_PORTAL; elapsed += 5)
+        HostClock::Advance(5);
+    CHECK_EQUAL(EASYWIFI_PORTAL, wifi.GetState());
+    CHECK_EQUAL(attempts - 1, (long)wifi.GetTimeline().retries);
+    HostWiFi::SetStationJoined(true);
+
+    CHECK(phone.Get("/metrics", response));
+    CHECK_EQUAL(200, response.status);
+    int oldest = attempts - TIMELINE_RETRY_HISTORY;        // retries 1 .. oldest - 1 left the ring
+    CHECK_EQUAL(-1, MetricValue(response.body, "easywifi_retry_ms{retry=\"" + std::to_string(oldest - 1) + "\"}"));
+    long previous = 0;
+    for (int n = oldest; n < attempts; n++)
+    {
+        long value = MetricValue(response.body, "easywifi_retry_ms{retry=\"" + std::to_string(n) + "\"}");
+        CHECK(value > previous);
+        CHECK(n == oldest || value - previous >= 500 + CONNECT_TIMEOUT);
+        previous = value;
+    }
+    CHECK_EQUAL((long)wifi.GetTimeline().lastRetry, previous);
+    CHECK_EQUAL(previous, MetricValue(response.body, "easywifi_phase_ms{phase=\"last_retry\"}"));
+}
+
+static void TestRetryTimesAtBegin()
+{
+    HostTest::Case("retry times are those of the retry WiFi.begin()");
+    EasyWiFi wifi;
+    std::vector<unsigned long> begins;                     // ms after Begin() of each WiFi.begin()
+    wifi.UseAccessPoint(false);
+    wifi.GetRetryPolicy().SetBudget(TIMELINE_RETRY_HISTORY, 0);
+    wifi.GetRetryPolicy().SetJitter(100);
+    wifi.GetRetryPolicy().Seed(77);
+    unsigned long start = millis();
+    unsigned long count = HostWiFi::GetCounters().begins;
+    wifi.Begin();
+    for (unsigned long elapsed = 0; elapsed < 600000 && wifi.GetTimeline().retries < 4; elapsed++)
+    {
+        wifi.Poll();
+        if (HostWiFi::GetCounters().begins != count)
+        {
+            count = HostWiFi::GetCounters().begins;
+            begins.push_back(millis() - start);
+        }
+        HostClock::Advance(1);
+    }
+    CHECK_EQUAL(4, (long)wifi.GetTimeline().retries);
+    CHECK_EQUAL(5, (long)begins.size());                   // the first attempt and 4 retries
+    for (size_t n = 1; n < begins.size() && n <= 4; n++)
+        CHECK_EQUAL(begins[n], wifi.GetTimeline().retryTimes[n - 1]);
+    CHECK_EQUAL(begins[4], wifi.GetTimeline().lastRetry);
+}
+
+int main()
+{
+    TestBackoff();
+    TestJitter();
+    TestSeedKept();
+    TestRetryMetrics();
+    TestRetryTimesAtBegin();
+    return HostTest::Result();
+}
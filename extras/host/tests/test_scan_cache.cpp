@@ -0,0 +1,102 @@
+// The portal scan list outlives the portal session: GetScanResult() works after CONNECTED and a portal
+// opened again within SCAN_CACHE_TTL shows the cached list instead of scanning.
+
+#include <EasyWiFi.h>
+#include <HostSim.h>
+#include "HostTest.h"
+#include "HostPhone.h"
+
+static void PumpWiFi(void* context)
+{
+    ((EasyWiFi*)context)->Poll();
+    HostClock::Advance(1);
+}
+
+static bool RunUntil(EasyWiFi& wifi, EasyWiFiState state, unsigned long limit)
+{
+    for (unsigned long elapsed = 0; elapsed < limit; elapsed += 5)
+    {
+        if (wifi.Poll() == state)
+            return true;
+        HostClock::Advance(5);
+    }
+    return false;
+}
+
+// Enter credentials in the open portal and wait for the verified connection
+static bool Provision(EasyWiFi& wifi, const char* form)
+{
+    HostPhone phone(PumpWiFi, &wifi);
+    HostHttpResponse response;
+    HostWiFi::SetStationJoined(true);
+    return phone.Post("/connect", form, response) && response.status == 200 && RunUntil(wifi, EASYWIFI_CONNECTED, 60000);
+}
+
+// Lose the network, the login with the stored ones fails and the portal opens
+static bool ReopenPortal(EasyWiFi& wifi, const char* lost)
+{
+    HostWiFi::RemoveNetwork(lost);
+    WiFi.disconnect();
+    wifi.Begin();
+    return RunUntil(wifi, EASYWIFI_PORTAL, 600000);
+}
+
+static void TestScanListOutlivesSession()
+{
+    HostTest::Case("scan list outlives the portal session");
+    EasyWiFi wifi;
+    wifi.GetRetryPolicy().SetBudget(1, 0);
+
+    HostWiFi::AddNetwork("Home", "secretpass", -48);
+    HostWiFi::AddNetwork("Cafe", "espresso-42", -67);
+    wifi.Begin();
+    CHECK(RunUntil(wifi, EASYWIFI_PORTAL, 600000));
+    CHECK_EQUAL(1, (long)HostWiFi::GetCounters().scans);
+    CHECK(Provision(wifi, "network=Home&password=secretpass"));
+
+    CHECK(!wifi.GetPortalArena().IsActive());
+    CHECK_EQUAL(2, wifi.GetScanCount());
+    CHECK(wifi.GetScanResult(1) != NULL);
+    if (wifi.GetScanResult(1) != NULL)
+        CHECK_TEXT("Cafe", wifi.GetScanResult(1)->ssid);
+
+    HostTest::Case("portal within SCAN_CACHE_TTL reuses the scan");
+    CHECK(ReopenPortal(wifi, "Home"));
+    CHECK(wifi.GetScanAge() < SCAN_CACHE_TTL);
+    CHECK_EQUAL(1, (long)HostWiFi::GetCounters().scans);
+    CHECK_EQUAL(2, wifi.GetScanCount());
+    CHECK(Provision(wifi, "network=Cafe&password=espresso-42"));
+
+    HostTest::Case("portal after SCAN_CACHE_TTL scans again");
+    HostClock::Advance(SCAN_CACHE_TTL);
+    CHECK(ReopenPortal(wifi, "Cafe"));
+    CHECK(wifi.GetScanAge() < SCAN_MIN_INTERVAL);
+    CHECK_EQUAL(0, wifi.GetScanCount());
+}
+
+// Stored networks against scan entries without a name: nothing matches, the most preferred one is tried
+static void TestEntriesWithoutSsid()
+{
+    HostTest::Case("scan entries lost or hidden");
+    EasyWiFi wifi;
+    HostStorage::Clear();
+    CredentialsHandler::Invalidate();
+    HostWiFi::Reset();
+    HostWiFi::AddNetwork("", "hidden-pass", -40);
+    HostWiFi::AddNetwork("Home", "secretpass", -48);
+    CHECK(CredentialsHandler::AddNetwork("Cafe", "espresso-42", 100) != 0);
+    CHECK(CredentialsHandler::AddNetwork("Home", "secretpass", 200) != 0);
+
+    HostWiFi::SetScanEntriesLost(true);
+    wifi.Begin();
+    CHECK(RunUntil(wifi, EASYWIFI_CONNECTED, 600000));
+    CHECK_TEXT("Home", HostWiFi::GetConnectedSsid());
+    HostWiFi::SetScanEntriesLost(false);
+}
+
+int main()
+{
+    TestScanListOutlivesSession();
+    TestEntriesWithoutSsid();
+    return HostTest::Result();
+}
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+Build src/PortalAssets.h from the portal pages in extras/portal.
+
+Every page is minified and gzip compressed. Both versions are written as
+PROGMEM arrays: the gzip version is sent when the client accepts gzip,
+the minified version otherwise.
+
+Run after changing a page in extras/portal:
+    python3 extras/tools/build_portal_assets.py
+"""
+
+import gzip
+import os
+import re
+
+ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+PORTAL_DIR = os.path.join(ROOT, "extras", "portal")
+OUTPUT = os.path.join(ROOT, "src", "PortalAssets.h")
+
+# (file, C name)
+ASSETS = [
+    ("start.html", "PORTAL_START_PAGE"),
+    ("password.html", "PORTAL_PASSWORD_PAGE"),
+]
+
+
+def minify(text):
+    """Strip indentation, blank lines and whole-line // comments, keep line breaks for the JavaScript."""
+    lines = []
+    for line in text.splitlines():
+        line = line.strip()
+        if not line or line.startswith("//"):
+            continue
+        lines.append(line)
+    text = "\n".join(lines)
+    # Line breaks between tags are not needed
+    return re.sub(r">\n<", "><", text)
+
+
+def c_string(data):
+    out = []
+    for line in data.decode("utf-8").split("\n"):
+        out.append('\t"' + line.replace("\\", "\\\\").replace('"', '\\"') + '\\n"')
+    out[-1] = out[-1][:-3] + '"'
+    return "\n".join(out)
+
+
+def c_bytes(data):
+    rows = []
+    for i in range(0, len(data), 16):
+        rows.append("\t" + ",".join("0x%02x" % b for b in data[i:i + 16]))
+    return ",\n".join(rows)
+
+
+def main():
+    parts = [
+        "// PortalAssets.h",
+        "// Generated by extras/tools/build_portal_assets.py from extras/portal - do not edit",
+        "",
+        "#ifndef _PORTALASSETS_h",
+        "#define _PORTALASSETS_h",
+        "",
+        '#include <Arduino.h>',
+        "",
+    ]
+    for filename, name in ASSETS:
+        with open(os.path.join(PORTAL_DIR, filename), encoding="utf-8") as f:
+            raw = minify(f.read()).encode("utf-8")
+        compressed = gzip.compress(raw, compresslevel=9, mtime=0)
+        parts += [
+            "// %s: %d bytes minified, %d bytes gzip" % (filename, len(raw), len(compressed)),
+            "const char %s[] PROGMEM =" % name,
+            c_string(raw) + ";",
+            "const uint8_t %s_GZ[] PROGMEM = {" % name,
+            c_bytes(compressed),
+            "};",
+            "",
+        ]
+    parts += ["#endif", ""]
+    with open(OUTPUT, "w", newline="\n") as f:
+        f.write("\n".join(parts))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""
+Decode EventLog records in a serial capture back into text.
+
+The board writes every record as "~EL " and 32 hex digits, see src/EventLog.h.
+The event texts are the // comments of enum EventLogId in that header, so
+decode a capture with the sources of the build that produced it. Lines
+without a record are passed through unchanged.
+
+    python3 extras/tools/decode_log.py capture.txt
+    cat /dev/ttyACM0 | python3 extras/tools/decode_log.py
+
+extras/host/tests/test_event_log.cpp drains known records through this script
+and compares the text, change both together.
+"""
+
+import argparse
+import glob
+import os
+import re
+import struct
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+SRC_DIR = os.path.join(ROOT, "src")
+EVENT_HEADER = os.path.join(SRC_DIR, "EventLog.h")
+
+PREFIX = "~EL "
+RECORD = struct.Struct("<IBBHii")   # time, event, level, sequence, args
+LEVELS = ["OFF", "ERROR", "WARN", "INFO", "DEBUG"]
+
+ENUM_RE = re.compile(r"enum\s+(\w+)\s*\{(.*?)\};", re.S)
+ENTRY_RE = re.compile(r"^\s*(\w+)\s*(?:=\s*([^,/]+?))?\s*,?\s*(?://\s?(.*))?$")
+RECORD_RE = re.compile(re.escape(PREFIX) + r"([0-9a-fA-F]{%d})" % (2 * RECORD.size))
+FIELD_RE = re.compile(r"\{(\w+)\}")
+
+
+def read_enums():
+    """{enum name: [(enumerator, comment)]} of all headers in src, in declaration order."""
+    enums = {}
+    for path in sorted(glob.glob(os.path.join(SRC_DIR, "*.h"))):
+        with open(path) as header:
+            text = header.read()
+        for match in ENUM_RE.finditer(text):
+            entries = []
+            value = 0
+            for line in match.group(2).splitlines():
+                entry = ENTRY_RE.match(line)
+                if not entry:
+                    continue
+                if entry.group(2):
+                    value = int(entry.group(2), 0)
+                entries.append((value, entry.group(1), (entry.group(3) or "").strip()))
+                value += 1
+            enums[match.group(1)] = entries
+    return enums
+
+
+def text_of(args):
+    """The two arguments as the text EventLog::WriteText() packed into them."""
+    return struct.pack("<ii", *args).split(b"\0", 1)[0].decode("ascii", "replace")
+
+
+def format_event(fmt, args, enums):
+    """fmt with its fields filled from args, see the comment of enum EventLogId."""
+    queue = list(args)
+
+    def field(match):
+        kind = match.group(1)
+        if kind == "s":
+            text = text_of(args)
+            del queue[:]
+            return text
+        value = queue.pop(0) if queue else 0
+        if kind == "d":
+            return str(value)
+        if kind == "u":
+            return str(value & 0xFFFFFFFF)
+        if kind == "x":
+            return "0x%x" % (value & 0xFFFFFFFF)
+        if kind == "ip":
+            return ".".join(str(b) for b in struct.pack("<i", value))
+        names = dict((v, n) for v, n, _ in enums.get(kind, []))
+        return names.get(value, "%s(%d)" % (kind, value))
+
+    return FIELD_RE.sub(field, fmt)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="capture file, stdin if left out")
+    parser.add_argument("--only", action="store_true", help="drop lines without a record")
+    args = parser.parse_args()
+
+    enums = read_enums()
+    events = dict((v, (n, c)) for v, n, c in enums["EventLogId"])
+    source = open(args.capture, errors="replace") if args.capture else sys.stdin
+
+    sequence = None
+    for line in source:
+        match = RECORD_RE.search(line)
+        if not match:
+            if not args.only:
+                sys.stdout.write(line)
+            continue
+        time, event, level, number, a, b = RECORD.unpack(bytes.fromhex(match.group(1)))
+        if sequence is not None and number != sequence:
+            print("... %d records lost" % ((number - sequence) & 0xFFFF))
+        sequence = (number + 1) & 0xFFFF
+
+        name, fmt = events.get(event, ("EVENT_%d" % event, "unknown event {d} {d}"))
+        level_name = LEVELS[level] if level < len(LEVELS) else str(level)
+        print("%10.3f %-5s %s" % (time / 1000.0, level_name, format_event(fmt or name, (a, b), enums)))
+        sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""
+Print the flash and RAM use of examples/wifi_easy for the usual feature
+combinations of src/EasyWiFiConfig.h.
+
+Every combination is compiled with arduino-cli, the switches go in as
+build flags, and arm-none-eabi-size reads the resulting elf:
+    text  flash code and constants
+    data  initialised RAM (also takes flash)
+    bss   zeroed RAM
+
+Needs arduino-cli with the SAMD core and WiFiNINA installed. arm-none-eabi-size
+is taken from PATH, else from the toolchain the SAMD core installed:
+    python3 extras/tools/size_report.py [--fqbn arduino:samd:mkrwifi1010] [--markdown FILE]
+
+--host needs neither: it compiles only the library sources with the host C++
+compiler and -Os against the stand-ins of extras/host/include, and sums the
+sections of the objects. No core, no WiFiNINA, nothing linked or dropped by
+the linker, and host code instead of Thumb: the numbers compare the variants
+with each other, they are no board sizes.
+    python3 extras/tools/size_report.py --host [--markdown FILE]
+
+--markdown appends the table to FILE as Markdown, .github/workflows/size-report.yml
+passes $GITHUB_STEP_SUMMARY so every CI run shows it.
+"""
+
+import argparse
+import glob
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+SKETCH = os.path.join(ROOT, "examples", "wifi_easy")
+
+# (name, build flags)
+CONFIGS = [
+    ("default", ""),
+    ("no dns", "-DEASYWIFI_WITH_DNS=0"),
+    ("no portal", "-DEASYWIFI_WITH_PORTAL=0"),
+    ("no portal, led, log", "-DEASYWIFI_WITH_PORTAL=0 -DEASYWIFI_WITH_LED=0 -DEASYWIFI_LOG_LEVEL=0"),
+]
+
+
+def build(fqbn, flags, build_dir):
+    """Compile the sketch into build_dir, return the path of the elf."""
+    cmd = ["arduino-cli", "compile", "--fqbn", fqbn, "--library", ROOT,
+           "--build-path", build_dir,
+           "--build-property", "compiler.cpp.extra_flags=" + flags,
+           SKETCH]
+    subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL)
+    return os.path.join(build_dir, os.path.basename(SKETCH) + ".ino.elf")
+
+
+def build_host(compiler, flags, build_dir):
+    """Compile src/*.cpp into build_dir with the host compiler, return the object paths."""
+    objects = []
+    for source in sorted(glob.glob(os.path.join(ROOT, "src", "*.cpp"))):
+        obj = os.path.join(build_dir, os.path.basename(source) + ".o")
+        cmd = [compiler, "-std=gnu++11", "-Os", "-ffunction-sections", "-fdata-sections", "-c",
+               "-I", os.path.join(ROOT, "extras", "host", "include"), "-I", os.path.join(ROOT, "src"),
+               "-o", obj, source] + flags.split()
+        subprocess.run(cmd, check=True)
+        objects.append(obj)
+    return objects
+
+
+def find_size_tool():
+    """arm-none-eabi-size from PATH, else the newest one under the arduino-cli data directory."""
+    tool = shutil.which("arm-none-eabi-size")
+    if tool:
+        return tool
+    data = os.path.expanduser("~/.arduino15")
+    try:
+        out = subprocess.run(["arduino-cli", "config", "dump", "--format", "json"], check=True,
+                             stdout=subprocess.PIPE, universal_newlines=True).stdout
+        config = json.loads(out)
+        config = config.get("config", config)        # arduino-cli 0.35 and later nest it
+        data = config.get("directories", {}).get("data", data)
+    except (OSError, ValueError, subprocess.CalledProcessError):
+        pass
+    found = sorted(glob.glob(os.path.join(data, "packages", "arduino", "tools", "arm-none-eabi-gcc",
+                                          "*", "bin", "arm-none-eabi-size")))
+    return found[-1] if found else "arm-none-eabi-size"
+
+
+def size(tool, files):
+    """text, data, bss summed over files."""
+    out = subprocess.run([tool] + files, check=True,
+                         stdout=subprocess.PIPE, universal_newlines=True).stdout
+    total = [0, 0, 0]
+    for line in out.splitlines()[1:]:
+        fields = line.split()
+        for i in range(3):
+            total[i] += int(fields[i])
+    return tuple(total)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--fqbn", default="arduino:samd:mkrwifi1010")
+    parser.add_argument("--markdown", metavar="FILE", help="append the table to FILE as Markdown")
+    parser.add_argument("--host", action="store_true", help="library objects only, host compiler")
+    args = parser.parse_args()
+
+    if args.host:
+        compiler = os.environ.get("CXX", "c++")
+        tool = shutil.which("size") or "size"
+        target = "library objects, host %s -Os" % os.path.basename(compiler)
+    else:
+        tool = find_size_tool()
+        target = args.fqbn
+    rows = []
+    for name, flags in CONFIGS:
+        with tempfile.TemporaryDirectory() as build_dir:
+            try:
+                if args.host:
+                    files = build_host(compiler, flags, build_dir)
+                else:
+                    files = [build(args.fqbn, flags, build_dir)]
+                rows.append((name,) + size(tool, files))
+            except (OSError, subprocess.CalledProcessError) as error:
+                sys.exit("%s: %s" % (name, error))
+
+    base = rows[0]
+    print("%-24s %8s %8s %8s %10s %10s" % ("config", "text", "data", "bss", "flash", "ram"))
+    for name, text, data, bss in rows:
+        print("%-24s %8d %8d %8d %+10d %+10d" % (name, text, data, bss,
+              (text + data) - (base[1] + base[2]), (data + bss) - (base[2] + base[3])))
+
+    if args.markdown:
+        with open(args.markdown, "a") as out:
+            out.write("### EasyWiFi size, %s\n\n" % target)
+            out.write("| config | text | data | bss | flash | ram |\n|---|---:|---:|---:|---:|---:|\n")
+            for name, text, data, bss in rows:
+                out.write("| %s | %d | %d | %d | %+d | %+d |\n" % (name, text, data, bss,
+                          (text + data) - (base[1] + base[2]), (data + bss) - (base[2] + base[3])))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,195 @@
+
+#include "ChaChaPoly.h"
+
+#define CHACHA_ROTL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+#define CHACHA_QUARTERROUND(a, b, c, d) \
+	a += b; d ^= a; d = CHACHA_ROTL(d, 16); \
+	c += d; b ^= c; b = CHACHA_ROTL(b, 12); \
+	a += b; d ^= a; d = CHACHA_ROTL(d, 8); \
+	c += d; b ^= c; b = CHACHA_ROTL(b, 7)
+
+/* Encrypt length bytes of data in place and compute the tag over aad and the ciphertext */
+void ChaChaPoly::Encrypt(const uint8_t* key, const uint8_t* nonce, const uint8_t* aad, size_t aadLength,
+	uint8_t* data, size_t length, uint8_t* tag)
+{
+	Xor(key, 1, nonce, data, length);
+	ComputeTag(key, nonce, aad, aadLength, data, length, tag);
+}
+
+/* Verify the tag, then decrypt in place. Returns false and leaves data untouched if the tag does not match */
+boolean ChaChaPoly::Decrypt(const uint8_t* key, const uint8_t* nonce, const uint8_t* aad, size_t aadLength,
+	uint8_t* data, size_t length, const uint8_t* tag)
+{
+	uint8_t expected[CHACHAPOLY_TAG_SIZE];
+	uint8_t diff = 0;
+	ComputeTag(key, nonce, aad, aadLength, data, length, expected);
+	for (int i = 0; i < CHACHAPOLY_TAG_SIZE; i++)
+		diff |= expected[i] ^ tag[i]; // constant time compare
+	if (diff != 0)
+		return false;
+	Xor(key, 1, nonce, data, length);
+	return true;
+}
+
+/* One 64 byte ChaCha20 key stream block as 16 little endian words */
+void ChaChaPoly::Block(const uint8_t* key, uint32_t counter, const uint8_t* nonce, uint32_t* out)
+{
+	uint32_t state[16];
+	state[0] = 0x61707865; // "expand 32-byte k"
+	state[1] = 0x3320646e;
+	state[2] = 0x79622d32;
+	state[3] = 0x6b206574;
+	for (int i = 0; i < 8; i++)
+		state[4 + i] = Load32(key + 4 * i);
+	state[12] = counter;
+	for (int i = 0; i < 3; i++)
+		state[13 + i] = Load32(nonce + 4 * i);
+
+	for (int i = 0; i < 16; i++)
+		out[i] = state[i];
+	for (int round = 0; round < 10; round++)
+	{
+		CHACHA_QUARTERROUND(out[0], out[4], out[8], out[12]);
+		CHACHA_QUARTERROUND(out[1], out[5], out[9], out[13]);
+		CHACHA_QUARTERROUND(out[2], out[6], out[10], out[14]);
+		CHACHA_QUARTERROUND(out[3], out[7], out[11], out[15]);
+		CHACHA_QUARTERROUND(out[0], out[5], out[10], out[15]);
+		CHACHA_QUARTERROUND(out[1], out[6], out[11], out[12]);
+		CHACHA_QUARTERROUND(out[2], out[7], out[8], out[13]);
+		CHACHA_QUARTERROUND(out[3], out[4], out[9], out[14]);
+	}
+	for (int i = 0; i < 16; i++)
+		out[i] += state[i];
+}
+
+/* XOR the key stream starting at block counter into data, a whole word at a time */
+void ChaChaPoly::Xor(const uint8_t* key, uint32_t counter, const uint8_t* nonce, uint8_t* data, size_t length)
+{
+	uint32_t stream[16];
+	while (length > 0)
+	{
+		Block(key, counter++, nonce, stream);
+		size_t n = (length < 64) ? length : 64;
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			Store32(data + i, Load32(data + i) ^ stream[i / 4]);
+		for (; i < n; i++)
+			data[i] ^= (uint8_t)(stream[i / 4] >> (8 * (i % 4)));
+		data += n;
+		length -= n;
+	}
+}
+
+/* Poly1305 over aad and ciphertext, both zero padded to 16 bytes, followed by their lengths */
+void ChaChaPoly::ComputeTag(const uint8_t* key, const uint8_t* nonce, const uint8_t* aad, size_t aadLength,
+	const uint8_t* data, size_t length, uint8_t* tag)
+{
+	uint32_t stream[16];
+	uint32_t r[5], h[5] = { 0, 0, 0, 0, 0 };
+	uint8_t lengths[16];
+
+	// one time key: first half of block 0
+	Block(key, 0, nonce, stream);
+	r[0] = stream[0] & 0x3ffffff;
+	r[1] = ((stream[0] >> 26) | (stream[1] << 6)) & 0x3ffff03;
+	r[2] = ((stream[1] >> 20) | (stream[2] << 12)) & 0x3ffc0ff;
+	r[3] = ((stream[2] >> 14) | (stream[3] << 18)) & 0x3f03fff;
+	r[4] = (stream[3] >> 8) & 0x00fffff;
+
+	PolyBlocks(h, r, aad, aadLength);
+	PolyBlocks(h, r, data, length);
+	Store32(lengths, (uint32_t)aadLength);
+	Store32(lengths + 4, 0);
+	Store32(lengths + 8, (uint32_t)length);
+	Store32(lengths + 12, 0);
+	PolyBlock(h, r, lengths, 1 << 24);
+
+	// full carry, then h mod 2^130 - 5
+	uint32_t c = h[1] >> 26; h[1] &= 0x3ffffff;
+	h[2] += c; c = h[2] >> 26; h[2] &= 0x3ffffff;
+	h[3] += c; c = h[3] >> 26; h[3] &= 0x3ffffff;
+	h[4] += c; c = h[4] >> 26; h[4] &= 0x3ffffff;
+	h[0] += c * 5; c = h[0] >> 26; h[0] &= 0x3ffffff;
+	h[1] += c;
+
+	uint32_t g[5];
+	g[0] = h[0] + 5; c = g[0] >> 26; g[0] &= 0x3ffffff;
+	g[1] = h[1] + c; c = g[1] >> 26; g[1] &= 0x3ffffff;
+	g[2] = h[2] + c; c = g[2] >> 26; g[2] &= 0x3ffffff;
+	g[3] = h[3] + c; c = g[3] >> 26; g[3] &= 0x3ffffff;
+	g[4] = h[4] + c - (1UL << 26);
+
+	uint32_t mask = (g[4] >> 31) - 1; // all ones if h >= 2^130 - 5
+	for (int i = 0; i < 5; i++)
+		h[i] = (h[i] & ~mask) | (g[i] & mask);
+
+	// h + s, s is the second half of the one time key
+	uint32_t w0 = h[0] | (h[1] << 26);
+	uint32_t w1 = (h[1] >> 6) | (h[2] << 20);
+	uint32_t w2 = (h[2] >> 12) | (h[3] << 14);
+	uint32_t w3 = (h[3] >> 18) | (h[4] << 8);
+	uint64_t f;
+	f = (uint64_t)w0 + stream[4];             Store32(tag, (uint32_t)f);
+	f = (uint64_t)w1 + stream[5] + (f >> 32); Store32(tag + 4, (uint32_t)f);
+	f = (uint64_t)w2 + stream[6] + (f >> 32); Store32(tag + 8, (uint32_t)f);
+	f = (uint64_t)w3 + stream[7] + (f >> 32); Store32(tag + 12, (uint32_t)f);
+}
+
+/* Absorb data as 16 byte blocks, a short last block is zero padded */
+void ChaChaPoly::PolyBlocks(uint32_t* h, const uint32_t* r, const uint8_t* data, size_t length)
+{
+	while (length >= 16)
+	{
+		PolyBlock(h, r, data, 1 << 24);
+		data += 16;
+		length -= 16;
+	}
+	if (length > 0)
+	{
+		uint8_t block[16];
+		memset(block, 0, sizeof(block));
+		memcpy(block, data, length);
+		PolyBlock(h, r, block, 1 << 24);
+	}
+}
+
+/* h = (h + block) * r mod 2^130 - 5, 26-bit limbs with 32x32 -> 64 bit products */
+void ChaChaPoly::PolyBlock(uint32_t* h, const uint32_t* r, const uint8_t* block, uint32_t hibit)
+{
+	uint32_t s1 = r[1] * 5, s2 = r[2] * 5, s3 = r[3] * 5, s4 = r[4] * 5;
+
+	h[0] += Load32(block) & 0x3ffffff;
+	h[1] += (Load32(block + 3) >> 2) & 0x3ffffff;
+	h[2] += (Load32(block + 6) >> 4) & 0x3ffffff;
+	h[3] += (Load32(block + 9) >> 6) & 0x3ffffff;
+	h[4] += (Load32(block + 12) >> 8) | hibit;
+
+	uint64_t d0 = (uint64_t)h[0] * r[0] + (uint64_t)h[1] * s4 + (uint64_t)h[2] * s3 + (uint64_t)h[3] * s2 + (uint64_t)h[4] * s1;
+	uint64_t d1 = (uint64_t)h[0] * r[1] + (uint64_t)h[1] * r[0] + (uint64_t)h[2] * s4 + (uint64_t)h[3] * s3 + (uint64_t)h[4] * s2;
+	uint64_t d2 = (uint64_t)h[0] * r[2] + (uint64_t)h[1] * r[1] + (uint64_t)h[2] * r[0] + (uint64_t)h[3] * s4 + (uint64_t)h[4] * s3;
+	uint64_t d3 = (uint64_t)h[0] * r[3] + (uint64_t)h[1] * r[2] + (uint64_t)h[2] * r[1] + (uint64_t)h[3] * r[0] + (uint64_t)h[4] * s4;
+	uint64_t d4 = (uint64_t)h[0] * r[4] + (uint64_t)h[1] * r[3] + (uint64_t)h[2] * r[2] + (uint64_t)h[3] * r[1] + (uint64_t)h[4] * r[0];
+
+	uint32_t c;
+	c = (uint32_t)(d0 >> 26); h[0] = (uint32_t)d0 & 0x3ffffff;
+	d1 += c; c = (uint32_t)(d1 >> 26); h[1] = (uint32_t)d1 & 0x3ffffff;
+	d2 += c; c = (uint32_t)(d2 >> 26); h[2] = (uint32_t)d2 & 0x3ffffff;
+	d3 += c; c = (uint32_t)(d3 >> 26); h[3] = (uint32_t)d3 & 0x3ffffff;
+	d4 += c; c = (uint32_t)(d4 >> 26); h[4] = (uint32_t)d4 & 0x3ffffff;
+	h[0] += c * 5; c = h[0] >> 26; h[0] &= 0x3ffffff;
+	h[1] += c;
+}
+
+// Little endian load/store, byte wise so unaligned buffers are fine on Cortex-M0+
+uint32_t ChaChaPoly::Load32(const uint8_t* p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void ChaChaPoly::Store32(uint8_t* p, uint32_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	p[2] = (uint8_t)(value >> 16);
+	p[3] = (uint8_t)(value >> 24);
+}
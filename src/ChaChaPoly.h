@@ -0,0 +1,33 @@
+// ChaChaPoly.h
+
+#ifndef _CHACHAPOLY_h
+#define _CHACHAPOLY_h
+
+#include <Arduino.h>
+
+#define CHACHAPOLY_KEY_SIZE 32
+#define CHACHAPOLY_NONCE_SIZE 12
+#define CHACHAPOLY_TAG_SIZE 16
+
+/* ChaCha20-Poly1305 AEAD (RFC 8439), in place and without heap.
+   Works on 32-bit words only, Poly1305 uses 26-bit limbs so a Cortex-M0+ needs no 64x64 multiply. */
+class ChaChaPoly
+{
+public:
+    static void Encrypt(const uint8_t* key, const uint8_t* nonce, const uint8_t* aad, size_t aadLength,
+                        uint8_t* data, size_t length, uint8_t* tag);
+    static boolean Decrypt(const uint8_t* key, const uint8_t* nonce, const uint8_t* aad, size_t aadLength,
+                           uint8_t* data, size_t length, const uint8_t* tag);
+    static void Block(const uint8_t* key, uint32_t counter, const uint8_t* nonce, uint32_t* out);
+
+private:
+    static void Xor(const uint8_t* key, uint32_t counter, const uint8_t* nonce, uint8_t* data, size_t length);
+    static void ComputeTag(const uint8_t* key, const uint8_t* nonce, const uint8_t* aad, size_t aadLength,
+                           const uint8_t* data, size_t length, uint8_t* tag);
+    static void PolyBlocks(uint32_t* h, const uint32_t* r, const uint8_t* data, size_t length);
+    static void PolyBlock(uint32_t* h, const uint32_t* r, const uint8_t* block, uint32_t hibit);
+    static uint32_t Load32(const uint8_t* p);
+    static void Store32(uint8_t* p, uint32_t value);
+};
+
+#endif
@@ -1,188 +1,924 @@
 #include "CredentialsHandler.h"
+#include "ChaChaPoly.h"
+#include "DriverTrace.h"
+#include "EventLog.h"
 
 #define CREDENTIAL_FILE "/fs/WifiCredentials"
 
-#define Debug_On       // Debug option  -serial print
+/* Binary store, a journal: 12 byte file header followed by fixed size records, appended one per change.
+   Records are replayed in file order, a later record for the same ssid supersedes the earlier one and
+   a record flagged REMOVED drops it. Once the journal would exceed CREDENTIALS_JOURNAL_RECORDS it is
+   compacted: erased and rewritten with the live networks only.
+   header : 'E' 'W' 'C' 'S', version, record size, store salt (2, little endian),
+            store sequence at compaction (4, little endian)
+   record : flags, priority, ssid length, password length, lastSuccess (4, little endian),   <- authenticated
+            nonce (12) starting with the record sequence (4, little endian),
+            ssid (33) and password (64) zero padded and encrypted, 3 reserved, Poly1305 tag (16)
+   The salt is drawn when the store is created, again after an erase, and is part of the record key: the
+   sequence starts over with a new store, the key does not. Stores written before the salt have 0 there.
+   Version 1 (CRC protected records, 8 byte header) and files without a header (single network
+   text format of version 1.4.2 and earlier) are read once and rewritten. */
+#define CREDENTIAL_FILE_VERSION 2
+#define CREDENTIAL_HEADER_SIZE 12
+#define CREDENTIAL_RECORD_SIZE 136
+#define CREDENTIAL_RECORD_AAD 8
+#define CREDENTIAL_RECORD_NONCE 8
+#define CREDENTIAL_RECORD_SSID (CREDENTIAL_RECORD_NONCE + CHACHAPOLY_NONCE_SIZE)
+#define CREDENTIAL_RECORD_PASS (CREDENTIAL_RECORD_SSID + CREDENTIALS_SSID_SIZE)
+#define CREDENTIAL_RECORD_TAG (CREDENTIAL_RECORD_SIZE - CHACHAPOLY_TAG_SIZE)
+#define CREDENTIAL_RECORD_VALID 0x01
+#define CREDENTIAL_RECORD_REMOVED 0x02
+#define CREDENTIAL_FILE_SIZE (CREDENTIAL_HEADER_SIZE + CREDENTIALS_MAX_NETWORKS * CREDENTIAL_RECORD_SIZE)
+#define CREDENTIAL_JOURNAL_SIZE (CREDENTIAL_HEADER_SIZE + CREDENTIALS_JOURNAL_RECORDS * CREDENTIAL_RECORD_SIZE)
+#define CREDENTIAL_V1_VERSION 1
+#define CREDENTIAL_V1_HEADER_SIZE 8
+#define CREDENTIAL_V1_RECORD_SIZE 112
+#define CREDENTIAL_V1_RECORD_SSID 8
+#define CREDENTIAL_V1_RECORD_CRC (CREDENTIAL_V1_RECORD_SIZE - 4)
+#define CREDENTIAL_V1_FILE_SIZE (CREDENTIAL_V1_HEADER_SIZE + CREDENTIALS_MAX_NETWORKS * CREDENTIAL_V1_RECORD_SIZE)
+#define CREDENTIAL_LEGACY_FIELD 32   // Field size of the text format
+
+/* Reconnect cache, stored next to the credentials:
+   'E' 'W' 'R' 'C', version, ssid length, ssid (33), bssid (6), ip, gateway, dns, netmask (4 each),
+   CRC32 over all preceding bytes (4, little endian) */
+#define RECONNECT_FILE "/fs/WifiReconnect"
+#define RECONNECT_FILE_VERSION 1
+#define RECONNECT_BSSID (6 + CREDENTIALS_SSID_SIZE)
+#define RECONNECT_ADDRESSES (RECONNECT_BSSID + 6)
+#define RECONNECT_CRC (RECONNECT_ADDRESSES + 16)
+#define RECONNECT_FILE_SIZE (RECONNECT_CRC + 4)
+
+// Addresses of the four words of the 128 bit serial number, see the device service unit of the datasheet
+#if defined(__SAMD51__)
+	#define CREDENTIAL_SERIAL_WORDS 0x008061FC, 0x00806010, 0x00806014, 0x00806018
+#elif defined(__SAMD21__) || defined(__SAMD21G18A__) || defined(__SAMD21E18A__) || defined(__SAMD21J18A__)
+	#define CREDENTIAL_SERIAL_WORDS 0x0080A00C, 0x0080A040, 0x0080A044, 0x0080A048
+#elif defined(ARDUINO_ARCH_SAMD)
+	#error "EasyWiFi: unknown SAMD variant, add the addresses of its serial number to CREDENTIAL_SERIAL_WORDS"
+#endif
 
 int SEED = 4;
+static uint32_t G_CredentialSequence = 0; // highest sequence in the store last read or written
+static uint32_t G_JournalSize = 0;         // bytes of the journal last read or written, 0 if there is none
+static uint16_t G_StoreSalt = 0;           // salt of the store last read or written
+static boolean G_StoreSaltValid = false;   // false: the next compaction creates the store, with a new salt
+static uint8_t G_EntropyPool[CHACHAPOLY_KEY_SIZE];
+static uint32_t G_EntropyDraws = 0;        // blocks drawn from the pool, 0 until the module was sampled
+static WiFiCredentialStoreStats G_StoreStats = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+// RAM copy of the store, loaded on first use and written through, so reconnects do not touch flash
+static WiFiNetworkCredentials G_CachedNetworks[CREDENTIALS_MAX_NETWORKS];
+static int G_CachedCount = 0;
+static boolean G_CacheValid = false;
+static WiFiReconnectCache G_CachedReconnect;
+static uint8_t G_ReconnectCacheState = 0;  // 0 not read yet, 1 no valid cache file, 2 G_CachedReconnect valid
+
+static const char CREDENTIAL_MAGIC[4] = { 'E', 'W', 'C', 'S' };
+static const char RECONNECT_MAGIC[4] = { 'E', 'W', 'R', 'C' };
 
-// Set Seed of the Cypher, should be positive
+// Set Seed of the record key, should be positive. Records stored under another seed can no longer be read
 void CredentialsHandler::SetSeed(int seed)
 {
 	if (seed >= 0)
 	{
 		SEED = seed;
+		Invalidate(); // the records have to be opened with the new key
 	}
 }
 
-/* Read credentials ID,pass to Flash file , Comma separated style*/
+/* Read the preferred stored network into ssid buf1 (CREDENTIALS_SSID_SIZE) and password buf2 (CREDENTIALS_PASS_SIZE)
+   Returns 0 if no network is stored */
 byte CredentialsHandler::Read_Credentials(char* buf1, char* buf2)
 {
-	int u, t, currentReadPosition = 0;
-	char buffer[68], comma = 1, zero = 0;
-	char bufc[68];
-	WiFiStorageFile file = WiFiStorage.open(CREDENTIAL_FILE);
-	if (file) // check if file is valid/exists
+	WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+	int count = GetNetworks(networks);
+	if (count == 0)
+	{
+		EASYWIFI_LOG(LOG_LEVEL_WARN, EVENT_CREDENTIALS_READ_FAILED, 0, 0);
+		return(0);
+	}
+
+	int best = 0;
+	for (int i = 1; i < count; i++)
 	{
-		file.seek(0); // start filestream from the beginning / read file from the beginning
-		if (file.available())
+		if (IsPreferred(networks[i], networks[best]))
+			best = i;
+	}
+	strcpy(buf1, networks[best].ssid);
+	strcpy(buf2, networks[best].password);
+	EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_CREDENTIALS_READ, count, 0);
+	return(count);
+}
+
+/* Store credentials ID,pass with the default priority, kept for sketches written against the single network store */
+byte CredentialsHandler::Write_Credentials(char* buf1, int size1, char* buf2, int size2)
+{
+	char ssid[CREDENTIALS_SSID_SIZE], password[CREDENTIALS_PASS_SIZE];
+	CopyField(ssid, sizeof(ssid), buf1, size1);
+	CopyField(password, sizeof(password), buf2, size2);
+	return AddNetwork(ssid, password, CREDENTIALS_DEFAULT_PRIORITY); // an empty ssid is refused there
+}
+
+/* Copy the text in buffer (size bytes, not necessarily terminated) into field, cut to fieldSize - 1
+   characters and terminated. A NULL buffer or a size of 0 or less gives an empty field */
+void CredentialsHandler::CopyField(char* field, size_t fieldSize, const char* buffer, int size)
+{
+	size_t length = (buffer != NULL && size > 0) ? strnlen(buffer, size) : 0;
+	if (length > fieldSize - 1)
+		length = fieldSize - 1;
+	if (length > 0)
+		memcpy(field, buffer, length);
+	field[length] = 0;
+}
+
+/* Add a network or update password and priority of a stored one.
+   A full store replaces its least preferred network. Returns 0 on failure */
+byte CredentialsHandler::AddNetwork(const char* ssid, const char* password, uint8_t priority)
+{
+	if (ssid == NULL || ssid[0] == 0 || strlen(ssid) >= CREDENTIALS_SSID_SIZE || strlen(password) >= CREDENTIALS_PASS_SIZE)
+		return(0);
+
+	WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+	int count = GetNetworks(networks);
+	int index = -1;
+	for (int i = 0; i < count; i++)
+	{
+		if (strcmp(networks[i].ssid, ssid) == 0)
+			index = i;
+	}
+	boolean evicted = false;
+	if (index < 0)
+	{
+		if (count < CREDENTIALS_MAX_NETWORKS)
 		{
-			// read file buffer into memory, max size is 64 bytes for 2 char-strings
-			currentReadPosition = file.read(buffer, 68);  // read lenght of 68 chars into the buffer
+			index = count++;
 		}
-
-		if (currentReadPosition != 0) // check if, it actually read something
+		else
 		{
-			t = 0;
-			u = 0;
-			while (buffer[t] != comma) // read ID until comma
+			evicted = true;
+			index = 0;
+			for (int i = 1; i < count; i++)
 			{
-				bufc[u++] = buffer[t++];
-				if (u > 31)
-					break;
+				if (IsPreferred(networks[index], networks[i]))
+					index = i;
 			}
-			bufc[u] = 0;
-			SimpleDecypher(bufc, buf1);
-			u = 0;
-			t++;                // move to second part: pass
-			while (buffer[t] != zero) // read till zero
-			{
-				bufc[u++] = buffer[t++];
-				if (u > 31)
-					break;
-			}
-			bufc[u] = 0;
-			SimpleDecypher(bufc, buf2);
+			EASYWIFI_LOG_TEXT(LOG_LEVEL_WARN, EVENT_CREDENTIALS_REPLACED, networks[index].ssid);
 		}
-		#ifdef Debug_On
-			Serial.print("* Read Credentials : ");
-			Serial.println(currentReadPosition);
-		#endif    
-		file.close();
-		return(currentReadPosition);
+		networks[index].lastSuccess = 0;
 	}
-	else
+	strcpy(networks[index].ssid, ssid);
+	strcpy(networks[index].password, password);
+	networks[index].priority = priority;
+	if (evicted)
+		return Compact(networks, count); // drops the replaced network in one go
+	return Commit(networks, count, networks[index], 0);
+}
+
+/* Remove a stored network, returns 0 if it was not stored */
+byte CredentialsHandler::RemoveNetwork(const char* ssid)
+{
+	WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+	int count = GetNetworks(networks);
+	for (int i = 0; i < count; i++)
+	{
+		if (strcmp(networks[i].ssid, ssid) == 0)
+		{
+			WiFiNetworkCredentials removed = networks[i];
+			for (int t = i; t < count - 1; t++)
+				networks[t] = networks[t + 1];
+			removed.password[0] = 0;
+			return Commit(networks, count - 1, removed, CREDENTIAL_RECORD_REMOVED) ? 1 : 0;
+		}
+	}
+	return(0);
+}
+
+/* Record a successful connection to a stored network. Without a valid time (WiFi.getTime() returns 0
+   until the module synced) the network is stamped just after the most recent one to keep the order */
+byte CredentialsHandler::MarkConnected(const char* ssid, uint32_t time)
+{
+	WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+	int count = GetNetworks(networks);
+	int index = -1;
+	uint32_t newest = 0;
+	for (int i = 0; i < count; i++)
 	{
-		#ifdef Debug_On
-			Serial.println("* Cant read Credentials :");
-		#endif    
-		file.close();
+		if (strcmp(networks[i].ssid, ssid) == 0)
+			index = i;
+		if (networks[i].lastSuccess > newest)
+			newest = networks[i].lastSuccess;
+	}
+	if (index < 0)
 		return(0);
+	boolean wasNewest = (networks[index].lastSuccess == newest && newest != 0);
+	if (time == 0)
+	{
+		if (wasNewest)
+			return(1); // already the most recent one, spare the flash write
+		time = newest + 1;
+	}
+	if (wasNewest && time >= networks[index].lastSuccess && time - networks[index].lastSuccess < CREDENTIALS_MARK_INTERVAL)
+	{
+		// order unchanged: keep the new stamp in RAM only, it reaches flash with the next write
+		G_CachedNetworks[index].lastSuccess = time;
+		return(1);
 	}
+	networks[index].lastSuccess = time;
+	return Commit(networks, count, networks[index], 0);
 }
 
-/* Write credentials ID,pass to Flash file , Comma separated style*/
-byte CredentialsHandler::Write_Credentials(char* buf1, int size1, char* buf2, int size2)
+// Number of networks in the store
+int CredentialsHandler::GetNetworkCount()
+{
+	WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+	return GetNetworks(networks);
+}
+
+// Copy stored network index (0 .. GetNetworkCount() - 1) into network
+boolean CredentialsHandler::GetNetwork(int index, WiFiNetworkCredentials& network)
+{
+	WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+	int count = GetNetworks(networks);
+	if (index < 0 || index >= count)
+		return false;
+	network = networks[index];
+	return true;
+}
+
+// Index of a stored network, -1 if not stored
+int CredentialsHandler::FindNetwork(const char* ssid)
 {
-	int c = 0;
-	char comma = 1, zero = 0;
-	char buf[32];
-	WiFiStorageFile file = WiFiStorage.open(CREDENTIAL_FILE);
-	if (file)
-	{
-		file.erase();     // erase content bnefore writing
-	}
-	SimpleCypher(buf1, buf);
-	c = c + file.write(buf, size1);
-	file.write(&comma, 1);
-	c++;
-	SimpleCypher(buf2, buf);
-	c = c + file.write(buf, size2);
-	file.write(&zero, 1);
-	c++;
-	if (c != 0)
-	{
-		#ifdef Debug_On
-			Serial.print("* Written Credentials : ");
-			Serial.println(c);
-		#endif
-		file.close();
-		return(c);
+	WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+	int count = GetNetworks(networks);
+	for (int i = 0; i < count; i++)
+	{
+		if (strcmp(networks[i].ssid, ssid) == 0)
+			return i;
 	}
-	else
+	return -1;
+}
+
+// Order of the connection attempts: higher priority first, then the most recent success
+boolean CredentialsHandler::IsPreferred(const WiFiNetworkCredentials& a, const WiFiNetworkCredentials& b)
+{
+	if (a.priority != b.priority)
+		return a.priority > b.priority;
+	return a.lastSuccess > b.lastSuccess;
+}
+
+/* Read the reconnect cache, false if there is none or it fails its CRC */
+boolean CredentialsHandler::ReadReconnectCache(WiFiReconnectCache& cache)
+{
+	if (G_ReconnectCacheState != 0)
+	{
+		G_StoreStats.cacheHits++;
+		cache = G_CachedReconnect;
+		return G_ReconnectCacheState == 2;
+	}
+	G_StoreStats.cacheMisses++;
+	G_ReconnectCacheState = 1;
+
+	uint8_t buffer[RECONNECT_FILE_SIZE];
+	int size = 0;
+	memset(buffer, 0, sizeof(buffer)); // a short file leaves no stale bytes in the CRC check
+	G_StoreStats.readOpens++;
+	WiFiStorageFile file = EASYWIFI_DRIVER(DRIVER_STORAGE_OPEN, WiFiStorage.open(RECONNECT_FILE));
+	if (EASYWIFI_DRIVER(DRIVER_STORAGE_EXISTS, (bool)file))
+	{
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_READ, file.seek(0));
+		if (EASYWIFI_DRIVER(DRIVER_STORAGE_READ, file.available()))
+			size = EASYWIFI_DRIVER(DRIVER_STORAGE_READ, file.read(buffer, sizeof(buffer)));
+	}
+	EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
+
+	uint32_t crc = 0;
+	for (int i = 0; i < 4; i++)
+		crc |= (uint32_t)buffer[RECONNECT_CRC + i] << (8 * i);
+	if (size != RECONNECT_FILE_SIZE || memcmp(buffer, RECONNECT_MAGIC, sizeof(RECONNECT_MAGIC)) != 0
+		|| buffer[4] != RECONNECT_FILE_VERSION || buffer[5] == 0 || buffer[5] >= CREDENTIALS_SSID_SIZE
+		|| crc != Crc32(buffer, RECONNECT_CRC))
 	{
-		#ifdef Debug_On
-			Serial.println("* Cant write Credentials");
-		#endif  
-		file.close();
+		EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_RECONNECT_INVALID, 0, 0);
+		return false;
+	}
+
+	memcpy(cache.ssid, buffer + 6, buffer[5]);
+	cache.ssid[buffer[5]] = 0;
+	memcpy(cache.bssid, buffer + RECONNECT_BSSID, 6);
+	cache.localIP = ReadAddress(buffer + RECONNECT_ADDRESSES);
+	cache.gateway = ReadAddress(buffer + RECONNECT_ADDRESSES + 4);
+	cache.dns = ReadAddress(buffer + RECONNECT_ADDRESSES + 8);
+	cache.subnet = ReadAddress(buffer + RECONNECT_ADDRESSES + 12);
+	G_CachedReconnect = cache;
+	G_ReconnectCacheState = 2;
+	return true;
+}
+
+/* Replace the reconnect cache with one erase and one write */
+byte CredentialsHandler::WriteReconnectCache(const WiFiReconnectCache& cache)
+{
+	uint8_t buffer[RECONNECT_FILE_SIZE];
+	uint8_t ssidLength = strlen(cache.ssid);
+	if (ssidLength >= CREDENTIALS_SSID_SIZE)
 		return(0);
+	memset(buffer, 0, sizeof(buffer));
+	memcpy(buffer, RECONNECT_MAGIC, sizeof(RECONNECT_MAGIC));
+	buffer[4] = RECONNECT_FILE_VERSION;
+	buffer[5] = ssidLength;
+	memcpy(buffer + 6, cache.ssid, ssidLength);
+	memcpy(buffer + RECONNECT_BSSID, cache.bssid, 6);
+	WriteAddress(buffer + RECONNECT_ADDRESSES, cache.localIP);
+	WriteAddress(buffer + RECONNECT_ADDRESSES + 4, cache.gateway);
+	WriteAddress(buffer + RECONNECT_ADDRESSES + 8, cache.dns);
+	WriteAddress(buffer + RECONNECT_ADDRESSES + 12, cache.subnet);
+	uint32_t crc = Crc32(buffer, RECONNECT_CRC);
+	for (int i = 0; i < 4; i++)
+		buffer[RECONNECT_CRC + i] = (uint8_t)(crc >> (8 * i));
+
+	G_StoreStats.writeOpens++;
+	WiFiStorageFile file = EASYWIFI_DRIVER(DRIVER_STORAGE_OPEN, WiFiStorage.open(RECONNECT_FILE));
+	if (EASYWIFI_DRIVER(DRIVER_STORAGE_EXISTS, (bool)file))
+	{
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_ERASE, file.erase());
+		G_StoreStats.erases++;
 	}
+	int c = EASYWIFI_DRIVER(DRIVER_STORAGE_WRITE, file.write(buffer, sizeof(buffer)));
+	EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
+	G_StoreStats.bytesWritten += c;
+	G_CachedReconnect = cache;
+	G_ReconnectCacheState = (c == RECONNECT_FILE_SIZE) ? 2 : 0;
+	EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_RECONNECT_WRITTEN, c, 0);
+	return (c == RECONNECT_FILE_SIZE) ? 1 : 0;
+}
+
+/* Drop the reconnect cache, the next connect takes the DHCP path */
+byte CredentialsHandler::EraseReconnectCache()
+{
+	G_ReconnectCacheState = 1;
+	G_StoreStats.writeOpens++;
+	WiFiStorageFile file = EASYWIFI_DRIVER(DRIVER_STORAGE_OPEN, WiFiStorage.open(RECONNECT_FILE));
+	if (EASYWIFI_DRIVER(DRIVER_STORAGE_EXISTS, (bool)file))
+	{
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_ERASE, file.erase());
+		G_StoreStats.erases++;
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
+		return(1);
+	}
+	EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
+	return(0);
 }
 
 /* Erase credentials in flkash file */
 byte CredentialsHandler::Erase_Credentials()
 {
-	char empty[16] = "0empty0o0empty0";
-	WiFiStorageFile file = WiFiStorage.open(CREDENTIAL_FILE);
-	if (file)
+	EraseReconnectCache();
+
+	G_StoreStats.writeOpens++;
+	WiFiStorageFile file = EASYWIFI_DRIVER(DRIVER_STORAGE_OPEN, WiFiStorage.open(CREDENTIAL_FILE));
+	G_JournalSize = 0;
+	G_StoreSalt = 0;
+	G_StoreSaltValid = false; // the sequence starts over after a reset, the key of the next store differs
+	G_CachedCount = 0;
+	G_CacheValid = true;
+	if (EASYWIFI_DRIVER(DRIVER_STORAGE_EXISTS, (bool)file))
 	{
-		file.seek(0);
-		file.write(empty, 16); //overwrite flash
-		file.erase();
-		#ifdef Debug_On
-			Serial.println("* Erased Credentialsfile : ");
-		#endif  
-		file.close(); return(1);
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_ERASE, file.erase()); // records are encrypted, no need to overwrite them first
+		G_StoreStats.erases++;
+		EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_CREDENTIALS_ERASED, 0, 0);
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close()); return(1);
 	}
 	else
 	{
-		#ifdef Debug_On
-			Serial.println("* Could not erased Credentialsfile : ");
-		#endif  
-		file.close();
+		EASYWIFI_LOG(LOG_LEVEL_ERROR, EVENT_CREDENTIALS_ERASE_FAILED, 0, 0);
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
 		return(0);
 	}
 }
 
-/* Check credentials file */
+/* Check credentials file, answered from RAM once the store is loaded and holds networks */
 byte CredentialsHandler::Check_Credentials()
 {
-	WiFiStorageFile file = WiFiStorage.open(CREDENTIAL_FILE);
-	if (file)
+	if (G_CacheValid && G_CachedCount > 0)
 	{
-		#ifdef Debug_On
-			Serial.println("* Found Credentialsfile : ");
-		#endif  
-		file.close();
+		G_StoreStats.cacheHits++;
+		return(1);
+	}
+	G_StoreStats.readOpens++;
+	WiFiStorageFile file = EASYWIFI_DRIVER(DRIVER_STORAGE_OPEN, WiFiStorage.open(CREDENTIAL_FILE));
+	if (EASYWIFI_DRIVER(DRIVER_STORAGE_EXISTS, (bool)file))
+	{
+		EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_CREDENTIALS_FOUND, 0, 0);
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
 		return(1);
 	}
 	else
 	{
-		#ifdef Debug_On
-			Serial.println("* Could not find Credentialsfile : ");
-		#endif  
-		file.close();
+		EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_CREDENTIALS_MISSING, 0, 0);
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
 		return(0);
 	}
 }
 
-/* Simple DeCyphering the text code */
-void CredentialsHandler::SimpleDecypher(char* textin, char* textout)
+/* Copy the stored networks into networks (CREDENTIALS_MAX_NETWORKS entries), from RAM once loaded.
+   Returns the number of networks */
+int CredentialsHandler::GetNetworks(WiFiNetworkCredentials* networks)
 {
-	int c, t = 0;
-	while (textin[t] != 0)
+	if (G_CacheValid)
 	{
-		textout[t] = textin[t] - SEED % 17 + t % 7;
-		t++;
+		G_StoreStats.cacheHits++;
 	}
-	textout[t] = 0;
-	#ifdef Debug_On
-	// Serial.print("* Decyphered ");Serial.print(t);Serial.print(" - ");Serial.println(textout);
-	#endif
+	else
+	{
+		G_StoreStats.cacheMisses++;
+		G_CachedCount = LoadStore(G_CachedNetworks);
+		G_CacheValid = true;
+	}
+	for (int i = 0; i < G_CachedCount; i++)
+		networks[i] = G_CachedNetworks[i];
+	return G_CachedCount;
+}
+
+/* Forget the RAM copy of the store and the reconnect cache, the next access reads flash.
+   Needed only if the files were changed behind the back of CredentialsHandler */
+void CredentialsHandler::Invalidate()
+{
+	G_CacheValid = false;
+	G_ReconnectCacheState = 0;
+}
+
+// Write through: networks is what the store holds after a successful write
+void CredentialsHandler::UpdateCache(WiFiNetworkCredentials* networks, int count, boolean written)
+{
+	if (!written)
+	{
+		G_CacheValid = false;
+		return;
+	}
+	for (int i = 0; i < count; i++)
+		G_CachedNetworks[i] = networks[i];
+	G_CachedCount = count;
+	G_CacheValid = true;
 }
 
-/* Simple Cyphering the text code */
-void CredentialsHandler::SimpleCypher(char* textin, char* textout)
+/* Replay the credentials journal into networks (CREDENTIALS_MAX_NETWORKS entries), records failing
+   authentication are skipped. Older formats are migrated. Returns the number of networks read */
+int CredentialsHandler::LoadStore(WiFiNetworkCredentials* networks)
 {
-	int c, t = 0;
-	while (textin[t] != 0)
+	uint8_t header[CREDENTIAL_HEADER_SIZE];
+	int size = 0, count = 0;
+	G_CredentialSequence = 0;
+	G_JournalSize = 0;
+	G_StoreSalt = 0;
+	G_StoreSaltValid = false;
+	G_StoreStats.readOpens++;
+	WiFiStorageFile file = EASYWIFI_DRIVER(DRIVER_STORAGE_OPEN, WiFiStorage.open(CREDENTIAL_FILE));
+	if (EASYWIFI_DRIVER(DRIVER_STORAGE_EXISTS, (bool)file))
+	{
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_READ, file.seek(0));
+		size = EASYWIFI_DRIVER(DRIVER_STORAGE_READ, file.size());
+		if (size >= CREDENTIAL_HEADER_SIZE)
+			EASYWIFI_DRIVER(DRIVER_STORAGE_READ, file.read(header, CREDENTIAL_HEADER_SIZE));
+	}
+	if (size <= 0)
+	{
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
+		return 0;
+	}
+
+	if (size < CREDENTIAL_HEADER_SIZE || memcmp(header, CREDENTIAL_MAGIC, sizeof(CREDENTIAL_MAGIC)) != 0
+		|| header[4] == CREDENTIAL_V1_VERSION)
+	{
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
+		return LoadOldFormat(networks);
+	}
+	if (header[4] != CREDENTIAL_FILE_VERSION || header[5] != CREDENTIAL_RECORD_SIZE)
+	{
+		EASYWIFI_LOG(LOG_LEVEL_ERROR, EVENT_CREDENTIALS_VERSION, header[4], 0);
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
+		return 0;
+	}
+
+	for (int i = 0; i < 4; i++)
+		G_CredentialSequence |= (uint32_t)header[8 + i] << (8 * i);
+	G_StoreSalt = header[6] | (header[7] << 8);
+	G_StoreSaltValid = true;
+	G_JournalSize = CREDENTIAL_HEADER_SIZE;
+
+	uint8_t key[CHACHAPOLY_KEY_SIZE];
+	uint8_t record[CREDENTIAL_RECORD_SIZE];
+	WiFiNetworkCredentials network;
+	DeriveKey(key);
+	while (G_JournalSize + CREDENTIAL_RECORD_SIZE <= (uint32_t)size
+		&& EASYWIFI_DRIVER(DRIVER_STORAGE_READ, file.read(record, CREDENTIAL_RECORD_SIZE)) == CREDENTIAL_RECORD_SIZE)
 	{
-		textout[t] = textin[t] + SEED % 17 - t % 7;
+		uint32_t sequence = 0;
+		for (int i = 0; i < 4; i++)
+			sequence |= (uint32_t)record[CREDENTIAL_RECORD_NONCE + i] << (8 * i);
+		if (sequence > G_CredentialSequence)
+			G_CredentialSequence = sequence; // also from records failing authentication, so no nonce comes back
+
+		if (DecodeRecord(key, record, network))
+		{
+			Replay(networks, count, network, record[0]);
+		}
+		else
+		{
+			EASYWIFI_LOG(LOG_LEVEL_WARN, EVENT_CREDENTIALS_CORRUPT, G_JournalSize, 0);
+		}
+		G_JournalSize += CREDENTIAL_RECORD_SIZE;
+	}
+	EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
+	memset(key, 0, sizeof(key));
+	if (G_JournalSize != (uint32_t)size)
+		G_JournalSize = 0; // a record cut short, the firmware appends after it: the next change compacts
+	return count;
+}
+
+// Apply one journal record to the live networks
+void CredentialsHandler::Replay(WiFiNetworkCredentials* networks, int& count, WiFiNetworkCredentials& network, uint8_t flags)
+{
+	int index = -1;
+	for (int i = 0; i < count; i++)
+	{
+		if (strcmp(networks[i].ssid, network.ssid) == 0)
+			index = i;
+	}
+	if (flags & CREDENTIAL_RECORD_REMOVED)
+	{
+		if (index >= 0)
+		{
+			for (int t = index; t < count - 1; t++)
+				networks[t] = networks[t + 1];
+			count--;
+		}
+		return;
+	}
+	if (index < 0)
+	{
+		if (count < CREDENTIALS_MAX_NETWORKS)
+		{
+			index = count++;
+		}
+		else
+		{
+			index = 0;
+			for (int i = 1; i < count; i++)
+			{
+				if (IsPreferred(networks[index], networks[i]))
+					index = i;
+			}
+		}
+	}
+	networks[index] = network;
+}
+
+/* Persist one change: append its record, or compact once the journal would grow past CREDENTIALS_JOURNAL_RECORDS.
+   networks holds the live networks after the change. Returns 0 on failure */
+byte CredentialsHandler::Commit(WiFiNetworkCredentials* networks, int count, WiFiNetworkCredentials& changed, uint8_t flags)
+{
+	if (G_JournalSize < CREDENTIAL_HEADER_SIZE || G_JournalSize + CREDENTIAL_RECORD_SIZE > CREDENTIAL_JOURNAL_SIZE)
+		return Compact(networks, count);
+
+	uint8_t key[CHACHAPOLY_KEY_SIZE];
+	uint8_t record[CREDENTIAL_RECORD_SIZE];
+	DeriveKey(key);
+	EncodeRecord(key, changed, flags, record);
+	memset(key, 0, sizeof(key));
+
+	G_StoreStats.writeOpens++;
+	WiFiStorageFile file = EASYWIFI_DRIVER(DRIVER_STORAGE_OPEN, WiFiStorage.open(CREDENTIAL_FILE));
+	EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_READ, file.seek(G_JournalSize));
+	int c = EASYWIFI_DRIVER(DRIVER_STORAGE_WRITE, file.write(record, CREDENTIAL_RECORD_SIZE)); // one contiguous write, nothing is erased
+	EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
+	G_StoreStats.appends++;
+	G_StoreStats.bytesWritten += c;
+	EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_CREDENTIALS_APPENDED, G_JournalSize, 0);
+	if (c != CREDENTIAL_RECORD_SIZE)
+	{
+		G_JournalSize = 0; // unknown state, the next change compacts
+		UpdateCache(networks, count, false);
+		return 0;
+	}
+	G_JournalSize += CREDENTIAL_RECORD_SIZE;
+	UpdateCache(networks, count, true);
+	return (flags & CREDENTIAL_RECORD_REMOVED) ? 1 : count;
+}
+
+/* Rewrite the journal with the live networks only: one erase and one write */
+byte CredentialsHandler::Compact(WiFiNetworkCredentials* networks, int count)
+{
+	uint8_t buffer[CREDENTIAL_FILE_SIZE];
+	uint8_t key[CHACHAPOLY_KEY_SIZE];
+	int size = CREDENTIAL_HEADER_SIZE + count * CREDENTIAL_RECORD_SIZE;
+	memcpy(buffer, CREDENTIAL_MAGIC, sizeof(CREDENTIAL_MAGIC));
+	buffer[4] = CREDENTIAL_FILE_VERSION;
+	buffer[5] = CREDENTIAL_RECORD_SIZE;
+	if (!G_StoreSaltValid)
+	{
+		uint8_t salt[2];
+		RandomBytes(salt, sizeof(salt), true);
+		G_StoreSalt = salt[0] | (salt[1] << 8);
+		G_StoreSaltValid = true;
+	}
+	buffer[6] = (uint8_t)G_StoreSalt;
+	buffer[7] = (uint8_t)(G_StoreSalt >> 8);
+	for (int i = 0; i < 4; i++)
+		buffer[8 + i] = (uint8_t)(G_CredentialSequence >> (8 * i));
+	DeriveKey(key);
+	for (int i = 0; i < count; i++)
+		EncodeRecord(key, networks[i], 0, buffer + CREDENTIAL_HEADER_SIZE + i * CREDENTIAL_RECORD_SIZE);
+	memset(key, 0, sizeof(key));
+
+	G_StoreStats.writeOpens++;
+	WiFiStorageFile file = EASYWIFI_DRIVER(DRIVER_STORAGE_OPEN, WiFiStorage.open(CREDENTIAL_FILE));
+	if (EASYWIFI_DRIVER(DRIVER_STORAGE_EXISTS, (bool)file))
+	{
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_ERASE, file.erase());     // erase content before writing
+		G_StoreStats.erases++;
+	}
+	int c = EASYWIFI_DRIVER(DRIVER_STORAGE_WRITE, file.write(buffer, size));
+	EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
+	G_StoreStats.compactions++;
+	G_StoreStats.bytesWritten += c;
+	G_JournalSize = (c == size) ? size : 0;
+	UpdateCache(networks, count, c == size);
+	EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_CREDENTIALS_COMPACTED, c, 0);
+	return (c == size) ? ((count > 0) ? count : 1) : 0;
+}
+
+/* Read a store written before the journal and rewrite it: version 1 records or the text format of version 1.4.2 */
+int CredentialsHandler::LoadOldFormat(WiFiNetworkCredentials* networks)
+{
+	uint8_t buffer[CREDENTIAL_V1_FILE_SIZE];
+	int size = 0, count = 0;
+	G_StoreStats.readOpens++;
+	WiFiStorageFile file = EASYWIFI_DRIVER(DRIVER_STORAGE_OPEN, WiFiStorage.open(CREDENTIAL_FILE));
+	if (EASYWIFI_DRIVER(DRIVER_STORAGE_EXISTS, (bool)file))
+	{
+		EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_READ, file.seek(0));
+		if (EASYWIFI_DRIVER(DRIVER_STORAGE_READ, file.available()))
+			size = EASYWIFI_DRIVER(DRIVER_STORAGE_READ, file.read(buffer, sizeof(buffer))); // whole store in one read
+	}
+	EASYWIFI_DRIVER_VOID(DRIVER_STORAGE_OPEN, file.close());
+
+	if (size >= CREDENTIAL_V1_HEADER_SIZE && memcmp(buffer, CREDENTIAL_MAGIC, sizeof(CREDENTIAL_MAGIC)) == 0)
+	{
+		if (buffer[5] != CREDENTIAL_V1_RECORD_SIZE)
+			return 0;
+		for (int offset = CREDENTIAL_V1_HEADER_SIZE; offset + CREDENTIAL_V1_RECORD_SIZE <= size; offset += CREDENTIAL_V1_RECORD_SIZE)
+		{
+			if (DecodeRecordV1(buffer + offset, networks[count]))
+				count++;
+		}
+	}
+	else if (size > 0)
+	{
+		count = LoadLegacy(buffer, size, networks);
+	}
+
+	if (count > 0)
+	{
+		EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_CREDENTIALS_MIGRATED, 0, 0);
+		Compact(networks, count);
+	}
+	return count;
+}
+
+/* Parse the text format of version 1.4.2: cyphered ssid, 0x01, cyphered password, 0x00 */
+int CredentialsHandler::LoadLegacy(uint8_t* buffer, int size, WiFiNetworkCredentials* networks)
+{
+	char field[CREDENTIAL_LEGACY_FIELD + 1];
+	int t = 0, u = 0;
+	while (t < size && buffer[t] != 1 && u < CREDENTIAL_LEGACY_FIELD) // read ID until comma
+		field[u++] = buffer[t++];
+	field[u] = 0;
+	SimpleDecypher(field, networks[0].ssid, strlen(field));
+	while (t < size && buffer[t] != 1) // skip the rest of the field
 		t++;
+	t++;
+	u = 0;
+	while (t < size && buffer[t] != 0 && u < CREDENTIAL_LEGACY_FIELD) // read till zero
+		field[u++] = buffer[t++];
+	field[u] = 0;
+	SimpleDecypher(field, networks[0].password, strlen(field));
+	if (networks[0].ssid[0] == 0)
+		return 0;
+
+	networks[0].priority = CREDENTIALS_DEFAULT_PRIORITY;
+	networks[0].lastSuccess = 0;
+	return 1;
+}
+
+// Flash traffic and RAM cache use of the credential and reconnect cache files since power up
+WiFiCredentialStoreStats CredentialsHandler::GetStoreStats()
+{
+	return G_StoreStats;
+}
+
+/* Seal one network: the plain fields (flags .. lastSuccess) are authenticated, ssid and password
+   zero padded to their full size and encrypted, so neither length nor stale buffer bytes leak */
+void CredentialsHandler::EncodeRecord(const uint8_t* key, WiFiNetworkCredentials& network, uint8_t flags, uint8_t* record)
+{
+	uint8_t ssidLength = strlen(network.ssid);
+	uint8_t passLength = strlen(network.password);
+	memset(record, 0, CREDENTIAL_RECORD_SIZE);
+	record[0] = CREDENTIAL_RECORD_VALID | flags;
+	record[1] = network.priority;
+	record[2] = ssidLength;
+	record[3] = passLength;
+	for (int i = 0; i < 4; i++)
+		record[4 + i] = (uint8_t)(network.lastSuccess >> (8 * i));
+
+	// nonce: record sequence, random
+	uint8_t* nonce = record + CREDENTIAL_RECORD_NONCE;
+	G_CredentialSequence++; // a nonce is never used twice with the same key
+	for (int i = 0; i < 4; i++)
+		nonce[i] = (uint8_t)(G_CredentialSequence >> (8 * i));
+	RandomBytes(nonce + 4, CHACHAPOLY_NONCE_SIZE - 4, false);
+
+	memcpy(record + CREDENTIAL_RECORD_SSID, network.ssid, ssidLength);
+	memcpy(record + CREDENTIAL_RECORD_PASS, network.password, passLength);
+	ChaChaPoly::Encrypt(key, nonce, record, CREDENTIAL_RECORD_AAD, record + CREDENTIAL_RECORD_SSID,
+		CREDENTIALS_SSID_SIZE + CREDENTIALS_PASS_SIZE, record + CREDENTIAL_RECORD_TAG);
+}
+
+boolean CredentialsHandler::DecodeRecord(const uint8_t* key, uint8_t* record, WiFiNetworkCredentials& network)
+{
+	if (!(record[0] & CREDENTIAL_RECORD_VALID) || record[2] == 0 || record[2] >= CREDENTIALS_SSID_SIZE
+		|| record[3] >= CREDENTIALS_PASS_SIZE)
+		return false;
+	if (!ChaChaPoly::Decrypt(key, record + CREDENTIAL_RECORD_NONCE, record, CREDENTIAL_RECORD_AAD, record + CREDENTIAL_RECORD_SSID,
+		CREDENTIALS_SSID_SIZE + CREDENTIALS_PASS_SIZE, record + CREDENTIAL_RECORD_TAG))
+		return false; // corrupt, tampered or sealed with another key
+
+	network.priority = record[1];
+	network.lastSuccess = 0;
+	for (int i = 0; i < 4; i++)
+		network.lastSuccess |= (uint32_t)record[4 + i] << (8 * i);
+	memcpy(network.ssid, record + CREDENTIAL_RECORD_SSID, record[2]);
+	network.ssid[record[2]] = 0;
+	memcpy(network.password, record + CREDENTIAL_RECORD_PASS, record[3]);
+	network.password[record[3]] = 0;
+	memset(record + CREDENTIAL_RECORD_SSID, 0, CREDENTIALS_SSID_SIZE + CREDENTIALS_PASS_SIZE);
+	return true;
+}
+
+/* Record of the CRC protected store version 1 */
+boolean CredentialsHandler::DecodeRecordV1(uint8_t* record, WiFiNetworkCredentials& network)
+{
+	uint32_t crc = 0;
+	for (int i = 0; i < 4; i++)
+		crc |= (uint32_t)record[CREDENTIAL_V1_RECORD_CRC + i] << (8 * i);
+	if (crc != Crc32(record, CREDENTIAL_V1_RECORD_CRC) || !(record[0] & CREDENTIAL_RECORD_VALID)
+		|| record[2] == 0 || record[2] >= CREDENTIALS_SSID_SIZE || record[3] >= CREDENTIALS_PASS_SIZE)
+		return false;
+
+	network.priority = record[1];
+	network.lastSuccess = 0;
+	for (int i = 0; i < 4; i++)
+		network.lastSuccess |= (uint32_t)record[4 + i] << (8 * i);
+	SimpleDecypher((char*)record + CREDENTIAL_V1_RECORD_SSID, network.ssid, record[2]);
+	SimpleDecypher((char*)record + CREDENTIAL_V1_RECORD_SSID + CREDENTIALS_SSID_SIZE, network.password, record[3]);
+	return true;
+}
+
+/* Record key: ChaCha20 block over the serial number of the SAMD21 or SAMD51, the NINA MAC address, the seed and
+   the store salt. The serial number lives in the MCU, so a copy of the NINA flash alone does not open the store */
+void CredentialsHandler::DeriveKey(uint8_t* key)
+{
+	uint8_t material[CHACHAPOLY_KEY_SIZE];
+	uint32_t block[16];
+	memset(material, 0, sizeof(material));
+	#ifdef CREDENTIAL_SERIAL_WORDS
+		const uint32_t serial[4] = { CREDENTIAL_SERIAL_WORDS };
+		for (int i = 0; i < 4; i++)
+		{
+			uint32_t word = *(const volatile uint32_t*)serial[i];
+			for (int b = 0; b < 4; b++)
+				material[4 * i + b] = (uint8_t)(word >> (8 * b));
+		}
+	#endif
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_INFO, WiFi.macAddress(material + 16));
+	for (int i = 0; i < 4; i++)
+		material[22 + i] = (uint8_t)((uint32_t)SEED >> (8 * i));
+	memcpy(material + 26, "EWCS", 4);
+	material[30] = (uint8_t)G_StoreSalt;
+	material[31] = (uint8_t)(G_StoreSalt >> 8);
+
+	ChaChaPoly::Block(material, 0, (const uint8_t*)"EasyWiFi-key", block);
+	for (int i = 0; i < 8; i++)
+	{
+		for (int b = 0; b < 4; b++)
+			key[4 * i + b] = (uint8_t)(block[i] >> (8 * b));
 	}
-	textout[t] = 0;
-	#ifdef Debug_On
-	// Serial.print("* Cyphered ");Serial.print(t);Serial.print(" - ");Serial.println(textout);
+	memset(material, 0, sizeof(material));
+	memset(block, 0, sizeof(block));
+}
+
+/* Mix data into the entropy pool: XOR it in, then a ChaCha20 block keyed with the pool replaces the pool.
+   EasyWiFi feeds the RSSI values and the duration of every scan */
+void CredentialsHandler::AddEntropy(const void* data, size_t length)
+{
+	const uint8_t* bytes = (const uint8_t*)data;
+	uint32_t block[16];
+	while (length > 0)
+	{
+		size_t chunk = (length < CHACHAPOLY_KEY_SIZE) ? length : CHACHAPOLY_KEY_SIZE;
+		for (size_t i = 0; i < chunk; i++)
+			G_EntropyPool[i] ^= bytes[i];
+		ChaChaPoly::Block(G_EntropyPool, 0, (const uint8_t*)"EasyWiFi-mix", block);
+		for (int i = 0; i < 8; i++)
+		{
+			for (int b = 0; b < 4; b++)
+				G_EntropyPool[4 * i + b] = (uint8_t)(block[i] >> (8 * b));
+		}
+		bytes += chunk;
+		length -= chunk;
+	}
+	memset(block, 0, sizeof(block));
+}
+
+/* Random bytes for salts and nonces, drawn from the entropy pool after stirring in fresh samples: the TRNG
+   of the SAMD51 where there is one, else the time, the RSSI and the timing of those SPI round trips to the
+   module, read on the first draw of a boot and for every salt. random() and micros() alone repeat */
+void CredentialsHandler::RandomBytes(uint8_t* out, size_t length, boolean sampleModule)
+{
+	uint32_t sample[8];
+	uint32_t block[16];
+	memset(sample, 0, sizeof(sample));
+	#if defined(TRNG) && defined(MCLK_APBCMASK_TRNG)
+		MCLK->APBCMASK.reg |= MCLK_APBCMASK_TRNG;
+		TRNG->CTRLA.reg = TRNG_CTRLA_ENABLE;
+		for (int i = 0; i < 8; i++)
+		{
+			while (!(TRNG->INTFLAG.reg & TRNG_INTFLAG_DATARDY))
+				;
+			sample[i] = TRNG->DATA.reg;
+		}
+		TRNG->CTRLA.reg = 0;
 	#endif
+	if (sampleModule || G_EntropyDraws == 0)
+	{
+		uint32_t start = micros();
+		sample[0] ^= EASYWIFI_DRIVER(DRIVER_WIFI_INFO, WiFi.getTime());
+		sample[1] ^= micros() - start;
+		sample[2] ^= (uint32_t)EASYWIFI_DRIVER(DRIVER_WIFI_RSSI, WiFi.RSSI());
+		sample[3] ^= micros() - start;
+		sample[4] ^= millis();
+	}
+	sample[7] ^= micros();
+	AddEntropy(sample, sizeof(sample));
+
+	while (length > 0)
+	{
+		ChaChaPoly::Block(G_EntropyPool, ++G_EntropyDraws, (const uint8_t*)"EasyWiFi-rnd", block);
+		size_t chunk = (length < 32) ? length : 32;
+		for (size_t i = 0; i < chunk; i++)
+			out[i] = (uint8_t)(block[i / 4] >> (8 * (i % 4)));
+		// the second half replaces the pool, so the bytes handed out cannot be computed from it
+		for (int i = 0; i < 8; i++)
+		{
+			for (int b = 0; b < 4; b++)
+				G_EntropyPool[4 * i + b] = (uint8_t)(block[8 + i] >> (8 * b));
+		}
+		out += chunk;
+		length -= chunk;
+	}
+	memset(sample, 0, sizeof(sample));
+	memset(block, 0, sizeof(block));
+}
+
+void CredentialsHandler::WriteAddress(uint8_t* buffer, const IPAddress& address)
+{
+	for (int i = 0; i < 4; i++)
+		buffer[i] = address[i];
 }
 
+IPAddress CredentialsHandler::ReadAddress(const uint8_t* buffer)
+{
+	return IPAddress(buffer[0], buffer[1], buffer[2], buffer[3]);
+}
+
+// CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320), bitwise to keep the table out of flash
+uint32_t CredentialsHandler::Crc32(const uint8_t* data, size_t length)
+{
+	uint32_t crc = 0xFFFFFFFF;
+	for (size_t i = 0; i < length; i++)
+	{
+		crc ^= data[i];
+		for (int b = 0; b < 8; b++)
+			crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+	}
+	return ~crc;
+}
+
+/* Simple DeCyphering of the formats before version 2, textout gets length characters and a closing 0 */
+void CredentialsHandler::SimpleDecypher(const char* textin, char* textout, int length)
+{
+	int t;
+	for (t = 0; t < length; t++)
+	{
+		textout[t] = textin[t] - SEED % 17 + t % 7;
+	}
+	textout[t] = 0;
+}
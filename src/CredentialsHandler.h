@@ -3,9 +3,49 @@
 #ifndef _CREDENTIALSHANDLER_h
 #define _CREDENTIALSHANDLER_h
 
-#include "arduino.h"
+#include <Arduino.h>
 #include <WiFiNINA.h>
 #include <WiFiUdp.h>
+#include "EasyWiFiConfig.h"
+
+#define CREDENTIALS_SSID_SIZE 33          // SSID, max 32 characters + 0
+#define CREDENTIALS_PASS_SIZE 64          // WPA passphrase, max 63 characters + 0
+#define CREDENTIALS_DEFAULT_PRIORITY 100  // Priority of networks entered in the portal
+#define CREDENTIALS_JOURNAL_RECORDS 16    // Records appended to the store before it is compacted
+#define CREDENTIALS_MARK_INTERVAL 86400   // Time in s a repeated success on the most recent network is kept in RAM only
+
+// One stored network
+struct WiFiNetworkCredentials
+{
+    char ssid[CREDENTIALS_SSID_SIZE];
+    char password[CREDENTIALS_PASS_SIZE];
+    uint8_t priority;          // Higher is preferred
+    uint32_t lastSuccess;      // Unix time of the last successful connection, 0 = never
+};
+
+// Link details of the last successful connection, replayed by the fast reconnect
+struct WiFiReconnectCache
+{
+    char ssid[CREDENTIALS_SSID_SIZE];
+    uint8_t bssid[6];          // Access point the module was associated with
+    IPAddress localIP;         // DHCP lease, configured statically on the fast path
+    IPAddress gateway;
+    IPAddress dns;
+    IPAddress subnet;
+};
+
+// Flash traffic and RAM cache use of the credential store
+struct WiFiCredentialStoreStats
+{
+    unsigned long appends;       // Records appended without erase
+    unsigned long compactions;   // Journal rewrites
+    unsigned long erases;        // File erases, including the reconnect cache
+    unsigned long bytesWritten;
+    unsigned long cacheHits;     // Reads answered from RAM
+    unsigned long cacheMisses;   // Reads that loaded a file
+    unsigned long readOpens;     // Files opened to load or check
+    unsigned long writeOpens;    // Files opened to append, compact or erase
+};
 
 class CredentialsHandler
 {
@@ -16,10 +56,40 @@ public:
     static byte Write_Credentials(char* buf1, int size1, char* buf2, int size2);
     static byte Read_Credentials(char* buf1, char* buf2);
 
+    static byte AddNetwork(const char* ssid, const char* password, uint8_t priority);
+    static byte RemoveNetwork(const char* ssid);
+    static byte MarkConnected(const char* ssid, uint32_t time);
+    static int GetNetworkCount();
+    static boolean GetNetwork(int index, WiFiNetworkCredentials& network);
+    static int GetNetworks(WiFiNetworkCredentials* networks);
+    static int FindNetwork(const char* ssid);
+    static boolean IsPreferred(const WiFiNetworkCredentials& a, const WiFiNetworkCredentials& b);
+
+    static boolean ReadReconnectCache(WiFiReconnectCache& cache);
+    static byte WriteReconnectCache(const WiFiReconnectCache& cache);
+    static byte EraseReconnectCache();
+    static WiFiCredentialStoreStats GetStoreStats();
+    static void Invalidate();
+    static void AddEntropy(const void* data, size_t length);
+
 private:
-    static void SimpleDecypher(char* textin, char* textout);
-    static void SimpleCypher(char* textin, char* textout);
+    static void CopyField(char* field, size_t fieldSize, const char* buffer, int size);
+    static int LoadStore(WiFiNetworkCredentials* networks);
+    static void UpdateCache(WiFiNetworkCredentials* networks, int count, boolean written);
+    static void Replay(WiFiNetworkCredentials* networks, int& count, WiFiNetworkCredentials& network, uint8_t flags);
+    static byte Commit(WiFiNetworkCredentials* networks, int count, WiFiNetworkCredentials& changed, uint8_t flags);
+    static byte Compact(WiFiNetworkCredentials* networks, int count);
+    static int LoadOldFormat(WiFiNetworkCredentials* networks);
+    static int LoadLegacy(uint8_t* buffer, int size, WiFiNetworkCredentials* networks);
+    static void EncodeRecord(const uint8_t* key, WiFiNetworkCredentials& network, uint8_t flags, uint8_t* record);
+    static boolean DecodeRecord(const uint8_t* key, uint8_t* record, WiFiNetworkCredentials& network);
+    static boolean DecodeRecordV1(uint8_t* record, WiFiNetworkCredentials& network);
+    static void DeriveKey(uint8_t* key);
+    static void RandomBytes(uint8_t* out, size_t length, boolean sampleModule);
+    static void WriteAddress(uint8_t* buffer, const IPAddress& address);
+    static IPAddress ReadAddress(const uint8_t* buffer);
+    static uint32_t Crc32(const uint8_t* data, size_t length);
+    static void SimpleDecypher(const char* textin, char* textout, int length);
 };
 
 #endif
-
@@ -0,0 +1,105 @@
+
+#include "DnsResponder.h"
+
+// Header flag bits
+#define DNS_FLAG_QR 0x80               // byte 2: this is a response
+#define DNS_FLAG_OPCODE 0x78           // byte 2: kind of query, 0 = standard query
+#define DNS_FLAG_AA 0x04               // byte 2: authoritative answer
+#define DNS_FLAG_RD 0x01               // byte 2: recursion desired, copied from the query
+#define DNS_FLAG_RA 0x80               // byte 3: recursion available
+
+#define DNS_RCODE_FORMERR 1
+#define DNS_RCODE_NOTIMP 4
+
+#define DNS_TYPE_A 1
+#define DNS_TYPE_ANY 255
+#define DNS_CLASS_IN 1
+
+/* Turn the query in packet into its reply, in place.
+   A and ANY queries are answered with ip, all other types (AAAA, HTTPS, ...) get an empty NOERROR answer
+   so the client does not wait for them. Returns the reply length, or 0 if the packet must be dropped. */
+size_t DnsResponder::BuildReply(uint8_t* packet, size_t length, size_t capacity, IPAddress ip)
+{
+	if (length < DNS_HEADER_SIZE || capacity < DNS_HEADER_SIZE)
+		return 0; // not even a header
+	if (packet[2] & DNS_FLAG_QR)
+		return 0; // a response, never answer those
+	if (packet[2] & DNS_FLAG_OPCODE)
+		return BuildErrorReply(packet, DNS_RCODE_NOTIMP);
+	if (packet[4] != 0 || packet[5] != 1)
+		return BuildErrorReply(packet, DNS_RCODE_FORMERR); // exactly one question is supported
+
+	// Walk the QNAME labels, bounded by the packet and the max name size
+	size_t position = DNS_HEADER_SIZE;
+	for (;;)
+	{
+		if (position >= length || position - DNS_HEADER_SIZE >= DNS_MAX_NAME_SIZE)
+			return BuildErrorReply(packet, DNS_RCODE_FORMERR);
+		uint8_t labelLength = packet[position];
+		if (labelLength == 0)
+			break;
+		if (labelLength & 0xC0)
+			return BuildErrorReply(packet, DNS_RCODE_FORMERR); // no compression pointers in a question
+		position += labelLength + 1;
+	}
+	position++; // zero length root label
+
+	// QTYPE and QCLASS
+	if (position + 4 > length)
+		return BuildErrorReply(packet, DNS_RCODE_FORMERR);
+	uint16_t type = (packet[position] << 8) | packet[position + 1];
+	uint16_t dnsClass = (packet[position + 2] << 8) | packet[position + 3];
+	position += 4;
+
+	boolean answer = (dnsClass == DNS_CLASS_IN) && (type == DNS_TYPE_A || type == DNS_TYPE_ANY);
+	if (position + (answer ? DNS_ANSWER_SIZE : 0) > capacity)
+		return 0;
+
+	// Header: keep the ID, authoritative response, NOERROR, additional records of the query (EDNS) are dropped
+	packet[2] = DNS_FLAG_QR | DNS_FLAG_AA | (packet[2] & DNS_FLAG_RD);
+	packet[3] = DNS_FLAG_RA;
+	SetCounts(packet, 1, answer ? 1 : 0);
+	if (!answer)
+		return position;
+
+	// Answer: name pointer to the question at offset 12, type A, class IN, TTL, 4 byte address
+	uint8_t* record = packet + position;
+	record[0] = 0xC0;
+	record[1] = DNS_HEADER_SIZE;
+	record[2] = 0;
+	record[3] = DNS_TYPE_A;
+	record[4] = 0;
+	record[5] = DNS_CLASS_IN;
+	record[6] = (DNS_ANSWER_TTL >> 24) & 0xFF;
+	record[7] = (DNS_ANSWER_TTL >> 16) & 0xFF;
+	record[8] = (DNS_ANSWER_TTL >> 8) & 0xFF;
+	record[9] = DNS_ANSWER_TTL & 0xFF;
+	record[10] = 0;
+	record[11] = 4;
+	record[12] = ip[0];
+	record[13] = ip[1];
+	record[14] = ip[2];
+	record[15] = ip[3];
+	return position + DNS_ANSWER_SIZE;
+}
+
+// Header only reply with the given error code
+size_t DnsResponder::BuildErrorReply(uint8_t* packet, uint8_t rcode)
+{
+	packet[2] = DNS_FLAG_QR | (packet[2] & (DNS_FLAG_OPCODE | DNS_FLAG_RD));
+	packet[3] = DNS_FLAG_RA | rcode;
+	SetCounts(packet, 0, 0);
+	return DNS_HEADER_SIZE;
+}
+
+void DnsResponder::SetCounts(uint8_t* packet, uint16_t questions, uint16_t answers)
+{
+	packet[4] = questions >> 8;
+	packet[5] = questions & 0xFF;
+	packet[6] = answers >> 8;
+	packet[7] = answers & 0xFF;
+	packet[8] = 0;  // NSCOUNT
+	packet[9] = 0;
+	packet[10] = 0; // ARCOUNT
+	packet[11] = 0;
+}
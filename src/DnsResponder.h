@@ -0,0 +1,25 @@
+// DnsResponder.h
+
+#ifndef _DNSRESPONDER_h
+#define _DNSRESPONDER_h
+
+#include <Arduino.h>
+#include <WiFiNINA.h>
+
+#define DNS_HEADER_SIZE 12             // DNS Header
+#define DNS_ANSWER_SIZE 16             // DNS Answer = standard set with Packet Compression
+#define DNS_ANSWER_TTL 60              // TTL in seconds of the captive portal answer, short so phones drop it after provisioning
+#define DNS_MAX_NAME_SIZE 255          // Max length of a QNAME in wire format
+
+// Captive portal DNS engine: turns a query into its reply in the receive buffer itself.
+class DnsResponder
+{
+public:
+    static size_t BuildReply(uint8_t* packet, size_t length, size_t capacity, IPAddress ip);
+
+private:
+    static size_t BuildErrorReply(uint8_t* packet, uint8_t rcode);
+    static void SetCounts(uint8_t* packet, uint16_t questions, uint16_t answers);
+};
+
+#endif
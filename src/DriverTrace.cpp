@@ -0,0 +1,110 @@
+
+#include "DriverTrace.h"
+
+#ifdef EASYWIFI_TRACE
+
+unsigned long (*DriverTrace::m_Clock)() = micros;
+DriverTraceSite DriverTrace::m_Site = DRIVER_WIFI_STATUS;
+unsigned long DriverTrace::m_Start = 0;
+DriverTraceStats DriverTrace::m_Sites[DRIVER_SITE_COUNT];
+
+void DriverTrace::Reset()
+{
+	memset(m_Sites, 0, sizeof(m_Sites));
+}
+
+// Time source in us, micros() unless replaced
+void DriverTrace::SetClock(unsigned long (*clock)())
+{
+	m_Clock = (clock != NULL) ? clock : micros;
+}
+
+// A driver call of site starts
+void DriverTrace::Begin(DriverTraceSite site)
+{
+	m_Site = site;
+	m_Start = m_Clock();
+}
+
+// The driver call started by Begin() returned
+void DriverTrace::End()
+{
+	unsigned long elapsed = m_Clock() - m_Start;
+	DriverTraceStats& stats = m_Sites[m_Site];
+	stats.calls++;
+	stats.totalTime += elapsed;
+	if (elapsed > stats.maxTime)
+		stats.maxTime = elapsed;
+
+	uint8_t bucket = 0;
+	elapsed >>= 4;
+	while (elapsed > 0 && bucket < DRIVER_TRACE_BUCKETS - 1)
+	{
+		elapsed >>= 1;
+		bucket++;
+	}
+	if (stats.latency[bucket] < 0xFFFF)
+		stats.latency[bucket]++;
+}
+
+const DriverTraceStats& DriverTrace::Get(DriverTraceSite site)
+{
+	return m_Sites[site];
+}
+
+/* One line per site that was called: calls, total, mean and max time in us, then the histogram
+   "site calls total mean max | b0 b1 ... b15". Same calls and clock give the same text */
+void DriverTrace::PrintTo(Print& out)
+{
+	out.println("site calls total_us mean_us max_us | <16us <32us ... >=262ms");
+	for (int i = 0; i < DRIVER_SITE_COUNT; i++)
+	{
+		const DriverTraceStats& stats = m_Sites[i];
+		if (stats.calls == 0)
+			continue;
+		out.print(GetSiteName((DriverTraceSite)i));
+		out.print(' '); out.print(stats.calls);
+		out.print(' '); out.print(stats.totalTime);
+		out.print(' '); out.print(stats.totalTime / stats.calls);
+		out.print(' '); out.print(stats.maxTime);
+		out.print(" |");
+		for (int b = 0; b < DRIVER_TRACE_BUCKETS; b++)
+		{
+			out.print(' ');
+			out.print(stats.latency[b]);
+		}
+		out.println();
+	}
+}
+
+const char* DriverTrace::GetSiteName(DriverTraceSite site)
+{
+	switch (site)
+	{
+	case DRIVER_WIFI_STATUS: return "wifi_status";
+	case DRIVER_WIFI_RSSI: return "wifi_rssi";
+	case DRIVER_WIFI_BEGIN: return "wifi_begin";
+	case DRIVER_WIFI_BEGIN_AP: return "wifi_begin_ap";
+	case DRIVER_WIFI_END: return "wifi_end";
+	case DRIVER_WIFI_CONFIG: return "wifi_config";
+	case DRIVER_WIFI_INFO: return "wifi_info";
+	case DRIVER_WIFI_SCAN: return "wifi_scan";
+	case DRIVER_WIFI_SCAN_ENTRY: return "wifi_scan_entry";
+	case DRIVER_LED: return "led";
+	case DRIVER_STORAGE_OPEN: return "storage_open";
+	case DRIVER_STORAGE_EXISTS: return "storage_exists";
+	case DRIVER_STORAGE_READ: return "storage_read";
+	case DRIVER_STORAGE_WRITE: return "storage_write";
+	case DRIVER_STORAGE_ERASE: return "storage_erase";
+	case DRIVER_SOCKET_SETUP: return "socket_setup";
+	case DRIVER_UDP_RECEIVE: return "udp_receive";
+	case DRIVER_UDP_SEND: return "udp_send";
+	case DRIVER_SERVER_ACCEPT: return "server_accept";
+	case DRIVER_CLIENT_READ: return "client_read";
+	case DRIVER_CLIENT_WRITE: return "client_write";
+	case DRIVER_CLIENT_STOP: return "client_stop";
+	default: return "unknown";
+	}
+}
+
+#endif
@@ -0,0 +1,89 @@
+// DriverTrace.h
+
+#ifndef _DRIVERTRACE_h
+#define _DRIVERTRACE_h
+
+#include <Arduino.h>
+
+//#define EASYWIFI_TRACE               // Count and time every WiFiNINA / WiFiDrv / WiFiStorage call, see DriverTrace::PrintTo()
+
+#define DRIVER_TRACE_BUCKETS 16          // Latency histogram buckets: <16, <32, <64 ... <262144, >=262144 us
+
+// Call sites of the module driver, grouped by the operation they issue over SPI
+enum DriverTraceSite
+{
+    DRIVER_WIFI_STATUS,         // WiFi.status()
+    DRIVER_WIFI_RSSI,           // WiFi.RSSI() of the connection
+    DRIVER_WIFI_BEGIN,          // WiFi.begin()
+    DRIVER_WIFI_BEGIN_AP,       // WiFi.beginAP()
+    DRIVER_WIFI_END,            // WiFi.end(), WiFi.disconnect()
+    DRIVER_WIFI_CONFIG,         // WiFi.config(), WiFi.setTimeout()
+    DRIVER_WIFI_INFO,           // MAC, BSSID, IP addresses, SSID and time of the connection
+    DRIVER_WIFI_SCAN,           // WiFi.scanNetworks()
+    DRIVER_WIFI_SCAN_ENTRY,     // SSID, RSSI, BSSID, channel and encryption of one scan entry
+    DRIVER_LED,                 // WiFiDrv::pinMode(), WiFiDrv::analogWrite()
+    DRIVER_STORAGE_OPEN,        // WiFiStorage.open(), close() of a storage file
+    DRIVER_STORAGE_EXISTS,      // operator bool of a storage file, WiFiStorage.exists()
+    DRIVER_STORAGE_READ,        // read(), seek(), size(), available() of a storage file
+    DRIVER_STORAGE_WRITE,       // write() to a storage file
+    DRIVER_STORAGE_ERASE,       // erase() of a storage file
+    DRIVER_SOCKET_SETUP,        // UDP / server begin() and stop()
+    DRIVER_UDP_RECEIVE,         // parsePacket(), read(), remoteIP(), remotePort()
+    DRIVER_UDP_SEND,            // beginPacket(), write(), endPacket()
+    DRIVER_SERVER_ACCEPT,       // WiFiServer::available()
+    DRIVER_CLIENT_READ,         // available(), read(), connected() of a portal client
+    DRIVER_CLIENT_WRITE,        // write() / print() to a portal client
+    DRIVER_CLIENT_STOP,         // stop() of a portal client
+    DRIVER_SITE_COUNT
+};
+
+struct DriverTraceStats
+{
+    unsigned long calls;
+    unsigned long totalTime;                    // us
+    unsigned long maxTime;                      // us
+    uint16_t latency[DRIVER_TRACE_BUCKETS];     // Calls per latency bucket, saturating
+};
+
+#ifdef EASYWIFI_TRACE
+
+/* Per call site counters and latency histograms of the module driver calls.
+   The clock defaults to micros() and can be replaced, e.g. by a virtual clock in a host build,
+   so the same sequence of calls always prints the same table. */
+class DriverTrace
+{
+public:
+    static void Reset();
+    static void SetClock(unsigned long (*clock)());
+    static void Begin(DriverTraceSite site);
+    static void End();
+    template <typename T> static T Pass(T value)
+    {
+        End();
+        return value;
+    }
+
+    static const DriverTraceStats& Get(DriverTraceSite site);
+    static void PrintTo(Print& out);
+    static const char* GetSiteName(DriverTraceSite site);
+
+private:
+    static unsigned long (*m_Clock)();
+    static DriverTraceSite m_Site;     // Site of the call in progress, driver calls do not nest
+    static unsigned long m_Start;
+    static DriverTraceStats m_Sites[DRIVER_SITE_COUNT];
+};
+
+// Value of call, counted and timed under site. The comma operator starts the clock before call is evaluated
+#define EASYWIFI_DRIVER(site, call) DriverTrace::Pass((DriverTrace::Begin(site), (call)))
+// Statement form for calls without a value
+#define EASYWIFI_DRIVER_VOID(site, call) do { DriverTrace::Begin(site); call; DriverTrace::End(); } while (0)
+
+#else
+
+#define EASYWIFI_DRIVER(site, call) (call)
+#define EASYWIFI_DRIVER_VOID(site, call) do { call; } while (0)
+
+#endif
+
+#endif
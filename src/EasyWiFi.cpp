@@ -1,1035 +1,1801 @@
-/*
-* EasyWiFi
-* Modified by Daniel Patyk May 2023 based on John V. Version 1.4.1
-* Version: 1.4.2 https://github/SirPytan/EasyWifi
-* 
-*  RGB LED INDICATOR on uBlox nina Module
-*  GREEN: Connected
-*
-*  BLUE: (Stored) Credentials found, connecting					 <<<<--_
-*  YELLOW: No Stored Credentials found, connecting					     \
-*  PURPLE: Can'i connect, opening Access Point for credentials input      |
-*  CYAN: Client connected to Access Point, wait for credentials input >>--/
-*
-*  RED: Not connected / Can'i connect, wifi.start is stopped, return to program
-*
-* Released into the public domain on github: https://github.com/javos65/EasyWifi-for-MKR1010
-*/
-
-#include "EasyWiFi.h"
-#include "CredentialsHandler.h"
-
-#define Debug_On       // Debug option  -serial print
-//#define Debug_On_X   // Debug option - incl packets
-
-char G_AccessPointName[SSID_BUFFER_SIZE] = ACCESS_POINT_NAME; // ACCESS POINT name, dynamic adaptable
-char G_SSID_List[MAX_SSID][SSID_BUFFER_SIZE];				// Store of available SSID's
-int G_AP_Status = WL_IDLE_STATUS, G_AP_InputFlag;  // global AP flag to use
-int G_SSID_Counter = 0;                           // Gloabl counter for number of found SSID's
-char G_SSID[32] = SECRET_SSID;                   // optional init: your network SSID (name) 
-char G_PASS[32] = SECRET_PASS;                   // optional init: your network password 
-WiFiServer G_AP_Webserver(80);                    // Global Acces Point Web Server
-WiFiUDP G_UDP_AP_DNS;                            // A UDP instance to let us send and receive packets over UDP
-IPAddress G_AP_IP;                                // Global Acces Point IP adress 
-IPAddress G_AP_DNS_CLIENT_IP;
-int G_DNS_ClientPort;
-int G_DNS_RequestCounter = 0;
-boolean G_UseAP = 1; // use AP after loging failure, or quit with no AP service
-boolean G_LED_On = 1; // leds on or of
-byte G_UDP_PacketBuffer[UDP_PACKET_SIZE];  // buffer to hold incoming and outgoing packets
-byte G_DNS_ReplyHeader[DNS_HEADER_SIZE] = {
-  0x00,0x00,   // ID, to be filled in #offset 0
-  0x81,0x80,   // answer header Codes
-  0x00,0x01,   //QDCOUNT = 1 question
-  0x00,0x01,   //ANCOUNT = 1 answer
-  0x00,0x00,   //NSCOUNT / ignore
-  0x00,0x00    //ARCOUNT / ignore
-};
-byte G_DNS_ReplyAnswer[DNS_ANSWER_SIZE] = {
-  0xc0,0x0c,  // pointer to pos 12 : NAME Labels
-  0x00,0x01,  // TYPE
-  0x00,0x01,  // CLASS
-  0x00,0x00,  // TTL
-  0x18,0x4c,  // TLL 2 days
-  0x00,0x04,  // RDLENGTH = 4
-  0x00,0x00,  // IP adress octets to be filled #offset 12
-  0x00,0x00   // IP adress octeds to be filled
-};
-
-// ***************************************
-
-
-EasyWiFi::EasyWiFi() {}
-
-// Login to local network  //
-void EasyWiFi::Start()
-{
-	// Early exit if already connected
-	bool alreadyConnected = !IsWifiNotConnectedOrReachable(WiFi.status());
-	if (alreadyConnected)
-	{
-		SetNINA_LED(GREEN); // Set Green  
-		#ifdef Debug_On
-			Serial.println("* Already connected."); // you're already connected
-			PrintWiFiStatus();
-		#endif
-		return;
-	}
-
-	// Read saved credentials from file
-	const byte READ_FAILED = 0;
-	if (CredentialsHandler::Read_Credentials(G_SSID, G_PASS) == READ_FAILED) // if no success use hardcoded credentials
-	{
-		SetNINA_LED(ORANGE); // no credentials found SET ORANGE
-		#ifdef Debug_On
-			Serial.println("* Using hardcoded credentials");
-		#endif
-	}
-
-	// Start while loop for finding a connection 
-	SetNINA_LED(BLUE); // Starting to connect: Set Blue  
-	int totalConnectionAttempts = 0;
-	while (IsWifiNotConnectedOrReachable(WiFi.status())) 
-	{
-		// Attempt to connect to WiFi network:
-		//totalConnectionAttempts += TryToConnectToWifiWithCredentials();   // count total failed connects     
-
-		// If connected, exit while loop
-		if (WiFi.status() == WL_CONNECTED)
-		{
-			SetNINA_LED(GREEN); // Set Green   
-			#ifdef Debug_On
-				PrintWiFiStatus(); // you're connected now, so print out the status and break while loop
-			#endif
-			break;
-		}
-		
-		if ((totalConnectionAttempts > ESCAPE_CONNECT) || (G_UseAP == false)) // quite login service?
-		{
-			SetNINA_LED(RED); // Set red 
-			#ifdef Debug_On
-				Serial.println("* Connection not possible after too many retries, quit wifi.start process");
-			#endif
-			break;
-		}
-
-		// No connection possible opening Access Point		
-		#ifdef Debug_On
-			Serial.println("* Connection not possible after several retries, opening Access Point");
-		#endif
-
-		// start direct-Wifi connect to manualy input Wifi credentials
-		SetNINA_LED(RED); // no network, : RED
-		ListNetworks();   // load avaialble networks in a list
-		AccessPointSetup();
-		SetNINA_LED(PURPLE); // start AP, : Purple
-
-		G_AP_InputFlag = 0;
-		while (!G_AP_InputFlag) // Keep AP open until input is received or until 30 seconds are over
-		{
-			UpdateDeviceConnectedStatus();
-
-			if (G_AP_Status == WL_AP_CONNECTED)  // IF client connected to AP, start DNS and check Webserver
-			{
-				AccessPointDNSScan();          // check DNS requests
-				AccessPointWiFiClientCheck_Test();  // check HTTP server Client
-			}
-		}
-		G_UDP_AP_DNS.stop(); // Close UDP connection
-		WiFi.end();
-		WiFi.disconnect();
-		SetNINA_LED(BLUE); // new credentials : BLUE
-		delay(2000);
-		
-	} //while loop until connected
-
-}
-
-
-
-// Erase credentials from disk file
-byte EasyWiFi::Erase()
-{
-	return CredentialsHandler::Erase_Credentials();
-}
-
-// Set Name of AccessPoint
-byte EasyWiFi::SetAccessPointName(char* name)
-{
-	int i = 0;
-	while (name[i] != 0)
-	{
-		G_AccessPointName[i] = name[i];
-		i++;
-		if (i >= SSID_BUFFER_SIZE)
-			break;
-	}
-	G_AccessPointName[i] = 0; // close string
-	return i;
-}
-
-// Set Seed of the Cypher, should be positive
-void EasyWiFi::SetSeed(int seed)
-{
-	CredentialsHandler::SetSeed(seed);
-}
-
-/* Set Led indicator active on or off - for low power usage*/
-void EasyWiFi::UseLED(boolean value)
-{
-	G_LED_On = value;
-}
-
-/* Set AP or no AP service*/
-void EasyWiFi::UseAccessPoint(boolean value)
-{
-	G_UseAP = value;
-}
-
-/* Set RGB led on uBlox Module R-G-B , max 128*/
-void EasyWiFi::SetNINA_LED(char r, char g, char b)
-{
-	if (G_LED_On)
-	{
-		// Set LED pin modes to output
-		WiFiDrv::pinMode(25, OUTPUT);
-		WiFiDrv::pinMode(26, OUTPUT);
-		WiFiDrv::pinMode(27, OUTPUT);
-
-		// Set all LED color 
-		WiFiDrv::analogWrite(25, g % 128);    // GREEN
-		WiFiDrv::analogWrite(26, r % 128);    // RED
-		WiFiDrv::analogWrite(27, b % 128);    // BLUE
-	}
-}
-
-// Scan for available Wifi Networks and place is Glovbal SSIDList
-void EasyWiFi::ListNetworks()
-{
-	// scan for nearby networks:
-	int foundNetworksAmount = WiFi.scanNetworks();
-	if (foundNetworksAmount == -1)
-	{
-		#ifdef Debug_On        
-			Serial.println("* Couldn't get a Wifi List");
-		#endif
-	}
-	else
-	{
-		#ifdef Debug_On    
-			Serial.print("* Found total "); Serial.print(foundNetworksAmount); Serial.println(" Networks.");
-		#endif      
-		G_SSID_Counter = 0;
-
-		String tempString;
-		// print the network number and name for each network found:
-		for (int thisNetwork = 0; thisNetwork < foundNetworksAmount; thisNetwork++)
-		{
-			if (G_SSID_Counter < MAX_SSID) // store only maximum of <SSIDMAX> SSDI's with high dB > -80 && WiFi.RSSI(thisNet) > -81
-			{
-				// Transfering the MAX_SSID amounts of network names to the global list
-				tempString = WiFi.SSID(thisNetwork);
-				int i;
-				for (i = 0; i < tempString.length(); ++i)
-				{
-					G_SSID_List[G_SSID_Counter][i] = tempString[i];
-				}
-				G_SSID_List[G_SSID_Counter][i] = 0;
-
-				#ifdef Debug_On
-					// print each network
-					Serial.print(G_SSID_Counter);
-					Serial.print(". ");
-					Serial.print(G_SSID_List[G_SSID_Counter]);
-					Serial.print("\t\tSignal: ");
-					Serial.print(WiFi.RSSI(thisNetwork));
-					Serial.println(" dBm");
-					Serial.flush();
-				#endif
-
-				G_SSID_Counter++;
-			}
-		} // end for list loop
-	}
-}
-
-/* Wifi Access Point Initialisation */
-/* Starting Webserver and UDP Server on success */
-void EasyWiFi::AccessPointSetup()
-{
-	int tries = 5;  // 5 tries to setup AccessPoint
-	
-	#ifdef Debug_On
-		Serial.print("* Creating access point named: "); Serial.println(G_AccessPointName);
-	#endif
-	
-	// Generate Access Point IP Adress and setup config
-	G_AP_IP = IPAddress((char)random(11, 172), (char)random(0, 255), (char)random(0, 255), 0x01); // Generate random IP address in private IP range
-	WiFi.end();																					 // close Wifi - just to be sure
-	delay(3000);																				 // Wait 3 seconds
-	WiFi.config(G_AP_IP, G_AP_IP, G_AP_IP, IPAddress(255, 255, 255, 0));							 // Setup config
-
-	while (tries > 0)
-	{
-		G_AP_Status = WiFi.beginAP(G_AccessPointName, ACCESS_POINT_CHANNEL); // setup AccessPoint
-		if (G_AP_Status != WL_AP_LISTENING) // if AccessPoint is not listening -> Retry
-		{
-			#ifdef Debug_On
-				Serial.print(".");
-			#endif        
-			--tries;
-			// Just to be sure, set config again
-			WiFi.config(G_AP_IP, G_AP_IP, G_AP_IP, IPAddress(255, 255, 255, 0));
-		}
-		else
-			break; // break while loop when AccessPoint is connected/listening
-	}
-
-	if (tries == 0)
-	{  
-		// not possible to connect in 5 retries
-		#ifdef Debug_On  
-			Serial.println("* Creating access point failed");
-		#endif     
-	}
-	else
-	{
-		delay(2000);
-		PrintWiFiStatus();            // you're connected now, so print out the status
-		G_UDP_AP_DNS.begin(UDP_PORT); // start the UDP server
-		G_AP_Webserver.begin();       // start the Access Point web server on port 80
-	}
-}
-
-/* DNS Routines via UDP, act on DSN requests on Port 53 */
-/* assume wifi UDP connection has been set up */
-void EasyWiFi::AccessPointDNSScan()
-{
-	int i = 0; // generic loop counter
-	int replyCounter, packetCounter;
-	unsigned int packetSize = 0;
-	unsigned int replySize = 0;
-	byte G_DNSReplybuffer[UDP_PACKET_SIZE]; // buffer to hold the send DNS reply
-
-	packetSize = G_UDP_AP_DNS.parsePacket();
-	if (packetSize) // We've received a packet, read the data from it
-	{
-		G_UDP_AP_DNS.read(G_UDP_PacketBuffer, packetSize); // read the packet into the buffer
-		G_AP_DNS_CLIENT_IP = G_UDP_AP_DNS.remoteIP();
-		G_DNS_ClientPort = G_UDP_AP_DNS.remotePort();
-
-		//if ( (G_AP_DNS_CLIENT_IP != G_APip) && (G_DNS_RequestCounter<=DNS_MAX_REQUESTS) )       // skip own requests - ie ntp-pool time requestfrom Wifi module
-		if (G_AP_DNS_CLIENT_IP != G_AP_IP) // skip own requests - ie ntp-pool time requestfrom Wifi module
-		{
-			#ifdef Debug_On_X  
-				Serial.print("DNS-packets ("); Serial.print(packetSize);
-				Serial.print(") from "); Serial.print(G_AP_DNS_CLIENT_IP);
-				Serial.print(" port "); Serial.println(G_DNS_ClientPort);
-				for (i = 0; i < packetSize; ++i)
-				{
-					Serial.print(G_UDP_PacketBuffer[i], HEX); Serial.print(":");
-				}
-				Serial.println(" ");
-				for (i = 0; i < packetSize; ++i)
-				{
-					Serial.print((char)G_UDP_PacketBuffer[i]);//Serial.print("");
-				}
-				Serial.println("");
-			#endif
-
-			//Copy Packet ID and IP into DNS header and DNS answer
-			G_DNS_ReplyHeader[0] = G_UDP_PacketBuffer[0];
-			G_DNS_ReplyHeader[1] = G_UDP_PacketBuffer[1]; // Copy ID of Packet offset 0 in Header (look at definition)
-			G_DNS_ReplyAnswer[12] = G_AP_IP[0];
-			G_DNS_ReplyAnswer[13] = G_AP_IP[1];
-			G_DNS_ReplyAnswer[14] = G_AP_IP[2];
-			G_DNS_ReplyAnswer[15] = G_AP_IP[3]; // copy Access Point Ip address offset 12 in Answer (look at definition)
-
-			replyCounter = 0;   // set reply buffer counter
-			packetCounter = 12; // set packetbuffer counter @ QUESTION QNAME section
-
-			// copy Header into reply
-			for (i = 0; i < DNS_HEADER_SIZE; ++i)
-			{
-				G_DNSReplybuffer[replyCounter++] = G_DNS_ReplyHeader[i];
-			}
-
-			// copy Qusetion into reply: Name labels until octet=0x00
-			while (G_UDP_PacketBuffer[packetCounter] != 0)
-			{
-				G_DNSReplybuffer[replyCounter++] = G_UDP_PacketBuffer[packetCounter++];
-			}
-
-			// copy end of question plus Qtype and Qclass 5 octets
-			for (i = 0; i < 5; ++i)
-			{
-				G_DNSReplybuffer[replyCounter++] = G_UDP_PacketBuffer[packetCounter++];
-			}
-
-			// copy Answer into reply
-			for (i = 0; i < DNS_ANSWER_SIZE; ++i)
-			{
-				G_DNSReplybuffer[replyCounter++] = G_DNS_ReplyAnswer[i];
-			}
-
-			replySize = replyCounter;
-
-			#ifdef Debug_On_X  
-				Serial.print("* DNS-Reply ("); Serial.print(replySize);
-				Serial.print(") from "); Serial.print(G_APip);
-				Serial.print(" port "); Serial.println(UDP_PORT);
-				for (i = 0; i < replySize; ++i)
-				{
-					Serial.print(G_DNSReplybuffer[i], HEX); Serial.print(":");
-				}
-				Serial.println(" ");
-				for (i = 0; i < replySize; ++i)
-				{
-					Serial.print((char)G_DNSReplybuffer[i]);//Serial.print("");
-				}
-				Serial.println("");
-			#endif     
-
-			// Send DSN UDP packet
-			G_UDP_AP_DNS.beginPacket(G_AP_DNS_CLIENT_IP, G_DNS_ClientPort); //reply DNS question
-			G_UDP_AP_DNS.write(G_DNSReplybuffer, replySize);
-			G_UDP_AP_DNS.endPacket();
-			G_DNS_RequestCounter++;
-
-		} // end loop correct IP
-	} // end loop received packet
-}
-
-// Check the Access Point wifi Client Responses and read the inputs on the main Access Point web-page.
-void EasyWiFi::AccessPointWiFiClientCheck()
-{
-	String PostLine = "";     // make a String to hold incoming POST-Data
-	String currentLine = "";  // make a String to hold incoming data from the client
-	char charBuffer;          // Character read buffer
-	int t, u, v, pos1, pos2;  // loop counter
-
-	WiFiClient client = G_AP_Webserver.available();  // listen for incoming clients
-	if (client) // if you get a client,
-	{
-		#ifdef Debug_On     
-			Serial.println("* New Access Point webclient");
-		#endif
-
-		while (client.connected()) // loop while the client's connected
-		{
-			if (client.available()) // if there's bytes to read from the client,
-			{
-				charBuffer = client.read(); // read a byte, then
-
-				#ifdef Debug_On  
-					// print it out the serial monitor
-					Serial.write(charBuffer);                 
-				#endif
-
-				if (charBuffer == '\n') // if the byte is a newline character
-				{
-					// if the current line is blank, you got two newline characters in a row.
-					// that's the end of the client HTTP request, so send a response:
-					if (currentLine.length() == 0)
-					{
-						// HTTP headers always start with a response code (e.g. HTTP/1.1 200 OK)
-						// and a content-type so the client knows what's coming, then a blank line:
-						client.println("HTTP/1.1 200 OK");
-						client.println("Content-type:text/html");
-						client.println();
-						// the content of the HTTP response follows the header:
-						client.println("<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">"); // metaview
-						client.println("<body style=\"background-color:SteelBlue\">"); // set color CCS HTML5 style . I | I . I | I .
-						client.print("<p style=\"font-family:verdana; color:GhostWhite\">&nbsp<font size=3> l </font><font size=4> l </font><font size=5> | </font><font size=4> l </font><font size=3> l </font><font size=4> l </font><font size=5> | </font><font size=4> l </font><font size=3> l </font> <br>");
-						client.print("<font size=5>Arduino</font>  <br><font size=5>"); client.print(WiFi.SSID()); client.println("</font>");
-						client.print("<p style=\"font-family:verdana; color:Gainsboro\">");
-						for (t = 0; t < G_SSID_Counter; t++)
-						{
-							client.print(t); client.print(". ["); client.print(G_SSID_List[t]); client.print("]<br>");
-						}
-						client.println("</font></p>");
-						client.print("<p style=\"font-family:verdana; color:Gainsboro\">Enter Wifi-Ssid (Number or name) and Pass:<br>");
-						client.println("<form method=POST action=\"checkpass.php\">");
-						client.println("<input type=text name=XXID><br>");                      // XXID is a key word fo parsing the response
-						client.println("<form method=POST action=\"checkpass.php\">");
-						client.println("<input type=password name=XXPS><br>");                   //XXPS is a key word for parsing
-						client.println("<input type=submit name=action value=Submit>");
-						client.println("</form></p>");
-						client.print("<meta http-equiv=\"refresh\" content=\"30;url=http://"); client.print(WiFi.localIP()); client.println("\">");
-						// The HTTP response ends with another blank line:
-						client.println();
-						// break out of the while loop:
-						break;
-					}
-					else // if you got a newline, then clear currentLine:
-					{
-						currentLine = "";
-					}
-				}
-				else if (charBuffer != '\r') // if you got anything else but a carriage return character,
-				{
-					currentLine += charBuffer;      // add it to the end of the currentLine
-				}
-				// Check to see if the client request was a post on our checkpass.php
-				if (currentLine.endsWith("POST /checkpass.php"))
-				{
-					#ifdef Debug_On            
-						Serial.println("* Found AP Server POST");
-					#endif        
-
-					currentLine = "";
-					while (client.connected()) // loop while the client's connected
-					{
-						if (client.available()) // if there's bytes to read from the client,
-						{
-							charBuffer = client.read();    // read a byte, then
-
-							#ifdef Debug_On_X                      
-								Serial.write(charBuffer);  // print it out the serial monitor
-							#endif    
-
-							if (charBuffer == '\n') // if the byte is a newline character
-							{
-								//if (currentLine.length() == 0) break; // no lenght :  end of data request
-								currentLine = "";                      // if you got a newline, then clear currentLine:
-							}
-							else if (charBuffer != '\r')
-							{
-								currentLine += charBuffer;     // if you got anything else but a carriage return character, add to string
-							}
-
-							if (currentLine.endsWith("XXID="))
-							{
-								pos1 = currentLine.length();
-							}
-
-							if (currentLine.endsWith("&XXPS="))
-							{
-								pos2 = currentLine.length();
-							}
-
-							if (currentLine.endsWith("&action")) // Check read line on "data=" start that ends with "&action"
-							{
-								t = currentLine.length();
-
-								if (t < 78)
-								{
-									if (pos2 - pos1 == 7)
-									{
-										u = (currentLine[pos1] - 48);
-										if (u > G_SSID_Counter)
-										{
-											u = 0; // one digit - convert to max index
-										}
-
-										// copy list name to ssid
-										for (v = 0; G_SSID_List[u][v] != 0; v++)
-										{
-											G_SSID[v] = G_SSID_List[u][v]; 
-											G_SSID[v] = 0;
-										}
-									}
-									else
-									{
-										u = 0;
-										// if not one digit, copy input name to ssid
-										for (v = pos1; v < (pos2 - 6); v++)
-										{
-											G_SSID[u++] = currentLine[v];
-										}
-										G_SSID[u] = 0;
-									}
-
-									u = 0;
-									for (v = pos2; v < (t - 7); v++)
-									{
-										G_PASS[u++] = currentLine[v];
-									}
-									G_PASS[u] = 0;
-
-									CredentialsHandler::Write_Credentials(G_SSID, sizeof(G_SSID), G_PASS, sizeof(G_PASS)); // write credentials to flash 
-								}
-								else
-								{
-									#ifdef Debug_On                        
-										Serial.print("* Invalid input from AP Client"); Serial.println(currentLine);
-									#endif                            
-								}
-
-								#ifdef Debug_On                        
-									Serial.print("\n* AP client input found: ");
-									Serial.print(G_SSID); Serial.print(","); Serial.println("******");
-								#endif     
-
-								// copy inputs to G_SSID and G_PASS
-								G_AP_InputFlag = 1; // flag AP input
-								break;
-							}
-						}
-					}
-					//delay(1000);
-					client.println("HTTP/1.1 200 OK");
-					client.println("Content-type:text/html");
-					client.println();
-					client.println("<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">"); // metaview
-					client.println("<body style=\"background-color:SteelBlue\">"); // set color CCS HTML5 style
-					client.print("<p style=\"font-family:verdana; color:GhostWhite\">&nbsp<font size=3> l </font><font size=4> l </font><font size=5> | </font><font size=4> l </font><font size=3> l </font><font size=4> l </font><font size=5> | </font><font size=4> l </font><font size=3> l </font> <br>");
-					client.print("<font size=5>Arduino</font>  <br><font size=5>"); client.print(WiFi.SSID()); client.println("</font></p>");
-					client.print("<p style=\"font-family:verdana; color:DarkOrange\"><font size=5>Thank You.....</font><br>");
-					client.println("<meta http-equiv=\"refresh\" content=\"6;url=/\" />");
-					// The HTTP response ends with another blank line:
-					client.println();
-					// break out of the while loop: 
-					delay(1000);   // wait 2 seconds to show the message !                     
-					break;
-				} // end loop POST check
-
-
-				if (currentLine.endsWith("GET /generate_204")) // HTTP generate_204 HTTP/1.1
-				{
-					client.println("HTTP/1.1 200 OK");
-					client.println("Content-type:text/html");
-					client.println();
-					client.print("<meta http-equiv=\"refresh\" content=\"0;url=http://"); client.print(WiFi.localIP()); client.print("\">");
-					client.println();
-					#ifdef Debug_On                  
-						Serial.println("**generate_204 replyied 200 OK");
-					#endif             
-					// The HTTP response ends with another blank line:
-					client.println();
-					// break out of the while loop:              
-					break;
-				}
-
-				/*
-						if (currentLine.endsWith("GET /RESET"))
-						{
-						  client.println("HTTP/1.1 200 OK");
-						  client.println("Content-type:text/html");
-						  client.println();
-						  client.println("<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">"); // metaview
-						  client.println("<body style=\"background-color:black\">"); // set color CCS HTML5 style
-						  client.print( "<h2 style=\"font-family:verdana; color:GoldenRod\">Access Router ");client.print(WiFi.SSID());client.println("</h2>");
-						  client.print("<packetCounter style=\"font-family:verdana; color:indianred\">Authentication failed<br>");
-						  client.print("<meta http-equiv=\"refresh\" content=\"4;url=/\" />");
-						  G_DNS_RequestCounter=0;
-						  Serial.println("**Reset");
-						  break;
-						}
-
-						if (currentLine.endsWith("GET /connecttest")) // HTTP redirect for browsers with connect-test
-						{
-						  // client.println("HTTP/1.1 302 found");
-						  // client.print("Location: http://");client.print(WiFi.localIP());client.println("/");
-						  client.println("HTTP/1.1 200 OK");
-						  client.println("Content-type:text/html");
-						  client.println();
-						  client.print("<meta http-equiv=\"refresh\" content=\"1;url=/\" />");
-						  client.println();
-						  Serial.println("**generate_204 replyied 200 OK");
-						  break;
-						}
-				*/
-
-			} // end loop client data avaialbe    
-		} // end while loop client connected
-
-		// close the connection:
-		client.stop();
-		#ifdef Debug_On     
-			Serial.println("* AP webclient disconnected");
-		#endif
-	} // end If Client
-}
-
-// Check the Access Point wifi Client Responses and read the inputs on the main Access Point web-page.
-void EasyWiFi::AccessPointWiFiClientCheck_Test()
-{
-	String PostLine = "";     // make a String to hold incoming POST-Data
-	String currentLine = "";  // make a String to hold incoming data from the client
-	char charBuffer;          // Character read buffer
-	int t, u, v, pos1, pos2;  // loop counter
-
-	WiFiClient client = G_AP_Webserver.available();  // listen for incoming clients
-	if (client) // if you get a client,
-	{
-		#ifdef Debug_On     
-			Serial.println("* New Access Point webclient");
-		#endif
-
-		while (client.connected()) // loop while the client's connected
-		{
-			if (client.available()) // if there's bytes to read from the client,
-			{
-				processRequest(client);
-				break;
-//				charBuffer = client.read(); // read a byte, then
-//
-//#ifdef Debug_On  
-//				// print it out the serial monitor
-//				Serial.write(charBuffer);
-//#endif
-//
-//				if (charBuffer == '\n') // if the byte is a newline character
-//				{
-//					// if the current line is blank, you got two newline characters in a row.
-//					// that's the end of the client HTTP request, so send a response:
-//					if (currentLine.length() == 0)
-//					{
-//						
-//					}
-//					else // if you got a newline, then clear currentLine:
-//					{
-//						currentLine = "";
-//					}
-//				}
-//				else if (charBuffer != '\r') // if you got anything else but a carriage return character,
-//				{
-//					currentLine += charBuffer;      // add it to the end of the currentLine
-//				}
-			} // end loop client data avaialbe    
-		} // end while loop client connected
-
-		// close the connection:
-		client.stop();
-		#ifdef Debug_On     
-			Serial.println("* AP webclient disconnected");
-		#endif
-	} // end If Client
-}
-
-void EasyWiFi::processRequest(WiFiClient client) {
-	// Read the request from the client
-	String request = client.readStringUntil('\r');
-	client.flush();
-
-	#ifdef Debug_On     
-		Serial.println("Process request");
-	#endif
-
-	// Handle the request
-	if (request.indexOf("/list_networks") != -1)
-	{
-		#ifdef Debug_On     
-			Serial.println("* Send network list");
-		#endif
-		// Send the list of Wi-Fi networks as a web page
-		sendNetworkList(client);
-	}
-	else if (request.indexOf("/enterPassword") != -1)
-	{
-		#ifdef Debug_On     
-			Serial.println("* sendEnterWifiPasswordPage");
-		#endif
-		// Process the network selection and password entry
-		sendEnterWifiPasswordPage(client, request);
-	}
-	else if (request.indexOf("POST /connect") != -1)
-	{
-		#ifdef Debug_On     
-			Serial.println("* handleProvidedWifiCredentials");
-		#endif
-		// Process the connection form submission
-		handleProvidedWifiCredentials(client, request);
-	}
-	else
-	{
-		#ifdef Debug_On     
-			Serial.println("* Send default page");
-		#endif
-		// Send the default web page
-		sendStartPage(client);
-	}
-}
-
-void EasyWiFi::handleProvidedWifiCredentials(WiFiClient client, String request) {
-	// Extract the network SSID and password from the request body
-	String requestBody = request.substring(request.indexOf("\r\n\r\n") + 4);
-	String networkName = getValueFromRequest(requestBody, "network");
-	String password = getValueFromRequest(requestBody, "password");
-
-	// Attempt to connect to the network
-	Serial.print("* Entered Wifi PW: ");
-	Serial.println(password.c_str());
-
-	Serial.print("* Entered Wifi SSID: ");
-	Serial.println(networkName.c_str());
-
-
-	// Connect to the network using the provided SSID and password
-	boolean connected = connectToNetwork(networkName, password);
-
-	//G_SSID = networkName;
-	//TryToConnectToWifiWithCredentials()
-
-	// Send the response back to the client
-	client.println("HTTP/1.1 200 OK");
-	client.println("Content-Type: text/html");
-	client.println();
-
-	client.println("<html>");
-	client.println("<head><title>Connection Status</title></head>");
-	client.println("<meta charset='UTF-8'>");
-	client.println("<meta name='viewport' content='width=device-width,initial-scale=1'>");
-	client.println("<body>");
-
-	if (connected) {
-		client.println("<h2>Network Connection Successful</h2>");
-		// Additional actions or information for a successful connection
-	}
-	else {
-		client.println("<h2>Network Connection Failed</h2>");
-		client.println("<p>Failed to connect to network: " + networkName + "</p>");
-		client.println("<button onclick=\"location.href='/networklist'\">Select network and try again</button>");
-	}
-
-	client.println("</body>");
-	client.println("</html>");
-	client.println();
-}
-
-String EasyWiFi::getValueFromRequest(String requestBody, String key) {
-	String value = "";
-	int keyIndex = requestBody.indexOf(key + "=");
-	if (keyIndex != -1) {
-		int valueIndex = keyIndex + key.length() + 1;
-		int endIndex = requestBody.indexOf("&", valueIndex);
-		if (endIndex == -1) {
-			endIndex = requestBody.length();
-		}
-		value = requestBody.substring(valueIndex, endIndex);
-		value = urlDecode(value);
-	}
-	return value;
-}
-
-String EasyWiFi::urlDecode(String str) {
-	String decodedString = "";
-	char temp[3] = { 0 };
-	unsigned int len = str.length();
-	unsigned int i = 0;
-	while (i < len) {
-		char decodedChar;
-		if (str.charAt(i) == '%') {
-			temp[0] = str.charAt(i + 1);
-			temp[1] = str.charAt(i + 2);
-			decodedChar = strtol(temp, NULL, 16);
-			i += 2;
-		}
-		else if (str.charAt(i) == '+') {
-			decodedChar = ' ';
-		}
-		else {
-			decodedChar = str.charAt(i);
-		}
-		i++;
-		decodedString += decodedChar;
-	}
-	return decodedString;
-}
-
-boolean EasyWiFi::connectToNetwork(String networkName, String password) {
-	int attempts = 4;
-	int delayInSeconds = 2;
-	boolean connected = false;
-
-	for (int i = 0; i < attempts; i++)
-	{
-		WiFi.begin(networkName.c_str(), password.c_str());
-		delay(delayInSeconds * 1000);
-		if (WiFi.status() == WL_CONNECTED)
-		{
-			connected = true;
-			break;
-		}
-	}
-
-	return connected;
-}
-
-void EasyWiFi::sendStartPage(WiFiClient client) {
-	// Send the HTTP header
-	client.println("HTTP/1.1 200 OK");
-	client.println("Content-type:text/html");
-	client.println();
-
-	// Send the default web page
-	client.println("<html>");
-	client.println("<head><title>Welcome</title></head>");
-	client.println("<meta charset='UTF-8'>");
-	client.println("<meta name='viewport' content='width=device-width,initial-scale=1'>");
-	client.println("<body>");
-	client.println("<h1>Welcome to the Arduino IoT Web Server</h1>");
-	client.println("<p>Please select your network:</p>");
-	client.println("<a href=\"/list_networks\">Network Selection</a>");
-	client.println("</body>");
-	client.println("</html>");
-	// The HTTP response ends with another blank line:
-	client.println();
-}
-
-void EasyWiFi::sendNetworkList(WiFiClient client) {
-	// Send the HTTP header
-	client.println("HTTP/1.1 200 OK");
-	client.println("Content-Type: text/html");
-	client.println();
-
-	// Send the HTML page
-	client.println("<html>");
-	client.println("<head><title>Select your network</title></head>");
-	client.println("<meta charset='UTF-8'>");
-	client.println("<meta name='viewport' content='width=device-width,initial-scale=1'>");
-	client.println("<body>");
-	client.println("<h2>Select your network:</h2>");
-
-	// Generate a button for each network
-	for (int i = 0; i < G_SSID_Counter; i++)
-	{
-		String networkName = G_SSID_List[i];
-		client.print("<form action=\"/enterPassword?network=" + networkName + "\" method=\"post\">");
-		client.print("<input type=\"submit\" value=\"");
-		client.print(i+1);
-		client.print(". ");
-		client.print(networkName);
-		client.println("\"/>");
-		client.println("</form>");
-	}
-
-	client.println("</body>");
-	client.println("</html>");
-	client.print("<meta http-equiv=\"refresh\" content=\"20;url=http://"); client.print(WiFi.localIP()); client.println("\">");
-	// The HTTP response ends with another blank line:
-	client.println();
-}
-
-void EasyWiFi::sendEnterWifiPasswordPage(WiFiClient client, String request)
-{
-	// Extract the selected network from the request
-	String networkName = request.substring(request.indexOf("/enterPassword?network=") + 23);
-	networkName = networkName.substring(0, networkName.indexOf(" "));
-
-	// Send the HTTP header
-	client.println("HTTP/1.1 200 OK");
-	client.println("Content-Type: text/html");
-	client.println();
-
-	// Send the HTML page with password entry form
-	client.println("<html>");
-	client.println("<meta charset='UTF-8'>");
-	client.println("<meta name='viewport' content='width=device-width,initial-scale=1'>");
-	client.println("<head><title>Enter Wi-Fi Password</title></head>");
-	client.println("<body>");
-	client.print("<h2>Network: ");
-	client.print(networkName);
-	client.println("</h2>");
-	// Input fields
-	client.println("<form id=\"connectForm\" onsubmit=\"submitForm(event)\" method=\"post\">");
-	client.println("Password: <input id=\"passwordField\" type=\"password\" name=\"password\" /><br/>");
-	client.println("Show password: <input id=\"showPasswordCheckbox\" type=\"checkbox\" onchange=\"togglePasswordVisibility()\" /><br/>");
-	client.println("<input type=\"submit\" value=\"Connect\"/>");
-	client.println("</form>");
-
-	// JavaScript section
-	client.println("<script>");
-	// Function to toggle password visibility
-	client.println("function togglePasswordVisibility() {");
-	client.println("  var passwordField = document.getElementById('passwordField');");
-	client.println("  var showPasswordCheckbox = document.getElementById('showPasswordCheckbox');");
-	client.println("  if (showPasswordCheckbox.checked) {");
-	client.println("    passwordField.type = 'text';");
-	client.println("  } else {");
-	client.println("    passwordField.type = 'password';");
-	client.println("  }");
-	client.println("}");
-	// Function for handling the password sending
-	client.println("function submitForm(event) {");
-	client.println("  event.preventDefault();");
-	client.println("  var password = document.getElementById('passwordField').value;");
-	client.println("  var xhr = new XMLHttpRequest();");
-	client.println("  xhr.open('POST', '/connect', true);");
-	client.println("  xhr.setRequestHeader('Content-Type', 'application/x-www-form-urlencoded');");
-	client.println("  xhr.onreadystatechange = function() {");
-	client.println("    if (xhr.readyState === 4 && xhr.status === 200) {");
-	client.println("      // Handle the server response if needed");
-	client.println("      console.log(xhr.responseText);");
-	client.println("    }");
-	client.println("  };");
-	client.println("  var params = 'network=" + networkName + "&password=' + encodeURIComponent(password);");
-	client.println("  xhr.send(params);");
-	client.println("}");
-	client.println("</script>");
-
-	client.println("</body>");
-	client.println("</html>");
-	// The HTTP response ends with another blank line:
-	client.println();
-}
-
-// SERIALPRINT Wifi Status - only for debug
-void EasyWiFi::PrintWiFiStatus()
-{
-#ifdef Debug_On
-	// print the SSID of the network you're attached to:
-	Serial.print("* SSID: ");
-	Serial.print(WiFi.SSID());
-	// print your WiFi shield's IP address:
-	IPAddress ip = WiFi.localIP();
-	Serial.print(" - IP Address: ");
-	Serial.print(ip);
-	// print your WiFi gateway:
-	IPAddress ip2 = WiFi.gatewayIP();
-	Serial.print(" - IP Gateway: ");
-	Serial.print(ip2);
-	// print the received signal strength:
-	long rssi = WiFi.RSSI();
-	Serial.print("- Rssi: ");
-	Serial.print(rssi);
-	Serial.println(" dBm");
-#endif
-}
-
-bool EasyWiFi::IsWifiNotConnectedOrReachable(int wifiStatus)
-{
-	return (wifiStatus != WL_CONNECTED) || (WiFi.RSSI() <= -90) || (WiFi.RSSI() == 0);
-}
-
-int EasyWiFi::TryToConnectToWifiWithCredentials()
-{
-	int connectionAttempts = 0;
-	int wifiStatus = WiFi.status();
-	while (IsWifiNotConnectedOrReachable(wifiStatus) && connectionAttempts < MAX_CONNECT) // attempt to connect to WiFi network 3 times
-	{
-		#ifdef Debug_On
-			Serial.print("* Attempt#"); Serial.print(connectionAttempts); Serial.print(" to connect to Network: "); Serial.println(G_SSID); // print the network name (SSID);
-		#endif
-		wifiStatus = WiFi.begin(G_SSID, G_PASS);     // Connect to WPA/WPA2 network. Change this line if using open or WEP network:
-		delay(2000);                                 // wait 2 seconds for connection:
-		connectionAttempts++;                        // try-counter
-	}
-	return connectionAttempts;
-}
-
-void EasyWiFi::UpdateDeviceConnectedStatus()
-{
-	// Check AP status - new client on or off?
-	if (G_AP_Status != WiFi.status())
-	{
-		G_AP_Status = WiFi.status();        // it has changed update the variable
-		if (G_AP_Status == WL_AP_CONNECTED) // a device has connected to the AP
-		{
-			#ifdef Debug_On                     
-				Serial.println("Device connected to AP\n");
-			#endif                 
-			SetNINA_LED(CYAN); // Client on AP : CYAN
-			G_DNS_RequestCounter = 0; // reset DNS counter
-		}
-		else // a device has disconnected from the AP, and we are back in listening mode
-		{
-			#ifdef Debug_On                  
-				Serial.println("Device disconnected from AP\n");
-			#endif                    
-		}
-	} // end if loop changed G_AP_Status  
-}
-
-
+/*
+* EasyWiFi
+* Modified by Daniel Patyk May 2023 based on John V. Version 1.4.1
+* Version: 1.4.2 https://github/SirPytan/EasyWifi
+* 
+*  RGB LED INDICATOR on uBlox nina Module
+*  GREEN: Connected
+*
+*  BLUE: (Stored) Credentials found, connecting					 <<<<--_
+*  YELLOW: No Stored Credentials found, connecting					     \
+*  PURPLE: Can'i connect, opening Access Point for credentials input      |
+*  CYAN: Client connected to Access Point, wait for credentials input >>--/
+*
+*  RED: Not connected / Can'i connect, wifi.start is stopped, return to program
+*
+* Released into the public domain on github: https://github.com/javos65/EasyWifi-for-MKR1010
+*/
+
+#include "EasyWiFi.h"
+#include "CredentialsHandler.h"
+#include "HttpRequestParser.h"
+#include "HttpResponseWriter.h"
+#include "PortalPages.h"
+#include "PortalAssets.h"
+#include "DnsResponder.h"
+#include "DriverTrace.h"
+#include "EventLog.h"
+#include "PortalArena.h"
+
+char G_SSID[CREDENTIALS_SSID_SIZE] = SECRET_SSID; // optional init: your network SSID (name) 
+char G_PASS[CREDENTIALS_PASS_SIZE] = SECRET_PASS; // optional init: your network password 
+boolean G_UseAP = 1; // use AP after loging failure, or quit with no AP service
+boolean G_LED_On = 1; // leds on or of
+boolean G_UseFastReconnect = 1; // try the cached lease of the last connection first
+boolean G_UseLinkMonitor = 1; // reconnect from Poll() when the link stays lost or degraded
+#if EASYWIFI_WITH_PORTAL
+char G_AccessPointName[SSID_BUFFER_SIZE] = ACCESS_POINT_NAME; // ACCESS POINT name, dynamic adaptable
+EasyWiFiNetwork G_ScanList[MAX_SSID];			// Store of available networks, strongest first after a scan (outlives the portal arena, see SCAN_CACHE_TTL)
+unsigned long G_ScanTime = 0;                     // millis() when G_ScanList was filled
+unsigned long G_ScanDuration = 0;                 // Time in ms the last scan took
+boolean G_ScanValid = false;                      // G_ScanList holds a scan
+int G_AP_Status = WL_IDLE_STATUS, G_AP_InputFlag;  // global AP flag to use
+int G_SSID_Counter = 0;                           // Gloabl counter for number of found SSID's
+WiFiServer* G_AP_Webserver = NULL;                // Global Acces Point Web Server (portal arena)
+PortalConnection* G_PortalConnections = NULL;     // PORTAL_MAX_CONNECTIONS open Access Point web server connections (portal arena)
+HttpResponseWriter* G_ResponseWriter = NULL;      // Segment sized buffer for the Access Point web server responses (portal arena)
+PortalArena G_PortalArena;                        // Owns the portal buffers while the Access Point is up
+#if PORTAL_ARENA_SIZE > 0
+#define PORTAL_ARENA_BYTES PORTAL_ARENA_SIZE
+#else
+// exactly what OpenPortalSession() allocates
+#define PORTAL_ARENA_BYTES (PortalArena::GetObjectsSize(sizeof(WiFiServer)) \
+	+ PortalArena::GetObjectsSize(sizeof(PortalConnection), PORTAL_MAX_CONNECTIONS) \
+	+ PortalArena::GetObjectsSize(sizeof(HttpResponseWriter)) \
+	+ (EASYWIFI_WITH_DNS ? PortalArena::GetObjectsSize(sizeof(WiFiUDP)) + UDP_PACKET_SIZE : 0))
+#endif
+IPAddress G_AP_IP;                                // Global Acces Point IP adress 
+PortalStats G_PortalStats;                        // Request counters and latencies of the Access Point web server
+#endif
+#if EASYWIFI_WITH_DNS
+WiFiUDP* G_UDP_AP_DNS = NULL;                    // A UDP instance to let us send and receive packets over UDP (portal arena)
+IPAddress G_AP_DNS_CLIENT_IP;
+int G_DNS_ClientPort;
+int G_DNS_RequestCounter = 0;
+EasyWiFiDnsStats G_DNS_Stats = { 0, 0, 0, 0 };
+byte* G_UDP_PacketBuffer = NULL;  // UDP_PACKET_SIZE buffer to hold incoming packets, the DNS reply is built in place (portal arena)
+#endif
+
+// ***************************************
+
+
+EasyWiFi::EasyWiFi()
+{
+	m_State = EASYWIFI_IDLE;
+	m_StateEnteredTime = 0;
+	m_LastStatusPoll = 0;
+	m_RetryDelay = 0;
+	m_RetryState = EASYWIFI_CONNECT;
+	m_RetryPending = false;
+	m_TotalConnectionAttempts = 0;
+	m_AccessPointTries = 0;
+	m_PortalCredentials = false;
+	m_CandidateCount = 0;
+	m_CandidateIndex = 0;
+	m_BeginTime = 0;
+	m_TimeToConnect = 0;
+	m_FastReconnectTried = false;
+	m_FastReconnect = false;
+	m_RescanRequested = false;
+	m_Rescanning = false;
+	m_ProvisionResult = EASYWIFI_PROVISION_NONE;
+	ResetTimeline();
+	m_DnsMaxPackets = DNS_MAX_PACKETS_PER_POLL;
+	m_DnsTimeBudget = DNS_POLL_TIME_BUDGET;
+}
+
+// Login to local network, blocking until connected or given up //
+void EasyWiFi::Start()
+{
+	Begin();
+	while (!IsFinished())
+	{
+		Poll();
+	}
+#if EASYWIFI_WITH_PORTAL
+	ClosePortalSession(); // the application gets the portal RAM back
+#endif
+}
+
+// Start a new login to the local network, advanced by Poll() //
+void EasyWiFi::Begin()
+{
+	if (!m_RetryPolicy.IsSeeded()) // a seed of the application is kept, so is the sequence of an earlier Begin()
+	{
+		uint8_t mac[6];
+		uint32_t seed = micros();
+		EASYWIFI_DRIVER_VOID(DRIVER_WIFI_INFO, WiFi.macAddress(mac));
+		for (int i = 0; i < 6; i++)
+			seed = (seed ^ mac[i]) * 16777619; // FNV-1a: a different jitter sequence per device
+		m_RetryPolicy.Seed(seed);
+	}
+	m_RetryPolicy.Reset(millis());
+	m_RetryPending = false;
+	m_TotalConnectionAttempts = 0;
+	m_PortalCredentials = false;
+	m_CandidateCount = 0;
+	m_CandidateIndex = 0;
+	m_BeginTime = millis();
+	m_TimeToConnect = 0;
+	m_FastReconnectTried = false;
+	m_FastReconnect = false;
+	m_RescanRequested = false;
+	m_Rescanning = false;
+	m_ProvisionResult = EASYWIFI_PROVISION_NONE;
+	ResetTimeline();
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_CONFIG, WiFi.setTimeout(0)); // WiFi.begin() returns immediately, the connection is awaited in EASYWIFI_CONNECT_WAIT
+
+	// Early exit if already connected
+	bool alreadyConnected = !IsWifiNotConnectedOrReachable(EASYWIFI_DRIVER(DRIVER_WIFI_STATUS, WiFi.status()));
+	if (alreadyConnected)
+	{
+		SetNINA_LED(GREEN); // Set Green  
+		EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_ALREADY_CONNECTED, EASYWIFI_DRIVER(DRIVER_WIFI_INFO, WiFi.localIP()), 0);
+		LogWiFiStatus();
+		MarkPhase(m_Timeline.connected);
+		m_LinkMonitor.Reset(millis());
+		SetState(EASYWIFI_CONNECTED);
+		return;
+	}
+	SetState(EASYWIFI_READ_CREDENTIALS);
+}
+
+// Advance the login by one step, never waits: timeouts are checked against millis()
+EasyWiFiState EasyWiFi::Poll()
+{
+	unsigned long now = millis();
+	EventLog::Service();
+	switch (m_State)
+	{
+	case EASYWIFI_READ_CREDENTIALS:
+		if (G_UseFastReconnect && !m_FastReconnectTried)
+		{
+			m_FastReconnectTried = true;
+			if (TryFastReconnect())
+			{
+				SetState(EASYWIFI_FAST_CONNECT_WAIT);
+				break;
+			}
+		}
+		// Read saved credentials from file
+		m_CandidateCount = CredentialsHandler::GetNetworkCount();
+		MarkPhase(m_Timeline.credentialsRead);
+		m_CandidateIndex = 0;
+		m_RetryPolicy.Reset(now);
+		if (m_CandidateCount == 0) // if no success use hardcoded credentials
+		{
+			SetNINA_LED(ORANGE); // no credentials found SET ORANGE
+			EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_HARDCODED_CREDENTIALS, 0, 0);
+		}
+		else if (m_CandidateCount > 1)
+		{
+			SetState(EASYWIFI_SELECT_NETWORK); // several networks stored: pick the ones in range
+			break;
+		}
+		else
+		{
+			m_Candidates[0] = 0;
+			LoadCandidate();
+		}
+		SetNINA_LED(BLUE); // Starting to connect: Set Blue  
+		SetState(EASYWIFI_CONNECT);
+		break;
+
+	case EASYWIFI_FAST_CONNECT_WAIT:
+		if (now - m_LastStatusPoll < FAST_CONNECT_POLL_INTERVAL)
+			break;
+		m_LastStatusPoll = now;
+		if (!IsWifiNotConnectedOrReachable(EASYWIFI_DRIVER(DRIVER_WIFI_STATUS, WiFi.status())))
+		{
+			if (IsCachedAccessPoint())
+			{
+				m_FastReconnect = true;
+				HandleConnected();
+				break;
+			}
+			// another access point answered, the cached lease need not be valid behind it
+			EASYWIFI_LOG(LOG_LEVEL_WARN, EVENT_FAST_RECONNECT_MOVED, 0, 0);
+			AbandonFastReconnect();
+		}
+		else if (now - m_StateEnteredTime >= FAST_CONNECT_TIMEOUT)
+		{
+			EASYWIFI_LOG(LOG_LEVEL_WARN, EVENT_FAST_RECONNECT_FAILED, 0, 0);
+			AbandonFastReconnect();
+		}
+		break;
+
+	case EASYWIFI_SELECT_NETWORK:
+		SelectStoredNetworks();
+		LoadCandidate();
+		SetNINA_LED(BLUE); // Starting to connect: Set Blue  
+		SetState(EASYWIFI_CONNECT);
+		break;
+
+	case EASYWIFI_CONNECT:
+		TryToConnectToWifiWithCredentials();
+		SetState(EASYWIFI_CONNECT_WAIT);
+		break;
+
+	case EASYWIFI_CONNECT_WAIT:
+		if (now - m_LastStatusPoll < CONNECT_POLL_INTERVAL)
+			break;
+		m_LastStatusPoll = now;
+		if (!IsWifiNotConnectedOrReachable(EASYWIFI_DRIVER(DRIVER_WIFI_STATUS, WiFi.status())))
+		{
+			HandleConnected();
+		}
+		else if (now - m_StateEnteredTime >= CONNECT_TIMEOUT)
+		{
+			HandleConnectTimeout();
+		}
+		break;
+
+	case EASYWIFI_RETRY_WAIT:
+		if (now - m_StateEnteredTime >= m_RetryDelay)
+			SetState(m_RetryState);
+		break;
+
+#if EASYWIFI_WITH_PORTAL
+	case EASYWIFI_SCAN:
+		// start direct-Wifi connect to manualy input Wifi credentials
+		if (!m_Rescanning)
+			SetNINA_LED(RED); // no network, : RED
+		if (!OpenPortalSession())
+		{
+			SetState(EASYWIFI_FAILED);
+			break;
+		}
+		if (m_Rescanning || !G_ScanValid || now - G_ScanTime >= SCAN_CACHE_TTL)
+			ListNetworks();   // load avaialble networks in a list
+		MarkPhase(m_Timeline.scanDone);
+		AccessPointSetup();
+		break;
+
+	case EASYWIFI_AP_SETUP:
+		if (now - m_StateEnteredTime >= ACCESS_POINT_SHUTDOWN_TIME)
+			AccessPointStart();
+		break;
+
+	case EASYWIFI_AP_LISTENING:
+		if (now - m_StateEnteredTime >= ACCESS_POINT_SETTLE_TIME)
+		{
+			EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_AP_LISTENING, (uint32_t)G_AP_IP, 0);
+#if EASYWIFI_WITH_DNS
+			EASYWIFI_DRIVER_VOID(DRIVER_SOCKET_SETUP, G_UDP_AP_DNS->begin(UDP_PORT)); // start the UDP server
+#endif
+			EASYWIFI_DRIVER_VOID(DRIVER_SOCKET_SETUP, G_AP_Webserver->begin());       // start the Access Point web server on port 80
+			SetNINA_LED(PURPLE); // start AP, : Purple
+			G_AP_InputFlag = 0;
+			m_Rescanning = false;
+			MarkPhase(m_Timeline.apListening);
+			SetState(EASYWIFI_PORTAL);
+		}
+		break;
+
+	case EASYWIFI_PORTAL:
+		UpdateDeviceConnectedStatus();
+		if (G_AP_Status == WL_AP_CONNECTED)  // IF client connected to AP, start DNS and check Webserver
+		{
+#if EASYWIFI_WITH_DNS
+			AccessPointDNSScan();          // check DNS requests
+#endif
+			AccessPointWiFiClientCheck();  // check HTTP server Clients
+		}
+		if (G_AP_InputFlag) // Keep AP open until input is received
+		{
+			AccessPointStop();
+			ClosePortalSession(); // provisioning is over, a failed login opens a new one
+			SetNINA_LED(BLUE); // new credentials : BLUE
+			m_RetryPolicy.Reset(now);
+			SetState(EASYWIFI_VERIFY);
+		}
+		else if (m_RescanRequested && !IsPortalBusy())
+		{
+			// safe point: no request in flight, the AP is closed for the scan and opened again
+			EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_RESCAN, 0, 0);
+			AccessPointStop();
+			m_RescanRequested = false;
+			m_Rescanning = true;
+			SetState(EASYWIFI_SCAN);
+		}
+		break;
+#endif
+
+	case EASYWIFI_VERIFY:
+		if (now - m_StateEnteredTime >= RECONNECT_SETTLE_TIME)
+			SetState(EASYWIFI_CONNECT);
+		break;
+
+	case EASYWIFI_CONNECTED:
+		// one status and RSSI read per LINK_POLL_INTERVAL, reconnect only on sustained loss or degradation
+		if (G_UseLinkMonitor && m_LinkMonitor.Update(now) && m_LinkMonitor.NeedsReconnect())
+		{
+			EASYWIFI_LOG(LOG_LEVEL_WARN, m_LinkMonitor.IsConnected() ? EVENT_LINK_DEGRADED : EVENT_LINK_LOST, m_LinkMonitor.GetRssi(), 0);
+			EASYWIFI_DRIVER_VOID(DRIVER_WIFI_END, WiFi.disconnect());
+			Begin(); // picks the strongest stored network in range again
+		}
+		break;
+
+	default: // EASYWIFI_IDLE, EASYWIFI_FAILED
+		break;
+	}
+	return m_State;
+}
+
+// Current state of the login state machine
+EasyWiFiState EasyWiFi::GetState()
+{
+	return m_State;
+}
+
+// True when the login ended, either connected or given up
+boolean EasyWiFi::IsFinished()
+{
+	return (m_State == EASYWIFI_CONNECTED) || (m_State == EASYWIFI_FAILED) || (m_State == EASYWIFI_IDLE);
+}
+
+void EasyWiFi::SetState(EasyWiFiState state)
+{
+	EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_STATE, state, 0);
+	m_State = state;
+	m_StateEnteredTime = millis();
+	m_LastStatusPoll = m_StateEnteredTime;
+}
+
+/* Start the connection to the network of the reconnect cache with its lease configured statically,
+   skipping the DHCP exchange. False if there is no cache or its network is no longer stored.
+   EASYWIFI_FAST_CONNECT_WAIT falls back to DHCP if another access point answers */
+boolean EasyWiFi::TryFastReconnect()
+{
+	WiFiReconnectCache cache;
+	WiFiNetworkCredentials network;
+	if (!CredentialsHandler::ReadReconnectCache(cache))
+		return false;
+	int index = CredentialsHandler::FindNetwork(cache.ssid);
+	if (index < 0 || !CredentialsHandler::GetNetwork(index, network))
+		return false;
+
+	strcpy(G_SSID, network.ssid);
+	strcpy(G_PASS, network.password);
+	m_Candidates[0] = index;
+	m_CandidateCount = 1;
+	m_CandidateIndex = 0;
+	EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_FAST_RECONNECT, (uint32_t)cache.localIP, 0);
+	SetNINA_LED(BLUE); // Starting to connect: Set Blue
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_CONFIG, WiFi.config(cache.localIP, cache.dns, cache.gateway, cache.subnet));
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_BEGIN, WiFi.begin(G_SSID, G_PASS));
+	MarkPhase(m_Timeline.firstBegin);
+	return true;
+}
+
+// WL_CONNECTED reached: store what proved to work and finish
+void EasyWiFi::HandleConnected()
+{
+	m_TimeToConnect = millis() - m_BeginTime;
+	MarkPhase(m_Timeline.connected);
+	if (m_PortalCredentials)
+	{
+		CredentialsHandler::AddNetwork(G_SSID, G_PASS, CREDENTIALS_DEFAULT_PRIORITY); // write verified credentials to flash
+		m_ProvisionResult = EASYWIFI_PROVISION_CONNECTED;
+	}
+	if (m_PortalCredentials || m_CandidateCount > 0)
+	{
+		CredentialsHandler::MarkConnected(G_SSID, EASYWIFI_DRIVER(DRIVER_WIFI_INFO, WiFi.getTime()));
+		UpdateReconnectCache();
+	}
+	m_PortalCredentials = false;
+	m_LinkMonitor.Reset(millis());
+	SetNINA_LED(GREEN); // Set Green   
+	EASYWIFI_LOG(LOG_LEVEL_INFO, m_FastReconnect ? EVENT_CONNECTED_FAST : EVENT_CONNECTED, m_TimeToConnect, EASYWIFI_DRIVER(DRIVER_WIFI_INFO, WiFi.localIP()));
+	LogWiFiStatus();
+	SetState(EASYWIFI_CONNECTED);
+}
+
+// Remember BSSID and lease of the current connection, flash is only written when they changed
+void EasyWiFi::UpdateReconnectCache()
+{
+	WiFiReconnectCache cache, stored;
+	strcpy(cache.ssid, G_SSID);
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_INFO, WiFi.BSSID(cache.bssid));
+	cache.localIP = EASYWIFI_DRIVER(DRIVER_WIFI_INFO, WiFi.localIP());
+	cache.gateway = EASYWIFI_DRIVER(DRIVER_WIFI_INFO, WiFi.gatewayIP());
+	cache.dns = EASYWIFI_DRIVER(DRIVER_WIFI_INFO, WiFi.dnsIP(0));
+	cache.subnet = EASYWIFI_DRIVER(DRIVER_WIFI_INFO, WiFi.subnetMask());
+	if (CredentialsHandler::ReadReconnectCache(stored) && strcmp(stored.ssid, cache.ssid) == 0
+		&& memcmp(stored.bssid, cache.bssid, sizeof(cache.bssid)) == 0 && stored.localIP == cache.localIP
+		&& stored.gateway == cache.gateway && stored.dns == cache.dns && stored.subnet == cache.subnet)
+		return;
+	CredentialsHandler::WriteReconnectCache(cache);
+}
+
+/* A WiFi.begin() attempt did not connect in time: back off and retry while the budget of the network lasts,
+   then move to the next stored network, and once all are exhausted do what the retry policy says */
+void EasyWiFi::HandleConnectTimeout()
+{
+	unsigned long now = millis();
+	unsigned long delay;
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_END, WiFi.disconnect()); // stop the module from retrying on its own while backing off
+	m_Timeline.failedAttempts++;
+
+	if (m_RetryPolicy.Next(now, delay))
+	{
+		EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_RETRY_WAIT, delay, 0);
+		m_RetryDelay = delay;
+		m_RetryState = EASYWIFI_CONNECT;
+		m_RetryPending = true; // the timeline takes the retry when its WiFi.begin() goes out
+		SetState(EASYWIFI_RETRY_WAIT);
+		return;
+	}
+
+	if (m_CandidateIndex + 1 < m_CandidateCount) // next stored network in range
+	{
+		m_CandidateIndex++;
+		LoadCandidate();
+		m_RetryPolicy.Reset(now);
+		SetState(EASYWIFI_CONNECT);
+		return;
+	}
+
+	if (m_PortalCredentials)
+		m_ProvisionResult = EASYWIFI_PROVISION_FAILED;
+
+	if ((m_TotalConnectionAttempts <= ESCAPE_CONNECT) && !m_PortalCredentials
+		&& (m_RetryPolicy.GetOnExhausted() == RETRY_START_OVER))
+	{
+		// headless devices: wait for the router to come back instead of opening the portal
+		EASYWIFI_LOG(LOG_LEVEL_WARN, EVENT_START_OVER, 0, 0);
+		m_RetryPolicy.Reset(now);
+		m_RetryDelay = m_RetryPolicy.GetMaxDelay();
+		m_RetryState = EASYWIFI_READ_CREDENTIALS;
+		SetState(EASYWIFI_RETRY_WAIT);
+		return;
+	}
+
+	if ((m_TotalConnectionAttempts > ESCAPE_CONNECT) || (G_UseAP == false) || !EASYWIFI_WITH_PORTAL
+		|| (m_RetryPolicy.GetOnExhausted() == RETRY_FAIL)) // quite login service?
+	{
+		SetNINA_LED(RED); // Set red 
+		EASYWIFI_LOG(LOG_LEVEL_ERROR, EVENT_LOGIN_FAILED, 0, 0);
+		SetState(EASYWIFI_FAILED);
+		return;
+	}
+
+	// No connection possible opening Access Point		
+	EASYWIFI_LOG(LOG_LEVEL_WARN, EVENT_OPEN_PORTAL, 0, 0);
+	m_PortalCredentials = false;
+	m_CandidateCount = 0; // from now on only credentials entered in the portal are tried
+	SetState(EASYWIFI_SCAN);
+}
+
+// Erase credentials from disk file
+byte EasyWiFi::Erase()
+{
+	return CredentialsHandler::Erase_Credentials();
+}
+
+// Store a network, a higher priority is tried first when several stored networks are in range
+byte EasyWiFi::AddNetwork(const char* ssid, const char* password, uint8_t priority)
+{
+	return CredentialsHandler::AddNetwork(ssid, password, priority);
+}
+
+// Remove a stored network
+byte EasyWiFi::RemoveNetwork(const char* ssid)
+{
+	return CredentialsHandler::RemoveNetwork(ssid);
+}
+
+// Number of stored networks
+int EasyWiFi::GetNetworkCount()
+{
+	return CredentialsHandler::GetNetworkCount();
+}
+
+// Read stored network index (0 .. GetNetworkCount() - 1)
+boolean EasyWiFi::GetNetwork(int index, WiFiNetworkCredentials& network)
+{
+	return CredentialsHandler::GetNetwork(index, network);
+}
+
+// Set Name of AccessPoint
+byte EasyWiFi::SetAccessPointName(char* name)
+{
+	int i = 0;
+#if EASYWIFI_WITH_PORTAL
+	while (name[i] != 0)
+	{
+		G_AccessPointName[i] = name[i];
+		i++;
+		if (i >= SSID_BUFFER_SIZE)
+			break;
+	}
+	G_AccessPointName[i] = 0; // close string
+#else
+	(void)name; // no access point without the portal
+#endif
+	return i;
+}
+
+// Set Seed of the Cypher, should be positive
+void EasyWiFi::SetSeed(int seed)
+{
+	CredentialsHandler::SetSeed(seed);
+}
+
+// Backoff, budgets and final action of the connect loop, configure before Begin()
+RetryPolicy& EasyWiFi::GetRetryPolicy()
+{
+	return m_RetryPolicy;
+}
+
+// Smoothed link quality of the connection, with thresholds and timing to configure
+LinkMonitor& EasyWiFi::GetLinkMonitor()
+{
+	return m_LinkMonitor;
+}
+
+// Let Poll() reconnect when the link stays lost or degraded, or leave that to the application
+void EasyWiFi::UseLinkMonitor(boolean value)
+{
+	G_UseLinkMonitor = value;
+}
+
+/* Set Led indicator active on or off - for low power usage*/
+void EasyWiFi::UseLED(boolean value)
+{
+	G_LED_On = value;
+}
+
+/* Set AP or no AP service*/
+void EasyWiFi::UseAccessPoint(boolean value)
+{
+	G_UseAP = value;
+}
+
+/* Set fast reconnect with the cached lease of the last connection on or off*/
+void EasyWiFi::UseFastReconnect(boolean value)
+{
+	G_UseFastReconnect = value;
+}
+
+// The fast reconnect associated with the access point of the reconnect cache
+boolean EasyWiFi::IsCachedAccessPoint()
+{
+	WiFiReconnectCache cache;
+	uint8_t bssid[6];
+	if (!CredentialsHandler::ReadReconnectCache(cache))
+		return false;
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_INFO, WiFi.BSSID(bssid));
+	return memcmp(bssid, cache.bssid, sizeof(bssid)) == 0;
+}
+
+// Drop the fast reconnect and its static lease, the stored networks are tried with DHCP
+void EasyWiFi::AbandonFastReconnect()
+{
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_END, WiFi.disconnect());
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_CONFIG, WiFi.config(IPAddress(0, 0, 0, 0))); // back to DHCP
+	SetState(EASYWIFI_READ_CREDENTIALS);
+}
+
+// Time in ms Begin() took to reach WL_CONNECTED, 0 while not connected
+unsigned long EasyWiFi::GetTimeToConnect()
+{
+	return m_TimeToConnect;
+}
+
+// True if the last connection was made through the cached lease
+boolean EasyWiFi::IsFastReconnect()
+{
+	return m_FastReconnect;
+}
+
+/* Set RGB led on uBlox Module R-G-B , max 128*/
+void EasyWiFi::SetNINA_LED(char r, char g, char b)
+{
+#if EASYWIFI_WITH_LED
+	if (G_LED_On)
+	{
+		// Set LED pin modes to output
+		EASYWIFI_DRIVER_VOID(DRIVER_LED, WiFiDrv::pinMode(25, OUTPUT));
+		EASYWIFI_DRIVER_VOID(DRIVER_LED, WiFiDrv::pinMode(26, OUTPUT));
+		EASYWIFI_DRIVER_VOID(DRIVER_LED, WiFiDrv::pinMode(27, OUTPUT));
+
+		// Set all LED color 
+		EASYWIFI_DRIVER_VOID(DRIVER_LED, WiFiDrv::analogWrite(25, g % 128));    // GREEN
+		EASYWIFI_DRIVER_VOID(DRIVER_LED, WiFiDrv::analogWrite(26, r % 128));    // RED
+		EASYWIFI_DRIVER_VOID(DRIVER_LED, WiFiDrv::analogWrite(27, b % 128));    // BLUE
+	}
+#else
+	(void)r; (void)g; (void)b;
+#endif
+}
+
+#if EASYWIFI_WITH_PORTAL
+/* Scan for available Wifi Networks and keep the MAX_SSID strongest, one entry per SSID, in G_ScanList.
+   A min-heap on RSSI holds the best ones seen so far, so the scan is walked once without allocation */
+void EasyWiFi::ListNetworks()
+{
+	// scan for nearby networks:
+	unsigned long scanStart = millis();
+	int foundNetworksAmount = EASYWIFI_DRIVER(DRIVER_WIFI_SCAN, WiFi.scanNetworks());
+	G_ScanDuration = millis() - scanStart;
+	if (foundNetworksAmount == -1)
+	{
+		EASYWIFI_LOG(LOG_LEVEL_WARN, EVENT_SCAN_FAILED, 0, 0);
+		return; // keep the previous list
+	}
+	G_ScanTime = millis();
+	G_ScanValid = true;
+	EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_SCAN_DONE, foundNetworksAmount, G_ScanDuration);
+	G_SSID_Counter = 0;
+	uint8_t noise[32]; // low bits of the RSSI values and the scan timing, for the credential store salt
+	memset(noise, 0, sizeof(noise));
+	noise[0] = (uint8_t)G_ScanDuration;
+	noise[1] = (uint8_t)micros();
+
+	for (int thisNetwork = 0; thisNetwork < foundNetworksAmount; thisNetwork++)
+	{
+		const char* ssid = EASYWIFI_DRIVER(DRIVER_WIFI_SCAN_ENTRY, WiFi.SSID(thisNetwork));
+		int32_t rssi = EASYWIFI_DRIVER(DRIVER_WIFI_SCAN_ENTRY, WiFi.RSSI(thisNetwork));
+		noise[2 + thisNetwork % (sizeof(noise) - 2)] ^= (uint8_t)rssi;
+		if (ssid == NULL || ssid[0] == 0)
+			continue; // hidden network, nothing to offer
+
+		int slot = -1;
+		for (int i = 0; i < G_SSID_Counter; i++)
+		{
+			if (strcmp(G_ScanList[i].ssid, ssid) == 0)
+				slot = i;
+		}
+		if (slot >= 0)
+		{
+			// same SSID from another access point: keep the stronger one
+			if (rssi <= G_ScanList[slot].rssi)
+				continue;
+			StoreScanResult(G_ScanList[slot], thisNetwork, ssid, rssi);
+			ScanHeapDown(slot);
+		}
+		else if (G_SSID_Counter < MAX_SSID)
+		{
+			StoreScanResult(G_ScanList[G_SSID_Counter], thisNetwork, ssid, rssi);
+			ScanHeapUp(G_SSID_Counter++);
+		}
+		else if (rssi > G_ScanList[0].rssi)
+		{
+			// stronger than the weakest kept one, which is the heap root
+			StoreScanResult(G_ScanList[0], thisNetwork, ssid, rssi);
+			ScanHeapDown(0);
+		}
+	}
+
+	CredentialsHandler::AddEntropy(noise, sizeof(noise));
+
+	// heap sort: strongest first
+	for (int end = G_SSID_Counter - 1; end > 0; end--)
+	{
+		EasyWiFiNetwork weakest = G_ScanList[0];
+		G_ScanList[0] = G_ScanList[end];
+		G_ScanList[end] = weakest;
+		ScanHeapDown(0, end);
+	}
+
+	for (int i = 0; i < G_SSID_Counter; i++)
+	{
+		EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_SCAN_ENTRY, i, G_ScanList[i].rssi);
+		EASYWIFI_LOG_TEXT(LOG_LEVEL_DEBUG, EVENT_SCAN_SSID, G_ScanList[i].ssid);
+	}
+}
+
+// Copy scan result index into entry, the SSID is cut to its 32 characters
+void EasyWiFi::StoreScanResult(EasyWiFiNetwork& entry, int index, const char* ssid, int32_t rssi)
+{
+	strncpy(entry.ssid, ssid, sizeof(entry.ssid) - 1);
+	entry.ssid[sizeof(entry.ssid) - 1] = 0;
+	entry.rssi = rssi;
+	entry.channel = EASYWIFI_DRIVER(DRIVER_WIFI_SCAN_ENTRY, WiFi.channel(index));
+	entry.encryption = EASYWIFI_DRIVER(DRIVER_WIFI_SCAN_ENTRY, WiFi.encryptionType(index));
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_SCAN_ENTRY, WiFi.BSSID(index, entry.bssid));
+}
+
+// Restore the min-heap order of G_ScanList after entry index got weaker or was added
+void EasyWiFi::ScanHeapUp(int index)
+{
+	while (index > 0)
+	{
+		int parent = (index - 1) / 2;
+		if (G_ScanList[parent].rssi <= G_ScanList[index].rssi)
+			break;
+		EasyWiFiNetwork swap = G_ScanList[parent];
+		G_ScanList[parent] = G_ScanList[index];
+		G_ScanList[index] = swap;
+		index = parent;
+	}
+}
+
+// Restore the min-heap order of the first count entries of G_ScanList after entry index got stronger
+void EasyWiFi::ScanHeapDown(int index, int count)
+{
+	if (count < 0)
+		count = G_SSID_Counter;
+	while (true)
+	{
+		int weakest = index;
+		int left = 2 * index + 1;
+		int right = left + 1;
+		if (left < count && G_ScanList[left].rssi < G_ScanList[weakest].rssi)
+			weakest = left;
+		if (right < count && G_ScanList[right].rssi < G_ScanList[weakest].rssi)
+			weakest = right;
+		if (weakest == index)
+			break;
+		EasyWiFiNetwork swap = G_ScanList[weakest];
+		G_ScanList[weakest] = G_ScanList[index];
+		G_ScanList[index] = swap;
+		index = weakest;
+	}
+}
+
+// Time in ms since the last portal scan, 0xFFFFFFFF if there was none
+unsigned long EasyWiFi::GetScanAge()
+{
+	if (!G_ScanValid)
+		return 0xFFFFFFFF;
+	return millis() - G_ScanTime;
+}
+
+// Time in ms WiFi.scanNetworks() took in the last portal scan
+unsigned long EasyWiFi::GetScanDuration()
+{
+	return G_ScanDuration;
+}
+#endif
+
+// Outcome of the last credentials entered in the portal since Begin()
+EasyWiFiProvisionResult EasyWiFi::GetProvisionResult()
+{
+	return m_ProvisionResult;
+}
+
+// Phases and counters of the login since Begin(), a phase not reached is EASYWIFI_PHASE_NONE
+const EasyWiFiTimeline& EasyWiFi::GetTimeline()
+{
+	return m_Timeline;
+}
+
+// All phases not reached, all counters 0
+void EasyWiFi::ResetTimeline()
+{
+	memset(&m_Timeline, 0, sizeof(m_Timeline));
+	m_Timeline.credentialsRead = m_Timeline.firstBegin = m_Timeline.lastRetry = m_Timeline.scanDone = EASYWIFI_PHASE_NONE;
+	m_Timeline.apListening = m_Timeline.firstDnsQuery = m_Timeline.firstHttpRequest = EASYWIFI_PHASE_NONE;
+	m_Timeline.credentialsReceived = m_Timeline.connected = EASYWIFI_PHASE_NONE;
+}
+
+// Time since Begin() of the first time phase is reached
+void EasyWiFi::MarkPhase(unsigned long& phase)
+{
+	if (phase == EASYWIFI_PHASE_NONE)
+		phase = millis() - m_BeginTime;
+}
+
+#if EASYWIFI_WITH_PORTAL
+// Number of networks of the last portal scan, strongest first
+int EasyWiFi::GetScanCount()
+{
+	return G_SSID_Counter;
+}
+
+// Network index (0 .. GetScanCount() - 1) of the last portal scan, NULL if out of range
+const EasyWiFiNetwork* EasyWiFi::GetScanResult(int index)
+{
+	if (index < 0 || index >= G_SSID_Counter)
+		return NULL;
+	return &G_ScanList[index];
+}
+
+#endif
+
+/* Order the stored networks found in a scan into m_Candidates, most preferred first.
+   If none is in range (hidden network, failed scan) only the most preferred one is tried */
+void EasyWiFi::SelectStoredNetworks()
+{
+	WiFiNetworkCredentials networks[CREDENTIALS_MAX_NETWORKS];
+	int count = CredentialsHandler::GetNetworks(networks);
+	int foundNetworksAmount = EASYWIFI_DRIVER(DRIVER_WIFI_SCAN, WiFi.scanNetworks());
+	m_CandidateCount = 0;
+	m_CandidateIndex = 0;
+	for (int n = 0; n < count; n++)
+	{
+		boolean inRange = false;
+		for (int thisNetwork = 0; thisNetwork < foundNetworksAmount && !inRange; thisNetwork++)
+		{
+			const char* ssid = EASYWIFI_DRIVER(DRIVER_WIFI_SCAN_ENTRY, WiFi.SSID(thisNetwork));
+			inRange = (ssid != NULL && ssid[0] != 0 && strcmp(ssid, networks[n].ssid) == 0); // NULL: entry gone, "": hidden
+		}
+		if (!inRange)
+			continue;
+
+		// insert sorted
+		int i = m_CandidateCount++;
+		while (i > 0 && CredentialsHandler::IsPreferred(networks[n], networks[m_Candidates[i - 1]]))
+		{
+			m_Candidates[i] = m_Candidates[i - 1];
+			i--;
+		}
+		m_Candidates[i] = n;
+	}
+
+	if (m_CandidateCount == 0 && count > 0)
+	{
+		m_Candidates[0] = 0;
+		for (int n = 1; n < count; n++)
+		{
+			if (CredentialsHandler::IsPreferred(networks[n], networks[m_Candidates[0]]))
+				m_Candidates[0] = n;
+		}
+		m_CandidateCount = 1;
+	}
+	EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_CANDIDATES, m_CandidateCount, 0);
+}
+
+/* Copy the stored network m_Candidates[m_CandidateIndex] into G_SSID, G_PASS */
+void EasyWiFi::LoadCandidate()
+{
+	WiFiNetworkCredentials network;
+	if (m_CandidateIndex < m_CandidateCount && CredentialsHandler::GetNetwork(m_Candidates[m_CandidateIndex], network))
+	{
+		strcpy(G_SSID, network.ssid);
+		strcpy(G_PASS, network.password);
+	}
+}
+
+#if EASYWIFI_WITH_PORTAL
+/* Wifi Access Point Initialisation */
+/* Shuts the module down, the AP is started by AccessPointStart() once ACCESS_POINT_SHUTDOWN_TIME passed */
+void EasyWiFi::AccessPointSetup()
+{
+	EASYWIFI_LOG_TEXT(LOG_LEVEL_INFO, EVENT_AP_CREATE, G_AccessPointName);
+	
+	// Generate Access Point IP Adress and setup config, a rescan keeps it so open pages stay valid
+	if (!m_Rescanning)
+		G_AP_IP = IPAddress((char)random(11, 172), (char)random(0, 255), (char)random(0, 255), 0x01); // Generate random IP address in private IP range
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_END, WiFi.end());																					 // close Wifi - just to be sure
+	m_AccessPointTries = 0;
+	SetState(EASYWIFI_AP_SETUP);
+}
+
+/* One try to start the Access Point per call, the servers are started in EASYWIFI_AP_LISTENING */
+void EasyWiFi::AccessPointStart()
+{
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_CONFIG, WiFi.config(G_AP_IP, G_AP_IP, G_AP_IP, IPAddress(255, 255, 255, 0))); // Setup config
+	G_AP_Status = EASYWIFI_DRIVER(DRIVER_WIFI_BEGIN_AP, WiFi.beginAP(G_AccessPointName, ACCESS_POINT_CHANNEL)); // setup AccessPoint
+	if (G_AP_Status == WL_AP_LISTENING)
+	{
+		SetState(EASYWIFI_AP_LISTENING);
+		return;
+	}
+
+	// if AccessPoint is not listening -> Retry on the next Poll()
+	EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_AP_SETUP_RETRY, m_AccessPointTries + 1, 0);
+	if (++m_AccessPointTries >= ACCESS_POINT_SETUP_TRIES)
+	{
+		// not possible to connect in 5 retries
+		EASYWIFI_LOG(LOG_LEVEL_ERROR, EVENT_AP_FAILED, 0, 0);
+		ClosePortalSession();
+		SetNINA_LED(RED); // Set red 
+		SetState(EASYWIFI_FAILED);
+	}
+}
+
+/* Take the portal buffers from a fresh arena, a rescan keeps the open session.
+   False if the heap cannot hold them */
+boolean EasyWiFi::OpenPortalSession()
+{
+	if (G_PortalArena.IsActive())
+		return true;
+	unsigned long failures = G_PortalArena.GetFailures();
+	if (G_PortalArena.Begin(PORTAL_ARENA_BYTES))
+	{
+		G_AP_Webserver = G_PortalArena.New<WiFiServer>(80);
+		G_PortalConnections = G_PortalArena.NewArray<PortalConnection>(PORTAL_MAX_CONNECTIONS);
+		G_ResponseWriter = G_PortalArena.New<HttpResponseWriter>();
+#if EASYWIFI_WITH_DNS
+		G_UDP_AP_DNS = G_PortalArena.New<WiFiUDP>();
+		G_UDP_PacketBuffer = (byte*)G_PortalArena.Allocate(UDP_PACKET_SIZE);
+#endif
+		// an allocation that did not fit is counted by GetFailures()
+		if (G_PortalArena.GetFailures() == failures)
+			return true;
+	}
+	EASYWIFI_LOG(LOG_LEVEL_ERROR, EVENT_PORTAL_ARENA_FAILED, PORTAL_ARENA_BYTES, G_PortalArena.GetUsed());
+	ClosePortalSession();
+	return false;
+}
+
+/* Destroy the portal buffers and give the arena back to the heap. The scan list is kept, so
+   GetScanResult() still works and a portal opened again within SCAN_CACHE_TTL skips the scan */
+void EasyWiFi::ClosePortalSession()
+{
+	if (!G_PortalArena.IsActive())
+		return;
+	EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_PORTAL_ARENA, G_PortalArena.GetUsed(), G_PortalArena.GetSize());
+	G_PortalArena.End();
+	G_AP_Webserver = NULL;
+	G_PortalConnections = NULL;
+	G_ResponseWriter = NULL;
+#if EASYWIFI_WITH_DNS
+	G_UDP_AP_DNS = NULL;
+	G_UDP_PacketBuffer = NULL;
+#endif
+}
+
+// Portal arena of the access point session, its high-water mark shows the PORTAL_ARENA_SIZE really needed
+PortalArena& EasyWiFi::GetPortalArena()
+{
+	return G_PortalArena;
+}
+
+/* Close the DNS server and the Access Point */
+void EasyWiFi::AccessPointStop()
+{
+	for (int i = 0; i < PORTAL_MAX_CONNECTIONS; i++)
+	{
+		if (G_PortalConnections[i].inUse)
+			ClosePortalConnection(G_PortalConnections[i]);
+	}
+#if EASYWIFI_WITH_DNS
+	EASYWIFI_DRIVER_VOID(DRIVER_SOCKET_SETUP, G_UDP_AP_DNS->stop()); // Close UDP connection
+#endif
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_END, WiFi.end());
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_END, WiFi.disconnect());
+}
+
+#if EASYWIFI_WITH_DNS
+/* DNS Routines via UDP, act on DSN requests on Port 53 */
+/* assume wifi UDP connection has been set up */
+/* Drains the pending queries, bounded by the packet and time budget of one Poll() */
+void EasyWiFi::AccessPointDNSScan()
+{
+	unsigned long startTime = micros();
+	unsigned int drained = 0;
+	while (drained < m_DnsMaxPackets)
+	{
+		if (!AccessPointDNSReply())
+			break; // queue empty
+		drained++;
+		if (micros() - startTime >= m_DnsTimeBudget)
+			break;
+	}
+	if (drained > G_DNS_Stats.queueHighWater)
+		G_DNS_Stats.queueHighWater = drained;
+}
+
+/* Answer one pending DNS query, returns false if none was pending */
+boolean EasyWiFi::AccessPointDNSReply()
+{
+	unsigned int packetSize = 0;
+	unsigned int replySize = 0;
+
+	packetSize = EASYWIFI_DRIVER(DRIVER_UDP_RECEIVE, G_UDP_AP_DNS->parsePacket());
+	if (packetSize == 0)
+		return false;
+
+	// We've received a packet, read the data from it
+	if (packetSize > UDP_PACKET_SIZE)
+	{
+		G_DNS_Stats.packetsOversize++;
+		return true; // too large for a query, left unread the next parsePacket() discards it
+	}
+	EASYWIFI_DRIVER_VOID(DRIVER_UDP_RECEIVE, G_UDP_AP_DNS->read(G_UDP_PacketBuffer, packetSize)); // read the packet into the buffer
+	G_AP_DNS_CLIENT_IP = EASYWIFI_DRIVER(DRIVER_UDP_RECEIVE, G_UDP_AP_DNS->remoteIP());
+	G_DNS_ClientPort = EASYWIFI_DRIVER(DRIVER_UDP_RECEIVE, G_UDP_AP_DNS->remotePort());
+
+	if (G_AP_DNS_CLIENT_IP == G_AP_IP) // skip own requests - ie ntp-pool time requestfrom Wifi module
+	{
+		G_DNS_Stats.packetsDropped++;
+		return true;
+	}
+
+	EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_DNS_QUERY, packetSize, (uint32_t)G_AP_DNS_CLIENT_IP);
+
+	// Turn the query into the reply, in the receive buffer
+	replySize = DnsResponder::BuildReply(G_UDP_PacketBuffer, packetSize, UDP_PACKET_SIZE, G_AP_IP);
+	if (replySize == 0)
+	{
+		G_DNS_Stats.packetsDropped++;
+		return true;
+	}
+
+	EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_DNS_REPLY, replySize, 0);
+
+	// Send DSN UDP packet
+	EASYWIFI_DRIVER_VOID(DRIVER_UDP_SEND, G_UDP_AP_DNS->beginPacket(G_AP_DNS_CLIENT_IP, G_DNS_ClientPort)); //reply DNS question
+	EASYWIFI_DRIVER_VOID(DRIVER_UDP_SEND, G_UDP_AP_DNS->write(G_UDP_PacketBuffer, replySize));
+	EASYWIFI_DRIVER_VOID(DRIVER_UDP_SEND, G_UDP_AP_DNS->endPacket());
+	G_DNS_RequestCounter++;
+	G_DNS_Stats.packetsHandled++;
+	m_Timeline.dnsReplies++;
+	MarkPhase(m_Timeline.firstDnsQuery);
+	return true;
+}
+
+// Counters of the captive portal DNS server
+EasyWiFiDnsStats EasyWiFi::GetDnsStats()
+{
+	return G_DNS_Stats;
+}
+#endif
+
+// Request counters and latency histogram of one portal step
+const EasyWiFiRouteStats& EasyWiFi::GetPortalStats(EasyWiFiPortalRoute route)
+{
+	return G_PortalStats.Get(route);
+}
+
+// Latency in ms that percent of the requests of a portal step stayed below
+unsigned long EasyWiFi::GetPortalLatency(EasyWiFiPortalRoute route, uint8_t percent)
+{
+	return G_PortalStats.GetPercentile(route, percent);
+}
+
+// Print the portal statistics as CSV, one line per step
+void EasyWiFi::PrintPortalStats(Print& out)
+{
+	G_PortalStats.PrintTo(out);
+}
+
+// Limit the DNS work of one Poll() to maxPackets queries and timeBudget microseconds
+void EasyWiFi::SetDnsBudget(unsigned int maxPackets, unsigned long timeBudget)
+{
+	m_DnsMaxPackets = (maxPackets > 0) ? maxPackets : 1;
+	m_DnsTimeBudget = timeBudget;
+}
+
+// Accept new Access Point web clients and advance every open connection by one step
+void EasyWiFi::AccessPointWiFiClientCheck()
+{
+	// Accept: available() hands out a client with unread data, known or new
+	for (int i = 0; i < PORTAL_MAX_CONNECTIONS; i++)
+	{
+		WiFiClient client = EASYWIFI_DRIVER(DRIVER_SERVER_ACCEPT, G_AP_Webserver->available());
+		if (!client || FindPortalConnection(client) != NULL)
+			break;
+		PortalConnection* connection = FindPortalConnection(WiFiClient());
+		if (connection == NULL)
+		{
+			// All slots busy: refuse, so the NINA socket is freed
+			EASYWIFI_LOG(LOG_LEVEL_WARN, EVENT_CLIENT_REFUSED, 0, 0);
+			EASYWIFI_DRIVER_VOID(DRIVER_CLIENT_WRITE, client.print("HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"));
+			EASYWIFI_DRIVER_VOID(DRIVER_CLIENT_STOP, client.stop());
+			G_PortalStats.Record(EASYWIFI_ROUTE_OTHER, 0, true);
+			break;
+		}
+		EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_CLIENT_NEW, 0, 0);
+		connection->client = client;
+		connection->parser.Reset();
+		connection->requestStartTime = millis();
+		connection->lastActivityTime = connection->requestStartTime;
+		connection->requestCount = 0;
+		connection->requestStarted = false;
+		connection->keepAlive = false;
+		connection->inUse = true;
+	}
+
+	// Interleave progress of all open connections
+	for (int i = 0; i < PORTAL_MAX_CONNECTIONS; i++)
+	{
+		if (G_PortalConnections[i].inUse)
+			ServicePortalConnection(G_PortalConnections[i]);
+	}
+}
+
+// The slot serving client, or a free slot when client is empty
+PortalConnection* EasyWiFi::FindPortalConnection(WiFiClient client)
+{
+	for (int i = 0; i < PORTAL_MAX_CONNECTIONS; i++)
+	{
+		PortalConnection& connection = G_PortalConnections[i];
+		if (client ? (connection.inUse && connection.client == client) : !connection.inUse)
+			return &connection;
+	}
+	return NULL;
+}
+
+// Read what one connection has received, answer every request completed by it
+void EasyWiFi::ServicePortalConnection(PortalConnection& connection)
+{
+	uint8_t buffer[HTTP_READ_CHUNK_SIZE];
+	unsigned long now = millis();
+
+	int available = EASYWIFI_DRIVER(DRIVER_CLIENT_READ, connection.client.available());
+	if (available > 0)
+	{
+		int count = EASYWIFI_DRIVER(DRIVER_CLIENT_READ, connection.client.read(buffer, (available < HTTP_READ_CHUNK_SIZE) ? available : HTTP_READ_CHUNK_SIZE));
+		int offset = 0;
+		connection.lastActivityTime = now;
+		while (offset < count)
+		{
+			if (!connection.requestStarted)
+			{
+				connection.requestStarted = true;
+				connection.requestStartTime = now;
+			}
+			offset += connection.parser.Feed(buffer + offset, count - offset);
+			if (connection.parser.IsComplete() || connection.parser.HasError())
+			{
+				if (!processRequest(connection))
+				{
+					ClosePortalConnection(connection);
+					return;
+				}
+				// Keep-alive: the rest of the chunk belongs to the next (pipelined) request
+				connection.parser.Reset();
+				connection.requestStarted = false;
+				connection.requestCount++;
+			}
+		}
+		return;
+	}
+
+	if (!EASYWIFI_DRIVER(DRIVER_CLIENT_READ, connection.client.connected()))
+	{
+		if (connection.requestStarted)
+			G_PortalStats.Record(EASYWIFI_ROUTE_OTHER, now - connection.requestStartTime, true); // client went away mid request
+		ClosePortalConnection(connection);
+	}
+	else if (!connection.requestStarted)
+	{
+		// Idle keep-alive connection, waiting for the next request
+		if (now - connection.lastActivityTime >= PORTAL_KEEPALIVE_TIMEOUT)
+			ClosePortalConnection(connection);
+	}
+	else if ((now - connection.lastActivityTime >= PORTAL_IDLE_TIMEOUT) || (now - connection.requestStartTime >= PORTAL_REQUEST_TIMEOUT))
+	{
+		EASYWIFI_LOG(LOG_LEVEL_WARN, EVENT_CLIENT_TIMEOUT, 0, 0);
+		G_PortalStats.Record(EASYWIFI_ROUTE_OTHER, now - connection.requestStartTime, true);
+		ClosePortalConnection(connection);
+	}
+}
+
+void EasyWiFi::ClosePortalConnection(PortalConnection& connection)
+{
+	EASYWIFI_DRIVER_VOID(DRIVER_CLIENT_STOP, connection.client.stop());
+	connection.inUse = false;
+	EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_CLIENT_CLOSED, 0, 0);
+}
+
+/* Answer the complete (or malformed) request parsed on connection.
+   Returns true if the connection stays open for a further request. */
+boolean EasyWiFi::processRequest(PortalConnection& connection) {
+	HttpRequestParser& parser = connection.parser;
+	HttpResponseWriter& response = *G_ResponseWriter;
+
+	response.Begin(connection.client);
+	if (parser.HasError())
+	{
+		EASYWIFI_LOG(LOG_LEVEL_WARN, EVENT_REQUEST_MALFORMED, parser.GetErrorStatus(), 0);
+		connection.keepAlive = false;
+		sendHeader(response, connection, parser.GetErrorStatus(), NULL, 0);
+		m_Timeline.bytesSent += response.End();
+		m_Timeline.httpRequests++;
+		G_PortalStats.Record(EASYWIFI_ROUTE_OTHER, millis() - connection.requestStartTime, true);
+		return false;
+	}
+	connection.keepAlive = parser.KeepAlive() && (connection.requestCount + 1 < PORTAL_KEEPALIVE_MAX_REQUESTS);
+
+
+	// Handle the request
+	EasyWiFiPortalRoute route = EASYWIFI_ROUTE_OTHER;
+	if (parser.IsRequest("GET", "/list_networks"))
+	{
+		route = EASYWIFI_ROUTE_NETWORK_LIST;
+		// Send the list of Wi-Fi networks as a web page
+		sendNetworkList(response, connection);
+	}
+	else if (parser.IsRequest(NULL, "/enterPassword"))
+	{
+		route = EASYWIFI_ROUTE_ENTER_PASSWORD;
+		// Process the network selection and password entry
+		sendEnterWifiPasswordPage(response, connection);
+	}
+	else if (parser.IsRequest(NULL, "/refresh"))
+	{
+		route = EASYWIFI_ROUTE_REFRESH;
+		handleRefresh(response, connection);
+	}
+	else if (parser.IsRequest("GET", "/api/networks"))
+	{
+		route = EASYWIFI_ROUTE_API;
+		sendApiNetworks(response, connection);
+	}
+	else if (parser.IsRequest("GET", "/api/status"))
+	{
+		route = EASYWIFI_ROUTE_API;
+		sendApiStatus(response, connection);
+	}
+	else if (parser.IsRequest("POST", "/api/credentials"))
+	{
+		route = EASYWIFI_ROUTE_API;
+		handleApiCredentials(response, connection);
+	}
+	else if (parser.IsRequest("GET", "/api/result"))
+	{
+		route = EASYWIFI_ROUTE_API;
+		sendApiResult(response, connection);
+	}
+	else if (parser.IsRequest("GET", "/metrics"))
+	{
+		route = EASYWIFI_ROUTE_METRICS;
+		sendMetrics(response, connection);
+	}
+#ifdef EASYWIFI_TRACE
+	else if (parser.IsRequest("GET", "/api/trace"))
+	{
+		route = EASYWIFI_ROUTE_API;
+		sendApiTrace(response, connection);
+	}
+#endif
+	else if (parser.IsRequest("POST", "/connect"))
+	{
+		route = EASYWIFI_ROUTE_CONNECT;
+		// Process the connection form submission
+		handleProvidedWifiCredentials(response, connection);
+	}
+	else
+	{
+		if (parser.IsRequest("GET", "/"))
+			route = EASYWIFI_ROUTE_START;
+		else if (isCaptivePortalProbe(parser.GetPath()))
+			route = EASYWIFI_ROUTE_PROBE;
+		// Send the default web page
+		sendStartPage(response, connection);
+	}
+	size_t responseSize = response.End();
+	m_Timeline.bytesSent += responseSize;
+	m_Timeline.httpRequests++;
+	MarkPhase(m_Timeline.firstHttpRequest);
+	G_PortalStats.Record(route, millis() - connection.requestStartTime, false);
+
+	EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_RESPONSE, route, responseSize);
+	return connection.keepAlive;
+}
+
+void EasyWiFi::handleProvidedWifiCredentials(HttpResponseWriter& response, PortalConnection& connection) {
+	HttpRequestParser& request = connection.parser;
+	char ssid[CREDENTIALS_SSID_SIZE + 1];  // one more byte to notice values that are too long
+	char password[CREDENTIALS_PASS_SIZE + 1];
+
+	// Extract the network SSID and password from the request body
+	HttpRequestParser::GetFormValue(request.GetBody(), "network", ssid, sizeof(ssid));
+	HttpRequestParser::GetFormValue(request.GetBody(), "password", password, sizeof(password));
+	const char* error = validateCredentials(ssid, password);
+
+	connection.keepAlive = false;
+	if (error != NULL)
+	{
+		// The portal stays open, the password page shows the error
+		sendHeader(response, connection, 400, PORTAL_TEXT_HEADER, strlen(error));
+		response.print(error);
+		return;
+	}
+
+	strcpy(G_SSID, ssid);
+	strcpy(G_PASS, password);
+	EASYWIFI_LOG_TEXT(LOG_LEVEL_INFO, EVENT_PORTAL_SSID, G_SSID);
+
+	// Hand the credentials to the state machine, they are verified once the AP is closed
+	m_PortalCredentials = true;
+	m_ProvisionResult = EASYWIFI_PROVISION_PENDING;
+	MarkPhase(m_Timeline.credentialsReceived);
+	G_AP_InputFlag = 1;
+
+	// Send the response back to the client, the AP closes right after it
+	sendHeader(response, connection, 200, PORTAL_HTML_HEADER, -1);
+	response.WriteP(PORTAL_CONNECTING_PAGE_BEGIN);
+	printHtmlEscaped(response, G_SSID);
+	response.WriteP(PORTAL_CONNECTING_PAGE_END);
+}
+
+/* Error text for credentials from a portal form, NULL if they can be tried. ssid and password are read
+   into buffers one byte larger than the credential buffers, so a value that was cut is too long here */
+const char* EasyWiFi::validateCredentials(const char* ssid, const char* password)
+{
+	size_t passwordLength = strlen(password);
+	if (ssid[0] == 0 || strlen(ssid) >= CREDENTIALS_SSID_SIZE)
+		return "invalid ssid";
+	if (passwordLength >= CREDENTIALS_PASS_SIZE || (passwordLength > 0 && passwordLength < 8))
+		return "invalid password"; // WPA needs 8 to 63 characters, empty is an open network
+	return NULL;
+}
+
+void EasyWiFi::sendStartPage(HttpResponseWriter& response, PortalConnection& connection) {
+	sendAsset(response, connection, PORTAL_START_PAGE, sizeof(PORTAL_START_PAGE) - 1, PORTAL_START_PAGE_GZ, sizeof(PORTAL_START_PAGE_GZ));
+}
+
+// Send a static page from PortalAssets.h, gzip compressed if the client accepts it
+void EasyWiFi::sendAsset(HttpResponseWriter& response, PortalConnection& connection, const char* page, size_t pageSize, const uint8_t* pageGzip, size_t pageGzipSize)
+{
+	if (connection.parser.AcceptsGzip())
+	{
+		sendHeader(response, connection, 200, PORTAL_HTML_GZIP_HEADER, pageGzipSize);
+		response.WriteP(pageGzip, pageGzipSize);
+	}
+	else
+	{
+		sendHeader(response, connection, 200, PORTAL_HTML_HEADER, pageSize);
+		response.WriteP((const uint8_t*)page, pageSize);
+	}
+}
+
+/* Write status line and headers. headers is a PROGMEM text of further header lines, or NULL.
+   A negative contentLength sends the body chunked (HTTP/1.1) or delimited by closing the connection (HTTP/1.0). */
+void EasyWiFi::sendHeader(HttpResponseWriter& response, PortalConnection& connection, int status, const char* headers, long contentLength)
+{
+	boolean chunked = (contentLength < 0) && connection.parser.IsHttp11();
+	if (contentLength < 0 && !chunked)
+		connection.keepAlive = false;
+
+	response.print("HTTP/1.1 "); response.print(status); response.print(' '); response.print(getStatusReason(status)); response.print("\r\n");
+	if (headers != NULL)
+		response.WriteP(headers);
+	if (chunked)
+	{
+		response.print("Transfer-Encoding: chunked\r\n");
+	}
+	else if (contentLength >= 0)
+	{
+		response.print("Content-Length: "); response.print(contentLength); response.print("\r\n");
+	}
+	if (connection.keepAlive)
+	{
+		response.print("Connection: keep-alive\r\nKeep-Alive: timeout=");
+		response.print(PORTAL_KEEPALIVE_TIMEOUT / 1000);
+		response.print(", max=");
+		response.print(PORTAL_KEEPALIVE_MAX_REQUESTS - connection.requestCount - 1);
+		response.print("\r\n\r\n");
+	}
+	else
+	{
+		response.print("Connection: close\r\n\r\n");
+	}
+	if (chunked)
+		response.BeginChunkedBody();
+}
+
+const char* EasyWiFi::getStatusReason(int status)
+{
+	switch (status)
+	{
+	case 200: return "OK";
+	case 413: return "Payload Too Large";
+	case 414: return "URI Too Long";
+	case 431: return "Request Header Fields Too Large";
+	case 501: return "Not Implemented";
+	case 503: return "Service Unavailable";
+	case 505: return "HTTP Version Not Supported";
+	default: return "Bad Request";
+	}
+}
+
+void EasyWiFi::sendNetworkList(HttpResponseWriter& response, PortalConnection& connection) {
+	sendHeader(response, connection, 200, PORTAL_HTML_HEADER, -1);
+	response.WriteP(PORTAL_NETWORK_LIST_BEGIN);
+
+	// Generate a button for each network
+	for (int i = 0; i < G_SSID_Counter; i++)
+	{
+		response.print("<form action=\"/enterPassword?network=");
+		printUrlEncoded(response, G_ScanList[i].ssid);
+		response.print("\" method=\"post\"><input type=\"submit\" value=\"");
+		response.print(i+1);
+		response.print(". ");
+		printHtmlEscaped(response, G_ScanList[i].ssid);
+		response.print("\"/></form>\n");
+	}
+
+	response.WriteP(PORTAL_NETWORK_LIST_AGE_BEGIN);
+	response.print(GetScanAge() / 1000);
+	response.WriteP(PORTAL_NETWORK_LIST_AGE_END);
+	response.WriteP(PORTAL_NETWORK_LIST_END);
+	response.print(EASYWIFI_DRIVER(DRIVER_WIFI_INFO, WiFi.localIP()));
+	response.print("\">\n");
+}
+
+/* Schedule a rescan, Poll() runs it once no request is in flight. Rescans closer than
+   SCAN_MIN_INTERVAL to the last scan are ignored, the page just shows the current list again */
+void EasyWiFi::handleRefresh(HttpResponseWriter& response, PortalConnection& connection)
+{
+	if (GetScanAge() < SCAN_MIN_INTERVAL)
+	{
+		sendNetworkList(response, connection);
+		return;
+	}
+	EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_RESCAN_SCHEDULED, 0, 0);
+	m_RescanRequested = true;
+	connection.keepAlive = false;
+	sendHeader(response, connection, 200, PORTAL_HTML_HEADER, strlen_P(PORTAL_RESCAN_PAGE));
+	response.WriteP(PORTAL_RESCAN_PAGE);
+}
+
+/* GET /api/networks: the scan list, strongest first
+   {"age":3120,"duration":2140,"networks":[{"ssid":"Home","bssid":"aa:bb:cc:dd:ee:ff","rssi":-52,"channel":6,"encryption":4},...]} */
+void EasyWiFi::sendApiNetworks(HttpResponseWriter& response, PortalConnection& connection)
+{
+	const char hexDigits[] = "0123456789abcdef";
+	char bssid[18];
+	JsonWriter json(response);
+
+	sendHeader(response, connection, 200, PORTAL_JSON_HEADER, -1);
+	json.BeginObject();
+	json.Member("age", GetScanAge());
+	json.Member("duration", G_ScanDuration);
+	json.Key("networks");
+	json.BeginArray();
+	for (int i = 0; i < G_SSID_Counter; i++)
+	{
+		// WiFiNINA reports the BSSID last byte first
+		for (int b = 0; b < 6; b++)
+		{
+			bssid[b * 3] = hexDigits[G_ScanList[i].bssid[5 - b] >> 4];
+			bssid[b * 3 + 1] = hexDigits[G_ScanList[i].bssid[5 - b] & 0x0F];
+			bssid[b * 3 + 2] = (b < 5) ? ':' : 0;
+		}
+		json.BeginObject();
+		json.Member("ssid", G_ScanList[i].ssid);
+		json.Member("bssid", bssid);
+		json.Member("rssi", (long)G_ScanList[i].rssi);
+		json.Member("channel", (int)G_ScanList[i].channel);
+		json.Member("encryption", (int)G_ScanList[i].encryption);
+		json.EndObject();
+	}
+	json.EndArray();
+	json.EndObject();
+}
+
+// GET /api/status: state machine, access point and store summary
+void EasyWiFi::sendApiStatus(HttpResponseWriter& response, PortalConnection& connection)
+{
+	char ip[16];
+	JsonWriter json(response);
+
+	snprintf(ip, sizeof(ip), "%u.%u.%u.%u", G_AP_IP[0], G_AP_IP[1], G_AP_IP[2], G_AP_IP[3]);
+	sendHeader(response, connection, 200, PORTAL_JSON_HEADER, -1);
+	json.BeginObject();
+	json.Member("state", getStateName(m_State));
+	json.Member("uptime", millis() - m_BeginTime);
+	json.Member("ap", G_AccessPointName);
+	json.Member("ip", ip);
+	json.Member("channel", ACCESS_POINT_CHANNEL);
+	json.Member("attempts", m_TotalConnectionAttempts);
+	json.Member("storedNetworks", GetNetworkCount());
+	json.Member("scanCount", G_SSID_Counter);
+	json.Member("scanAge", GetScanAge());
+	json.Member("result", getProvisionResultName(m_ProvisionResult));
+	json.EndObject();
+}
+
+/* POST /api/credentials, form encoded "ssid" and "password" as for /connect.
+   Answers {"accepted":true} and closes the access point, or 400 with {"accepted":false,"error":"..."} */
+void EasyWiFi::handleApiCredentials(HttpResponseWriter& response, PortalConnection& connection)
+{
+	HttpRequestParser& request = connection.parser;
+	char ssid[CREDENTIALS_SSID_SIZE + 1];  // one more byte to notice values that are too long
+	char password[CREDENTIALS_PASS_SIZE + 1];
+	JsonWriter json(response);
+
+	HttpRequestParser::GetFormValue(request.GetBody(), "ssid", ssid, sizeof(ssid));
+	HttpRequestParser::GetFormValue(request.GetBody(), "password", password, sizeof(password));
+	const char* error = validateCredentials(ssid, password);
+
+	connection.keepAlive = false;
+	if (error != NULL)
+	{
+		sendHeader(response, connection, 400, PORTAL_JSON_HEADER, -1);
+		json.BeginObject();
+		json.Member("accepted", false);
+		json.Member("error", error);
+		json.EndObject();
+		return;
+	}
+
+	strcpy(G_SSID, ssid);
+	strcpy(G_PASS, password);
+	EASYWIFI_LOG_TEXT(LOG_LEVEL_INFO, EVENT_API_SSID, G_SSID);
+	m_PortalCredentials = true;
+	m_ProvisionResult = EASYWIFI_PROVISION_PENDING;
+	MarkPhase(m_Timeline.credentialsReceived);
+	G_AP_InputFlag = 1;
+
+	sendHeader(response, connection, 200, PORTAL_JSON_HEADER, -1);
+	json.BeginObject();
+	json.Member("accepted", true);
+	json.Member("ssid", G_SSID);
+	json.EndObject();
+}
+
+/* GET /api/result: outcome of the last credentials. The access point is down while they are verified,
+   so a client polling after reconnecting to it sees "failed"; "connected" is only seen through GetProvisionResult() */
+void EasyWiFi::sendApiResult(HttpResponseWriter& response, PortalConnection& connection)
+{
+	JsonWriter json(response);
+
+	sendHeader(response, connection, 200, PORTAL_JSON_HEADER, -1);
+	json.BeginObject();
+	json.Member("result", getProvisionResultName(m_ProvisionResult));
+	if (m_ProvisionResult != EASYWIFI_PROVISION_NONE)
+		json.Member("ssid", G_SSID);
+	else
+	{
+		json.Key("ssid");
+		json.Null();
+	}
+	json.Member("attempts", m_TotalConnectionAttempts);
+	json.EndObject();
+}
+
+/* GET /metrics: timeline and counters in Prometheus text format. Phases not reached are left out,
+   the portal request counters come from PortalStats */
+void EasyWiFi::sendMetrics(HttpResponseWriter& response, PortalConnection& connection)
+{
+	sendHeader(response, connection, 200, PORTAL_METRICS_HEADER, -1);
+	response.print("# HELP easywifi_phase_ms Time from Begin() to the first time a login phase was reached.\n");
+	response.print("# TYPE easywifi_phase_ms gauge\n");
+	printMetric(response, "credentials_read", m_Timeline.credentialsRead);
+	printMetric(response, "first_begin", m_Timeline.firstBegin);
+	printMetric(response, "last_retry", m_Timeline.lastRetry);
+	printMetric(response, "scan_done", m_Timeline.scanDone);
+	printMetric(response, "ap_listening", m_Timeline.apListening);
+	printMetric(response, "first_dns_query", m_Timeline.firstDnsQuery);
+	printMetric(response, "first_http_request", m_Timeline.firstHttpRequest);
+	printMetric(response, "credentials_received", m_Timeline.credentialsReceived);
+	printMetric(response, "connected", m_Timeline.connected);
+
+	// the retries still in the ring, oldest first, labelled with their number since Begin()
+	unsigned long firstRetry = (m_Timeline.retries > TIMELINE_RETRY_HISTORY) ? m_Timeline.retries - TIMELINE_RETRY_HISTORY : 0;
+	if (m_Timeline.retries > 0)
+		response.print("# HELP easywifi_retry_ms Time from Begin() to each of the most recent retries.\n# TYPE easywifi_retry_ms gauge\n");
+	for (unsigned long n = firstRetry; n < m_Timeline.retries; n++)
+	{
+		response.print("easywifi_retry_ms{retry=\"");
+		response.print(n + 1);
+		response.print("\"} ");
+		response.print(m_Timeline.retryTimes[n % TIMELINE_RETRY_HISTORY]);
+		response.print('\n');
+	}
+
+	response.print("# TYPE easywifi_uptime_ms gauge\neasywifi_uptime_ms ");
+	response.print(millis() - m_BeginTime);
+	response.print("\n# TYPE easywifi_retries_total counter\neasywifi_retries_total ");
+	response.print(m_Timeline.retries);
+	response.print("\n# TYPE easywifi_failed_attempts_total counter\neasywifi_failed_attempts_total ");
+	response.print(m_Timeline.failedAttempts);
+	response.print("\n# TYPE easywifi_dns_replies_total counter\neasywifi_dns_replies_total ");
+	response.print(m_Timeline.dnsReplies);
+	response.print("\n# TYPE easywifi_http_bytes_sent_total counter\neasywifi_http_bytes_sent_total ");
+	response.print(m_Timeline.bytesSent);
+	response.print("\n# TYPE easywifi_scan_duration_ms gauge\neasywifi_scan_duration_ms ");
+	response.print(G_ScanDuration);
+	response.print("\n# TYPE easywifi_portal_arena_bytes gauge\neasywifi_portal_arena_bytes{kind=\"size\"} ");
+	response.print((unsigned long)G_PortalArena.GetSize());
+	response.print("\neasywifi_portal_arena_bytes{kind=\"used\"} ");
+	response.print((unsigned long)G_PortalArena.GetUsed());
+	response.print("\neasywifi_portal_arena_bytes{kind=\"high_water\"} ");
+	response.print((unsigned long)G_PortalArena.GetHighWater());
+	response.print("\n# TYPE easywifi_http_requests_total counter\n");
+	for (int i = 0; i < EASYWIFI_ROUTE_COUNT; i++)
+	{
+		const EasyWiFiRouteStats& stats = G_PortalStats.Get((EasyWiFiPortalRoute)i);
+		response.print("easywifi_http_requests_total{route=\"");
+		response.print(PortalStats::GetRouteName((EasyWiFiPortalRoute)i));
+		response.print("\"} ");
+		response.print(stats.requests);
+		response.print('\n');
+	}
+}
+
+// One sample of easywifi_phase_ms, nothing if the phase was not reached
+void EasyWiFi::printMetric(Print& out, const char* phase, unsigned long value)
+{
+	if (value == EASYWIFI_PHASE_NONE)
+		return;
+	out.print("easywifi_phase_ms{phase=\"");
+	out.print(phase);
+	out.print("\"} ");
+	out.print(value);
+	out.print('\n');
+}
+
+#ifdef EASYWIFI_TRACE
+// GET /api/trace: driver call counters per site, {"sites":[{"site":"wifi_status","calls":12,"total":2400,"max":350,"latency":[...]},...]}
+void EasyWiFi::sendApiTrace(HttpResponseWriter& response, PortalConnection& connection)
+{
+	JsonWriter json(response);
+
+	sendHeader(response, connection, 200, PORTAL_JSON_HEADER, -1);
+	json.BeginObject();
+	json.Key("sites");
+	json.BeginArray();
+	for (int i = 0; i < DRIVER_SITE_COUNT; i++)
+	{
+		const DriverTraceStats& stats = DriverTrace::Get((DriverTraceSite)i);
+		if (stats.calls == 0)
+			continue;
+		json.BeginObject();
+		json.Member("site", DriverTrace::GetSiteName((DriverTraceSite)i));
+		json.Member("calls", stats.calls);
+		json.Member("total", stats.totalTime);
+		json.Member("max", stats.maxTime);
+		json.Key("latency");
+		json.BeginArray();
+		for (int b = 0; b < DRIVER_TRACE_BUCKETS; b++)
+			json.Value((unsigned long)stats.latency[b]);
+		json.EndArray();
+		json.EndObject();
+	}
+	json.EndArray();
+	json.EndObject();
+}
+#endif
+
+const char* EasyWiFi::getStateName(EasyWiFiState state)
+{
+	switch (state)
+	{
+	case EASYWIFI_IDLE: return "idle";
+	case EASYWIFI_READ_CREDENTIALS: return "read_credentials";
+	case EASYWIFI_FAST_CONNECT_WAIT: return "fast_connect";
+	case EASYWIFI_SELECT_NETWORK: return "select_network";
+	case EASYWIFI_CONNECT: return "connect";
+	case EASYWIFI_CONNECT_WAIT: return "connect_wait";
+	case EASYWIFI_RETRY_WAIT: return "retry_wait";
+	case EASYWIFI_SCAN: return "scan";
+	case EASYWIFI_AP_SETUP: return "ap_setup";
+	case EASYWIFI_AP_LISTENING: return "ap_listening";
+	case EASYWIFI_PORTAL: return "portal";
+	case EASYWIFI_VERIFY: return "verify";
+	case EASYWIFI_CONNECTED: return "connected";
+	default: return "failed";
+	}
+}
+
+const char* EasyWiFi::getProvisionResultName(EasyWiFiProvisionResult result)
+{
+	switch (result)
+	{
+	case EASYWIFI_PROVISION_PENDING: return "pending";
+	case EASYWIFI_PROVISION_CONNECTED: return "connected";
+	case EASYWIFI_PROVISION_FAILED: return "failed";
+	default: return "none";
+	}
+}
+
+// True while a portal connection is in the middle of a request
+boolean EasyWiFi::IsPortalBusy()
+{
+	for (int i = 0; i < PORTAL_MAX_CONNECTIONS; i++)
+	{
+		if (G_PortalConnections[i].inUse && G_PortalConnections[i].requestStarted)
+			return true;
+	}
+	return false;
+}
+
+void EasyWiFi::sendEnterWifiPasswordPage(HttpResponseWriter& response, PortalConnection& connection)
+{
+	// Static page, it takes the selected network from the query string itself
+	sendAsset(response, connection, PORTAL_PASSWORD_PAGE, sizeof(PORTAL_PASSWORD_PAGE) - 1, PORTAL_PASSWORD_PAGE_GZ, sizeof(PORTAL_PASSWORD_PAGE_GZ));
+}
+
+// Paths phones and PCs request to detect a captive portal
+boolean EasyWiFi::isCaptivePortalProbe(const char* path)
+{
+	return (strcmp(path, "/generate_204") == 0) || (strcmp(path, "/gen_204") == 0) ||     // Android
+		(strcmp(path, "/hotspot-detect.html") == 0) || (strcmp(path, "/library/test/success.html") == 0) || // Apple
+		(strcmp(path, "/connecttest.txt") == 0) || (strcmp(path, "/ncsi.txt") == 0) ||        // Windows
+		(strcmp(path, "/success.txt") == 0) || (strcmp(path, "/canonical.html") == 0);        // Firefox
+}
+
+// Print text percent-encoded, for use in URLs and form data
+void EasyWiFi::printUrlEncoded(Print& out, const char* text)
+{
+	const char hexDigits[] = "0123456789ABCDEF";
+	for (int i = 0; text[i] != 0; i++)
+	{
+		char c = text[i];
+		if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.' || c == '~')
+		{
+			out.print(c);
+		}
+		else
+		{
+			out.print('%');
+			out.print(hexDigits[(c >> 4) & 0x0F]);
+			out.print(hexDigits[c & 0x0F]);
+		}
+	}
+}
+
+// Print text with the HTML special characters as entities, for element content and quoted attribute values
+void EasyWiFi::printHtmlEscaped(Print& out, const char* text)
+{
+	for (int i = 0; text[i] != 0; i++)
+	{
+		switch (text[i])
+		{
+		case '&': out.print("&amp;"); break;
+		case '<': out.print("&lt;"); break;
+		case '>': out.print("&gt;"); break;
+		case '"': out.print("&quot;"); break;
+		case '\'': out.print("&#39;"); break;
+		default: out.print(text[i]); break;
+		}
+	}
+}
+
+#endif
+
+// Log gateway and signal of the connection - only for debug, the driver is not read otherwise
+void EasyWiFi::LogWiFiStatus()
+{
+	EASYWIFI_LOG(LOG_LEVEL_DEBUG, EVENT_WIFI_STATUS, EASYWIFI_DRIVER(DRIVER_WIFI_INFO, WiFi.gatewayIP()), EASYWIFI_DRIVER(DRIVER_WIFI_RSSI, WiFi.RSSI()));
+}
+
+// One RSSI read, and only when connected: every driver call is an SPI round-trip to the module
+bool EasyWiFi::IsWifiNotConnectedOrReachable(int wifiStatus)
+{
+	if (wifiStatus != WL_CONNECTED)
+		return true;
+	int32_t rssi = EASYWIFI_DRIVER(DRIVER_WIFI_RSSI, WiFi.RSSI());
+	return (rssi <= -90) || (rssi == 0);
+}
+
+// Issue one connection attempt, the result is awaited in EASYWIFI_CONNECT_WAIT
+void EasyWiFi::TryToConnectToWifiWithCredentials()
+{
+	EASYWIFI_LOG_TEXT(LOG_LEVEL_INFO, EVENT_CONNECT_ATTEMPT, G_SSID);
+	EASYWIFI_DRIVER_VOID(DRIVER_WIFI_BEGIN, WiFi.begin(G_SSID, G_PASS));     // Connect to WPA/WPA2 network. Change this line if using open or WEP network:
+	MarkPhase(m_Timeline.firstBegin);
+	if (m_RetryPending)
+	{
+		m_RetryPending = false;
+		m_Timeline.lastRetry = millis() - m_BeginTime;
+		m_Timeline.retryTimes[m_Timeline.retries % TIMELINE_RETRY_HISTORY] = m_Timeline.lastRetry;
+		m_Timeline.retries++;
+	}
+	m_RetryPolicy.OnAttempt();      // try-counter of the current network
+	m_TotalConnectionAttempts++;    // count total failed connects
+}
+
+#if EASYWIFI_WITH_PORTAL
+void EasyWiFi::UpdateDeviceConnectedStatus()
+{
+	// Check AP status - new client on or off?
+	int status = EASYWIFI_DRIVER(DRIVER_WIFI_STATUS, WiFi.status());
+	if (G_AP_Status != status)
+	{
+		G_AP_Status = status;        // it has changed update the variable
+		if (G_AP_Status == WL_AP_CONNECTED) // a device has connected to the AP
+		{
+			EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_AP_DEVICE_CONNECTED, 0, 0);
+			SetNINA_LED(CYAN); // Client on AP : CYAN
+#if EASYWIFI_WITH_DNS
+			G_DNS_RequestCounter = 0; // reset DNS counter
+#endif
+		}
+		else // a device has disconnected from the AP, and we are back in listening mode
+		{
+			EASYWIFI_LOG(LOG_LEVEL_INFO, EVENT_AP_DEVICE_DISCONNECTED, 0, 0);
+		}
+	} // end if loop changed G_AP_Status  
+}
+#endif
@@ -1,76 +1,277 @@
-/*
-* EasyWiFi
-* Based on Version 1.4.1 by John V. - 2020
-* Released into the public domain on github: https://github.com/javos65/EasyWifi-for-MKR1010
-* Modified by Daniel Patyk May 2023
-* Version: 1.4.2 https://github/SirPytan/EasyWifi
-* Editor:	http://www.visualmicro.com
-*/
-#ifndef EASYWIFI_h
-#define EASYWIFI_h
-
-#include "arduino.h"
-#include <WiFiNINA.h>
-#include <WiFiUdp.h>
-
-
-// Define AccessPoint(AP) Wifi-Client parameters
-#define MAX_SSID 10                          // MAX number of SSID's listed after search
-#define SSID_BUFFER_SIZE 32                   // SSID name BUFFER size
-#define ACCESS_POINT_CHANNEL  5                        // AP wifi channel
-#define SECRET_SSID "YourHomenetworName"	    // Hardcoded SSID - not required
-#define SECRET_PASS "YourPassword"	        // Hardcoded Pass - not required
-
-#define ACCESS_POINT_NAME "EasyWiFi_AP"
-#define MAX_CONNECT 4                        // Max number of wifi logon connects before opening AP
-#define ESCAPE_CONNECT 15                    // Max number of Total wifi logon retries-connects before escaping/stopping the Wifi start
-
-// Define UDP settings for DNS 
-#define UDP_PACKET_SIZE 1024          // UDP packet size time out, preventign too large packet reads
-#define DNS_HEADER_SIZE 12             // DNS Header
-#define DNS_ANSWER_SIZE 16             // DNS Answer = standard set with Packet Compression
-#define DNS_MAX_REQUESTS 32             // trigger first DNS requests, to redirect to own web-page
-#define UDP_PORT  53                   // local port to listen for UDP packets
-
-// Define RGB values for NINALed
-#define RED 16,0,0
-#define ORANGE 5,3,0
-#define GREEN 0,8,0
-#define BLUE 0,0,20
-#define PURPLE 6,0,10
-#define CYAN 0,6,10
-#define BLACK 0,0,0
-
-class EasyWiFi
-{
-public:
-    EasyWiFi();
-    void Start();
-    byte Erase();
-    byte SetAccessPointName(char* name);
-    void SetSeed(int seed);
-    void UseLED(boolean value);
-    void UseAccessPoint(boolean value);
-    void SetNINA_LED(char r, char g, char b);
-
-private:
-    void ListNetworks();
-    void AccessPointSetup();
-    void AccessPointDNSScan();
-    void AccessPointWiFiClientCheck();
-    void AccessPointWiFiClientCheck_Test();
-    void PrintWiFiStatus();
-    bool IsWifiNotConnectedOrReachable(int wifiStatus);
-    int TryToConnectToWifiWithCredentials();
-    void UpdateDeviceConnectedStatus();
-    void processRequest(WiFiClient client);
-    void handleProvidedWifiCredentials(WiFiClient client, String request);
-    void sendStartPage(WiFiClient client);
-    void sendNetworkList(WiFiClient client);
-    void sendEnterWifiPasswordPage(WiFiClient client, String request);
-    String getValueFromRequest(String requestBody, String key);
-    String urlDecode(String str);
-    boolean connectToNetwork(String networkName, String password);
-};
-
-#endif
+/*
+* EasyWiFi
+* Based on Version 1.4.1 by John V. - 2020
+* Released into the public domain on github: https://github.com/javos65/EasyWifi-for-MKR1010
+* Modified by Daniel Patyk May 2023
+* Version: 1.4.2 https://github/SirPytan/EasyWifi
+* Editor:	http://www.visualmicro.com
+*/
+#ifndef EASYWIFI_h
+#define EASYWIFI_h
+
+#include <Arduino.h>
+#include <WiFiNINA.h>
+#include <WiFiUdp.h>
+#include "EasyWiFiConfig.h"
+#include "HttpRequestParser.h"
+#include "HttpResponseWriter.h"
+#include "JsonWriter.h"
+#include "RetryPolicy.h"
+#include "LinkMonitor.h"
+#include "PortalStats.h"
+#include "CredentialsHandler.h"
+#include "DriverTrace.h"
+#include "EventLog.h"
+#include "PortalArena.h"
+
+
+// Define AccessPoint(AP) Wifi-Client parameters
+#define SCAN_CACHE_TTL 120000                // Time in ms a scan is reused when the portal opens again
+#define SCAN_MIN_INTERVAL 10000              // Time in ms a portal rescan request is ignored after the last scan
+#define SSID_BUFFER_SIZE 32                   // SSID name BUFFER size
+#define ACCESS_POINT_CHANNEL  5                        // AP wifi channel
+#define SECRET_SSID "YourHomenetworName"	    // Hardcoded SSID - not required
+#define SECRET_PASS "YourPassword"	        // Hardcoded Pass - not required
+
+#define ACCESS_POINT_NAME "EasyWiFi_AP"
+#define ESCAPE_CONNECT 15                    // Max number of Total wifi logon retries-connects before escaping/stopping the Wifi start
+#define CONNECT_TIMEOUT 10000                // Time in ms a single WiFi.begin() attempt gets to reach WL_CONNECTED
+#define CONNECT_POLL_INTERVAL 100            // Time in ms between two status reads while waiting for a connection
+#define ACCESS_POINT_SHUTDOWN_TIME 3000      // Time in ms to wait after WiFi.end() before the AP is started
+#define ACCESS_POINT_SETTLE_TIME 2000        // Time in ms to wait after the AP is listening before the servers are started
+#define ACCESS_POINT_SETUP_TRIES 5           // Max number of WiFi.beginAP() tries
+#define RECONNECT_SETTLE_TIME 2000           // Time in ms to wait after closing the AP before connecting with new credentials
+#define FAST_CONNECT_TIMEOUT 4000            // Time in ms the fast reconnect with the cached lease gets before the DHCP path is taken
+#define FAST_CONNECT_POLL_INTERVAL 20        // Time in ms between two status reads on the fast reconnect path
+
+// Define UDP settings for DNS 
+#define DNS_MAX_REQUESTS 32             // trigger first DNS requests, to redirect to own web-page
+#define UDP_PORT  53                   // local port to listen for UDP packets
+#define DNS_MAX_PACKETS_PER_POLL 16    // Max number of DNS queries answered per Poll()
+#define DNS_POLL_TIME_BUDGET 2000      // Time in us after which no further DNS query is read in the same Poll()
+
+// Define access point web server settings
+#define PORTAL_REQUEST_TIMEOUT 3000    // Time in ms a client gets to send a complete request
+#define PORTAL_IDLE_TIMEOUT 1000       // Time in ms a connection may stay silent in the middle of a request
+#define PORTAL_KEEPALIVE_TIMEOUT 5000  // Time in ms an idle keep-alive connection waits for its next request
+#define PORTAL_KEEPALIVE_MAX_REQUESTS 10 // Requests served over one connection before it is closed
+
+// Define RGB values for NINALed
+#define RED 16,0,0
+#define ORANGE 5,3,0
+#define GREEN 0,8,0
+#define BLUE 0,0,20
+#define PURPLE 6,0,10
+#define CYAN 0,6,10
+#define BLACK 0,0,0
+
+// States of the connection state machine, advanced by EasyWiFi::Poll()
+enum EasyWiFiState
+{
+    EASYWIFI_IDLE,              // Begin() not called yet
+    EASYWIFI_READ_CREDENTIALS,  // Read stored credentials from flash
+    EASYWIFI_FAST_CONNECT_WAIT, // Wait for the reconnect with the cached static lease
+    EASYWIFI_SELECT_NETWORK,    // Scan and order the stored networks in range
+    EASYWIFI_CONNECT,           // Issue WiFi.begin() with the current credentials
+    EASYWIFI_CONNECT_WAIT,      // Wait for WL_CONNECTED or the attempt timeout
+    EASYWIFI_RETRY_WAIT,        // Back off before the next attempt, see RetryPolicy
+    EASYWIFI_SCAN,              // Scan for networks to offer in the portal
+    EASYWIFI_AP_SETUP,          // Wait for the module to shut down, then start the AP
+    EASYWIFI_AP_LISTENING,      // AP is up, wait before starting the DNS and web server
+    EASYWIFI_PORTAL,            // Serve DNS and HTTP until credentials are entered
+    EASYWIFI_VERIFY,            // AP closed, wait before verifying the new credentials
+    EASYWIFI_CONNECTED,         // Connected (final state), the link is watched by LinkMonitor
+    EASYWIFI_FAILED             // Gave up connecting (final state)
+};
+
+// Outcome of the last credentials entered in the portal, see EasyWiFi::GetProvisionResult()
+enum EasyWiFiProvisionResult
+{
+    EASYWIFI_PROVISION_NONE,        // No credentials entered since Begin()
+    EASYWIFI_PROVISION_PENDING,     // Credentials received, being verified
+    EASYWIFI_PROVISION_CONNECTED,   // Verified and stored
+    EASYWIFI_PROVISION_FAILED       // Could not connect, the portal opened again
+};
+
+// One network of the portal scan, see EasyWiFi::GetScanResult()
+struct EasyWiFiNetwork
+{
+    char ssid[CREDENTIALS_SSID_SIZE];
+    uint8_t bssid[6];       // Access point with the strongest signal for this SSID
+    int32_t rssi;           // dBm
+    uint8_t channel;
+    uint8_t encryption;     // ENC_TYPE_...
+};
+
+#define EASYWIFI_PHASE_NONE 0xFFFFFFFF    // Phase of EasyWiFiTimeline not reached
+
+// Time in ms after Begin() at which each phase of the login was first reached, and counters since Begin()
+struct EasyWiFiTimeline
+{
+    unsigned long credentialsRead;      // Stored networks read from flash
+    unsigned long firstBegin;           // First WiFi.begin() issued
+    unsigned long lastRetry;            // WiFi.begin() of the last retry after a back off
+    unsigned long scanDone;             // Portal scan finished (or taken from the cache)
+    unsigned long apListening;          // Access point up, DNS and web server started
+    unsigned long firstDnsQuery;        // First DNS query answered
+    unsigned long firstHttpRequest;     // First portal request answered
+    unsigned long credentialsReceived;  // Credentials entered in the portal
+    unsigned long connected;            // WL_CONNECTED reached
+    unsigned long retries;              // Retries after a back off
+    unsigned long failedAttempts;       // WiFi.begin() attempts that timed out
+    unsigned long dnsReplies;           // DNS queries answered
+    unsigned long httpRequests;         // Portal requests answered
+    unsigned long bytesSent;            // Bytes of all portal responses
+    unsigned long retryTimes[TIMELINE_RETRY_HISTORY]; // Times of the last retries, retry n (from 1) in slot (n - 1) % TIMELINE_RETRY_HISTORY
+};
+
+// Counters of the captive portal DNS server
+struct EasyWiFiDnsStats
+{
+    unsigned long packetsHandled;   // Queries answered
+    unsigned long packetsDropped;   // Own, malformed or response packets not answered
+    unsigned long packetsOversize;  // Packets larger than UDP_PACKET_SIZE, discarded unread
+    unsigned int queueHighWater;    // Most queries found pending in one Poll()
+};
+
+// One Access Point web server connection with its own parse state, advanced by Poll()
+struct PortalConnection
+{
+    WiFiClient client;
+    HttpRequestParser parser;
+    unsigned long requestStartTime;  // millis() when the current request was accepted
+    unsigned long lastActivityTime;  // millis() when the last bytes were received
+    unsigned int requestCount;       // Requests answered on this connection
+    boolean requestStarted;          // Bytes of the current request were received
+    boolean keepAlive;               // Keep the connection open after the current response
+    boolean inUse;
+};
+
+class EasyWiFi
+{
+public:
+    EasyWiFi();
+    void Start();
+    void Begin();
+    EasyWiFiState Poll();
+    EasyWiFiState GetState();
+    boolean IsFinished();
+    byte Erase();
+    byte SetAccessPointName(char* name);
+    void SetSeed(int seed);
+    void UseLED(boolean value);
+    void UseAccessPoint(boolean value);
+    void UseFastReconnect(boolean value);
+    RetryPolicy& GetRetryPolicy();
+    LinkMonitor& GetLinkMonitor();
+    void UseLinkMonitor(boolean value);
+    unsigned long GetTimeToConnect();
+    boolean IsFastReconnect();
+    void SetNINA_LED(char r, char g, char b);
+#if EASYWIFI_WITH_DNS
+    EasyWiFiDnsStats GetDnsStats();
+#endif
+#if EASYWIFI_WITH_PORTAL
+    void SetDnsBudget(unsigned int maxPackets, unsigned long timeBudget);
+    const EasyWiFiRouteStats& GetPortalStats(EasyWiFiPortalRoute route);
+    unsigned long GetPortalLatency(EasyWiFiPortalRoute route, uint8_t percent);
+    void PrintPortalStats(Print& out);
+    PortalArena& GetPortalArena();
+#endif
+    byte AddNetwork(const char* ssid, const char* password, uint8_t priority = CREDENTIALS_DEFAULT_PRIORITY);
+    byte RemoveNetwork(const char* ssid);
+    int GetNetworkCount();
+    boolean GetNetwork(int index, WiFiNetworkCredentials& network);
+#if EASYWIFI_WITH_PORTAL
+    int GetScanCount();
+    const EasyWiFiNetwork* GetScanResult(int index);
+    unsigned long GetScanAge();
+    unsigned long GetScanDuration();
+#endif
+    EasyWiFiProvisionResult GetProvisionResult();
+    const EasyWiFiTimeline& GetTimeline();
+
+private:
+    void ListNetworks();
+    void StoreScanResult(EasyWiFiNetwork& entry, int index, const char* ssid, int32_t rssi);
+    void ScanHeapUp(int index);
+    void ScanHeapDown(int index, int count = -1);
+    void SelectStoredNetworks();
+    void LoadCandidate();
+    void SetState(EasyWiFiState state);
+    boolean OpenPortalSession();
+    void ClosePortalSession();
+    void AccessPointSetup();
+    void AccessPointStart();
+    void AccessPointStop();
+    void AccessPointDNSScan();
+    boolean AccessPointDNSReply();
+    void AccessPointWiFiClientCheck();
+    PortalConnection* FindPortalConnection(WiFiClient client);
+    void ServicePortalConnection(PortalConnection& connection);
+    void ClosePortalConnection(PortalConnection& connection);
+    void LogWiFiStatus();
+    bool IsWifiNotConnectedOrReachable(int wifiStatus);
+    void TryToConnectToWifiWithCredentials();
+    void HandleConnectTimeout();
+    boolean TryFastReconnect();
+    boolean IsCachedAccessPoint();
+    void AbandonFastReconnect();
+    void HandleConnected();
+    void UpdateReconnectCache();
+    void UpdateDeviceConnectedStatus();
+    boolean processRequest(PortalConnection& connection);
+    void handleProvidedWifiCredentials(HttpResponseWriter& response, PortalConnection& connection);
+    const char* validateCredentials(const char* ssid, const char* password);
+    void sendStartPage(HttpResponseWriter& response, PortalConnection& connection);
+    void sendAsset(HttpResponseWriter& response, PortalConnection& connection, const char* page, size_t pageSize, const uint8_t* pageGzip, size_t pageGzipSize);
+    void sendHeader(HttpResponseWriter& response, PortalConnection& connection, int status, const char* headers, long contentLength);
+    const char* getStatusReason(int status);
+    void sendNetworkList(HttpResponseWriter& response, PortalConnection& connection);
+    void handleRefresh(HttpResponseWriter& response, PortalConnection& connection);
+    boolean IsPortalBusy();
+    void sendMetrics(HttpResponseWriter& response, PortalConnection& connection);
+    void printMetric(Print& out, const char* phase, unsigned long value);
+    void ResetTimeline();
+    void MarkPhase(unsigned long& phase);
+    void sendApiNetworks(HttpResponseWriter& response, PortalConnection& connection);
+    void sendApiStatus(HttpResponseWriter& response, PortalConnection& connection);
+    void handleApiCredentials(HttpResponseWriter& response, PortalConnection& connection);
+    void sendApiResult(HttpResponseWriter& response, PortalConnection& connection);
+#ifdef EASYWIFI_TRACE
+    void sendApiTrace(HttpResponseWriter& response, PortalConnection& connection);
+#endif
+    static const char* getStateName(EasyWiFiState state);
+    static const char* getProvisionResultName(EasyWiFiProvisionResult result);
+    void sendEnterWifiPasswordPage(HttpResponseWriter& response, PortalConnection& connection);
+    boolean isCaptivePortalProbe(const char* path);
+    void printUrlEncoded(Print& out, const char* text);
+    void printHtmlEscaped(Print& out, const char* text);
+
+    EasyWiFiState m_State;
+    unsigned long m_StateEnteredTime;  // millis() when the current state was entered
+    unsigned long m_LastStatusPoll;    // millis() of the last WiFi.status() read while connecting
+    RetryPolicy m_RetryPolicy;         // Backoff and attempt budget per network
+    LinkMonitor m_LinkMonitor;         // Watches the connection once EASYWIFI_CONNECTED is reached
+    unsigned long m_RetryDelay;        // Time in ms to wait in EASYWIFI_RETRY_WAIT
+    EasyWiFiState m_RetryState;        // State entered once the retry delay is over
+    boolean m_RetryPending;            // The next WiFi.begin() is a retry after a back off
+    int m_TotalConnectionAttempts;     // WiFi.begin() attempts since Begin()
+    int m_AccessPointTries;            // WiFi.beginAP() attempts of the current AP setup
+    boolean m_PortalCredentials;       // Current credentials were entered in the portal, store them on success
+    uint8_t m_Candidates[CREDENTIALS_MAX_NETWORKS]; // Stored network indices to try, most preferred first
+    int m_CandidateCount;              // Entries of m_Candidates, 0 when connecting with hardcoded or portal credentials
+    int m_CandidateIndex;              // Entry of m_Candidates currently tried
+    unsigned long m_BeginTime;         // millis() when Begin() was called
+    unsigned long m_TimeToConnect;     // Time in ms from Begin() to WL_CONNECTED
+    boolean m_FastReconnectTried;      // The cached lease was tried since Begin()
+    boolean m_FastReconnect;           // Connected through the cached lease
+    boolean m_RescanRequested;         // The portal asked for a rescan, done once no request is in flight
+    boolean m_Rescanning;              // Scan and AP setup of a portal rescan are in progress
+    EasyWiFiProvisionResult m_ProvisionResult; // Outcome of the last portal credentials
+    EasyWiFiTimeline m_Timeline;       // Phases and counters since Begin()
+    unsigned int m_DnsMaxPackets;      // DNS queries answered per Poll() at most
+    unsigned long m_DnsTimeBudget;     // DNS time budget per Poll() in us
+};
+
+#endif
@@ -0,0 +1,70 @@
+// EasyWiFiConfig.h
+// Compile time features and sizes of the library. The Arduino IDE builds the library apart from the sketch,
+// so a #define in the sketch does not reach it: edit the defaults here, or pass them as build flags
+// (PlatformIO build_flags = -DEASYWIFI_WITH_PORTAL=0, arduino-cli --build-property compiler.cpp.extra_flags=...).
+// extras/tools/size_report.py prints .text / .data / .bss of the usual combinations.
+
+#ifndef _EASYWIFICONFIG_h
+#define _EASYWIFICONFIG_h
+
+// Access point portal: scan list, web server, pages and JSON API. Without it a login that finds
+// no stored network fails (or starts over, see RetryPolicy) and none of the portal buffers exist
+#ifndef EASYWIFI_WITH_PORTAL
+#define EASYWIFI_WITH_PORTAL 1
+#endif
+
+// Captive portal DNS responder and its UDP packet buffer, needs EASYWIFI_WITH_PORTAL
+#ifndef EASYWIFI_WITH_DNS
+#define EASYWIFI_WITH_DNS 1
+#endif
+
+// State colours on the RGB LED of the NINA module
+#ifndef EASYWIFI_WITH_LED
+#define EASYWIFI_WITH_LED 1
+#endif
+
+// Events kept in the EventLog ring: 0 off, 1 errors, 2 + warnings, 3 + info, 4 + debug.
+// Events above this level are not compiled in, see EventLog.h
+#ifndef EASYWIFI_LOG_LEVEL
+#define EASYWIFI_LOG_LEVEL 3
+#endif
+
+#if !EASYWIFI_WITH_PORTAL
+#undef EASYWIFI_WITH_DNS
+#define EASYWIFI_WITH_DNS 0
+#endif
+
+// Sizes, see the headers that use them
+#ifndef MAX_SSID
+#define MAX_SSID 10                      // Networks listed in the portal, the strongest are kept
+#endif
+
+#ifndef UDP_PACKET_SIZE
+#define UDP_PACKET_SIZE 1024             // Largest DNS query read, larger packets are discarded unread
+#endif
+
+#ifndef PORTAL_MAX_CONNECTIONS
+#define PORTAL_MAX_CONNECTIONS 4         // Web server connections served side by side (NINA offers a few sockets)
+#endif
+
+#ifndef HTTP_RESPONSE_BUFFER_SIZE
+#define HTTP_RESPONSE_BUFFER_SIZE 1460   // One TCP segment (MSS), the response goes out in writes of this size
+#endif
+
+#ifndef EVENT_LOG_SIZE
+#define EVENT_LOG_SIZE 32                // Records in the EventLog ring (16 bytes each), the oldest are overwritten
+#endif
+
+#ifndef TIMELINE_RETRY_HISTORY
+#define TIMELINE_RETRY_HISTORY 8         // Times of the most recent retries kept in the timeline, for /metrics
+#endif
+
+#ifndef PORTAL_ARENA_SIZE
+#define PORTAL_ARENA_SIZE 0              // Bytes taken from the heap while the portal is up, 0 sizes it to the portal buffers
+#endif
+
+#ifndef CREDENTIALS_MAX_NETWORKS
+#define CREDENTIALS_MAX_NETWORKS 5       // Networks kept in the credential store
+#endif
+
+#endif
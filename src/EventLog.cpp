@@ -0,0 +1,95 @@
+
+#include "EventLog.h"
+
+EventLogRecord EventLog::m_Records[EVENT_LOG_RECORDS];
+uint8_t EventLog::m_Level = EASYWIFI_LOG_LEVEL;
+uint16_t EventLog::m_Head = 0;
+uint16_t EventLog::m_Count = 0;
+uint16_t EventLog::m_Sequence = 0;
+unsigned long EventLog::m_Overrun = 0;
+Print* EventLog::m_Sink = NULL;
+
+// Events above level are dropped at runtime, the compiled level EASYWIFI_LOG_LEVEL is the upper limit
+void EventLog::SetLevel(EventLogLevel level)
+{
+	m_Level = level;
+}
+
+// Service() drains the ring to out, NULL (the default) keeps the records until Drain() is called
+void EventLog::SetSink(Print* out)
+{
+	m_Sink = out;
+}
+
+void EventLog::Clear()
+{
+	m_Count = 0;
+	m_Overrun = 0;
+}
+
+// Event with the first 8 characters of text, zero padded, in place of the two arguments
+void EventLog::WriteText(uint8_t level, uint8_t event, const char* text)
+{
+	int32_t args[2] = { 0, 0 };
+	char* bytes = (char*)args;
+	for (uint8_t i = 0; i < sizeof(args) && text[i] != 0; i++)
+		bytes[i] = text[i];
+	Write(level, event, args[0], args[1]);
+}
+
+// Write up to maxRecords of the oldest records to out and remove them, returns the number written
+unsigned int EventLog::Drain(Print& out, unsigned int maxRecords)
+{
+	unsigned int written = 0;
+	while (m_Count > 0 && written < maxRecords)
+	{
+		uint16_t tail = (m_Head + EVENT_LOG_RECORDS - m_Count) % EVENT_LOG_RECORDS;
+		WriteRecord(out, m_Records[tail]);
+		m_Count--;
+		written++;
+	}
+	return written;
+}
+
+// Lazy drain from Poll(): a few records per call to the sink, if one is set
+void EventLog::Service()
+{
+	if (m_Sink != NULL && m_Count > 0)
+		Drain(*m_Sink, EVENT_LOG_DRAIN_PER_POLL);
+}
+
+// Records waiting to be drained
+unsigned int EventLog::GetCount()
+{
+	return m_Count;
+}
+
+// Records overwritten before they were drained since the last Clear()
+unsigned long EventLog::GetOverrun()
+{
+	return m_Overrun;
+}
+
+// "~EL " + the 16 record bytes little endian as hex, one write per record
+void EventLog::WriteRecord(Print& out, const EventLogRecord& record)
+{
+	static const char hex[] = "0123456789abcdef";
+	uint8_t bytes[sizeof(EventLogRecord)];
+	uint32_t words[4] = { record.time,
+		(uint32_t)record.event | ((uint32_t)record.level << 8) | ((uint32_t)record.sequence << 16),
+		(uint32_t)record.args[0], (uint32_t)record.args[1] };
+	for (uint8_t i = 0; i < sizeof(bytes); i++)
+		bytes[i] = (uint8_t)(words[i / 4] >> ((i % 4) * 8));
+
+	char line[sizeof(EVENT_LOG_PREFIX) - 1 + 2 * sizeof(EventLogRecord) + 2];
+	size_t length = sizeof(EVENT_LOG_PREFIX) - 1;
+	memcpy(line, EVENT_LOG_PREFIX, length);
+	for (uint8_t i = 0; i < sizeof(bytes); i++)
+	{
+		line[length++] = hex[bytes[i] >> 4];
+		line[length++] = hex[bytes[i] & 0x0F];
+	}
+	line[length++] = '\r';
+	line[length++] = '\n';
+	out.write((const uint8_t*)line, length);
+}
@@ -0,0 +1,166 @@
+// EventLog.h
+
+#ifndef _EVENTLOG_h
+#define _EVENTLOG_h
+
+#include <Arduino.h>
+#include "EasyWiFiConfig.h"              // EASYWIFI_LOG_LEVEL, EVENT_LOG_SIZE
+
+#define EVENT_LOG_DRAIN_PER_POLL 2       // Records written to the sink per Service() call
+#define EVENT_LOG_PREFIX "~EL "          // Start of a drained record line, extras/tools/decode_log.py looks for it
+
+#if EASYWIFI_LOG_LEVEL > 0
+#define EVENT_LOG_RECORDS EVENT_LOG_SIZE
+#else
+#define EVENT_LOG_RECORDS 1              // Logging is compiled out, nothing is ever written
+#endif
+
+enum EventLogLevel
+{
+    LOG_LEVEL_OFF,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_DEBUG
+};
+
+/* Events of EasyWiFi and CredentialsHandler. Only the number is stored, the text after // is the
+   format extras/tools/decode_log.py prints: {d} signed, {u} unsigned, {x} hex, {ip} IPv4 address
+   take one argument, {s} takes both as text of up to 8 characters, {EnumName} prints the enumerator
+   of a library enum. Append new events at the end, a capture is decoded with the header of its build */
+enum EventLogId
+{
+    EVENT_STATE,                // State {EasyWiFiState}
+    EVENT_ALREADY_CONNECTED,    // Already connected as {ip}
+    EVENT_HARDCODED_CREDENTIALS,// Using hardcoded credentials
+    EVENT_FAST_RECONNECT,       // Fast reconnect as {ip}
+    EVENT_FAST_RECONNECT_FAILED,// Fast reconnect failed, using DHCP
+    EVENT_CONNECT_ATTEMPT,      // Connecting to {s}
+    EVENT_CONNECTED,            // Connected after {u} ms as {ip}
+    EVENT_CONNECTED_FAST,       // Connected after {u} ms as {ip} (fast reconnect)
+    EVENT_WIFI_STATUS,          // Gateway {ip}, RSSI {d} dBm
+    EVENT_RETRY_WAIT,           // Retry in {u} ms
+    EVENT_START_OVER,           // All networks exhausted, starting over
+    EVENT_LOGIN_FAILED,         // Connection not possible after too many retries, quit
+    EVENT_OPEN_PORTAL,          // Connection not possible after several retries, opening access point
+    EVENT_LINK_DEGRADED,        // Link degraded, RSSI {d} dBm, reconnecting
+    EVENT_LINK_LOST,            // Link lost, reconnecting
+    EVENT_CANDIDATES,           // Stored networks in range: {u}
+    EVENT_SCAN_FAILED,          // Couldn't get a WiFi list
+    EVENT_SCAN_DONE,            // Found {u} networks in {u} ms
+    EVENT_SCAN_ENTRY,           // Network {u}: {d} dBm
+    EVENT_SCAN_SSID,            //   SSID {s}
+    EVENT_RESCAN_SCHEDULED,     // Rescan scheduled
+    EVENT_RESCAN,               // Rescan requested by the portal
+    EVENT_AP_CREATE,            // Creating access point {s}
+    EVENT_AP_LISTENING,         // Access point listening at {ip}
+    EVENT_AP_SETUP_RETRY,       // Access point setup, try {u}
+    EVENT_AP_FAILED,            // Creating access point failed
+    EVENT_AP_DEVICE_CONNECTED,  // Device connected to access point
+    EVENT_AP_DEVICE_DISCONNECTED, // Device disconnected from access point
+    EVENT_DNS_QUERY,            // DNS query of {u} bytes from {ip}
+    EVENT_DNS_REPLY,            // DNS reply of {u} bytes
+    EVENT_CLIENT_NEW,           // New portal client
+    EVENT_CLIENT_REFUSED,       // Portal client refused, no free connection
+    EVENT_CLIENT_TIMEOUT,       // Portal request timed out
+    EVENT_CLIENT_CLOSED,        // Portal client disconnected
+    EVENT_REQUEST_MALFORMED,    // Malformed request, status {u}
+    EVENT_RESPONSE,             // {EasyWiFiPortalRoute} answered with {u} bytes
+    EVENT_PORTAL_SSID,          // Entered SSID {s}
+    EVENT_API_SSID,             // API SSID {s}
+    EVENT_CREDENTIALS_READ,     // Read {u} credentials
+    EVENT_CREDENTIALS_READ_FAILED, // Can't read credentials
+    EVENT_CREDENTIALS_VERSION,  // Unknown credentials version {u}
+    EVENT_CREDENTIALS_CORRUPT,  // Skipped corrupt credentials record at {u}
+    EVENT_CREDENTIALS_REPLACED, // Credentials full, replacing {s}
+    EVENT_CREDENTIALS_APPENDED, // Appended credentials record at {u}
+    EVENT_CREDENTIALS_COMPACTED,// Compacted credentials, {u} bytes
+    EVENT_CREDENTIALS_MIGRATED, // Migrating credentials to the encrypted format
+    EVENT_CREDENTIALS_ERASED,   // Erased credentials file
+    EVENT_CREDENTIALS_ERASE_FAILED, // Could not erase credentials file
+    EVENT_CREDENTIALS_FOUND,    // Found credentials file
+    EVENT_CREDENTIALS_MISSING,  // Could not find credentials file
+    EVENT_RECONNECT_INVALID,    // No valid reconnect cache
+    EVENT_RECONNECT_WRITTEN,    // Written reconnect cache, {u} bytes
+    EVENT_PORTAL_ARENA,         // Portal closed, arena used {u} of {u} bytes
+    EVENT_PORTAL_ARENA_FAILED,  // No RAM for the portal: arena of {u} bytes, {u} allocated
+    EVENT_FAST_RECONNECT_MOVED, // Fast reconnect reached another access point, using DHCP
+    EVENT_COUNT
+};
+
+// One event as kept in RAM and drained, 16 bytes little endian
+struct EventLogRecord
+{
+    uint32_t time;              // millis()
+    uint8_t event;              // EventLogId
+    uint8_t level;              // EventLogLevel
+    uint16_t sequence;          // Running number, a gap in a capture means records were lost
+    int32_t args[2];
+};
+
+/* Deferred event log. Logging stores a record in a fixed RAM ring and returns, no text is formatted
+   and no format string is kept on the board. The ring is written out on demand with Drain(), or a few
+   records per Poll() once a sink is set, as "~EL " + 32 hex digits per line. decode_log.py turns a
+   capture of these lines back into text. When the ring is full the oldest records are overwritten. */
+class EventLog
+{
+public:
+    static void SetLevel(EventLogLevel level);
+    static void SetSink(Print* out);
+    static void Clear();
+
+    static inline boolean IsEnabled(uint8_t level)
+    {
+        return level <= m_Level;
+    }
+    static inline void Write(uint8_t level, uint8_t event, int32_t a, int32_t b)
+    {
+        EventLogRecord& record = m_Records[m_Head];
+        record.time = millis();
+        record.event = event;
+        record.level = level;
+        record.sequence = m_Sequence++;
+        record.args[0] = a;
+        record.args[1] = b;
+        if (++m_Head == EVENT_LOG_RECORDS)
+            m_Head = 0;
+        if (m_Count < EVENT_LOG_RECORDS)
+            m_Count++;
+        else
+            m_Overrun++;
+    }
+    static void WriteText(uint8_t level, uint8_t event, const char* text);
+
+    static unsigned int Drain(Print& out, unsigned int maxRecords = EVENT_LOG_RECORDS);
+    static void Service();
+    static unsigned int GetCount();
+    static unsigned long GetOverrun();
+
+private:
+    static void WriteRecord(Print& out, const EventLogRecord& record);
+
+    static EventLogRecord m_Records[EVENT_LOG_RECORDS];
+    static uint8_t m_Level;
+    static uint16_t m_Head;            // Next record written
+    static uint16_t m_Count;           // Records not drained yet
+    static uint16_t m_Sequence;
+    static unsigned long m_Overrun;    // Records overwritten before they were drained
+    static Print* m_Sink;
+};
+
+#if EASYWIFI_LOG_LEVEL > 0
+
+// Log event with two integer arguments. Events above EASYWIFI_LOG_LEVEL are not compiled, the arguments
+// of events filtered by SetLevel() are not evaluated
+#define EASYWIFI_LOG(level, event, a, b) do { if ((level) <= EASYWIFI_LOG_LEVEL && EventLog::IsEnabled(level)) EventLog::Write((level), (event), (int32_t)(a), (int32_t)(b)); } while (0)
+// Log event with the first 8 characters of text as its arguments
+#define EASYWIFI_LOG_TEXT(level, event, text) do { if ((level) <= EASYWIFI_LOG_LEVEL && EventLog::IsEnabled(level)) EventLog::WriteText((level), (event), (text)); } while (0)
+
+#else
+
+#define EASYWIFI_LOG(level, event, a, b) do { } while (0)
+#define EASYWIFI_LOG_TEXT(level, event, text) do { } while (0)
+
+#endif
+
+#endif
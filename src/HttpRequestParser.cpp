@@ -0,0 +1,399 @@
+
+#include "HttpRequestParser.h"
+
+HttpRequestParser::HttpRequestParser()
+{
+	Reset();
+}
+
+// Prepare for the next request on the same or a new connection
+void HttpRequestParser::Reset()
+{
+	m_State = HTTP_PARSE_METHOD;
+	m_Method[0] = 0;
+	m_Path[0] = 0;
+	m_Query[0] = 0;
+	m_Token[0] = 0;
+	m_Value[0] = 0;
+	m_Body[0] = 0;
+	m_Length = 0;
+	m_ValueLength = 0;
+	m_BodyLength = 0;
+	m_ContentLength = 0;
+	m_HeaderBytes = 0;
+	m_VersionMinor = 0;
+	m_ErrorStatus = 0;
+	m_AcceptsGzip = false;
+	m_ConnectionClose = false;
+	m_ConnectionKeepAlive = false;
+}
+
+/* Parse the next chunk of the request. Returns the number of bytes consumed,
+   parsing stops at the end of the request so following bytes belong to the next one. */
+size_t HttpRequestParser::Feed(const uint8_t* data, size_t length)
+{
+	size_t i;
+	for (i = 0; i < length; i++)
+	{
+		char c = (char)data[i];
+
+		if (m_State < HTTP_PARSE_BODY && ++m_HeaderBytes > HTTP_MAX_HEADER_BYTES)
+		{
+			SetError(431); // Request Header Fields Too Large
+		}
+
+		switch (m_State)
+		{
+		case HTTP_PARSE_METHOD:
+			if (c == ' ' && m_Length > 0)
+			{
+				m_Method[m_Length] = 0;
+				m_Length = 0;
+				m_State = HTTP_PARSE_PATH;
+			}
+			else if (c >= 'A' && c <= 'Z' && m_Length < HTTP_METHOD_SIZE - 1)
+				m_Method[m_Length++] = c;
+			else
+				SetError(m_Length < HTTP_METHOD_SIZE - 1 ? 400 : 501);
+			break;
+
+		case HTTP_PARSE_PATH:
+		case HTTP_PARSE_QUERY:
+		{
+			char* target = (m_State == HTTP_PARSE_PATH) ? m_Path : m_Query;
+			uint16_t targetSize = (m_State == HTTP_PARSE_PATH) ? HTTP_PATH_SIZE : HTTP_QUERY_SIZE;
+			if (c == ' ')
+			{
+				target[m_Length] = 0;
+				m_Length = 0;
+				m_State = HTTP_PARSE_VERSION;
+			}
+			else if (c == '?' && m_State == HTTP_PARSE_PATH)
+			{
+				target[m_Length] = 0;
+				m_Length = 0;
+				m_State = HTTP_PARSE_QUERY;
+			}
+			else if (c == '\r' || c == '\n')
+				SetError(400); // HTTP/0.9 style request line without version
+			else if (m_Length < targetSize - 1)
+				target[m_Length++] = c;
+			else
+				SetError(414); // URI Too Long
+			break;
+		}
+
+		case HTTP_PARSE_VERSION:
+			if (c == '\n')
+			{
+				m_Token[m_Length] = 0;
+				if (m_Length != 8 || strncmp(m_Token, "HTTP/1.", 7) != 0 || m_Token[7] < '0' || m_Token[7] > '9')
+				{
+					SetError(505); // HTTP Version Not Supported
+					break;
+				}
+				m_VersionMinor = m_Token[7] - '0';
+				m_Length = 0;
+				m_State = HTTP_PARSE_HEADER_NAME;
+			}
+			else if (c != '\r')
+			{
+				if (m_Length < HTTP_TOKEN_SIZE - 1)
+					m_Token[m_Length++] = c;
+				else
+					SetError(400);
+			}
+			break;
+
+		case HTTP_PARSE_HEADER_NAME:
+			if (c == '\n')
+			{
+				if (m_Length != 0)
+				{
+					SetError(400); // Header line without ':'
+					break;
+				}
+				// Empty line: end of headers
+				m_State = (m_ContentLength > 0) ? HTTP_PARSE_BODY : HTTP_PARSE_DONE;
+				if (m_State == HTTP_PARSE_DONE)
+					return i + 1;
+			}
+			else if (c == ':')
+			{
+				m_Token[m_Length < HTTP_TOKEN_SIZE ? m_Length : HTTP_TOKEN_SIZE - 1] = 0;
+				m_ValueLength = 0;
+				m_State = HTTP_PARSE_HEADER_VALUE;
+			}
+			else if (c != '\r')
+			{
+				// Names are compared lower case, overlong names are kept truncated and never match
+				if (m_Length < HTTP_TOKEN_SIZE - 1)
+					m_Token[m_Length] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+				if (m_Length < HTTP_TOKEN_SIZE)
+					m_Length++;
+			}
+			break;
+
+		case HTTP_PARSE_HEADER_VALUE:
+			if (c == '\n')
+			{
+				m_Value[m_ValueLength] = 0;
+				ProcessHeader();
+				m_Length = 0;
+				if (m_State != HTTP_PARSE_ERROR)
+					m_State = HTTP_PARSE_HEADER_NAME;
+			}
+			else if (c != '\r' && !(m_ValueLength == 0 && (c == ' ' || c == '\t')))
+			{
+				if (m_ValueLength < HTTP_HEADER_VALUE_SIZE - 1)
+					m_Value[m_ValueLength++] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+			}
+			break;
+
+		case HTTP_PARSE_BODY:
+		{
+			// Copy as much of the body as this chunk holds in one go
+			size_t remaining = m_ContentLength - m_BodyLength;
+			size_t available = length - i;
+			size_t n = (available < remaining) ? available : remaining;
+			memcpy(m_Body + m_BodyLength, data + i, n);
+			m_BodyLength += n;
+			m_Body[m_BodyLength] = 0;
+			i += n - 1;
+			if (m_BodyLength == m_ContentLength)
+			{
+				m_State = HTTP_PARSE_DONE;
+				return i + 1;
+			}
+			break;
+		}
+
+		default: // HTTP_PARSE_DONE, HTTP_PARSE_ERROR
+			return (m_State == HTTP_PARSE_ERROR) ? length : i;
+		}
+
+		if (m_State == HTTP_PARSE_ERROR)
+			return length; // the rest of a malformed request is of no use
+	}
+	return i;
+}
+
+boolean HttpRequestParser::IsComplete()
+{
+	return m_State == HTTP_PARSE_DONE;
+}
+
+boolean HttpRequestParser::HasError()
+{
+	return m_State == HTTP_PARSE_ERROR;
+}
+
+// HTTP status code describing why the request was rejected
+int HttpRequestParser::GetErrorStatus()
+{
+	return m_ErrorStatus;
+}
+
+const char* HttpRequestParser::GetMethod()
+{
+	return m_Method;
+}
+
+const char* HttpRequestParser::GetPath()
+{
+	return m_Path;
+}
+
+const char* HttpRequestParser::GetQuery()
+{
+	return m_Query;
+}
+
+const char* HttpRequestParser::GetBody()
+{
+	return m_Body;
+}
+
+size_t HttpRequestParser::GetBodyLength()
+{
+	return m_BodyLength;
+}
+
+// Match method and path of a complete request, a NULL method matches any method
+boolean HttpRequestParser::IsRequest(const char* method, const char* path)
+{
+	return ((method == NULL) || (strcmp(m_Method, method) == 0)) && (strcmp(m_Path, path) == 0);
+}
+
+boolean HttpRequestParser::AcceptsGzip()
+{
+	return m_AcceptsGzip;
+}
+
+// Whether the client wants the connection kept open after the response
+boolean HttpRequestParser::KeepAlive()
+{
+	if (m_VersionMinor >= 1)
+		return !m_ConnectionClose;
+	return m_ConnectionKeepAlive;
+}
+
+// HTTP/1.1 or later, which allows a chunked response body
+boolean HttpRequestParser::IsHttp11()
+{
+	return m_VersionMinor >= 1;
+}
+
+/* Find key in a form-urlencoded string (query or body) and URL-decode its value into value.
+   The value is truncated to valueSize - 1 characters. */
+boolean HttpRequestParser::GetFormValue(const char* form, const char* key, char* value, size_t valueSize)
+{
+	size_t keyLength = strlen(key);
+	const char* pair = form;
+	while (*pair != 0)
+	{
+		if (strncmp(pair, key, keyLength) == 0 && pair[keyLength] == '=')
+		{
+			const char* in = pair + keyLength + 1;
+			size_t u = 0;
+			while (*in != 0 && *in != '&')
+			{
+				char decoded = *in;
+				if (*in == '+')
+				{
+					decoded = ' ';
+				}
+				else if (*in == '%' && HexValue(in[1]) >= 0 && HexValue(in[2]) >= 0)
+				{
+					decoded = (char)(HexValue(in[1]) * 16 + HexValue(in[2]));
+					in += 2;
+				}
+				if (u < valueSize - 1)
+					value[u++] = decoded;
+				in++;
+			}
+			value[u] = 0;
+			return true;
+		}
+
+		// move to the next key=value pair
+		while (*pair != 0 && *pair != '&')
+			pair++;
+		if (*pair == '&')
+			pair++;
+	}
+	if (valueSize > 0)
+		value[0] = 0;
+	return false;
+}
+
+void HttpRequestParser::SetError(int status)
+{
+	if (m_State != HTTP_PARSE_ERROR)
+		m_ErrorStatus = status;
+	m_State = HTTP_PARSE_ERROR;
+}
+
+/* Evaluate the header just read, m_Token holds the lower case name and m_Value the lower case value */
+void HttpRequestParser::ProcessHeader()
+{
+	if (strcmp(m_Token, "content-length") == 0)
+	{
+		unsigned long contentLength = 0;
+		for (uint16_t t = 0; t < m_ValueLength; t++)
+		{
+			if (m_Value[t] < '0' || m_Value[t] > '9' || contentLength >= HTTP_BODY_SIZE)
+			{
+				SetError((m_Value[t] < '0' || m_Value[t] > '9') ? 400 : 413);
+				return;
+			}
+			contentLength = contentLength * 10 + (m_Value[t] - '0');
+		}
+		if (contentLength > HTTP_BODY_SIZE - 1)
+		{
+			SetError(413); // Payload Too Large
+			return;
+		}
+		m_ContentLength = (uint16_t)contentLength;
+	}
+	else if (strcmp(m_Token, "transfer-encoding") == 0)
+	{
+		SetError(501); // Chunked request bodies are not supported
+	}
+	else if (strcmp(m_Token, "accept-encoding") == 0)
+	{
+		m_AcceptsGzip = AcceptsCoding(m_Value, "gzip");
+	}
+	else if (strcmp(m_Token, "connection") == 0)
+	{
+		m_ConnectionClose = (strstr(m_Value, "close") != NULL);
+		m_ConnectionKeepAlive = (strstr(m_Value, "keep-alive") != NULL);
+	}
+}
+
+/* True if the Accept-Encoding list names coding with a quality above 0.
+   "gzip", "br, gzip;q=0.5" accept gzip, "gzip;q=0" and "gzip ; q=0.000" refuse it */
+boolean HttpRequestParser::AcceptsCoding(const char* list, const char* coding)
+{
+	size_t codingLength = strlen(coding);
+	const char* element = list;
+	while (*element != 0)
+	{
+		while (*element == ',' || *element == ' ' || *element == '\t')
+			element++;
+		const char* end = element;
+		while (*end != 0 && *end != ',' && *end != ';' && *end != ' ' && *end != '\t')
+			end++;
+		boolean match = ((size_t)(end - element) == codingLength) && (strncmp(element, coding, codingLength) == 0);
+		boolean refused = false;
+
+		// Parameters up to the next element, only q matters
+		const char* c = end;
+		while (*c != 0 && *c != ',')
+		{
+			if (*c++ != ';')
+				continue;
+			while (*c == ' ' || *c == '\t')
+				c++;
+			if (*c != 'q')
+				continue;
+			const char* value = c + 1;
+			while (*value == ' ' || *value == '\t')
+				value++;
+			if (*value++ != '=')
+				continue;
+			while (*value == ' ' || *value == '\t')
+				value++;
+			refused = IsZeroQuality(value);
+		}
+		if (match)
+			return !refused;
+		element = c;
+	}
+	return false;
+}
+
+// qvalue "0", "0.", "0.0", "0.00" or "0.000": not acceptable at all
+boolean HttpRequestParser::IsZeroQuality(const char* value)
+{
+	if (*value++ != '0')
+		return false;
+	if (*value == '.')
+	{
+		value++;
+		for (int i = 0; i < 3 && *value == '0'; i++)
+			value++;
+	}
+	return *value == 0 || *value == ',' || *value == ';' || *value == ' ' || *value == '\t';
+}
+
+int HttpRequestParser::HexValue(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
@@ -0,0 +1,81 @@
+// HttpRequestParser.h
+
+#ifndef _HTTPREQUESTPARSER_h
+#define _HTTPREQUESTPARSER_h
+
+#include <Arduino.h>
+
+// Fixed buffer sizes, a request exceeding them is rejected with the matching HTTP status
+#define HTTP_METHOD_SIZE 8               // "GET", "POST", ...
+#define HTTP_PATH_SIZE 64                // Path without query string
+#define HTTP_QUERY_SIZE 128              // Query string without '?'
+#define HTTP_TOKEN_SIZE 24               // Header name / protocol version
+#define HTTP_HEADER_VALUE_SIZE 64        // Header value, longer values are truncated
+#define HTTP_BODY_SIZE 320               // Request body (form data), fits an URL-encoded 32 character SSID and 63 character password
+#define HTTP_MAX_HEADER_BYTES 2048       // Request line plus all headers
+#define HTTP_READ_CHUNK_SIZE 64          // Bytes fetched per WiFiClient::read(buf, n) call
+
+enum HttpParseState
+{
+    HTTP_PARSE_METHOD,
+    HTTP_PARSE_PATH,
+    HTTP_PARSE_QUERY,
+    HTTP_PARSE_VERSION,
+    HTTP_PARSE_HEADER_NAME,
+    HTTP_PARSE_HEADER_VALUE,
+    HTTP_PARSE_BODY,
+    HTTP_PARSE_DONE,
+    HTTP_PARSE_ERROR
+};
+
+// Incremental HTTP/1.x request parser, fed byte chunks as they arrive. Uses no String and no heap.
+class HttpRequestParser
+{
+public:
+    HttpRequestParser();
+    void Reset();
+    size_t Feed(const uint8_t* data, size_t length);
+
+    boolean IsComplete();
+    boolean HasError();
+    int GetErrorStatus();
+
+    const char* GetMethod();
+    const char* GetPath();
+    const char* GetQuery();
+    const char* GetBody();
+    size_t GetBodyLength();
+    boolean IsRequest(const char* method, const char* path);
+    boolean AcceptsGzip();
+    boolean KeepAlive();
+    boolean IsHttp11();
+
+    static boolean GetFormValue(const char* form, const char* key, char* value, size_t valueSize);
+
+private:
+    void SetError(int status);
+    void ProcessHeader();
+    static boolean AcceptsCoding(const char* list, const char* coding);
+    static boolean IsZeroQuality(const char* value);
+    static int HexValue(char c);
+
+    HttpParseState m_State;
+    char m_Method[HTTP_METHOD_SIZE];
+    char m_Path[HTTP_PATH_SIZE];
+    char m_Query[HTTP_QUERY_SIZE];
+    char m_Token[HTTP_TOKEN_SIZE];
+    char m_Value[HTTP_HEADER_VALUE_SIZE];
+    char m_Body[HTTP_BODY_SIZE];
+    uint16_t m_Length;             // Length of the field currently parsed
+    uint16_t m_ValueLength;        // Length of the header value currently parsed
+    uint16_t m_BodyLength;
+    uint16_t m_ContentLength;
+    uint16_t m_HeaderBytes;
+    uint8_t m_VersionMinor;        // 0 for HTTP/1.0, 1 for HTTP/1.1
+    int m_ErrorStatus;             // HTTP status to answer a malformed request with
+    boolean m_AcceptsGzip;
+    boolean m_ConnectionClose;
+    boolean m_ConnectionKeepAlive;
+};
+
+#endif
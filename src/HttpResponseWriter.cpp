@@ -0,0 +1,185 @@
+
+#include "HttpResponseWriter.h"
+#include "DriverTrace.h"
+
+HttpResponseWriter::HttpResponseWriter()
+{
+	m_Client = NULL;
+	m_Length = 0;
+	m_Limit = HTTP_RESPONSE_BUFFER_SIZE;
+	m_ChunkStart = 0;
+	m_Chunked = false;
+	m_ResponseBytes = 0;
+	m_ResponseWriteCalls = 0;
+	m_TotalWriteCalls = 0;
+	m_TotalBytesSent = 0;
+}
+
+// Start a new response to client
+void HttpResponseWriter::Begin(Client& client)
+{
+	m_Client = &client;
+	m_Length = 0;
+	m_Limit = HTTP_RESPONSE_BUFFER_SIZE;
+	m_ChunkStart = 0;
+	m_Chunked = false;
+	m_ResponseBytes = 0;
+	m_ResponseWriteCalls = 0;
+}
+
+/* Everything written from now on is body, sent with chunked transfer encoding.
+   The header must announce "Transfer-Encoding: chunked". */
+void HttpResponseWriter::BeginChunkedBody()
+{
+	if (m_Length + HTTP_CHUNK_HEADER_SIZE + HTTP_CHUNK_TRAILER_SIZE >= HTTP_RESPONSE_BUFFER_SIZE)
+		Flush();
+	m_Chunked = true;
+	m_Limit = HTTP_RESPONSE_BUFFER_SIZE - HTTP_CHUNK_TRAILER_SIZE;
+	m_ChunkStart = m_Length;
+	m_Length += HTTP_CHUNK_HEADER_SIZE; // filled in once the chunk size is known
+}
+
+// Send what is left of the response, returns the size of the whole response
+size_t HttpResponseWriter::End()
+{
+	if (m_Chunked)
+	{
+		// Last data chunk and the terminating zero size chunk go out in the same write
+		CloseChunk();
+		memcpy(m_Buffer + m_Length, "0\r\n\r\n", 5);
+		m_Length += 5;
+		m_Chunked = false;
+	}
+	Send();
+	m_Client = NULL;
+	return m_ResponseBytes;
+}
+
+size_t HttpResponseWriter::write(uint8_t c)
+{
+	if (m_Length >= m_Limit)
+		Flush();
+	m_Buffer[m_Length++] = c;
+	return 1;
+}
+
+size_t HttpResponseWriter::write(const uint8_t* data, size_t size)
+{
+	size_t written = size;
+	while (size > 0)
+	{
+		if (m_Length == 0 && size >= HTTP_RESPONSE_BUFFER_SIZE && !m_Chunked && m_Client != NULL)
+		{
+			// A full segment or more: no need to copy it through the buffer
+			EASYWIFI_DRIVER_VOID(DRIVER_CLIENT_WRITE, m_Client->write(data, HTTP_RESPONSE_BUFFER_SIZE));
+			m_ResponseWriteCalls++;
+			m_TotalWriteCalls++;
+			m_ResponseBytes += HTTP_RESPONSE_BUFFER_SIZE;
+			m_TotalBytesSent += HTTP_RESPONSE_BUFFER_SIZE;
+			data += HTTP_RESPONSE_BUFFER_SIZE;
+			size -= HTTP_RESPONSE_BUFFER_SIZE;
+			continue;
+		}
+		if (m_Length >= m_Limit)
+			Flush();
+		size_t n = m_Limit - m_Length;
+		if (n > size)
+			n = size;
+		memcpy(m_Buffer + m_Length, data, n);
+		m_Length += n;
+		data += n;
+		size -= n;
+	}
+	return written;
+}
+
+// Append a zero terminated text stored in flash (PROGMEM)
+size_t HttpResponseWriter::WriteP(const char* text)
+{
+	return WriteP((const uint8_t*)text, strlen_P(text));
+}
+
+// Append size bytes stored in flash (PROGMEM)
+size_t HttpResponseWriter::WriteP(const uint8_t* data, size_t size)
+{
+	size_t written = size;
+	while (size > 0)
+	{
+		if (m_Length >= m_Limit)
+			Flush();
+		size_t n = m_Limit - m_Length;
+		if (n > size)
+			n = size;
+		memcpy_P(m_Buffer + m_Length, data, n);
+		m_Length += n;
+		data += n;
+		size -= n;
+	}
+	return written;
+}
+
+// Hand the buffered bytes to the client in one write, as one chunk if chunked
+void HttpResponseWriter::Flush()
+{
+	if (m_Chunked)
+	{
+		CloseChunk();
+		Send();
+		m_ChunkStart = 0;
+		m_Length = HTTP_CHUNK_HEADER_SIZE;
+	}
+	else
+	{
+		Send();
+	}
+}
+
+// client.write() calls spent on the current (or last) response
+unsigned long HttpResponseWriter::GetResponseWriteCalls()
+{
+	return m_ResponseWriteCalls;
+}
+
+unsigned long HttpResponseWriter::GetTotalWriteCalls()
+{
+	return m_TotalWriteCalls;
+}
+
+unsigned long HttpResponseWriter::GetTotalBytesSent()
+{
+	return m_TotalBytesSent;
+}
+
+// Fill in the reserved chunk header and terminate the chunk, an empty chunk is dropped
+void HttpResponseWriter::CloseChunk()
+{
+	const char hexDigits[] = "0123456789abcdef";
+	size_t chunkSize = m_Length - m_ChunkStart - HTTP_CHUNK_HEADER_SIZE;
+	if (chunkSize == 0)
+	{
+		m_Length = m_ChunkStart;
+		return;
+	}
+	uint8_t* header = m_Buffer + m_ChunkStart;
+	for (int i = HTTP_CHUNK_DIGITS - 1; i >= 0; i--)
+	{
+		header[i] = hexDigits[chunkSize & 0x0F];
+		chunkSize >>= 4;
+	}
+	header[HTTP_CHUNK_DIGITS] = '\r';
+	header[HTTP_CHUNK_DIGITS + 1] = '\n';
+	m_Buffer[m_Length++] = '\r';
+	m_Buffer[m_Length++] = '\n';
+}
+
+void HttpResponseWriter::Send()
+{
+	if (m_Length == 0 || m_Client == NULL)
+		return;
+	EASYWIFI_DRIVER_VOID(DRIVER_CLIENT_WRITE, m_Client->write(m_Buffer, m_Length));
+	m_ResponseWriteCalls++;
+	m_TotalWriteCalls++;
+	m_ResponseBytes += m_Length;
+	m_TotalBytesSent += m_Length;
+	m_Length = 0;
+}
@@ -0,0 +1,58 @@
+// HttpResponseWriter.h
+
+#ifndef _HTTPRESPONSEWRITER_h
+#define _HTTPRESPONSEWRITER_h
+
+#include <Arduino.h>
+#include <WiFiNINA.h>
+#include "EasyWiFiConfig.h"           // HTTP_RESPONSE_BUFFER_SIZE
+// Hex digits of the chunk size, enough for a chunk filling the buffer
+#if HTTP_RESPONSE_BUFFER_SIZE <= 0xFFF
+#define HTTP_CHUNK_DIGITS 3
+#elif HTTP_RESPONSE_BUFFER_SIZE <= 0xFFFF
+#define HTTP_CHUNK_DIGITS 4
+#else
+#error "HTTP_RESPONSE_BUFFER_SIZE above 65535 is not supported"
+#endif
+#define HTTP_CHUNK_HEADER_SIZE (HTTP_CHUNK_DIGITS + 2) // "XXX\r\n", zero padded
+#define HTTP_CHUNK_TRAILER_SIZE 7        // "\r\n" closing a chunk plus "0\r\n\r\n" closing the body
+
+// Collects a response in a segment sized buffer and hands it to the client in few large writes,
+// instead of one SPI transaction (and often one TCP segment) per print() call.
+// A body of unknown length can be sent with chunked transfer encoding, one chunk per write.
+class HttpResponseWriter : public Print
+{
+public:
+    HttpResponseWriter();
+    void Begin(Client& client);
+    void BeginChunkedBody();
+    size_t End();
+
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t* data, size_t size);
+    using Print::write;
+    size_t WriteP(const char* text);
+    size_t WriteP(const uint8_t* data, size_t size);
+    void Flush();
+
+    unsigned long GetResponseWriteCalls();
+    unsigned long GetTotalWriteCalls();
+    unsigned long GetTotalBytesSent();
+
+private:
+    void CloseChunk();
+    void Send();
+
+    Client* m_Client;
+    uint8_t m_Buffer[HTTP_RESPONSE_BUFFER_SIZE];
+    size_t m_Length;
+    size_t m_Limit;                    // Buffer fill level that triggers a flush
+    size_t m_ChunkStart;               // Offset of the reserved chunk header, if chunked
+    boolean m_Chunked;
+    size_t m_ResponseBytes;            // Bytes of the current response
+    unsigned long m_ResponseWriteCalls; // client.write() calls of the current response
+    unsigned long m_TotalWriteCalls;
+    unsigned long m_TotalBytesSent;
+};
+
+#endif
@@ -0,0 +1,171 @@
+
+#include "JsonWriter.h"
+
+JsonWriter::JsonWriter(Print& out) : m_Out(out)
+{
+	m_Depth = 0;
+	m_HasItems = 0;
+	m_AfterKey = false;
+}
+
+void JsonWriter::BeginObject()
+{
+	Begin('{');
+}
+
+void JsonWriter::EndObject()
+{
+	End('}');
+}
+
+void JsonWriter::BeginArray()
+{
+	Begin('[');
+}
+
+void JsonWriter::EndArray()
+{
+	End(']');
+}
+
+// Member name, the value follows with the next call
+void JsonWriter::Key(const char* name)
+{
+	Separate();
+	WriteString(name);
+	m_Out.print(':');
+	m_AfterKey = true;
+}
+
+void JsonWriter::Value(const char* text)
+{
+	Separate();
+	if (text == NULL)
+		m_Out.print("null");
+	else
+		WriteString(text);
+}
+
+void JsonWriter::Value(long number)
+{
+	Separate();
+	m_Out.print(number);
+}
+
+void JsonWriter::Value(unsigned long number)
+{
+	Separate();
+	m_Out.print(number);
+}
+
+void JsonWriter::Value(int number)
+{
+	Value((long)number);
+}
+
+void JsonWriter::Value(boolean flag)
+{
+	Separate();
+	m_Out.print(flag ? "true" : "false");
+}
+
+void JsonWriter::Null()
+{
+	Separate();
+	m_Out.print("null");
+}
+
+void JsonWriter::Member(const char* name, const char* text)
+{
+	Key(name);
+	Value(text);
+}
+
+void JsonWriter::Member(const char* name, long number)
+{
+	Key(name);
+	Value(number);
+}
+
+void JsonWriter::Member(const char* name, unsigned long number)
+{
+	Key(name);
+	Value(number);
+}
+
+void JsonWriter::Member(const char* name, int number)
+{
+	Key(name);
+	Value(number);
+}
+
+void JsonWriter::Member(const char* name, boolean flag)
+{
+	Key(name);
+	Value(flag);
+}
+
+// Comma before every value but the first of its level, none between a key and its value
+void JsonWriter::Separate()
+{
+	if (m_AfterKey)
+	{
+		m_AfterKey = false;
+		return;
+	}
+	if (m_Depth == 0)
+		return;
+	uint8_t bit = 1 << (m_Depth - 1);
+	if (m_HasItems & bit)
+		m_Out.print(',');
+	m_HasItems |= bit;
+}
+
+void JsonWriter::Begin(char bracket)
+{
+	Separate();
+	m_Out.print(bracket);
+	if (m_Depth < JSON_MAX_DEPTH)
+	{
+		m_Depth++;
+		m_HasItems &= ~(1 << (m_Depth - 1));
+	}
+}
+
+void JsonWriter::End(char bracket)
+{
+	m_Out.print(bracket);
+	if (m_Depth > 0)
+		m_Depth--;
+}
+
+// Quoted and escaped, control characters as \u00XX. Other bytes pass through, SSIDs are UTF-8
+void JsonWriter::WriteString(const char* text)
+{
+	const char hexDigits[] = "0123456789abcdef";
+	m_Out.print('"');
+	for (int i = 0; text[i] != 0; i++)
+	{
+		char c = text[i];
+		if (c == '"' || c == '\\')
+		{
+			m_Out.print('\\');
+			m_Out.print(c);
+		}
+		else if (c == '\n')
+			m_Out.print("\\n");
+		else if (c == '\r')
+			m_Out.print("\\r");
+		else if (c == '\t')
+			m_Out.print("\\t");
+		else if ((uint8_t)c < 0x20)
+		{
+			m_Out.print("\\u00");
+			m_Out.print(hexDigits[(c >> 4) & 0x0F]);
+			m_Out.print(hexDigits[c & 0x0F]);
+		}
+		else
+			m_Out.print(c);
+	}
+	m_Out.print('"');
+}
@@ -0,0 +1,49 @@
+// JsonWriter.h
+
+#ifndef _JSONWRITER_h
+#define _JSONWRITER_h
+
+#include <Arduino.h>
+
+#define JSON_MAX_DEPTH 8                 // Nesting levels of objects and arrays
+
+/* Streaming JSON writer: every value goes straight to out, nothing is built in RAM first.
+   Keeps one bit per nesting level to place the commas, uses no String and no heap.
+   Members are written as Key() followed by a value, or with the Member() shorthands. */
+class JsonWriter
+{
+public:
+    JsonWriter(Print& out);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+    void Key(const char* name);
+
+    void Value(const char* text);
+    void Value(long number);
+    void Value(unsigned long number);
+    void Value(int number);
+    void Value(boolean flag);
+    void Null();
+
+    void Member(const char* name, const char* text);
+    void Member(const char* name, long number);
+    void Member(const char* name, unsigned long number);
+    void Member(const char* name, int number);
+    void Member(const char* name, boolean flag);
+
+private:
+    void Separate();
+    void Begin(char bracket);
+    void End(char bracket);
+    void WriteString(const char* text);
+
+    Print& m_Out;
+    uint8_t m_Depth;
+    uint8_t m_HasItems;                // Bit per level: a value was already written at that level
+    boolean m_AfterKey;                // A key was written, the next value needs no comma
+};
+
+#endif
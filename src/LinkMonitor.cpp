@@ -0,0 +1,159 @@
+
+#include "LinkMonitor.h"
+#include <WiFiNINA.h>
+#include "DriverTrace.h"
+
+LinkMonitor::LinkMonitor()
+{
+	m_Interval = LINK_POLL_INTERVAL;
+	m_Smoothing = LINK_RSSI_SMOOTHING;
+	m_DegradedLevel = LINK_RSSI_DEGRADED;
+	m_RecoveredLevel = LINK_RSSI_RECOVERED;
+	m_DegradedTime = LINK_DEGRADED_TIME;
+	m_LostTime = LINK_LOST_TIME;
+	m_Reads = 0;
+	Reset(0);
+}
+
+// Time in ms between two module reads
+void LinkMonitor::SetInterval(unsigned long interval)
+{
+	m_Interval = interval;
+}
+
+// Weight in percent of a new RSSI sample, 100 turns smoothing off
+void LinkMonitor::SetSmoothing(uint8_t percent)
+{
+	m_Smoothing = (percent == 0) ? 1 : ((percent > 100) ? 100 : percent);
+}
+
+// Smoothed RSSI in dBm that enters and leaves the degraded state, recovered should be above degraded
+void LinkMonitor::SetThresholds(int degraded, int recovered)
+{
+	m_DegradedLevel = degraded;
+	m_RecoveredLevel = (recovered < degraded) ? degraded : recovered;
+}
+
+// Time in ms a degraded or lost link is tolerated before NeedsReconnect()
+void LinkMonitor::SetTimes(unsigned long degradedTime, unsigned long lostTime)
+{
+	m_DegradedTime = degradedTime;
+	m_LostTime = lostTime;
+}
+
+// Start watching a fresh connection at time now, the next Update() reads the module
+void LinkMonitor::Reset(unsigned long now)
+{
+	m_LastRead = now - m_Interval;
+	m_Since = now;
+	m_Rssi16 = 0;
+	m_LastRssi = 0;
+	m_Status = WL_CONNECTED;
+	m_HasRssi = false;
+	m_Degraded = false;
+	m_Lost = false;
+}
+
+// Read status and RSSI if the interval is over, true if it did
+boolean LinkMonitor::Update(unsigned long now)
+{
+	if (now - m_LastRead < m_Interval)
+		return false;
+	m_Reads++;
+	uint8_t status = EASYWIFI_DRIVER(DRIVER_WIFI_STATUS, WiFi.status());
+	int32_t rssi = (status == WL_CONNECTED) ? EASYWIFI_DRIVER(DRIVER_WIFI_RSSI, WiFi.RSSI()) : 0;
+	Sample(now, status, rssi);
+	return true;
+}
+
+// Feed one status / RSSI sample taken at time now. RSSI 0 means the module had no value and is skipped
+void LinkMonitor::Sample(unsigned long now, uint8_t status, int32_t rssi)
+{
+	m_LastRead = now;
+	m_Status = status;
+	if (status != WL_CONNECTED)
+	{
+		if (!m_Lost)
+		{
+			m_Lost = true;
+			m_Since = now;
+		}
+		return;
+	}
+	if (m_Lost)
+	{
+		m_Lost = false;
+		m_Since = now;
+	}
+	if (rssi == 0)
+		return;
+
+	m_LastRssi = rssi;
+	if (!m_HasRssi)
+	{
+		m_Rssi16 = rssi * 16;
+		m_HasRssi = true;
+	}
+	else
+	{
+		m_Rssi16 += (rssi * 16 - m_Rssi16) * m_Smoothing / 100;
+	}
+
+	// hysteresis: enter below the degraded level, leave only above the recovered level
+	int smoothed = GetRssi();
+	if (!m_Degraded && smoothed <= m_DegradedLevel)
+	{
+		m_Degraded = true;
+		m_Since = now;
+	}
+	else if (m_Degraded && smoothed >= m_RecoveredLevel)
+	{
+		m_Degraded = false;
+	}
+}
+
+// Status of the last read was WL_CONNECTED
+boolean LinkMonitor::IsConnected()
+{
+	return !m_Lost;
+}
+
+boolean LinkMonitor::IsDegraded()
+{
+	return m_Degraded;
+}
+
+// The link was lost or degraded for longer than allowed
+boolean LinkMonitor::NeedsReconnect()
+{
+	if (m_Lost)
+		return m_LastRead - m_Since >= m_LostTime;
+	if (m_Degraded)
+		return m_LastRead - m_Since >= m_DegradedTime;
+	return false;
+}
+
+// Smoothed RSSI in dBm, 0 before the first sample
+int LinkMonitor::GetRssi()
+{
+	if (!m_HasRssi)
+		return 0;
+	return (m_Rssi16 - 8) / 16; // round to nearest, the values are negative
+}
+
+// Last raw RSSI sample in dBm
+int32_t LinkMonitor::GetLastRssi()
+{
+	return m_LastRssi;
+}
+
+uint8_t LinkMonitor::GetStatus()
+{
+	return m_Status;
+}
+
+// Status and RSSI reads from the module since the start
+unsigned long LinkMonitor::GetReads()
+{
+	return m_Reads;
+}
@@ -0,0 +1,59 @@
+// LinkMonitor.h
+
+#ifndef _LINKMONITOR_h
+#define _LINKMONITOR_h
+
+#include <Arduino.h>
+
+#define LINK_POLL_INTERVAL 1000          // Time in ms between two reads of status and RSSI from the module
+#define LINK_RSSI_SMOOTHING 25           // Weight in percent of a new RSSI sample in the moving average
+#define LINK_RSSI_DEGRADED -85           // Smoothed RSSI in dBm at or below which the link counts as degraded
+#define LINK_RSSI_RECOVERED -78          // Smoothed RSSI in dBm at or above which a degraded link counts as good again
+#define LINK_DEGRADED_TIME 10000         // Time in ms the link must stay degraded before a reconnect is triggered
+#define LINK_LOST_TIME 3000              // Time in ms the status must stay off WL_CONNECTED before a reconnect is triggered
+
+/* Watches an established connection with one status and one RSSI read per interval.
+   RSSI is smoothed (EWMA) and compared against separate enter / exit thresholds, and a reconnect
+   is only asked for once the link stays degraded or lost for a while: a single bad sample does nothing.
+   Update() reads the module, Sample() holds the logic and can be fed recorded values on the host. */
+class LinkMonitor
+{
+public:
+    LinkMonitor();
+    void SetInterval(unsigned long interval);
+    void SetSmoothing(uint8_t percent);
+    void SetThresholds(int degraded, int recovered);
+    void SetTimes(unsigned long degradedTime, unsigned long lostTime);
+
+    void Reset(unsigned long now);
+    boolean Update(unsigned long now);
+    void Sample(unsigned long now, uint8_t status, int32_t rssi);
+
+    boolean IsConnected();
+    boolean IsDegraded();
+    boolean NeedsReconnect();
+    int GetRssi();
+    int32_t GetLastRssi();
+    uint8_t GetStatus();
+    unsigned long GetReads();
+
+private:
+    unsigned long m_Interval;
+    uint8_t m_Smoothing;
+    int m_DegradedLevel;
+    int m_RecoveredLevel;
+    unsigned long m_DegradedTime;
+    unsigned long m_LostTime;
+
+    unsigned long m_LastRead;          // Time of the last Update() read
+    unsigned long m_Since;             // Time the link became degraded or lost
+    int32_t m_Rssi16;                  // Smoothed RSSI in 1/16 dBm
+    int32_t m_LastRssi;                // Last raw sample
+    uint8_t m_Status;                  // Last WiFi.status()
+    unsigned long m_Reads;             // Module reads since the start
+    boolean m_HasRssi;                 // m_Rssi16 holds a sample
+    boolean m_Degraded;
+    boolean m_Lost;
+};
+
+#endif
@@ -0,0 +1,114 @@
+
+#include "PortalArena.h"
+
+PortalArena::PortalArena()
+{
+	m_Block = NULL;
+	m_Size = 0;
+	m_Used = 0;
+	m_HighWater = 0;
+	m_Failures = 0;
+	m_Finalizers = NULL;
+}
+
+PortalArena::~PortalArena()
+{
+	End();
+}
+
+// Take a block of size bytes from the heap, false if there is not enough free RAM
+boolean PortalArena::Begin(size_t size)
+{
+	End();
+	m_Block = (uint8_t*)malloc(size);
+	if (m_Block == NULL)
+	{
+		m_Failures++;
+		return false;
+	}
+	m_Size = size;
+	return true;
+}
+
+// Destroy the objects of the arena, newest first, and give the block back
+void PortalArena::End()
+{
+	while (m_Finalizers != NULL)
+	{
+		Finalizer* finalizer = m_Finalizers;
+		m_Finalizers = finalizer->next;
+		finalizer->destroy((uint8_t*)finalizer + Align(sizeof(Finalizer)), finalizer->count);
+	}
+	free(m_Block);
+	m_Block = NULL;
+	m_Size = 0;
+	m_Used = 0;
+}
+
+boolean PortalArena::IsActive()
+{
+	return m_Block != NULL;
+}
+
+// size bytes of uninitialised memory, NULL if they do not fit
+void* PortalArena::Allocate(size_t size)
+{
+	size = Align(size);
+	if (m_Block == NULL || size > m_Size - m_Used)
+	{
+		m_Failures++;
+		return NULL;
+	}
+	void* memory = m_Block + m_Used;
+	m_Used += size;
+	if (m_Used > m_HighWater)
+		m_HighWater = m_Used;
+	return memory;
+}
+
+void* PortalArena::AllocateObjects(size_t objectSize, size_t count, void (*destroy)(void*, size_t))
+{
+	uint8_t* memory = (uint8_t*)Allocate(GetObjectsSize(objectSize, count));
+	if (memory == NULL)
+		return NULL;
+	Finalizer* finalizer = (Finalizer*)memory;
+	finalizer->destroy = destroy;
+	finalizer->count = count;
+	finalizer->next = m_Finalizers;
+	m_Finalizers = finalizer;
+	return memory + Align(sizeof(Finalizer));
+}
+
+// Size of the block
+size_t PortalArena::GetSize()
+{
+	return m_Size;
+}
+
+// Bytes allocated since Begin()
+size_t PortalArena::GetUsed()
+{
+	return m_Used;
+}
+
+// Most bytes allocated in one session since the start
+size_t PortalArena::GetHighWater()
+{
+	return m_HighWater;
+}
+
+// Begin() and allocations that failed for lack of RAM or arena space
+unsigned long PortalArena::GetFailures()
+{
+	return m_Failures;
+}
+
+size_t PortalArena::GetObjectsSize(size_t objectSize, size_t count)
+{
+	return Align(sizeof(Finalizer)) + Align(objectSize * count);
+}
+
+size_t PortalArena::Align(size_t size)
+{
+	return (size + PORTAL_ARENA_ALIGNMENT - 1) & ~(size_t)(PORTAL_ARENA_ALIGNMENT - 1);
+}
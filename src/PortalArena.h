@@ -0,0 +1,77 @@
+// PortalArena.h
+
+#ifndef _PORTALARENA_h
+#define _PORTALARENA_h
+
+#include <Arduino.h>
+#include <new>
+
+#define PORTAL_ARENA_ALIGNMENT 8         // Every allocation starts at a multiple of this
+
+/* Bump allocator over one malloc'd block. Everything allocated from it is released together by End():
+   destructors of New() / NewArray() objects run in reverse order and the block goes back to the heap,
+   so a session that needs a lot of RAM for a while leaves no fragments behind.
+   The high-water mark survives End() and shows how large the block really has to be. */
+class PortalArena
+{
+public:
+    PortalArena();
+    ~PortalArena();
+    boolean Begin(size_t size);
+    void End();
+    boolean IsActive();
+
+    void* Allocate(size_t size);
+
+    // Object constructed in the arena, NULL if it does not fit
+    template <typename T, typename... Args> T* New(Args... args)
+    {
+        void* memory = AllocateObjects(sizeof(T), 1, DestroyObjects<T>);
+        return (memory != NULL) ? new (memory) T(args...) : NULL;
+    }
+    // count default constructed objects in the arena, NULL if they do not fit
+    template <typename T> T* NewArray(size_t count)
+    {
+        T* objects = (T*)AllocateObjects(sizeof(T), count, DestroyObjects<T>);
+        if (objects != NULL)
+        {
+            for (size_t i = 0; i < count; i++)
+                new (&objects[i]) T();
+        }
+        return objects;
+    }
+
+    size_t GetSize();
+    size_t GetUsed();
+    size_t GetHighWater();
+    unsigned long GetFailures();
+
+    // Bytes New() / NewArray() use for count objects of objectSize, for sizing the block
+    static size_t GetObjectsSize(size_t objectSize, size_t count = 1);
+
+private:
+    // Ahead of every New() / NewArray() allocation, chained newest first for End()
+    struct Finalizer
+    {
+        void (*destroy)(void* objects, size_t count);
+        Finalizer* next;
+        size_t count;
+    };
+
+    void* AllocateObjects(size_t objectSize, size_t count, void (*destroy)(void*, size_t));
+    template <typename T> static void DestroyObjects(void* objects, size_t count)
+    {
+        for (size_t i = count; i > 0; i--)
+            ((T*)objects)[i - 1].~T();
+    }
+    static size_t Align(size_t size);
+
+    uint8_t* m_Block;
+    size_t m_Size;
+    size_t m_Used;
+    size_t m_HighWater;                // Most bytes used by any session
+    unsigned long m_Failures;          // Allocations that did not fit
+    Finalizer* m_Finalizers;
+};
+
+#endif
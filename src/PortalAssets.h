@@ -0,0 +1,111 @@
+// PortalAssets.h
+// Generated by extras/tools/build_portal_assets.py from extras/portal - do not edit
+
+#ifndef _PORTALASSETS_h
+#define _PORTALASSETS_h
+
+#include <Arduino.h>
+
+// start.html: 276 bytes minified, 217 bytes gzip
+const char PORTAL_START_PAGE[] PROGMEM =
+	"<html><head><title>Welcome</title></head><meta charset='UTF-8'><meta name='viewport' content='width=device-width,initial-scale=1'><body><h1>Welcome to the Arduino IoT Web Server</h1><p>Please select your network:</p><a href=\"/list_networks\">Network Selection</a></body></html>";
+const uint8_t PORTAL_START_PAGE_GZ[] PROGMEM = {
+	0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0x35,0x50,0x41,0x6a,0xc4,0x30,
+	0x0c,0xfc,0x8a,0xd8,0x4b,0x2e,0x0d,0x26,0xb7,0x52,0x6c,0x43,0x2f,0x85,0x5e,0x4a,
+	0xa1,0x5b,0xf6,0x58,0xbc,0xf6,0x14,0x8b,0x3a,0x76,0xb0,0xb5,0x09,0xfb,0xfb,0xba,
+	0x9b,0xed,0x4d,0xa3,0x91,0x66,0x46,0xd2,0x51,0xe6,0x64,0x75,0x84,0x0b,0x56,0x0b,
+	0x4b,0x82,0x3d,0x21,0xf9,0x32,0x43,0xab,0x1d,0x6a,0xb5,0x93,0x33,0xc4,0x91,0x8f,
+	0xae,0x36,0x88,0x19,0x3e,0x8f,0x2f,0xe3,0xe3,0x70,0xef,0x66,0x37,0xc3,0x0c,0x2b,
+	0x63,0x5b,0x4a,0x95,0x81,0x7c,0xc9,0x82,0xdc,0xa7,0x36,0x0e,0x12,0x4d,0xc0,0xca,
+	0x1e,0xe3,0x0d,0x3c,0x70,0x66,0x61,0x97,0xc6,0xe6,0x5d,0x82,0x99,0xba,0xc4,0xb9,
+	0x84,0x6b,0x4f,0x30,0xfd,0x1b,0x93,0x14,0x92,0x08,0x7a,0xae,0xe1,0xc2,0xb9,0xd0,
+	0x6b,0x39,0xd2,0x09,0x67,0xfa,0x40,0x5d,0x51,0x7b,0x9c,0xc9,0xea,0xc5,0xbe,0x27,
+	0xb8,0x06,0x6a,0x48,0xf0,0x42,0xd7,0x72,0xa9,0x94,0x21,0x5b,0xa9,0x3f,0x4f,0x5a,
+	0x2d,0x56,0x3b,0x8a,0x15,0xdf,0xe6,0xa0,0x12,0x37,0xf9,0xba,0x53,0xed,0x60,0xdf,
+	0xf6,0xaa,0xab,0xfd,0x2d,0x72,0xc9,0x5a,0xb9,0x7e,0xe3,0x1e,0x42,0xdd,0xbe,0xf1,
+	0x0b,0x0e,0xab,0xa8,0x96,0x14,0x01,0x00,0x00
+};
+
+// password.html: 1583 bytes minified, 732 bytes gzip
+const char PORTAL_PASSWORD_PAGE[] PROGMEM =
+	"<html><meta charset='UTF-8'><meta name='viewport' content='width=device-width,initial-scale=1'><head><title>Enter Wi-Fi Password</title></head><body><h2>Network: <span id=\"networkName\"></span></h2><form id=\"connectForm\" onsubmit=\"submitForm(event)\" method=\"post\">\n"
+	"Password: <input id=\"passwordField\" type=\"password\" name=\"password\" /><br/>\n"
+	"Show password: <input id=\"showPasswordCheckbox\" type=\"checkbox\" onchange=\"togglePasswordVisibility()\" /><br/><input type=\"submit\" value=\"Connect\"/></form><p id=\"error\"></p><script>\n"
+	"var network = new URLSearchParams(location.search).get('network') || '';\n"
+	"document.getElementById('networkName').textContent = network;\n"
+	"function togglePasswordVisibility() {\n"
+	"var passwordField = document.getElementById('passwordField');\n"
+	"var showPasswordCheckbox = document.getElementById('showPasswordCheckbox');\n"
+	"if (showPasswordCheckbox.checked) {\n"
+	"passwordField.type = 'text';\n"
+	"} else {\n"
+	"passwordField.type = 'password';\n"
+	"}\n"
+	"}\n"
+	"function submitForm(event) {\n"
+	"event.preventDefault();\n"
+	"var password = document.getElementById('passwordField').value;\n"
+	"var xhr = new XMLHttpRequest();\n"
+	"xhr.open('POST', '/connect', true);\n"
+	"xhr.setRequestHeader('Content-Type', 'application/x-www-form-urlencoded');\n"
+	"xhr.onreadystatechange = function() {\n"
+	"if (xhr.readyState === 4 && xhr.status === 200) {\n"
+	"document.body.innerHTML = xhr.responseText;\n"
+	"} else if (xhr.readyState === 4) {\n"
+	"document.getElementById('error').textContent = xhr.responseText;\n"
+	"}\n"
+	"};\n"
+	"var params = 'network=' + encodeURIComponent(network) + '&password=' + encodeURIComponent(password);\n"
+	"xhr.send(params);\n"
+	"}\n"
+	"</script></body></html>";
+const uint8_t PORTAL_PASSWORD_PAGE_GZ[] PROGMEM = {
+	0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0x95,0x55,0x5d,0x6f,0xd3,0x30,
+	0x14,0x7d,0xef,0xaf,0xb0,0xf2,0x30,0x27,0x62,0x4d,0xc6,0xc4,0x03,0x62,0x49,0x1e,
+	0x28,0x9b,0x36,0x69,0x8c,0x69,0xed,0x80,0x57,0x37,0xb9,0x6d,0xac,0x25,0x76,0xb0,
+	0x9d,0x7e,0x88,0xed,0xbf,0x73,0x6d,0x27,0x85,0xb2,0x16,0x09,0xf5,0x21,0xf6,0xfd,
+	0x38,0xf7,0xfa,0x9c,0x6b,0x37,0xad,0x4c,0x53,0xe7,0x69,0x03,0x86,0x91,0xa2,0x62,
+	0x4a,0x83,0xc9,0xe8,0xe3,0xec,0x6a,0xfc,0x9e,0xf6,0x56,0xc1,0x1a,0xc8,0xe8,0x8a,
+	0xc3,0xba,0x95,0xca,0x50,0x52,0x48,0x61,0x40,0x60,0xd4,0x9a,0x97,0xa6,0xca,0x4a,
+	0x58,0xf1,0x02,0xc6,0x6e,0x73,0xca,0x05,0x37,0x9c,0xd5,0x63,0x5d,0xb0,0x1a,0xb2,
+	0xb7,0x08,0x51,0x01,0x2b,0xf3,0xd4,0x70,0x53,0x43,0x7e,0x89,0x89,0x8a,0x7c,0xe3,
+	0xe3,0x2b,0x4e,0xee,0x99,0xd6,0x6b,0xa9,0xca,0x34,0xf1,0xbe,0x34,0xf1,0x91,0x73,
+	0x59,0x6e,0x31,0xeb,0x3c,0xbf,0x03,0x83,0xfe,0xa7,0x0f,0x24,0xd5,0x2d,0x13,0x84,
+	0x97,0x59,0x20,0xbc,0xe9,0x0e,0x1b,0x0a,0x30,0xc1,0xda,0x6d,0xde,0x79,0x9e,0x2e,
+	0xa4,0x6a,0x5c,0x08,0x36,0x27,0xa0,0x30,0x57,0xb8,0x0f,0x88,0x14,0xba,0x9b,0x37,
+	0xdc,0x64,0x81,0xff,0x5a,0x6b,0x08,0x2b,0x6c,0x3e,0x0a,0x08,0x9e,0xad,0x92,0x98,
+	0xd1,0x4a,0x6d,0x82,0x7c,0x34,0xf4,0x83,0xf5,0xb8,0x68,0x3b,0xe3,0xd0,0xda,0xde,
+	0x78,0xc5,0xa1,0x2e,0x03,0x62,0xb6,0x2d,0xfc,0x36,0x06,0x9e,0x99,0x3f,0xf6,0x09,
+	0xb6,0xaf,0x92,0x7c,0x34,0xad,0xe4,0x9a,0xb4,0x87,0x00,0x35,0x7a,0x86,0x4a,0x93,
+	0x0a,0x8a,0xa7,0xb9,0xdc,0x0c,0xb8,0xc5,0x6e,0x2f,0x05,0x2a,0x21,0x96,0x68,0x33,
+	0x72,0xb9,0xac,0x61,0xc8,0xf8,0xca,0x35,0x9f,0xf3,0x9a,0x9b,0x6d,0x18,0xed,0xaa,
+	0xf5,0xe8,0x1e,0xc3,0x9f,0x33,0x20,0x2b,0x56,0x77,0xb8,0x9d,0x78,0x36,0x02,0x8c,
+	0x4a,0x2c,0x45,0x79,0xda,0xba,0x36,0x40,0x29,0xa9,0x2c,0x85,0x6d,0x9e,0xea,0x42,
+	0xf1,0xd6,0xe4,0xa3,0x15,0x53,0xa4,0x27,0x98,0x64,0xb8,0x5a,0x93,0xc7,0x87,0xdb,
+	0x29,0x30,0x55,0x54,0xf7,0x4c,0xb1,0x46,0x87,0xb5,0x2c,0x98,0xe1,0x52,0xc4,0xda,
+	0x59,0xa3,0x78,0x09,0x26,0xa4,0x7d,0x0e,0x8d,0xc8,0xf3,0x33,0xa1,0xf4,0x62,0x54,
+	0xca,0xa2,0x6b,0x90,0x63,0xeb,0xbe,0xac,0xc1,0x2e,0x3f,0x6e,0x6f,0xca,0x5d,0xa4,
+	0x95,0x8f,0x46,0xb1,0x81,0x8d,0x99,0xf8,0x51,0x72,0xf5,0x9c,0xef,0x62,0xb4,0xe8,
+	0x44,0x61,0x8b,0x90,0xe3,0x47,0x27,0x3f,0x5d,0xb3,0x7b,0xe2,0x20,0xc4,0xd1,0xba,
+	0x7b,0x81,0x34,0xba,0x70,0xd9,0x87,0x94,0xf8,0x17,0xc8,0xa1,0x78,0x8b,0xc5,0x17,
+	0x24,0x3c,0xe4,0x8b,0x9d,0x9c,0x50,0xda,0x6e,0xf7,0x1a,0x88,0xad,0x52,0x58,0x89,
+	0x5a,0x02,0x90,0xae,0x17,0x02,0xb5,0x86,0xa3,0x51,0x83,0xd5,0x46,0xe2,0x6f,0x47,
+	0xcf,0xab,0x89,0x46,0x04,0xb7,0x88,0x5b,0xe5,0xbe,0x9f,0x60,0xc1,0xba,0xda,0x84,
+	0xfd,0x79,0x07,0x9c,0xff,0x20,0x2a,0x76,0x53,0xe4,0xd3,0x37,0x95,0xea,0xa7,0xe2,
+	0xfb,0xe7,0xdb,0x6b,0x63,0xda,0x07,0xf8,0xd1,0x81,0x76,0xf0,0xe8,0x8b,0x65,0x0b,
+	0x22,0xa4,0xf7,0x5f,0xa6,0x33,0x7a,0x4a,0x68,0xd2,0x5f,0x43,0x5c,0x1b,0xd5,0x41,
+	0x1f,0x83,0x4f,0x4b,0x9f,0x75,0x8d,0x57,0x1d,0x54,0x48,0x7b,0xfd,0xc7,0x33,0x3c,
+	0xac,0xcd,0x63,0x6d,0x5b,0x73,0x3f,0x64,0xc9,0x66,0xbc,0x5e,0xaf,0xc7,0x76,0x6a,
+	0xc7,0x9d,0xaa,0x41,0x14,0xb2,0x04,0xa7,0x9e,0x2b,0x27,0x14,0x42,0x6c,0xb5,0x61,
+	0x06,0xfc,0x5d,0xc1,0xee,0x06,0x6e,0xdc,0x84,0x58,0x5d,0x6c,0xa4,0x8b,0x9b,0xda,
+	0x38,0x92,0x65,0x19,0x79,0x47,0x4e,0x4e,0x88,0x6b,0x06,0x4d,0x9d,0x76,0xb6,0xf3,
+	0xb3,0x33,0x9b,0xb1,0xa3,0xc5,0x3e,0x41,0x31,0xc7,0x03,0xa8,0xeb,0xd9,0xe7,0x5b,
+	0x04,0xf6,0x38,0xba,0xc5,0xf7,0x04,0x66,0xa8,0xda,0x4e,0xb4,0x63,0x45,0xf6,0xe0,
+	0xfe,0x66,0xd9,0x5d,0xbe,0x57,0x17,0xe0,0x40,0x8d,0xd1,0xcb,0x20,0x9d,0xbd,0x7e,
+	0x76,0x18,0xfa,0x5b,0x92,0x51,0xf2,0x86,0x78,0x46,0x1e,0x1f,0x6e,0x26,0xb2,0xc1,
+	0x2c,0x44,0x09,0x7b,0x77,0x84,0x5e,0x7a,0x32,0x88,0x79,0x2c,0x78,0xf0,0xef,0xc4,
+	0x11,0x65,0xe8,0x2b,0x45,0xb6,0x36,0x3e,0xaf,0xfe,0x61,0x48,0x13,0xff,0x24,0x27,
+	0xee,0x8f,0xe2,0x17,0xd6,0xbf,0xdf,0x51,0x2f,0x06,0x00,0x00
+};
+
+#endif
@@ -0,0 +1,84 @@
+// PortalPages.h
+// Flash resident templates of the dynamic access point portal pages, sent through HttpResponseWriter::WriteP()
+// Static pages are generated into PortalAssets.h by extras/tools/build_portal_assets.py
+
+#ifndef _PORTALPAGES_h
+#define _PORTALPAGES_h
+
+#include <Arduino.h>
+
+// Header lines of a portal page, followed by the framing and connection headers
+const char PORTAL_HTML_HEADER[] PROGMEM =
+	"Content-Type: text/html\r\n"
+	"Cache-Control: no-store\r\n";
+
+// Header lines of a JSON API response
+const char PORTAL_JSON_HEADER[] PROGMEM =
+	"Content-Type: application/json\r\n"
+	"Cache-Control: no-store\r\n";
+
+// Header lines of a plain text answer, e.g. the error of a rejected form
+const char PORTAL_TEXT_HEADER[] PROGMEM =
+	"Content-Type: text/plain\r\n"
+	"Cache-Control: no-store\r\n";
+
+// Header lines of the /metrics page, Prometheus text format
+const char PORTAL_METRICS_HEADER[] PROGMEM =
+	"Content-Type: text/plain; version=0.0.4\r\n"
+	"Cache-Control: no-store\r\n";
+
+// Header lines of a gzip compressed static page from PortalAssets.h
+const char PORTAL_HTML_GZIP_HEADER[] PROGMEM =
+	"Content-Type: text/html\r\n"
+	"Content-Encoding: gzip\r\n"
+	"Vary: Accept-Encoding\r\n";
+
+const char PORTAL_NETWORK_LIST_BEGIN[] PROGMEM =
+	"<html>\n"
+	"<head><title>Select your network</title></head>\n"
+	"<meta charset='UTF-8'>\n"
+	"<meta name='viewport' content='width=device-width,initial-scale=1'>\n"
+	"<body>\n"
+	"<h2>Select your network:</h2>\n";
+
+// Scan age and rescan button below the network list, the age in seconds goes in between
+const char PORTAL_NETWORK_LIST_AGE_BEGIN[] PROGMEM =
+	"<p>Scanned ";
+
+const char PORTAL_NETWORK_LIST_AGE_END[] PROGMEM =
+	" s ago</p>\n"
+	"<form action=\"/refresh\" method=\"post\"><input type=\"submit\" value=\"Scan again\"/></form>\n";
+
+const char PORTAL_NETWORK_LIST_END[] PROGMEM =
+	"</body>\n"
+	"</html>\n"
+	"<meta http-equiv=\"refresh\" content=\"20;url=http://";
+
+// Answer to /refresh, the access point goes down for the rescan
+const char PORTAL_RESCAN_PAGE[] PROGMEM =
+	"<html>\n"
+	"<head><title>Scanning</title></head>\n"
+	"<meta charset='UTF-8'>\n"
+	"<meta name='viewport' content='width=device-width,initial-scale=1'>\n"
+	"<meta http-equiv=\"refresh\" content=\"15;url=/list_networks\">\n"
+	"<body>\n"
+	"<h2>Scanning for networks</h2>\n"
+	"<p>The access point restarts for a few seconds. Reconnect to it if your device does not do so by itself.</p>\n"
+	"</body>\n"
+	"</html>\n";
+
+const char PORTAL_CONNECTING_PAGE_BEGIN[] PROGMEM =
+	"<html>\n"
+	"<head><title>Connection Status</title></head>\n"
+	"<meta charset='UTF-8'>\n"
+	"<meta name='viewport' content='width=device-width,initial-scale=1'>\n"
+	"<body>\n"
+	"<h2>Connecting to network: ";
+
+const char PORTAL_CONNECTING_PAGE_END[] PROGMEM =
+	"</h2>\n"
+	"<p>The access point closes now. If the connection fails it opens again.</p>\n"
+	"</body>\n"
+	"</html>\n";
+
+#endif
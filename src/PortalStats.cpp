@@ -0,0 +1,81 @@
+
+#include "PortalStats.h"
+
+PortalStats::PortalStats()
+{
+	Reset();
+}
+
+void PortalStats::Reset()
+{
+	memset(m_Routes, 0, sizeof(m_Routes));
+}
+
+// Count one request of route, answered after latency ms
+void PortalStats::Record(EasyWiFiPortalRoute route, unsigned long latency, boolean failed)
+{
+	EasyWiFiRouteStats& stats = m_Routes[route];
+	stats.requests++;
+	if (failed)
+		stats.failures++;
+
+	uint8_t bucket = 0;
+	while (latency > 0 && bucket < PORTAL_LATENCY_BUCKETS - 1)
+	{
+		latency >>= 1;
+		bucket++;
+	}
+	stats.latency[bucket]++;
+}
+
+const EasyWiFiRouteStats& PortalStats::Get(EasyWiFiPortalRoute route)
+{
+	return m_Routes[route];
+}
+
+/* Latency in ms that percent of the requests of route stayed below, as the upper bound of its histogram bucket */
+unsigned long PortalStats::GetPercentile(EasyWiFiPortalRoute route, uint8_t percent)
+{
+	EasyWiFiRouteStats& stats = m_Routes[route];
+	if (stats.requests == 0)
+		return 0;
+	unsigned long rank = (stats.requests * percent + 99) / 100;
+	unsigned long count = 0;
+	for (uint8_t bucket = 0; bucket < PORTAL_LATENCY_BUCKETS; bucket++)
+	{
+		count += stats.latency[bucket];
+		if (count >= rank)
+			return 1UL << bucket;
+	}
+	return 1UL << (PORTAL_LATENCY_BUCKETS - 1);
+}
+
+/* Print one CSV line per route: route,requests,failures,p50_ms,p99_ms */
+void PortalStats::PrintTo(Print& out)
+{
+	out.print("route,requests,failures,p50_ms,p99_ms\n");
+	for (uint8_t route = 0; route < EASYWIFI_ROUTE_COUNT; route++)
+	{
+		out.print(GetRouteName((EasyWiFiPortalRoute)route)); out.print(',');
+		out.print(m_Routes[route].requests); out.print(',');
+		out.print(m_Routes[route].failures); out.print(',');
+		out.print(GetPercentile((EasyWiFiPortalRoute)route, 50)); out.print(',');
+		out.print(GetPercentile((EasyWiFiPortalRoute)route, 99)); out.print('\n');
+	}
+}
+
+const char* PortalStats::GetRouteName(EasyWiFiPortalRoute route)
+{
+	switch (route)
+	{
+	case EASYWIFI_ROUTE_PROBE: return "probe";
+	case EASYWIFI_ROUTE_START: return "start";
+	case EASYWIFI_ROUTE_NETWORK_LIST: return "list_networks";
+	case EASYWIFI_ROUTE_ENTER_PASSWORD: return "enter_password";
+	case EASYWIFI_ROUTE_CONNECT: return "connect";
+	case EASYWIFI_ROUTE_REFRESH: return "refresh";
+	case EASYWIFI_ROUTE_API: return "api";
+	case EASYWIFI_ROUTE_METRICS: return "metrics";
+	default: return "other";
+	}
+}
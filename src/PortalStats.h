@@ -0,0 +1,49 @@
+// PortalStats.h
+
+#ifndef _PORTALSTATS_h
+#define _PORTALSTATS_h
+
+#include <Arduino.h>
+
+#define PORTAL_LATENCY_BUCKETS 12        // Latency histogram buckets: <1, <2, <4 ... <1024, >=1024 ms
+
+// Steps a phone goes through in the access point portal
+enum EasyWiFiPortalRoute
+{
+    EASYWIFI_ROUTE_PROBE,           // Captive portal detection (generate_204, hotspot-detect, ...)
+    EASYWIFI_ROUTE_START,           // "/"
+    EASYWIFI_ROUTE_NETWORK_LIST,    // "/list_networks"
+    EASYWIFI_ROUTE_ENTER_PASSWORD,  // "/enterPassword"
+    EASYWIFI_ROUTE_CONNECT,         // "POST /connect"
+    EASYWIFI_ROUTE_REFRESH,         // "/refresh"
+    EASYWIFI_ROUTE_API,             // "/api/..." JSON endpoints
+    EASYWIFI_ROUTE_METRICS,         // "/metrics"
+    EASYWIFI_ROUTE_OTHER,           // Anything else, malformed and timed out requests
+    EASYWIFI_ROUTE_COUNT
+};
+
+struct EasyWiFiRouteStats
+{
+    unsigned long requests;
+    unsigned long failures;                         // Malformed, timed out or unanswered requests
+    unsigned long latency[PORTAL_LATENCY_BUCKETS];  // Requests per latency bucket
+};
+
+// Per route request counters and latency histograms of the access point portal
+class PortalStats
+{
+public:
+    PortalStats();
+    void Reset();
+    void Record(EasyWiFiPortalRoute route, unsigned long latency, boolean failed);
+    const EasyWiFiRouteStats& Get(EasyWiFiPortalRoute route);
+    unsigned long GetPercentile(EasyWiFiPortalRoute route, uint8_t percent);
+    void PrintTo(Print& out);
+
+    static const char* GetRouteName(EasyWiFiPortalRoute route);
+
+private:
+    EasyWiFiRouteStats m_Routes[EASYWIFI_ROUTE_COUNT];
+};
+
+#endif
@@ -0,0 +1,120 @@
+
+#include "RetryPolicy.h"
+
+RetryPolicy::RetryPolicy()
+{
+	m_InitialDelay = RETRY_INITIAL_DELAY;
+	m_Multiplier = RETRY_MULTIPLIER;
+	m_MaxDelay = RETRY_MAX_DELAY;
+	m_Jitter = RETRY_JITTER;
+	m_MaxAttempts = RETRY_MAX_ATTEMPTS;
+	m_MaxTime = RETRY_MAX_TIME;
+	m_OnExhausted = RETRY_OPEN_PORTAL;
+	m_RandomState = 0x9E3779B9;
+	m_Seeded = false;
+	Reset(0);
+}
+
+// Delay before the first retry, its growth per retry in percent (100 keeps it constant) and its upper limit, all in ms
+void RetryPolicy::SetDelays(unsigned long initialDelay, uint16_t multiplier, unsigned long maxDelay)
+{
+	m_InitialDelay = initialDelay;
+	m_Multiplier = (multiplier < 100) ? 100 : multiplier;
+	m_MaxDelay = (maxDelay < initialDelay) ? initialDelay : maxDelay;
+}
+
+// Every delay is varied by a random amount of up to +/- percent
+void RetryPolicy::SetJitter(uint8_t percent)
+{
+	m_Jitter = (percent > 100) ? 100 : percent;
+}
+
+// Attempts and time in ms spent on one network before giving up on it, 0 for no limit
+void RetryPolicy::SetBudget(int maxAttempts, unsigned long maxTime)
+{
+	m_MaxAttempts = maxAttempts;
+	m_MaxTime = maxTime;
+}
+
+void RetryPolicy::SetOnExhausted(RetryExhaustedAction action)
+{
+	m_OnExhausted = action;
+}
+
+// Seed of the jitter, should differ between devices. Without a call EasyWiFi seeds it from the MAC address
+void RetryPolicy::Seed(uint32_t seed)
+{
+	m_RandomState = (seed != 0) ? seed : 0x9E3779B9; // xorshift never leaves 0
+	m_Seeded = true;
+}
+
+// true once Seed() was called
+boolean RetryPolicy::IsSeeded()
+{
+	return m_Seeded;
+}
+
+// Start a new budget at time now
+void RetryPolicy::Reset(unsigned long now)
+{
+	m_StartTime = now;
+	m_Delay = m_InitialDelay;
+	m_Attempts = 0;
+}
+
+// Count an attempt that was just started
+void RetryPolicy::OnAttempt()
+{
+	m_Attempts++;
+}
+
+/* After a failed attempt at time now: false if the budget is exhausted, else true with the delay in ms
+   to wait before the next attempt. A retry that would start past the time budget counts as exhausted. */
+boolean RetryPolicy::Next(unsigned long now, unsigned long& delay)
+{
+	if (m_MaxAttempts > 0 && m_Attempts >= m_MaxAttempts)
+		return false;
+
+	delay = m_Delay;
+	if (m_Jitter > 0 && delay > 0)
+	{
+		unsigned long spread = delay / 100 * m_Jitter + (delay % 100) * m_Jitter / 100;
+		delay = delay - spread + Random() % (2 * spread + 1);
+	}
+	if (m_MaxTime > 0 && now - m_StartTime + delay >= m_MaxTime)
+		return false;
+
+	// grow the delay for the retry after this one
+	if (m_Delay >= m_MaxDelay / m_Multiplier * 100)
+		m_Delay = m_MaxDelay;
+	else
+		m_Delay = m_Delay * m_Multiplier / 100;
+	if (m_Delay > m_MaxDelay)
+		m_Delay = m_MaxDelay;
+	return true;
+}
+
+// Attempts since the last Reset()
+int RetryPolicy::GetAttempts()
+{
+	return m_Attempts;
+}
+
+unsigned long RetryPolicy::GetMaxDelay()
+{
+	return m_MaxDelay;
+}
+
+RetryExhaustedAction RetryPolicy::GetOnExhausted()
+{
+	return m_OnExhausted;
+}
+
+// xorshift32, enough to spread retries and the same sequence on any target for a given seed
+uint32_t RetryPolicy::Random()
+{
+	m_RandomState ^= m_RandomState << 13;
+	m_RandomState ^= m_RandomState >> 17;
+	m_RandomState ^= m_RandomState << 5;
+	return m_RandomState;
+}
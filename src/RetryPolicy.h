@@ -0,0 +1,63 @@
+// RetryPolicy.h
+
+#ifndef _RETRYPOLICY_h
+#define _RETRYPOLICY_h
+
+#include <Arduino.h>
+
+#define RETRY_INITIAL_DELAY 1000         // Time in ms before the first retry
+#define RETRY_MULTIPLIER 200             // Growth of the delay per retry in percent
+#define RETRY_MAX_DELAY 30000            // Longest delay in ms between two attempts
+#define RETRY_JITTER 25                  // Delay varied by up to +/- this percentage
+#define RETRY_MAX_ATTEMPTS 4             // Attempts per network before the budget is exhausted
+#define RETRY_MAX_TIME 90000             // Time in ms per network before the budget is exhausted, 0 for none
+
+// What EasyWiFi does once the attempts for all stored networks are exhausted
+enum RetryExhaustedAction
+{
+    RETRY_OPEN_PORTAL,      // Open the access point portal (fails instead if UseAccessPoint(false))
+    RETRY_FAIL,             // Give up, EASYWIFI_FAILED
+    RETRY_START_OVER        // Wait the max delay, then try the stored networks again
+};
+
+/* Exponential backoff with jitter and attempt / time budgets for the connect loop.
+   Never reads the clock itself: the caller passes the time, so a host test can drive it with a virtual clock.
+   The jitter comes from an own xorshift generator, seeded per device so a floor of devices does not retry in lockstep. */
+class RetryPolicy
+{
+public:
+    RetryPolicy();
+    void SetDelays(unsigned long initialDelay, uint16_t multiplier, unsigned long maxDelay);
+    void SetJitter(uint8_t percent);
+    void SetBudget(int maxAttempts, unsigned long maxTime);
+    void SetOnExhausted(RetryExhaustedAction action);
+    void Seed(uint32_t seed);
+    boolean IsSeeded();
+
+    void Reset(unsigned long now);
+    void OnAttempt();
+    boolean Next(unsigned long now, unsigned long& delay);
+
+    int GetAttempts();
+    unsigned long GetMaxDelay();
+    RetryExhaustedAction GetOnExhausted();
+
+private:
+    uint32_t Random();
+
+    unsigned long m_InitialDelay;
+    uint16_t m_Multiplier;             // Percent
+    unsigned long m_MaxDelay;
+    uint8_t m_Jitter;                  // Percent
+    int m_MaxAttempts;
+    unsigned long m_MaxTime;
+    RetryExhaustedAction m_OnExhausted;
+
+    unsigned long m_StartTime;         // Time of Reset()
+    unsigned long m_Delay;             // Delay before jitter of the next retry
+    int m_Attempts;                    // Attempts since Reset()
+    uint32_t m_RandomState;
+    boolean m_Seeded;                  // Seed() was called, Begin() keeps the sequence
+};
+
+#endif